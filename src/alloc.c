@@ -0,0 +1,412 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/alloc.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions for pluggable memory allocators.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "alloc.h"
+#include "util.h"
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stddef.h>                     /* for max_align_t */
+#include <stdlib.h>
+#include <string.h>                     /* for memcpy(3) */
+
+/// @endcond
+
+/// Default size of an arena chunk.
+#define ALLOC_ARENA_CHUNK_SIZE_DEFAULT  (64 * 1024)
+
+/// Value of alloc_arena_chunk::last when there is no last block.
+#define ALLOC_ARENA_NO_LAST             SIZE_MAX
+
+/**
+ * Header preceding every block allocated by an arena or limit allocator.
+ */
+union alloc_hdr {
+  size_t      size;                     ///< Size of the block (sans header).
+  max_align_t align;                    ///< Ensures alignment of the block.
+};
+typedef union alloc_hdr alloc_hdr_t;
+
+/**
+ * A chunk of memory blocks are allocated from by an arena.
+ */
+struct alloc_arena_chunk {
+  alloc_arena_chunk_t  *prev;           ///< Previous chunk, if any.
+  size_t                size;           ///< Usable bytes in \a data.
+  size_t                used;           ///< Bytes used in \a data.
+  size_t                last;           ///< Offset of most recent block.
+  max_align_t           data[];         ///< Memory for blocks.
+};
+
+/**
+ * Live memory of a subsystem.
+ */
+struct alloc_sub_stats {
+  atomic_size_t objects;                ///< Number of live objects.
+  atomic_size_t bytes;                  ///< Number of live bytes.
+};
+typedef struct alloc_sub_stats alloc_sub_stats_t;
+
+// local functions
+PJL_WARN_UNUSED_RESULT
+static void*  libc_realloc( allocator_t*, void*, size_t );
+
+static void   libc_free( allocator_t*, void* );
+
+// extern variable definitions
+allocator_t alloc_libc = { &libc_realloc, &libc_free };
+
+// local variable definitions
+static _Thread_local allocator_t     *alloc_cur = &alloc_libc;
+static _Thread_local alloc_oom_fn_t   alloc_oom_fn;
+static alloc_sub_stats_t              alloc_sub_stats[ ALLOC_SUB_NUM ];
+
+/**
+ * Names of subsystems indexed by <code>\ref alloc_sub</code>.
+ */
+static char const *const ALLOC_SUB_NAME[] = {
+  "AST nodes",                          // ALLOC_SUB_AST
+  "scoped names",                       // ALLOC_SUB_SNAME
+  "typedefs",                           // ALLOC_SUB_TYPEDEF
+  "typedef sets",                       // ALLOC_SUB_RCU_SET
+  "parser stacks",                      // ALLOC_SUB_PARSER
+  "strbufs",                            // ALLOC_SUB_STRBUF
+  "free_later list",                    // ALLOC_SUB_FREE_LATER
+};
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Rounds \a size up to a multiple of the alignment of <code>\ref
+ * alloc_hdr</code>.
+ *
+ * @param size The size to round.
+ * @return Returns said size.
+ */
+PJL_WARN_UNUSED_RESULT
+static inline size_t alloc_round_up( size_t size ) {
+  return (size + sizeof(alloc_hdr_t) - 1) & ~(sizeof(alloc_hdr_t) - 1);
+}
+
+/**
+ * Allocates a new block from an arena.
+ *
+ * @param arena A pointer to the arena.
+ * @param size The number of bytes to allocate; must be a multiple of the size
+ * of <code>\ref alloc_hdr</code>.
+ * @return Returns a pointer to the header of the block or NULL on failure.
+ */
+PJL_WARN_UNUSED_RESULT
+static alloc_hdr_t* arena_alloc( alloc_arena_t *arena, size_t size ) {
+  size_t const need = sizeof(alloc_hdr_t) + size;
+  alloc_arena_chunk_t *chunk = arena->chunk;
+
+  if ( chunk == NULL || chunk->size - chunk->used < need ) {
+    size_t const chunk_size =
+      need > arena->chunk_size ? need : arena->chunk_size;
+    chunk = (*arena->parent->realloc_fn)(
+      arena->parent, NULL, sizeof(alloc_arena_chunk_t) + chunk_size
+    );
+    if ( chunk == NULL )
+      return NULL;
+    chunk->prev = arena->chunk;
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    chunk->last = ALLOC_ARENA_NO_LAST;
+    arena->chunk = chunk;
+  }
+
+  alloc_hdr_t *const hdr = (alloc_hdr_t*)((char*)chunk->data + chunk->used);
+  hdr->size = size;
+  chunk->last = chunk->used;
+  chunk->used += need;
+  return hdr;
+}
+
+/**
+ * Checks whether \a hdr is the most recently allocated block of \a arena.
+ *
+ * @param arena A pointer to the arena.
+ * @param hdr A pointer to the header of the block.
+ * @return Returns `true` only if it is.
+ */
+PJL_WARN_UNUSED_RESULT
+static inline bool arena_is_last( alloc_arena_t const *arena,
+                                  alloc_hdr_t const *hdr ) {
+  alloc_arena_chunk_t const *const chunk = arena->chunk;
+  return  chunk != NULL && chunk->last != ALLOC_ARENA_NO_LAST &&
+          (char const*)hdr == (char const*)chunk->data + chunk->last;
+}
+
+/**
+ * Frees memory allocated by an arena.  This is a no-op unless \a p is the
+ * most recent allocation.
+ *
+ * @param a A pointer to the arena.
+ * @param p A pointer to the memory to free.
+ */
+static void arena_free( allocator_t *a, void *p ) {
+  alloc_arena_t *const arena = (alloc_arena_t*)a;
+  alloc_hdr_t *const hdr = (alloc_hdr_t*)p - 1;
+  if ( arena_is_last( arena, hdr ) ) {
+    arena->chunk->used = arena->chunk->last;
+    arena->chunk->last = ALLOC_ARENA_NO_LAST;
+  }
+}
+
+/**
+ * Reallocates memory from an arena.  The most recent allocation is grown in
+ * place if possible.
+ *
+ * @param a A pointer to the arena.
+ * @param p The pointer to reallocate or NULL.
+ * @param size The number of bytes to allocate.
+ * @return Returns a pointer to the allocated memory or NULL on failure.
+ */
+PJL_WARN_UNUSED_RESULT
+static void* arena_realloc( allocator_t *a, void *p, size_t size ) {
+  alloc_arena_t *const arena = (alloc_arena_t*)a;
+  size = alloc_round_up( size );
+
+  if ( p == NULL ) {
+    alloc_hdr_t *const hdr = arena_alloc( arena, size );
+    return hdr != NULL ? hdr + 1 : NULL;
+  }
+
+  alloc_hdr_t *const old_hdr = (alloc_hdr_t*)p - 1;
+  if ( size <= old_hdr->size )
+    return p;
+
+  if ( arena_is_last( arena, old_hdr ) ) {
+    alloc_arena_chunk_t *const chunk = arena->chunk;
+    size_t const need = sizeof(alloc_hdr_t) + size;
+    if ( chunk->size - chunk->last >= need ) {
+      old_hdr->size = size;
+      chunk->used = chunk->last + need;
+      return p;
+    }
+  }
+
+  alloc_hdr_t *const new_hdr = arena_alloc( arena, size );
+  if ( new_hdr == NULL )
+    return NULL;
+  memcpy( new_hdr + 1, p, old_hdr->size );
+  return new_hdr + 1;
+}
+
+/**
+ * Frees memory via **free**(3).
+ *
+ * @param a Not used.
+ * @param p A pointer to the memory to free.
+ */
+static void libc_free( allocator_t *a, void *p ) {
+  (void)a;
+  free( p );
+}
+
+/**
+ * Reallocates memory via **realloc**(3).
+ *
+ * @param a Not used.
+ * @param p The pointer to reallocate or NULL.
+ * @param size The number of bytes to allocate.
+ * @return Returns a pointer to the allocated memory or NULL on failure.
+ */
+PJL_WARN_UNUSED_RESULT
+static void* libc_realloc( allocator_t *a, void *p, size_t size ) {
+  (void)a;
+  //
+  // Autoconf, 5.5.1:
+  //
+  // realloc
+  //    The C standard says a call realloc(NULL, size) is equivalent to
+  //    malloc(size), but some old systems don't support this (e.g., NextStep).
+  //
+  return p != NULL ? realloc( p, size ) : malloc( size );
+}
+
+/**
+ * Frees memory via a limit allocator's parent.
+ *
+ * @param a A pointer to the limit allocator.
+ * @param p A pointer to the memory to free.
+ */
+static void limit_free( allocator_t *a, void *p ) {
+  alloc_limit_t *const lim = (alloc_limit_t*)a;
+  alloc_hdr_t *const hdr = (alloc_hdr_t*)p - 1;
+  assert( lim->cur_bytes >= hdr->size );
+  lim->cur_bytes -= hdr->size;
+  ++lim->n_frees;
+  (*lim->parent->free_fn)( lim->parent, hdr );
+}
+
+/**
+ * Reallocates memory via a limit allocator's parent unless doing so would
+ * exceed its limit.
+ *
+ * @param a A pointer to the limit allocator.
+ * @param p The pointer to reallocate or NULL.
+ * @param size The number of bytes to allocate.
+ * @return Returns a pointer to the allocated memory or NULL on failure.
+ */
+PJL_WARN_UNUSED_RESULT
+static void* limit_realloc( allocator_t *a, void *p, size_t size ) {
+  alloc_limit_t *const lim = (alloc_limit_t*)a;
+  alloc_hdr_t *const old_hdr = p != NULL ? (alloc_hdr_t*)p - 1 : NULL;
+  size_t const old_size = old_hdr != NULL ? old_hdr->size : 0;
+  size_t const new_bytes = lim->cur_bytes - old_size + size;
+
+  if ( lim->limit > 0 && new_bytes > lim->limit ) {
+    ++lim->n_failures;
+    return NULL;
+  }
+
+  alloc_hdr_t *const new_hdr = (*lim->parent->realloc_fn)(
+    lim->parent, old_hdr, sizeof(alloc_hdr_t) + size
+  );
+  if ( new_hdr == NULL ) {
+    ++lim->n_failures;
+    return NULL;
+  }
+
+  new_hdr->size = size;
+  lim->cur_bytes = new_bytes;
+  if ( new_bytes > lim->peak_bytes )
+    lim->peak_bytes = new_bytes;
+  ++lim->n_allocs;
+  return new_hdr + 1;
+}
+
+////////// extern functions ///////////////////////////////////////////////////
+
+void alloc_arena_cleanup( alloc_arena_t *arena ) {
+  assert( arena != NULL );
+  for ( alloc_arena_chunk_t *chunk = arena->chunk; chunk != NULL; ) {
+    alloc_arena_chunk_t *const prev = chunk->prev;
+    (*arena->parent->free_fn)( arena->parent, chunk );
+    chunk = prev;
+  } // for
+  arena->chunk = NULL;
+}
+
+void alloc_arena_init( alloc_arena_t *arena, allocator_t *parent,
+                       size_t chunk_size ) {
+  assert( arena != NULL );
+  *arena = (alloc_arena_t){
+    .alloc = { &arena_realloc, &arena_free },
+    .parent = parent != NULL ? parent : &alloc_libc,
+    .chunk_size = alloc_round_up(
+      chunk_size > 0 ? chunk_size : ALLOC_ARENA_CHUNK_SIZE_DEFAULT
+    )
+  };
+}
+
+allocator_t* alloc_current( void ) {
+  return alloc_cur;
+}
+
+void alloc_free( void *p ) {
+  if ( p != NULL )
+    (*alloc_cur->free_fn)( alloc_cur, p );
+}
+
+void alloc_limit_init( alloc_limit_t *lim, allocator_t *parent,
+                       size_t limit ) {
+  assert( lim != NULL );
+  *lim = (alloc_limit_t){
+    .alloc = { &limit_realloc, &limit_free },
+    .parent = parent != NULL ? parent : &alloc_libc,
+    .limit = limit
+  };
+}
+
+void alloc_oom( size_t size ) {
+  if ( alloc_oom_fn != NULL )
+    (*alloc_oom_fn)( size );
+  errno = ENOMEM;
+  perror_exit( EX_OSERR );
+}
+
+void* alloc_realloc( void *p, size_t size ) {
+  if ( unlikely( size == 0 ) )
+    size = 1;
+  return (*alloc_cur->realloc_fn)( alloc_cur, p, size );
+}
+
+void alloc_sub_add( alloc_sub_t sub, size_t objects, size_t bytes ) {
+  assert( sub < ALLOC_SUB_NUM );
+  alloc_sub_stats_t *const stats = &alloc_sub_stats[ sub ];
+  atomic_fetch_add_explicit( &stats->objects, objects, memory_order_relaxed );
+  atomic_fetch_add_explicit( &stats->bytes, bytes, memory_order_relaxed );
+}
+
+void alloc_sub_print( FILE *out ) {
+  assert( out != NULL );
+  size_t total_objects = 0, total_bytes = 0;
+  FPRINTF( out, "%-16s %10s %12s\n", "subsystem", "objects", "bytes" );
+  for ( unsigned sub = 0; sub < ALLOC_SUB_NUM; ++sub ) {
+    size_t const objects = atomic_load_explicit(
+      &alloc_sub_stats[ sub ].objects, memory_order_relaxed
+    );
+    size_t const bytes = atomic_load_explicit(
+      &alloc_sub_stats[ sub ].bytes, memory_order_relaxed
+    );
+    FPRINTF( out,
+      "%-16s %10zu %12zu\n", ALLOC_SUB_NAME[ sub ], objects, bytes
+    );
+    total_objects += objects;
+    total_bytes += bytes;
+  } // for
+  FPRINTF( out, "%-16s %10zu %12zu\n", "total", total_objects, total_bytes );
+}
+
+void alloc_sub_remove( alloc_sub_t sub, size_t objects, size_t bytes ) {
+  assert( sub < ALLOC_SUB_NUM );
+  alloc_sub_stats_t *const stats = &alloc_sub_stats[ sub ];
+  atomic_fetch_sub_explicit( &stats->objects, objects, memory_order_relaxed );
+  atomic_fetch_sub_explicit( &stats->bytes, bytes, memory_order_relaxed );
+}
+
+alloc_oom_fn_t alloc_set_oom_fn( alloc_oom_fn_t oom_fn ) {
+  alloc_oom_fn_t const prev_oom_fn = alloc_oom_fn;
+  alloc_oom_fn = oom_fn;
+  return prev_oom_fn;
+}
+
+allocator_t* alloc_use( allocator_t *a ) {
+  allocator_t *const prev_a = alloc_cur;
+  alloc_cur = a != NULL ? a : &alloc_libc;
+  return prev_a;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
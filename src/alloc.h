@@ -0,0 +1,305 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/alloc.h
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef cdecl_alloc_H
+#define cdecl_alloc_H
+
+/**
+ * @file
+ * Declares types and functions for pluggable memory allocators.
+ *
+ * All memory allocated via #MALLOC(), #REALLOC(), check_realloc(), and the
+ * `check_str*dup()` functions comes from the calling thread's _current_
+ * allocator (see alloc_use()); #FREE() returns memory to it.  Memory must be
+ * freed while the same allocator is current as when it was allocated.
+ *
+ * Memory that outlives any one request (e.g., `typedef`s, their ASTs, cached
+ * renderings, and parser stacks kept for reuse) is always allocated from
+ * <code>\ref alloc_libc</code> regardless of the current allocator.  Hence,
+ * the current allocator may be changed (and an arena cleaned up) between
+ * requests.
+ *
+ * Three allocators are provided:
+ *
+ *  + <code>\ref alloc_libc</code>: the default that uses **realloc**(3) and
+ *    **free**(3).
+ *  + <code>\ref alloc_arena</code>: a bump allocator whose memory is freed
+ *    all at once by alloc_arena_cleanup().
+ *  + <code>\ref alloc_limit</code>: a wrapper around another allocator that
+ *    counts allocations and optionally fails once a limit is reached.
+ *
+ * If an allocator fails, the calling thread's out-of-memory handler (see
+ * alloc_set_oom_fn()) is called.  By default, it prints an error message and
+ * exits, but it may instead **longjmp**(3) back to a point from which the
+ * caller can recover (e.g., the start of a request).
+ *
+ * Independently of allocators, allocations made by certain subsystems are
+ * accounted for via alloc_sub_add() and alloc_sub_remove() so the live bytes
+ * and objects of each can be reported by alloc_sub_print().
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <stddef.h>                     /* for size_t */
+#include <stdio.h>                      /* for FILE */
+#include <stdnoreturn.h>
+
+/// @endcond
+
+/**
+ * @defgroup alloc-group Memory Allocators
+ * Types and functions for pluggable memory allocators.
+ * @{
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct alloc_arena        alloc_arena_t;
+typedef struct alloc_arena_chunk  alloc_arena_chunk_t;
+typedef struct alloc_limit        alloc_limit_t;
+typedef struct allocator          allocator_t;
+
+/**
+ * The signature for a function called when an allocator fails.  It must not
+ * return: it must either exit or **longjmp**(3).
+ *
+ * @param size The number of bytes that could not be allocated.
+ */
+typedef void (*alloc_oom_fn_t)( size_t size );
+
+/**
+ * Subsystems whose live memory is accounted for separately.
+ *
+ * @sa alloc_sub_add()
+ * @sa alloc_sub_print()
+ * @sa alloc_sub_remove()
+ */
+enum alloc_sub {
+  ALLOC_SUB_AST,                        ///< AST nodes.
+  ALLOC_SUB_SNAME,                      ///< Scoped-name scopes and names.
+  ALLOC_SUB_TYPEDEF,                    ///< `c_typedef` entries.
+  ALLOC_SUB_RCU_SET,                    ///< Versions of RCU sets.
+  ALLOC_SUB_PARSER,                     ///< Parser stacks.
+  ALLOC_SUB_STRBUF,                     ///< String buffers.
+  ALLOC_SUB_FREE_LATER                  ///< Nodes of the free_later() list.
+};
+typedef enum alloc_sub alloc_sub_t;
+
+/// Number of <code>\ref alloc_sub</code> values.
+#define ALLOC_SUB_NUM             (ALLOC_SUB_FREE_LATER + 1)
+
+/**
+ * A memory allocator, i.e., a "vtable" of allocation functions.  Specific
+ * allocators embed this as their first member.
+ */
+struct allocator {
+  /**
+   * Reallocates memory.
+   *
+   * @param a A pointer to this allocator.
+   * @param p The pointer to reallocate or NULL to allocate new memory.
+   * @param size The number of bytes to allocate; never 0.
+   * @return Returns a pointer to the allocated memory or NULL if it could not
+   * be allocated (in which case \a p is unchanged).
+   */
+  void* (*realloc_fn)( allocator_t *a, void *p, size_t size );
+
+  /**
+   * Frees memory.
+   *
+   * @param a A pointer to this allocator.
+   * @param p The pointer to the memory to free; never NULL.
+   */
+  void  (*free_fn)( allocator_t *a, void *p );
+};
+
+/**
+ * An arena (bump) allocator.  Freeing memory is a no-op (except for the most
+ * recent allocation); all memory is freed by alloc_arena_cleanup().
+ *
+ * @sa alloc_arena_init()
+ */
+struct alloc_arena {
+  allocator_t           alloc;          ///< Allocator "vtable"; must be first.
+  allocator_t          *parent;         ///< Allocator chunks come from.
+  alloc_arena_chunk_t  *chunk;          ///< Current chunk (head of list).
+  size_t                chunk_size;     ///< Minimum chunk size.
+};
+
+/**
+ * An allocator wrapper that counts allocations and optionally limits the
+ * total number of bytes allocated.  It is not thread-safe.
+ *
+ * @sa alloc_limit_init()
+ */
+struct alloc_limit {
+  allocator_t   alloc;                  ///< Allocator "vtable"; must be first.
+  allocator_t  *parent;                 ///< Allocator being wrapped.
+  size_t        limit;                  ///< Maximum bytes or 0 for no limit.
+  size_t        cur_bytes;              ///< Bytes currently allocated.
+  size_t        peak_bytes;             ///< Maximum of \a cur_bytes.
+  size_t        n_allocs;               ///< Number of (re)allocations.
+  size_t        n_frees;                ///< Number of frees.
+  size_t        n_failures;             ///< Number of failed allocations.
+};
+
+/**
+ * The default allocator that uses **realloc**(3) and **free**(3).
+ */
+extern allocator_t alloc_libc;
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Accounts for memory allocated by a subsystem.
+ *
+ * @param sub The subsystem.
+ * @param objects The number of objects allocated, if any.
+ * @param bytes The number of bytes allocated.
+ *
+ * @sa alloc_sub_remove()
+ */
+void alloc_sub_add( alloc_sub_t sub, size_t objects, size_t bytes );
+
+/**
+ * Prints the live objects and bytes of every subsystem and their totals.
+ *
+ * @param out The `FILE` to print to.
+ */
+void alloc_sub_print( FILE *out );
+
+/**
+ * Accounts for memory freed by a subsystem.
+ *
+ * @param sub The subsystem.
+ * @param objects The number of objects freed, if any.
+ * @param bytes The number of bytes freed.
+ *
+ * @sa alloc_sub_add()
+ */
+void alloc_sub_remove( alloc_sub_t sub, size_t objects, size_t bytes );
+
+/**
+ * Cleans up an arena allocator freeing all memory allocated from it.
+ *
+ * @param arena A pointer to the arena to clean up.
+ *
+ * @sa alloc_arena_init()
+ */
+void alloc_arena_cleanup( alloc_arena_t *arena );
+
+/**
+ * Initializes an arena allocator.
+ *
+ * @param arena A pointer to the arena to initialize.
+ * @param parent A pointer to the allocator chunks come from or NULL for
+ * <code>\ref alloc_libc</code>.
+ * @param chunk_size The minimum size of each chunk or 0 for a default.
+ *
+ * @sa alloc_arena_cleanup()
+ */
+void alloc_arena_init( alloc_arena_t *arena, allocator_t *parent,
+                       size_t chunk_size );
+
+/**
+ * Gets the calling thread's current allocator.
+ *
+ * @return Returns said allocator.
+ *
+ * @sa alloc_use()
+ */
+PJL_WARN_UNUSED_RESULT
+allocator_t* alloc_current( void );
+
+/**
+ * Frees memory using the calling thread's current allocator.
+ *
+ * @param p A pointer to the memory to free.  If NULL, does nothing.
+ *
+ * @sa #FREE()
+ */
+void alloc_free( void *p );
+
+/**
+ * Initializes a counting/limiting allocator wrapper.
+ *
+ * @param lim A pointer to the wrapper to initialize.
+ * @param parent A pointer to the allocator to wrap or NULL for
+ * <code>\ref alloc_libc</code>.
+ * @param limit The maximum number of bytes that may be allocated at any one
+ * time or 0 for no limit.
+ */
+void alloc_limit_init( alloc_limit_t *lim, allocator_t *parent,
+                       size_t limit );
+
+/**
+ * Calls the calling thread's out-of-memory handler.
+ *
+ * @param size The number of bytes that could not be allocated.
+ *
+ * @sa alloc_set_oom_fn()
+ */
+noreturn void alloc_oom( size_t size );
+
+/**
+ * Reallocates memory using the calling thread's current allocator.  Unlike
+ * check_realloc(), this returns NULL on failure.
+ *
+ * @param p The pointer to reallocate or NULL to allocate new memory.
+ * @param size The number of bytes to allocate.
+ * @return Returns a pointer to the allocated memory or NULL on failure.
+ *
+ * @sa check_realloc()
+ */
+PJL_WARN_UNUSED_RESULT
+void* alloc_realloc( void *p, size_t size );
+
+/**
+ * Sets the calling thread's out-of-memory handler.
+ *
+ * @param oom_fn The handler or NULL for the default that prints an error
+ * message and exits.
+ * @return Returns the previous handler.
+ */
+PJL_NOWARN_UNUSED_RESULT
+alloc_oom_fn_t alloc_set_oom_fn( alloc_oom_fn_t oom_fn );
+
+/**
+ * Sets the calling thread's current allocator.
+ *
+ * @param a A pointer to the allocator to use or NULL for
+ * <code>\ref alloc_libc</code>.
+ * @return Returns the previously current allocator.
+ *
+ * @sa alloc_current()
+ */
+PJL_NOWARN_UNUSED_RESULT
+allocator_t* alloc_use( allocator_t *a );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** @} */
+
+#endif /* cdecl_alloc_H */
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,283 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/alloc_test.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions to test the memory allocators.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "alloc.h"
+#include "util.h"
+
+// standard
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+
+///////////////////////////////////////////////////////////////////////////////
+
+// extern variable definitions
+char const       *me;                   ///< Program name.
+
+/**
+ * Prints that \a EXPR failed and increments the test failure count.
+ *
+ * @param EXPR The stringified expression that failed.
+ * @return Always returns `false`.
+ */
+#define FAILED(EXPR) \
+  ( EPRINTF( "%s:%d: %s\n", me, __LINE__, (EXPR) ), !++test_failures )
+
+/**
+ * Tests \a EXPR and prints that it failed only if it failed.
+ *
+ * @param EXPR The expression to evaluate.
+ * @return Returns `true` only if \a EXPR is non-zero; `false` only if zero.
+ */
+#define TEST(EXPR)                ( !!(EXPR) || FAILED( #EXPR ) )
+
+// local variables
+static jmp_buf  oom_env;                ///< Where to go on out-of-memory.
+static size_t   oom_size;               ///< Size that failed.
+static unsigned test_failures;
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Out-of-memory handler that jumps back to the test.
+ *
+ * @param size The number of bytes that could not be allocated.
+ */
+static noreturn void test_oom( size_t size ) {
+  oom_size = size;
+  longjmp( oom_env, 1 );
+}
+
+/**
+ * Tests the arena allocator.
+ */
+static void test_arena( void ) {
+  alloc_arena_t arena;
+  alloc_arena_init( &arena, NULL, 256 );
+  allocator_t *const prev_a = alloc_use( &arena.alloc );
+  TEST( alloc_current() == &arena.alloc );
+
+  // test alignment
+  char *const c = MALLOC( char, 1 );
+  long *const l = MALLOC( long double, 1 );
+  TEST( (uintptr_t)l % _Alignof( max_align_t ) == 0 );
+  *c = 'c';
+  *l = 42;
+
+  // test growing the most recent allocation in place
+  char *s = check_strdup( "hello" );
+  char *const s0 = s;
+  REALLOC( s, char, 32 );
+  TEST( s == s0 );
+  TEST( strcmp( s, "hello" ) == 0 );
+
+  // test growing beyond a chunk (copies)
+  REALLOC( s, char, 1024 );
+  TEST( strcmp( s, "hello" ) == 0 );
+  TEST( *c == 'c' );
+  TEST( *l == 42 );
+
+  // test freeing the most recent allocation makes its space reusable
+  char *const t = MALLOC( char, 8 );
+  FREE( t );
+  char *const u = MALLOC( char, 8 );
+  TEST( t == u );
+  FREE( c );                            // no-op
+
+  alloc_use( prev_a );
+  alloc_arena_cleanup( &arena );
+  TEST( arena.chunk == NULL );
+}
+
+/**
+ * Tests the limit allocator and recovering from out-of-memory.
+ */
+static void test_limit( void ) {
+  alloc_limit_t lim;
+  alloc_limit_init( &lim, NULL, 100 );
+  allocator_t *const prev_a = alloc_use( &lim.alloc );
+
+  char *volatile p = MALLOC( char, 60 );
+  TEST( lim.cur_bytes == 60 );
+  TEST( lim.n_allocs == 1 );
+
+  // test that a failing allocation is recoverable
+  alloc_oom_fn_t const prev_oom_fn = alloc_set_oom_fn( &test_oom );
+  if ( setjmp( oom_env ) == 0 ) {
+    char *const q = MALLOC( char, 50 );
+    FAILED( "MALLOC() over limit didn't fail" );
+    FREE( q );
+  } else {
+    TEST( oom_size == 50 );
+    TEST( lim.n_failures == 1 );
+  }
+  alloc_set_oom_fn( prev_oom_fn );
+
+  // test that it fails without calling the handler for alloc_realloc()
+  TEST( alloc_realloc( NULL, 41 ) == NULL );
+  TEST( lim.n_failures == 2 );
+
+  // test reallocation
+  REALLOC( p, char, 80 );
+  TEST( lim.cur_bytes == 80 );
+  TEST( lim.peak_bytes == 80 );
+
+  FREE( p );
+  TEST( lim.cur_bytes == 0 );
+  TEST( lim.n_frees == 1 );
+
+  alloc_use( prev_a );
+  TEST( alloc_current() == &alloc_libc );
+}
+
+/**
+ * Tests an arena whose chunks come from a limit allocator.
+ */
+static void test_arena_limit( void ) {
+  alloc_limit_t lim;
+  alloc_limit_init( &lim, NULL, 0 );
+  alloc_arena_t arena;
+  alloc_arena_init( &arena, &lim.alloc, 128 );
+  allocator_t *const prev_a = alloc_use( &arena.alloc );
+
+  for ( unsigned i = 0; i < 100; ++i )
+    PJL_IGNORE_RV( MALLOC( char, 16 ) );
+  TEST( lim.n_allocs > 1 );
+  TEST( lim.n_frees == 0 );
+
+  alloc_use( prev_a );
+  alloc_arena_cleanup( &arena );
+  TEST( lim.cur_bytes == 0 );
+  TEST( lim.n_frees == lim.n_allocs );
+}
+
+/**
+ * Tests switching allocators between two parses, each of which allocates
+ * memory that's freed by the end of the parse as well as memory that outlives
+ * it (e.g., a cache) from <code>\ref alloc_libc</code> the way the parser
+ * does.
+ */
+static void test_parses( void ) {
+  char *cache;                          // outlives either parse
+
+  // first parse: an arena
+  alloc_arena_t arena;
+  alloc_arena_init( &arena, NULL, 128 );
+  allocator_t *const prev_a = alloc_use( &arena.alloc );
+  char *const name = check_strdup( "first" );
+  allocator_t *parse_a = alloc_use( &alloc_libc );
+  cache = check_strdup( name );
+  TEST( alloc_use( parse_a ) == &alloc_libc );
+  alloc_use( prev_a );
+  alloc_arena_cleanup( &arena );
+
+  // second parse: a limit allocator that must be charged for its memory only
+  alloc_limit_t lim;
+  alloc_limit_init( &lim, NULL, 0 );
+  alloc_use( &lim.alloc );
+  char *const buf = MALLOC( char, 16 );
+  parse_a = alloc_use( &alloc_libc );
+  REALLOC( cache, char, 1024 );         // allocated during the first parse
+  alloc_use( parse_a );
+  TEST( strcmp( cache, "first" ) == 0 );
+  TEST( lim.cur_bytes == 16 );
+  FREE( buf );
+  alloc_use( prev_a );
+  TEST( lim.cur_bytes == 0 );
+  TEST( lim.n_allocs == 1 );
+
+  FREE( cache );
+}
+
+/**
+ * Checks that alloc_sub_print() prints \a objects and \a bytes for the line
+ * starting with \a name.
+ *
+ * @param name The name of the subsystem (or `total`).
+ * @param objects The expected number of objects.
+ * @param bytes The expected number of bytes.
+ * @return Returns `true` only if the line was printed as expected.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool sub_printed( char const *name, size_t objects, size_t bytes ) {
+  char *buf = NULL;
+  size_t buf_size = 0;
+  FILE *const f = open_memstream( &buf, &buf_size );
+  IF_EXIT( f == NULL, EX_OSERR );
+  alloc_sub_print( f );
+  PJL_IGNORE_RV( fclose( f ) );
+
+  char line[ 80 ];
+  snprintf( line, sizeof line, "\n%-16s %10zu %12zu\n", name, objects, bytes );
+  bool const found = strstr( buf, line ) != NULL;
+  free( buf );                          // allocated by open_memstream()
+  return found;
+}
+
+/**
+ * Tests per-subsystem accounting.
+ */
+static void test_sub( void ) {
+  TEST( sub_printed( "total", 0, 0 ) );
+
+  long *const l = MALLOC_SUB( ALLOC_SUB_AST, long, 2 );
+  alloc_sub_add( ALLOC_SUB_STRBUF, 1, 16 );
+  alloc_sub_add( ALLOC_SUB_STRBUF, 0, 16 );
+  TEST( sub_printed( "AST nodes", 1, 2 * sizeof(long) ) );
+  TEST( sub_printed( "strbufs", 1, 32 ) );
+  TEST( sub_printed( "total", 2, 2 * sizeof(long) + 32 ) );
+
+  FREE_SUB( ALLOC_SUB_AST, l, 2 * sizeof(long) );
+  alloc_sub_remove( ALLOC_SUB_STRBUF, 1, 32 );
+  TEST( sub_printed( "AST nodes", 0, 0 ) );
+  TEST( sub_printed( "total", 0, 0 ) );
+}
+
+////////// main ///////////////////////////////////////////////////////////////
+
+int main( int argc, char const *argv[] ) {
+  me = base_name( argv[0] );
+  if ( --argc != 0 ) {
+    EPRINTF( "usage: %s\n", me );
+    exit( EX_USAGE );
+  }
+
+  test_arena();
+  test_limit();
+  test_arena_limit();
+  test_parses();
+  test_sub();
+
+  printf( "%u failures\n", test_failures );
+  exit( test_failures > 0 ? EX_SOFTWARE : EX_OK );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -110,6 +110,7 @@ static c_lang_lit_t const CDECL_KEYWORDS[] = {
   { LANG_ANY,               L_FLOAT               },
   { LANG_CPP_ANY,           L_FRIEND              },
   { LANG_ANY,               L_FUNCTION            },
+  { LANG_ANY,               L_HEADER              },
   { LANG_C_MIN(99),         L__IMAGINARY          },
   { LANG_C_MIN(99),         L_IMAGINARY           },
   { LANG_MIN(C_99),         L_INLINE              },
@@ -121,6 +122,7 @@ static c_lang_lit_t const CDECL_KEYWORDS[] = {
   { LANG_ANY,               L_LONG                },
   { LANG_C_CPP_MIN(2X,17),  L_MAYBE_UNUSED        },
   { LANG_CPP_ANY,           L_MEMBER              },
+  { LANG_ANY,               L_MEMORY              },
   { LANG_CPP_ANY,           L_MUTABLE             },
   //                        L_NAMESPACE   // handled in CDECL_COMMANDS
   { LANG_CPP_ANY,           L_NEW                 },
@@ -30,6 +30,7 @@
 /// @endcond
 #include "c_ast.h"
 #include "cdecl.h"
+#include "rule_prof.h"
 #include "util.h"
 
 /// @cond DOXYGEN_IGNORE
@@ -47,6 +48,22 @@ static unsigned   c_ast_count;          ///< ASTs allocated but not yet freed.
 
 ////////// local functions ////////////////////////////////////////////////////
 
+/**
+ * Gets the AST that a \ref K_TYPEDEF AST whose type is \a for_ast ultimately
+ * resolves to.
+ *
+ * @param for_ast The AST of what the `typedef` is for.
+ * @return Returns the first AST that is not a `typedef`.
+ */
+PJL_WARN_UNUSED_RESULT
+static c_ast_t const* c_ast_typedef_resolve( c_ast_t const *for_ast ) {
+  assert( for_ast != NULL );
+  if ( for_ast->kind_id != K_TYPEDEF )
+    return for_ast;
+  assert( for_ast->as.tdef.untypedef_ast != NULL );
+  return for_ast->as.tdef.untypedef_ast;
+}
+
 /**
  * Checks whether two alignments are equivalent, i.e., represent the same
  * alignment.
@@ -78,6 +95,31 @@ static bool c_alignas_equiv( c_alignas_t const *i_align,
   UNEXPECTED_INT_VALUE( i_align->kind );
 }
 
+/**
+ * Checks whether a `typedef` AST is equivalent to a non-`typedef` AST.
+ *
+ * @remarks Qualifiers on the `typedef` AST, e.g., `const` in `const CHAR`,
+ * apply to the type the `typedef` is for, so they're folded into that type
+ * before comparing.
+ *
+ * @param tdef_ast The \ref K_TYPEDEF AST.
+ * @param ast The other AST.
+ * @return Returns `true` only if the two ASTs are equivalent.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool c_ast_equiv_tdef( c_ast_t const *tdef_ast, c_ast_t const *ast ) {
+  assert( tdef_ast != NULL );
+  assert( tdef_ast->kind_id == K_TYPEDEF );
+
+  c_type_id_t const qual_stids = tdef_ast->type.store_tid & TS_MASK_QUALIFIER;
+  if ( qual_stids == TS_NONE )
+    return c_ast_equiv( tdef_ast->as.tdef.for_ast, ast );
+
+  c_ast_t for_ast = *tdef_ast->as.tdef.for_ast;
+  for_ast.type.store_tid |= qual_stids;
+  return c_ast_equiv( &for_ast, ast );
+}
+
 #ifndef NDEBUG
 /**
  * Checks \a ast for a cycle.
@@ -160,11 +202,18 @@ c_ast_t* c_ast_dup( c_ast_t const *ast, c_ast_list_t *ast_list ) {
       break;
   } // switch
 
-  if ( c_ast_is_parent( ast ) || ast->kind_id == K_TYPEDEF ) {
+  if ( c_ast_is_parent( ast ) ) {
     c_ast_t *const child_ast = ast->as.parent.of_ast;
     if ( child_ast != NULL )
       c_ast_set_parent( c_ast_dup( child_ast, ast_list ), dup_ast );
   }
+  else if ( ast->kind_id == K_TYPEDEF ) {
+    //
+    // The AST a typedef is for is never modified once defined, so every
+    // duplicate can share it rather than getting a deep copy of its own.
+    //
+    c_ast_set_typedef( dup_ast, ast->as.tdef.for_ast );
+  }
 
   return dup_ast;
 }
@@ -181,10 +230,10 @@ bool c_ast_equiv( c_ast_t const *i_ast, c_ast_t const *j_ast ) {
   //
   if ( i_ast->kind_id == K_TYPEDEF ) {
     if ( j_ast->kind_id != K_TYPEDEF )
-      return c_ast_equiv( i_ast->as.tdef.for_ast, j_ast );
+      return c_ast_equiv_tdef( i_ast, j_ast );
   } else {
     if ( j_ast->kind_id == K_TYPEDEF )
-      return c_ast_equiv( i_ast, j_ast->as.tdef.for_ast );
+      return c_ast_equiv_tdef( j_ast, i_ast );
   }
 
   if ( i_ast->kind_id != j_ast->kind_id )
@@ -313,7 +362,7 @@ void c_ast_free( c_ast_t *ast ) {
         break;
     } // switch
 
-    FREE( ast );
+    FREE_SUB( ALLOC_SUB_AST, ast, sizeof( c_ast_t ) );
   }
 }
 
@@ -322,11 +371,12 @@ c_ast_t* c_ast_new( c_kind_id_t kind_id, c_ast_depth_t depth,
   assert( loc != NULL );
   static c_ast_id_t next_id;
 
-  c_ast_t *const ast = MALLOC( c_ast_t, 1 );
+  c_ast_t *const ast = MALLOC_SUB( ALLOC_SUB_AST, c_ast_t, 1 );
   MEM_ZERO( ast );
 
   ast->depth = depth;
   ast->unique_id = ++next_id;
+  RULE_PROF_AST_NEW();
   ast->kind_id = kind_id;
   ast->type = T_NONE;
   ast->loc = *loc;
@@ -384,6 +434,8 @@ void c_ast_set_parent( c_ast_t *child_ast, c_ast_t *parent_ast ) {
 
   child_ast->parent_ast = parent_ast;
   parent_ast->as.parent.of_ast = child_ast;
+  if ( parent_ast->kind_id == K_TYPEDEF )
+    parent_ast->as.tdef.untypedef_ast = c_ast_typedef_resolve( child_ast );
 
   assert( !c_ast_has_cycle( child_ast ) );
 }
@@ -410,6 +462,13 @@ void c_ast_set_sname( c_ast_t *ast, c_sname_t *sname ) {
   c_ast_append_sname( ast, sname );
 }
 
+void c_ast_set_typedef( c_ast_t *tdef_ast, c_ast_t const *for_ast ) {
+  assert( tdef_ast != NULL );
+  assert( tdef_ast->kind_id == K_TYPEDEF );
+  tdef_ast->as.tdef.for_ast = for_ast;
+  tdef_ast->as.tdef.untypedef_ast = c_ast_typedef_resolve( for_ast );
+}
+
 c_ast_t* c_ast_visit( c_ast_t *ast, c_visit_dir_t dir, c_ast_visitor_t visitor,
                       void *data ) {
   switch ( dir ) {
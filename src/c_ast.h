@@ -316,6 +316,14 @@ struct c_ptr_ref_ast {
 struct c_typedef_ast {
   c_ast_t const  *for_ast;              ///< What it's a `typedef` for.
   c_bit_width_t   bit_width;            ///< Bit-field width when &gt; 0.
+
+  /**
+   * The AST that \ref for_ast ultimately resolves to, i.e., the first AST
+   * that is not a `typedef`.  It's set along with \ref for_ast by
+   * c_ast_set_parent() or c_ast_set_typedef() and never changed by readers,
+   * so ASTs of `typedef`s can be shared between threads.
+   */
+  c_ast_t const  *untypedef_ast;
 };
 
 /**
@@ -389,6 +397,8 @@ void c_ast_cleanup( void );
 /**
  * Duplicates the entire AST starting at \a ast.
  *
+ * @note The AST a #K_TYPEDEF AST is for is shared, not duplicated.
+ *
  * @param ast The AST to duplicate.
  * @param ast_list If not NULL, the duplicated AST is appended to the list.
  * @return Returns the duplicated AST.
@@ -725,6 +735,15 @@ void c_ast_set_parent( c_ast_t *child_ast, c_ast_t *parent_ast );
  */
 void c_ast_set_sname( c_ast_t *ast, c_sname_t *sname );
 
+/**
+ * Sets the type that the `typedef` AST \a tdef_ast is a synonym for.
+ *
+ * @param tdef_ast The \ref K_TYPEDEF AST node to set the type of.
+ * @param for_ast The AST of the existing `typedef`'s type.  It's shared, not
+ * duplicated.
+ */
+void c_ast_set_typedef( c_ast_t *tdef_ast, c_ast_t const *for_ast );
+
 /**
  * Does a depth-first, post-order traversal of an AST.
  *
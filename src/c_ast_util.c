@@ -312,10 +312,38 @@ static bool c_ast_vistor_type_any( c_ast_t *ast, void *data ) {
 
 ////////// extern functions ///////////////////////////////////////////////////
 
-c_ast_t* c_ast_add_array( c_ast_t *ast, c_ast_t *array_ast ) {
+c_ast_t* c_ast_add_array( c_ast_t *ast, c_ast_t **ptail_ast,
+                          c_ast_t *array_ast ) {
   assert( ast != NULL );
-  c_ast_t *const rv_ast = c_ast_add_array_impl( ast, array_ast );
+  assert( ptail_ast != NULL );
+  assert( array_ast != NULL );
+
+  c_ast_t *rv_ast;
+  c_ast_t *const tail_ast = *ptail_ast;
+  if ( tail_ast != NULL && tail_ast->depth == array_ast->depth ) {
+    //
+    // Walking down from ast would pass only through arrays (and pointers
+    // deeper than array_ast) to reach tail_ast and do nothing along the way,
+    // so start at tail_ast instead.  This makes declarations like:
+    //
+    //      int a[2][3][5]...
+    //
+    // linear rather than quadratic in the number of arrays.
+    //
+    assert( tail_ast->kind_id == K_ARRAY );
+    PJL_IGNORE_RV( c_ast_append_array( tail_ast, array_ast ) );
+    rv_ast = ast;
+  } else {
+    rv_ast = c_ast_add_array_impl( ast, array_ast );
+  }
   assert( rv_ast != NULL );
+
+  //
+  // Only if the resulting AST is itself an array will the next call walk down
+  // via c_ast_append_array() and so reach array_ast.
+  //
+  *ptail_ast = rv_ast->kind_id == K_ARRAY ? array_ast : NULL;
+
   c_type_t const taken_type = c_ast_take_storage( array_ast->as.array.of_ast );
   array_ast->type.store_tid |= taken_type.store_tid;
   array_ast->type.attr_tid  |= taken_type.attr_tid;
@@ -464,8 +492,9 @@ c_ast_t* c_ast_join_type_decl( bool has_typename, c_alignas_t const *align,
       bool const orig_semicolon = opt_semicolon;
       opt_semicolon = false;
 
-      c_typedef_t const temp_tdef = { decl_ast, LANG_ANY, false };
-      c_typedef_gibberish( &temp_tdef, C_GIB_TYPEDEF, stderr );
+      // The temporary typedef isn't added, so its rendering must not be cached.
+      c_typedef_t const temp_tdef = { decl_ast, LANG_ANY, false, NULL, 0 };
+      c_typedef_gibberish_nocache( &temp_tdef, C_GIB_TYPEDEF, stderr );
 
       opt_semicolon = orig_semicolon;
       return NULL;
@@ -602,12 +631,11 @@ c_ast_t const* c_ast_unreference( c_ast_t const *ast ) {
 }
 
 c_ast_t const* c_ast_untypedef( c_ast_t const *ast ) {
-  for (;;) {
-    assert( ast != NULL );
-    if ( ast->kind_id != K_TYPEDEF )
-      return ast;
-    ast = ast->as.tdef.for_ast;
-  } // for
+  assert( ast != NULL );
+  if ( ast->kind_id != K_TYPEDEF )
+    return ast;
+  assert( ast->as.tdef.untypedef_ast != NULL );
+  return ast->as.tdef.untypedef_ast;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -45,11 +45,17 @@
  * Adds an array to the AST being built.
  *
  * @param ast The AST to append to.
+ * @param ptail_ast A pointer to the array most recently added to \a ast (as
+ * set by a previous call) or to NULL if unknown.  If the array is at the same
+ * depth as \a array_ast, \a array_ast is appended directly to it in O(1);
+ * otherwise \a ast is walked.  On return, it's set to \a array_ast if a
+ * subsequent array can be appended directly to it or NULL if not.
  * @param array_ast The array AST to append.  Its "of" type must be NULL.
  * @return Returns the AST to be used as the grammar production's return value.
  */
 PJL_WARN_UNUSED_RESULT
-c_ast_t* c_ast_add_array( c_ast_t *ast, c_ast_t *array_ast );
+c_ast_t* c_ast_add_array( c_ast_t *ast, c_ast_t **ptail_ast,
+                          c_ast_t *array_ast );
 
 /**
  * Adds a function-like AST to the AST being built.
@@ -323,6 +329,9 @@ c_ast_t const* c_ast_unreference( c_ast_t const *ast );
  * Un-typedefs \a ast, i.e., if \a ast is a <code>\ref K_TYPEDEF</code>,
  * returns the underlying type AST.
  *
+ * @note The underlying type AST is resolved when the type of \a ast is set,
+ * so this is O(1) and never modifies \a ast.
+ *
  * @param ast The AST to un-typedef.
  * @return Returns the underlying type AST or \a ast if \a ast is not a
  * `typedef`.
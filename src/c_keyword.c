@@ -325,6 +325,7 @@ static c_keyword_t const C_KEYWORDS[] = {
   { L_NO_UNIQUE_ADDRESS,
     Y_NO_UNIQUE_ADDRESS,  LANG_CPP_MIN(20),       KC_A, TA_NO_UNIQUE_ADDRESS  },
 
+#if LANG_IS_LIVE(C_99)
   // Embedded C extensions
   { L_EMC__ACCUM,
     Y_EMC__ACCUM,         LANG_C_99_EMC,          KC__, TB_EMC_ACCUM          },
@@ -340,6 +341,7 @@ static c_keyword_t const C_KEYWORDS[] = {
     Y_UPC_SHARED,         LANG_C_99_UPC,          KC__, TS_UPC_SHARED         },
   { L_UPC_STRICT,
     Y_UPC_STRICT,         LANG_C_99_UPC,          KC__, TS_UPC_STRICT         },
+#endif /* LANG_IS_LIVE(C_99) */
 
   // GNU extensions
   { L_GNU___ATTRIBUTE__,
@@ -46,9 +46,6 @@
 
 // standard
 #include <stdbool.h>
-#if SIZEOF_C_KIND_T > SIZEOF_VOIDP
-#include <stdlib.h>                     /* for free(3) */
-#endif /* SIZEOF_C_KIND_T > SIZEOF_VOIDP */
 
 _GL_INLINE_HEADER_BEGIN
 #ifndef C_KIND_INLINE
@@ -162,7 +159,7 @@ enum c_kind_id {
 C_KIND_INLINE
 void c_kind_data_free( void *data ) {
 #if SIZEOF_C_KIND_T > SIZEOF_VOIDP
-  free( data );
+  FREE( data );
 #else
   (void)data;
 #endif /* SIZEOF_C_KIND_T > SIZEOF_VOIDP */
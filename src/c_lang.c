@@ -48,9 +48,12 @@
 /**
  * Array of `c_lang` for all supported languages. The last entry is
  * `{ NULL, false, LANG_NONE }`.
+ *
+ * @note The generic `C` and `C++` entries are for all languages of each: they
+ * mean the newest of those that are #LANG_ENABLED.
  */
 static c_lang_t const C_LANG[] = {
-  { "C",      false,  LANG_C_NEW   },
+  { "C",      false,  LANG_C_MAX(NEW) },
   { "CK&R",   true,   LANG_C_KNR   },
   { "CKNR",   true,   LANG_C_KNR   },
   { "CKR",    true,   LANG_C_KNR   },
@@ -69,7 +72,7 @@ static c_lang_t const C_LANG[] = {
   { "C17",    false,  LANG_C_17    },
   { "C18",    true,   LANG_C_17    },
   { "C2X",    false,  LANG_C_2X    },
-  { "C++",    false,  LANG_CPP_NEW },
+  { "C++",    false,  LANG_CPP_MAX(NEW) },
   { "C++98",  false,  LANG_CPP_98  },
   { "C++03",  false,  LANG_CPP_03  },
   { "C++11",  false,  LANG_CPP_11  },
@@ -87,7 +90,7 @@ c_lang_id_t c_lang_find( char const *name ) {
   // the list is small, so linear search is good enough
   for ( c_lang_t const *lang = C_LANG; lang->name != NULL; ++lang ) {
     if ( strcasecmp( name, lang->name ) == 0 )
-      return lang->lang_id;
+      return c_lang_newest( lang->lang_id & LANG_ENABLED );
   } // for
 
   return LANG_NONE;
@@ -126,25 +129,19 @@ char const* c_lang_name( c_lang_id_t lang_id ) {
 }
 
 c_lang_t const* c_lang_next( c_lang_t const *lang ) {
-  if ( lang == NULL )
-    lang = C_LANG;
-  else if ( (++lang)->name == NULL )
-    lang = NULL;
-  return lang;
+  for ( lang = lang == NULL ? C_LANG : lang + 1; lang->name != NULL; ++lang ) {
+    if ( (lang->lang_id & LANG_ENABLED) != LANG_NONE )
+      return lang;
+  } // for
+  return NULL;
 }
 
 void c_lang_set( c_lang_id_t lang_id ) {
   lang_id &= ~LANGX_MASK;
   assert( exactly_one_bit_set( lang_id ) );
   opt_lang = lang_id;
-
-  bool const prompt_enabled =
-    opt_prompt && (
-    cdecl_prompt[0] == NULL || // first time: cdecl_prompt_init() not called yet
-    cdecl_prompt[0][0] != '\0');
-
-  cdecl_prompt_init();         // change prompt based on new language
-  cdecl_prompt_enable( prompt_enabled );
+  if ( !opt_prompt )
+    cdecl_prompt_enable( false );
 }
 
 char const* c_lang_which( c_lang_id_t lang_ids ) {
@@ -158,6 +155,8 @@ char const* c_lang_which( c_lang_id_t lang_ids ) {
     return OPT_LANG_IS(C_ANY) ? " in C" : " in C++";
 
   static strbuf_t sbuf;
+  // The buffer is reused across requests: see alloc_use().
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
   strbuf_free( &sbuf );
 
   c_lang_id_t which_lang_id = c_lang_oldest( lang_ids );
@@ -176,6 +175,7 @@ char const* c_lang_which( c_lang_id_t lang_ids ) {
   }
 
   strbuf_cats( &sbuf, c_lang_name( which_lang_id ) );
+  alloc_use( prev_a );
   return sbuf.str;
 }
 
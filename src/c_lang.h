@@ -113,6 +113,38 @@ _GL_INLINE_HEADER_BEGIN
 #define LANG_MASK_CPP 0xFE00u           /**< C++ languages bitmask. */
 #define LANGX_MASK    0x0180u           /**< Language extensions bitmask. */
 
+#ifdef CDECL_LANGS
+/**
+ * The languages the user may select, i.e., those given to `configure
+ * --enable-langs`.
+ */
+#define LANG_ENABLED  (CDECL_LANGS)
+#else
+#define LANG_ENABLED  (LANG_MASK_C | LANG_MASK_CPP)
+#endif /* CDECL_LANGS */
+
+/**
+ * The languages that can ever be the current language: those enabled plus the
+ * newest C and C++ that are used internally to parse predefined types and the
+ * configuration file.  Checks for any other language are compiled out.
+ *
+ * @note Unlike #LANG_ANY, this may be used in `#if` expressions.
+ *
+ * @sa #LANG_IS_LIVE()
+ */
+#define LANG_LIVE     (LANG_ENABLED | LANG_C_NEW | LANG_CPP_NEW)
+
+/**
+ * Gets whether any of the languages \a L can ever be the current language.
+ *
+ * @param L The language(s) _without_ the `LANG_` prefix.
+ *
+ * @note This may be used in `#if` expressions.
+ *
+ * @sa #LANG_LIVE
+ */
+#define LANG_IS_LIVE(L)           ((LANG_ ## L & LANG_LIVE) != 0)
+
 /**
  * All languages up to and including \a L.
  *
@@ -197,9 +229,12 @@ struct c_lang_lit {
  * @param LANG_MACRO A `LANG_*` macro without the `LANG_` prefix.
  * @return Returns `true` only if the current language is among the languages
  * specified by \a LANG_MACRO.
+ *
+ * @note Languages not in #LANG_LIVE are masked off so that checks only for
+ * them are constant-folded away.
  */
 #define OPT_LANG_IS(LANG_MACRO) \
-  ((opt_lang & LANG_ ## LANG_MACRO) != LANG_NONE)
+  ((opt_lang & (LANG_ ## LANG_MACRO & LANG_LIVE)) != LANG_NONE)
 
 ///////////////////////////////////////////////////////////////////////////////
 
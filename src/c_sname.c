@@ -41,6 +41,19 @@
 
 ////////// local functions ////////////////////////////////////////////////////
 
+/**
+ * Gets the number of bytes allocated for a <code>\ref c_scope_data</code>
+ * including its name.
+ *
+ * @param data A pointer to the <code>\ref c_scope_data</code>.
+ * @return Returns said number of bytes.
+ */
+PJL_WARN_UNUSED_RESULT
+static inline size_t c_scope_data_size( c_scope_data_t const *data ) {
+  return sizeof( c_scope_data_t ) +
+    (data->name != NULL ? strlen( data->name ) + 1/*\0*/ : 0);
+}
+
 /**
  * Helper function for c_sname_local_type() that returns the scope type of the
  * innermost scope (that has a type).
@@ -72,12 +85,15 @@ static char const* scope_name_impl( strbuf_t *sbuf, c_sname_t const *sname,
   assert( sbuf != NULL );
   assert( sname != NULL );
 
+  // The buffer is reused across requests: see alloc_use().
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
   strbuf_free( sbuf );
   bool colon2 = false;
 
   FOREACH_SCOPE( scope, sname, end_scope )
     strbuf_sepsn_cats( sbuf, "::", 2, &colon2, c_scope_data( scope )->name );
 
+  alloc_use( prev_a );
   return sbuf->str != NULL ? sbuf->str : "";
 }
 
@@ -94,13 +110,15 @@ c_scope_data_t* c_scope_data_dup( c_scope_data_t const *src ) {
   c_scope_data_t *const dst = MALLOC( c_scope_data_t, 1 );
   dst->name = check_strdup( src->name );
   dst->type = src->type;
+  alloc_sub_add( ALLOC_SUB_SNAME, 1, c_scope_data_size( dst ) );
   return dst;
 }
 
 void c_scope_data_free( c_scope_data_t *data ) {
   if ( data != NULL ) {
+    alloc_sub_remove( ALLOC_SUB_SNAME, 1, c_scope_data_size( data ) );
     FREE( data->name );
-    free( data );
+    FREE( data );
   }
 }
 
@@ -110,6 +128,7 @@ void c_sname_append_name( c_sname_t *sname, char *name ) {
   c_scope_data_t *const data = MALLOC( c_scope_data_t, 1 );
   data->name = name;
   data->type = T_NONE;
+  alloc_sub_add( ALLOC_SUB_SNAME, 1, c_scope_data_size( data ) );
   slist_push_tail( sname, data );
 }
 
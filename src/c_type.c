@@ -811,6 +811,8 @@ char const* c_type_name( c_type_t const *type, bool in_english ) {
   static unsigned buf_index;
 
   strbuf_t *const sbuf = &sbufs[ buf_index++ % ARRAY_SIZE( sbufs ) ];
+  // The buffers are reused across requests: see alloc_use().
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
   strbuf_free( sbuf );
   bool space = false;
 
@@ -1005,6 +1007,7 @@ char const* c_type_name( c_type_t const *type, bool in_english ) {
   else if ( (base_tid & TB_SCOPE) != TB_NONE )
     strbuf_sepc_cats( sbuf, ' ', &space, L_SCOPE );
 
+  alloc_use( prev_a );
   return sbuf->str != NULL ? sbuf->str : "";
 }
 
@@ -31,13 +31,18 @@
 #include "c_ast.h"
 #include "c_lang.h"
 #include "options.h"
-#include "red_black.h"
+#include "rcu_set.h"
 #include "util.h"
 
 /// @cond DOXYGEN_IGNORE
 
 // standard
 #include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>                     /* for free() */
+#include <sysexits.h>
 
 /// @endcond
 
@@ -48,24 +53,138 @@
  * @param SNAME The sname.
  */
 #define C_TYPEDEF_LIT(SNAME) \
-  (c_typedef_t){ &(c_ast_t){ .sname = (SNAME) }, LANG_ANY, true }
+  (c_typedef_t){ &(c_ast_t){ .sname = (SNAME) }, LANG_ANY, true, NULL, 0 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
- * Data passed to our red-black tree visitor function.
+ * Data passed to our set visitor function.
  */
-struct td_rb_visitor_data {
+struct td_set_visitor_data {
   c_typedef_visitor_t   visitor;        ///< Caller's visitor function.
   void                 *data;           ///< Caller's optional data.
 };
-typedef struct td_rb_visitor_data td_rb_visitor_data_t;
+typedef struct td_set_visitor_data td_set_visitor_data_t;
+
+/**
+ * Data passed to our sync visitor functions.
+ */
+struct td_sync_data {
+  c_typedef_scope_t const  *from;       ///< Previous `typedef`s, if any.
+  c_typedef_scope_t        *to;         ///< New `typedef`s.
+  c_typedef_sync_fn_t       sync_fn;    ///< Caller's change function, if any.
+  void                     *data;       ///< Caller's optional data.
+};
+typedef struct td_sync_data td_sync_data_t;
+
+/**
+ * The settings a rendering of a `typedef` depends on.
+ */
+struct c_tdef_render_key {
+  unsigned      gen;                    ///< Value of \ref render_gen.
+  c_lang_id_t   lang;                   ///< Value of `opt_lang`.
+  c_graph_t     graph;                  ///< Value of `opt_graph`.
+  bool          alt_tokens;             ///< Value of `opt_alt_tokens`.
+  bool          east_const;             ///< Value of `opt_east_const`.
+  bool          semicolon;              ///< Value of `opt_semicolon`.
+};
+typedef struct c_tdef_render_key c_tdef_render_key_t;
+
+/**
+ * One cached rendering of a `typedef`.
+ */
+struct c_tdef_rendered {
+  c_tdef_render_key_t key;              ///< Settings rendered with.
+  char               *text;             ///< Rendered text or NULL if none.
+  size_t              len;              ///< Length of \a text.
+};
+typedef struct c_tdef_rendered c_tdef_rendered_t;
+
+/**
+ * Cached renderings of a `typedef`.
+ */
+struct c_tdef_cache {
+  c_tdef_rendered_t rendered[ C_TDEF_RENDER_N ];  ///< Indexed by render.
+};
+
+typedef struct td_index_entry td_index_entry_t;
+
+/**
+ * An entry in a <code>\ref td_index</code>.
+ */
+struct td_index_entry {
+  c_typedef_t const  *tdef;             ///< The `typedef`.
+  td_index_entry_t   *next;             ///< Next entry in the same bucket.
+};
+
+/**
+ * An index of `typedef`s by c_typedef::equiv_hash.  Since equivalent ASTs have
+ * equal hashes, only the `typedef`s in one bucket ever need to be compared via
+ * c_ast_equiv() to find those equivalent to a given AST.
+ */
+struct td_index {
+  td_index_entry_t  **buckets;          ///< Buckets; number is a power of 2.
+  size_t              n_buckets;        ///< Number of buckets.
+  size_t              n_entries;        ///< Number of entries.
+  pthread_mutex_t     mutex;            ///< Serializes access.
+};
+typedef struct td_index td_index_t;
+
+/**
+ * Data passed to td_equiv_walk().
+ */
+struct td_equiv_walk {
+  c_typedef_equiv_visitor_t visitor;    ///< Caller's visitor or NULL.
+  void                     *data;       ///< Caller's optional data.
+  c_ast_t const           **path;       ///< ASTs from the root down.
+  size_t                    n_path;     ///< Number of ASTs in \ref path.
+  size_t                    path_cap;   ///< Capacity of \ref path.
+};
+typedef struct td_equiv_walk td_equiv_walk_t;
+
+/**
+ * A layer of `typedef`s.  Lookups (mostly by the lexer) never block even if
+ * another thread is concurrently adding a `typedef`.
+ */
+struct c_typedef_scope {
+  rcu_set_t                 typedefs;   ///< This layer's `typedef`s.
+  c_typedef_scope_t const  *base;       ///< Base layer or NULL if none.
+  td_index_t                index;      ///< This layer's `typedef`s by hash.
+};
 
 // local variable definitions
-static rb_tree_t    typedefs;           ///< Global set of `typedef`s.
+
+/// The base layer: predefined types only; immutable once initialized.
+static c_typedef_scope_t  base_scope;
+
+/// The default overlay: user-defined types when no other overlay is in use.
+static c_typedef_scope_t  global_scope = { .base = &base_scope };
+
+/// The layer into which this thread adds and from which it looks up.
+static _Thread_local c_typedef_scope_t *cur_scope = &global_scope;
+
 static c_lang_id_t  predefined_lang_ids;///< Languages when predefining types.
 static bool         user_defined;       ///< Are new `typedef`s used-defined?
 
+/**
+ * Incremented by c_typedef_render_clear() to invalidate all cached renderings
+ * lazily.
+ */
+static atomic_uint  render_gen;
+
+/**
+ * Serializes access to the cached renderings of all `typedef`s since they're
+ * shared between threads.
+ */
+static pthread_mutex_t render_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// local functions
+PJL_WARN_UNUSED_RESULT
+static uint64_t td_equiv_walk( td_equiv_walk_t*, c_ast_t const* );
+
+static void     td_index_add( td_index_t*, c_typedef_t const* );
+static void     td_index_remove( td_index_t*, c_typedef_t const* );
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -77,15 +196,12 @@ static bool         user_defined;       ///< Are new `typedef`s used-defined?
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_KNR_C[] = {
-  "typedef          int   dev_t",
-  "typedef unsigned int   ino_t",
-  "typedef struct _iobuf  FILE",
-  "typedef          long  off_t",
-  "typedef          long  time_t",
-
-  NULL
-};
+static char const PREDEFINED_KNR_C[] =
+  "typedef          int   dev_t\0"
+  "typedef unsigned int   ino_t\0"
+  "typedef struct _iobuf  FILE\0"
+  "typedef          long  off_t\0"
+  "typedef          long  time_t\0";
 
 /**
  * Predefined types for C89.
@@ -93,25 +209,22 @@ static char const *const PREDEFINED_KNR_C[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_STD_C89[] = {
-  "typedef          long  clock_t",
-  "struct                 div_t",
-  "struct             imaxdiv_t",
-  "struct                ldiv_t",
-  "struct               lldiv_t",
-  "typedef          int   errno_t",
-  "struct                 fpos_t",
-  "typedef          int   jmp_buf[37]",
-  "struct                 lconv",
-  "struct                 mbstate_t",
-  "typedef          long  ptrdiff_t",
-  "typedef          int   sig_atomic_t",
-  "typedef          long ssize_t",
-  "typedef unsigned long  size_t",
-  "typedef          void *va_list",
-
-  NULL
-};
+static char const PREDEFINED_STD_C89[] =
+  "typedef          long  clock_t\0"
+  "struct                 div_t\0"
+  "struct             imaxdiv_t\0"
+  "struct                ldiv_t\0"
+  "struct               lldiv_t\0"
+  "typedef          int   errno_t\0"
+  "struct                 fpos_t\0"
+  "typedef          int   jmp_buf[37]\0"
+  "struct                 lconv\0"
+  "struct                 mbstate_t\0"
+  "typedef          long  ptrdiff_t\0"
+  "typedef          int   sig_atomic_t\0"
+  "typedef          long ssize_t\0"
+  "typedef unsigned long  size_t\0"
+  "typedef          void *va_list\0";
 
 /**
  * Predefined types for C95.
@@ -119,13 +232,10 @@ static char const *const PREDEFINED_STD_C89[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_STD_C_95[] = {
-  "typedef          int   wctrans_t",
-  "typedef unsigned long  wctype_t",
-  "typedef          int   wint_t",
-
-  NULL
-};
+static char const PREDEFINED_STD_C_95[] =
+  "typedef          int   wctrans_t\0"
+  "typedef unsigned long  wctype_t\0"
+  "typedef          int   wint_t\0";
 
 /**
  * Predefined types for C99.
@@ -133,41 +243,38 @@ static char const *const PREDEFINED_STD_C_95[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_STD_C_99[] = {
-  "typedef   signed char   int8_t",
-  "typedef          short  int16_t",
-  "typedef          int    int32_t",
-  "typedef          long   int64_t",
-  "typedef unsigned char  uint8_t",
-  "typedef unsigned short uint16_t",
-  "typedef unsigned int   uint32_t",
-  "typedef unsigned long  uint64_t",
-
-  "typedef          long   intmax_t",
-  "typedef          long   intptr_t",
-  "typedef unsigned long  uintmax_t",
-  "typedef unsigned long  uintptr_t",
-
-  "typedef   signed char   int_fast8_t",
-  "typedef          short  int_fast16_t",
-  "typedef          int    int_fast32_t",
-  "typedef          long   int_fast64_t",
-  "typedef unsigned char  uint_fast8_t",
-  "typedef unsigned short uint_fast16_t",
-  "typedef unsigned int   uint_fast32_t",
-  "typedef unsigned long  uint_fast64_t",
-
-  "typedef   signed char   int_least8_t",
-  "typedef          short  int_least16_t",
-  "typedef          int    int_least32_t",
-  "typedef          long   int_least64_t",
-  "typedef unsigned char  uint_least8_t",
-  "typedef unsigned short uint_least16_t",
-  "typedef unsigned int   uint_least32_t",
-  "typedef unsigned long  uint_least64_t",
-
-  NULL
-};
+static char const PREDEFINED_STD_C_99[] =
+  "typedef   signed char   int8_t\0"
+  "typedef          short  int16_t\0"
+  "typedef          int    int32_t\0"
+  "typedef          long   int64_t\0"
+  "typedef unsigned char  uint8_t\0"
+  "typedef unsigned short uint16_t\0"
+  "typedef unsigned int   uint32_t\0"
+  "typedef unsigned long  uint64_t\0"
+
+  "typedef          long   intmax_t\0"
+  "typedef          long   intptr_t\0"
+  "typedef unsigned long  uintmax_t\0"
+  "typedef unsigned long  uintptr_t\0"
+
+  "typedef   signed char   int_fast8_t\0"
+  "typedef          short  int_fast16_t\0"
+  "typedef          int    int_fast32_t\0"
+  "typedef          long   int_fast64_t\0"
+  "typedef unsigned char  uint_fast8_t\0"
+  "typedef unsigned short uint_fast16_t\0"
+  "typedef unsigned int   uint_fast32_t\0"
+  "typedef unsigned long  uint_fast64_t\0"
+
+  "typedef   signed char   int_least8_t\0"
+  "typedef          short  int_least16_t\0"
+  "typedef          int    int_least32_t\0"
+  "typedef          long   int_least64_t\0"
+  "typedef unsigned char  uint_least8_t\0"
+  "typedef unsigned short uint_least16_t\0"
+  "typedef unsigned int   uint_least32_t\0"
+  "typedef unsigned long  uint_least64_t\0";
 
 /**
  * Predefined types for C11.
@@ -175,65 +282,62 @@ static char const *const PREDEFINED_STD_C_99[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_STD_C_11[] = {
-  "typedef _Atomic          _Bool     atomic_bool",
-  "typedef _Atomic          char      atomic_char",
-  "typedef _Atomic   signed char      atomic_schar",
-  "typedef _Atomic          char8_t   atomic_char8_t",
-  "typedef _Atomic          char16_t  atomic_char16_t",
-  "typedef _Atomic          char32_t  atomic_char32_t",
-  "typedef _Atomic          wchar_t   atomic_wchar_t",
-  "typedef _Atomic          short     atomic_short",
-  "typedef _Atomic          int       atomic_int",
-  "typedef _Atomic          long      atomic_long",
-  "typedef _Atomic          long long atomic_llong",
-  "typedef _Atomic unsigned char      atomic_uchar",
-  "typedef _Atomic unsigned short     atomic_ushort",
-  "typedef _Atomic unsigned int       atomic_uint",
-  "typedef _Atomic unsigned long      atomic_ulong",
-  "typedef _Atomic unsigned long long atomic_ullong",
-
-  "struct                             atomic_flag",
-  "typedef _Atomic  ptrdiff_t         atomic_ptrdiff_t",
-  "typedef _Atomic  size_t            atomic_size_t",
-
-  "typedef _Atomic  intmax_t          atomic_intmax_t",
-  "typedef _Atomic  intptr_t          atomic_intptr_t",
-  "typedef _Atomic uintptr_t          atomic_uintptr_t",
-  "typedef _Atomic uintmax_t          atomic_uintmax_t",
-
-  "typedef _Atomic  int_fast8_t       atomic_int_fast8_t",
-  "typedef _Atomic  int_fast16_t      atomic_int_fast16_t",
-  "typedef _Atomic  int_fast32_t      atomic_int_fast32_t",
-  "typedef _Atomic  int_fast64_t      atomic_int_fast64_t",
-  "typedef _Atomic uint_fast8_t       atomic_uint_fast8_t",
-  "typedef _Atomic uint_fast16_t      atomic_uint_fast16_t",
-  "typedef _Atomic uint_fast32_t      atomic_uint_fast32_t",
-  "typedef _Atomic uint_fast64_t      atomic_uint_fast64_t",
-
-  "typedef _Atomic  int_least8_t      atomic_int_least8_t",
-  "typedef _Atomic  int_least16_t     atomic_int_least16_t",
-  "typedef _Atomic  int_least32_t     atomic_int_least32_t",
-  "typedef _Atomic  int_least64_t     atomic_int_least64_t",
-  "typedef _Atomic uint_least8_t      atomic_uint_least8_t",
-  "typedef _Atomic uint_least16_t     atomic_uint_least16_t",
-  "typedef _Atomic uint_least32_t     atomic_uint_least32_t",
-  "typedef _Atomic uint_least64_t     atomic_uint_least64_t",
-
-  "typedef pthread_cond_t             cnd_t",
-  "typedef void                     (*constraint_handler_t)(const char *restrict, void *restrict, errno_t)",
-  "typedef long     double            max_align_t",
-  "typedef enum memory_order          memory_order",
-  "typedef pthread_mutex_t            mtx_t",
-  "typedef          int               once_flag",
-  "typedef unsigned long              rsize_t",
-  "typedef pthread_t                  thrd_t",
-  "typedef          int             (*thrd_start_t)(void*)",
-  "typedef          void             *tss_t",
-  "typedef          void            (*tss_dtor_t)(void*)",
-
-  NULL
-};
+static char const PREDEFINED_STD_C_11[] =
+  "typedef _Atomic          _Bool     atomic_bool\0"
+  "typedef _Atomic          char      atomic_char\0"
+  "typedef _Atomic   signed char      atomic_schar\0"
+  "typedef _Atomic          char8_t   atomic_char8_t\0"
+  "typedef _Atomic          char16_t  atomic_char16_t\0"
+  "typedef _Atomic          char32_t  atomic_char32_t\0"
+  "typedef _Atomic          wchar_t   atomic_wchar_t\0"
+  "typedef _Atomic          short     atomic_short\0"
+  "typedef _Atomic          int       atomic_int\0"
+  "typedef _Atomic          long      atomic_long\0"
+  "typedef _Atomic          long long atomic_llong\0"
+  "typedef _Atomic unsigned char      atomic_uchar\0"
+  "typedef _Atomic unsigned short     atomic_ushort\0"
+  "typedef _Atomic unsigned int       atomic_uint\0"
+  "typedef _Atomic unsigned long      atomic_ulong\0"
+  "typedef _Atomic unsigned long long atomic_ullong\0"
+
+  "struct                             atomic_flag\0"
+  "typedef _Atomic  ptrdiff_t         atomic_ptrdiff_t\0"
+  "typedef _Atomic  size_t            atomic_size_t\0"
+
+  "typedef _Atomic  intmax_t          atomic_intmax_t\0"
+  "typedef _Atomic  intptr_t          atomic_intptr_t\0"
+  "typedef _Atomic uintptr_t          atomic_uintptr_t\0"
+  "typedef _Atomic uintmax_t          atomic_uintmax_t\0"
+
+  "typedef _Atomic  int_fast8_t       atomic_int_fast8_t\0"
+  "typedef _Atomic  int_fast16_t      atomic_int_fast16_t\0"
+  "typedef _Atomic  int_fast32_t      atomic_int_fast32_t\0"
+  "typedef _Atomic  int_fast64_t      atomic_int_fast64_t\0"
+  "typedef _Atomic uint_fast8_t       atomic_uint_fast8_t\0"
+  "typedef _Atomic uint_fast16_t      atomic_uint_fast16_t\0"
+  "typedef _Atomic uint_fast32_t      atomic_uint_fast32_t\0"
+  "typedef _Atomic uint_fast64_t      atomic_uint_fast64_t\0"
+
+  "typedef _Atomic  int_least8_t      atomic_int_least8_t\0"
+  "typedef _Atomic  int_least16_t     atomic_int_least16_t\0"
+  "typedef _Atomic  int_least32_t     atomic_int_least32_t\0"
+  "typedef _Atomic  int_least64_t     atomic_int_least64_t\0"
+  "typedef _Atomic uint_least8_t      atomic_uint_least8_t\0"
+  "typedef _Atomic uint_least16_t     atomic_uint_least16_t\0"
+  "typedef _Atomic uint_least32_t     atomic_uint_least32_t\0"
+  "typedef _Atomic uint_least64_t     atomic_uint_least64_t\0"
+
+  "typedef pthread_cond_t             cnd_t\0"
+  "typedef void                     (*constraint_handler_t)(const char *restrict, void *restrict, errno_t)\0"
+  "typedef long     double            max_align_t\0"
+  "typedef enum memory_order          memory_order\0"
+  "typedef pthread_mutex_t            mtx_t\0"
+  "typedef          int               once_flag\0"
+  "typedef unsigned long              rsize_t\0"
+  "typedef pthread_t                  thrd_t\0"
+  "typedef          int             (*thrd_start_t)(void*)\0"
+  "typedef          void             *tss_t\0"
+  "typedef          void            (*tss_dtor_t)(void*)\0";
 
 /**
  * Predefined types for Floating-point extensions for C.
@@ -241,38 +345,35 @@ static char const *const PREDEFINED_STD_C_11[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_FLOATING_POINT_EXTENSIONS[] = {
-  "typedef          float       _Float16",
-  "typedef          _Float16    _Float16_t",
-  "typedef          float       _Float32",
-  "typedef          _Float32    _Float32_t",
-  "typedef          _Float32    _Float32x",
-  "typedef          double      _Float64",
-  "typedef          _Float64    _Float64_t",
-  "typedef          _Float64    _Float64x",
-  "typedef long     double      _Float128",
-  "typedef          _Float128   _Float128_t",
-  "typedef          _Float128   _Float128x",
-
-  "typedef          float       _Decimal32",
-  "typedef          _Decimal32  _Decimal32_t",
-  "typedef          double      _Decimal64",
-  "typedef          _Decimal64  _Decimal64x",
-  "typedef          _Decimal64  _Decimal64_t",
-  "typedef long     double      _Decimal128",
-  "typedef          _Decimal128 _Decimal128_t",
-  "typedef          _Decimal128 _Decimal128x",
-
-  "typedef          double      double_t",
-  "typedef          float       float_t",
-  "typedef long     double      long_double_t",
-
-  "struct                       femode_t",
-  "struct                       fenv_t",
-  "typedef unsigned short       fexcept_t",
-
-  NULL
-};
+static char const PREDEFINED_FLOATING_POINT_EXTENSIONS[] =
+  "typedef          float       _Float16\0"
+  "typedef          _Float16    _Float16_t\0"
+  "typedef          float       _Float32\0"
+  "typedef          _Float32    _Float32_t\0"
+  "typedef          _Float32    _Float32x\0"
+  "typedef          double      _Float64\0"
+  "typedef          _Float64    _Float64_t\0"
+  "typedef          _Float64    _Float64x\0"
+  "typedef long     double      _Float128\0"
+  "typedef          _Float128   _Float128_t\0"
+  "typedef          _Float128   _Float128x\0"
+
+  "typedef          float       _Decimal32\0"
+  "typedef          _Decimal32  _Decimal32_t\0"
+  "typedef          double      _Decimal64\0"
+  "typedef          _Decimal64  _Decimal64x\0"
+  "typedef          _Decimal64  _Decimal64_t\0"
+  "typedef long     double      _Decimal128\0"
+  "typedef          _Decimal128 _Decimal128_t\0"
+  "typedef          _Decimal128 _Decimal128x\0"
+
+  "typedef          double      double_t\0"
+  "typedef          float       float_t\0"
+  "typedef long     double      long_double_t\0"
+
+  "struct                       femode_t\0"
+  "struct                       fenv_t\0"
+  "typedef unsigned short       fexcept_t\0";
 
 /**
  * Predefined types for `pthread.h`.
@@ -280,21 +381,18 @@ static char const *const PREDEFINED_FLOATING_POINT_EXTENSIONS[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_PTHREAD_H[] = {
-  "typedef unsigned long  pthread_t",
-  "struct                 pthread_barrier_t",
-  "struct                 pthread_barrierattr_t",
-  "struct                 pthread_cond_t",
-  "struct                 pthread_condattr_t",
-  "struct                 pthread_mutex_t",
-  "struct                 pthread_mutexattr_t",
-  "typedef          int   pthread_once_t",
-  "struct                 pthread_rwlock_t",
-  "struct                 pthread_rwlockattr_t",
-  "typedef volatile int   pthread_spinlock_t",
-
-  NULL
-};
+static char const PREDEFINED_PTHREAD_H[] =
+  "typedef unsigned long  pthread_t\0"
+  "struct                 pthread_barrier_t\0"
+  "struct                 pthread_barrierattr_t\0"
+  "struct                 pthread_cond_t\0"
+  "struct                 pthread_condattr_t\0"
+  "struct                 pthread_mutex_t\0"
+  "struct                 pthread_mutexattr_t\0"
+  "typedef          int   pthread_once_t\0"
+  "struct                 pthread_rwlock_t\0"
+  "struct                 pthread_rwlockattr_t\0"
+  "typedef volatile int   pthread_spinlock_t\0";
 
 /**
  * Predefined types for C++.
@@ -302,70 +400,67 @@ static char const *const PREDEFINED_PTHREAD_H[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_STD_CPP[] = {
-  "namespace std { class                  bad_alloc;        }",
-  "namespace std { class                  bad_cast;         }",
-  "namespace std { class                  bad_exception;    }",
-  "namespace std { class                  bad_type_id;      }",
-  "namespace std { class                  codecvt_base;     }",
-  "namespace std { class                  ctype_base;       }",
-  "namespace std { struct                 div_t;            }",
-  "namespace std { struct                ldiv_t;            }",
-  "namespace std { class                  domain_error;     }",
-  "namespace std { class                  exception;        }",
-  "namespace std { class                  filebuf;          }",
-  "namespace std { class                 wfilebuf;          }",
-  "namespace std { class                  invalid_argument; }",
-  "namespace std { class                  ios;              }",
-  "namespace std { class                 wios;              }",
-  "namespace std { class                  length_error;     }",
-  "namespace std { class                  locale;           }",
-  "namespace std { class                  logic_error;      }",
-  "namespace std { class                  messages_base;    }",
-  "namespace std { class                  money_base;       }",
-  "namespace std { struct                 nothrow_t;        }",
-  "namespace std { class                  out_of_range;     }",
-  "namespace std { class                  overflow_error;   }",
-  "namespace std { typedef long           ptrdiff_t;        }",
-  "namespace std { class                  range_error;      }",
-  "namespace std { class                  runtime_error;    }",
-  "namespace std { typedef int            sig_atomic_t;     }",
-  "namespace std { typedef unsigned long  size_t;           }",
-  "namespace std { class                 fstream;           }",
-  "namespace std { class                ifstream;           }",
-  "namespace std { class                wfstream;           }",
-  "namespace std { class               wifstream;           }",
-  "namespace std { class                ofstream;           }",
-  "namespace std { class               wofstream;           }",
-  "namespace std { class                 istream;           }",
-  "namespace std { class                wistream;           }",
-  "namespace std { class                iostream;           }",
-  "namespace std { class               wiostream;           }",
-  "namespace std { class                 ostream;           }",
-  "namespace std { class                wostream;           }",
-  "namespace std { class                  streambuf;        }",
-  "namespace std { class                 wstreambuf;        }",
-  "namespace std { typedef long long      streamoff;        }",
-  "namespace std { typedef long           streamsize;       }",
-  "namespace std { class                  string;           }",
-  "namespace std { class                 wstring;           }",
-  "namespace std { class                  stringbuf;        }",
-  "namespace std { class                 wstringbuf;        }",
-  "namespace std { class                  stringstream;     }",
-  "namespace std { class                 istringstream;     }",
-  "namespace std { class                 wstringstream;     }",
-  "namespace std { class                wistringstream;     }",
-  "namespace std { class                 ostringstream;     }",
-  "namespace std { class                wostringstream;     }",
-  "namespace std { class                  syncbuf;          }",
-  "namespace std { class                 wsyncbuf;          }",
-  "namespace std { class                 osyncstream;       }",
-  "namespace std { class                wosyncstream;       }",
-  "namespace std { class                  time_base;        }",
-  "namespace std { class                  underflow_error;  }",
-
-  NULL
-};
+static char const PREDEFINED_STD_CPP[] =
+  "namespace std { class                  bad_alloc;        }\0"
+  "namespace std { class                  bad_cast;         }\0"
+  "namespace std { class                  bad_exception;    }\0"
+  "namespace std { class                  bad_type_id;      }\0"
+  "namespace std { class                  codecvt_base;     }\0"
+  "namespace std { class                  ctype_base;       }\0"
+  "namespace std { struct                 div_t;            }\0"
+  "namespace std { struct                ldiv_t;            }\0"
+  "namespace std { class                  domain_error;     }\0"
+  "namespace std { class                  exception;        }\0"
+  "namespace std { class                  filebuf;          }\0"
+  "namespace std { class                 wfilebuf;          }\0"
+  "namespace std { class                  invalid_argument; }\0"
+  "namespace std { class                  ios;              }\0"
+  "namespace std { class                 wios;              }\0"
+  "namespace std { class                  length_error;     }\0"
+  "namespace std { class                  locale;           }\0"
+  "namespace std { class                  logic_error;      }\0"
+  "namespace std { class                  messages_base;    }\0"
+  "namespace std { class                  money_base;       }\0"
+  "namespace std { struct                 nothrow_t;        }\0"
+  "namespace std { class                  out_of_range;     }\0"
+  "namespace std { class                  overflow_error;   }\0"
+  "namespace std { typedef long           ptrdiff_t;        }\0"
+  "namespace std { class                  range_error;      }\0"
+  "namespace std { class                  runtime_error;    }\0"
+  "namespace std { typedef int            sig_atomic_t;     }\0"
+  "namespace std { typedef unsigned long  size_t;           }\0"
+  "namespace std { class                 fstream;           }\0"
+  "namespace std { class                ifstream;           }\0"
+  "namespace std { class                wfstream;           }\0"
+  "namespace std { class               wifstream;           }\0"
+  "namespace std { class                ofstream;           }\0"
+  "namespace std { class               wofstream;           }\0"
+  "namespace std { class                 istream;           }\0"
+  "namespace std { class                wistream;           }\0"
+  "namespace std { class                iostream;           }\0"
+  "namespace std { class               wiostream;           }\0"
+  "namespace std { class                 ostream;           }\0"
+  "namespace std { class                wostream;           }\0"
+  "namespace std { class                  streambuf;        }\0"
+  "namespace std { class                 wstreambuf;        }\0"
+  "namespace std { typedef long long      streamoff;        }\0"
+  "namespace std { typedef long           streamsize;       }\0"
+  "namespace std { class                  string;           }\0"
+  "namespace std { class                 wstring;           }\0"
+  "namespace std { class                  stringbuf;        }\0"
+  "namespace std { class                 wstringbuf;        }\0"
+  "namespace std { class                  stringstream;     }\0"
+  "namespace std { class                 istringstream;     }\0"
+  "namespace std { class                 wstringstream;     }\0"
+  "namespace std { class                wistringstream;     }\0"
+  "namespace std { class                 ostringstream;     }\0"
+  "namespace std { class                wostringstream;     }\0"
+  "namespace std { class                  syncbuf;          }\0"
+  "namespace std { class                 wsyncbuf;          }\0"
+  "namespace std { class                 osyncstream;       }\0"
+  "namespace std { class                wosyncstream;       }\0"
+  "namespace std { class                  time_base;        }\0"
+  "namespace std { class                  underflow_error;  }\0";
 
 /**
  * Predefined types for C++11.
@@ -373,197 +468,187 @@ static char const *const PREDEFINED_STD_CPP[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_STD_CPP_11[] = {
-  "namespace std { struct                 adopt_lock_t;               }",
-  "namespace std { struct                 atomic_bool;                }",
-  "namespace std { struct                 atomic_char8_t;             }",
-  "namespace std { struct                 atomic_char16_t;            }",
-  "namespace std { struct                 atomic_char32_t;            }",
-  "namespace std { struct                 atomic_char;                }",
-  "namespace std { struct                 atomic_flag;                }",
-  "namespace std { struct                 atomic_int8_t;              }",
-  "namespace std { struct                 atomic_int16_t;             }",
-  "namespace std { struct                 atomic_int32_t;             }",
-  "namespace std { struct                 atomic_int64_t;             }",
-  "namespace std { struct                 atomic_int;                 }",
-  "namespace std { struct                 atomic_int_fast8_t;         }",
-  "namespace std { struct                 atomic_int_fast16_t;        }",
-  "namespace std { struct                 atomic_int_fast32_t;        }",
-  "namespace std { struct                 atomic_int_fast64_t;        }",
-  "namespace std { struct                 atomic_int_least8_t;        }",
-  "namespace std { struct                 atomic_int_least16_t;       }",
-  "namespace std { struct                 atomic_int_least32_t;       }",
-  "namespace std { struct                 atomic_int_least64_t;       }",
-  "namespace std { struct                 atomic_intmax_t;            }",
-  "namespace std { struct                 atomic_intptr_t;            }",
-  "namespace std { struct                 atomic_llong;               }",
-  "namespace std { struct                 atomic_long;                }",
-  "namespace std { struct                 atomic_ptrdiff_t;           }",
-  "namespace std { struct                 atomic_schar;               }",
-  "namespace std { struct                 atomic_short;               }",
-  "namespace std { struct                 atomic_signed_lock_free;    }",
-  "namespace std { struct                 atomic_size_t;              }",
-  "namespace std { struct                 atomic_uchar;               }",
-  "namespace std { struct                 atomic_uint16_t;            }",
-  "namespace std { struct                 atomic_uint32_t;            }",
-  "namespace std { struct                 atomic_uint64_t;            }",
-  "namespace std { struct                 atomic_uint8_t;             }",
-  "namespace std { struct                 atomic_uint;                }",
-  "namespace std { struct                 atomic_uint_fast8_t;        }",
-  "namespace std { struct                 atomic_uint_fast16_t;       }",
-  "namespace std { struct                 atomic_uint_fast32_t;       }",
-  "namespace std { struct                 atomic_uint_fast64_t;       }",
-  "namespace std { struct                 atomic_uint_least8_t;       }",
-  "namespace std { struct                 atomic_uint_least16_t;      }",
-  "namespace std { struct                 atomic_uint_least32_t;      }",
-  "namespace std { struct                 atomic_uint_least64_t;      }",
-  "namespace std { struct                 atomic_uintmax_t;           }",
-  "namespace std { struct                 atomic_uintptr_t;           }",
-  "namespace std { struct                 atomic_ullong;              }",
-  "namespace std { struct                 atomic_ulong;               }",
-  "namespace std { struct                 atomic_unsigned_lock_free;  }",
-  "namespace std { struct                 atomic_ushort;              }",
-  "namespace std { struct                 atomic_wchar_t;             }",
-
-  "namespace std { class                  bad_array_new_length;       }",
-  "namespace std { class                  bad_function_call;          }",
-  "namespace std { class                  bad_weak_ptr;               }",
-  "namespace std { class                  condition_variable;         }",
-  "namespace std { class                  condition_variable_any;     }",
-  "namespace std { enum class             cv_status;                  }",
-  "namespace std { struct                 defer_lock_t;               }",
-  "namespace std { struct             imaxdiv_t;                      }",
-  "namespace std { struct               lldiv_t;                      }",
-  "namespace std { class                  error_category;             }",
-  "namespace std { class                  error_code;                 }",
-  "namespace std { class                  error_condition;            }",
-  "namespace std { class ios_base { class failure;                 }; }",
-  "namespace std { enum class             future_errc;                }",
-  "namespace std { class                  future_error;               }",
-  "namespace std { enum class             future_status;              }",
-  "namespace std::chrono { class          high_resolution_clock;      }",
-  "namespace std { typedef long double    max_align_t;                }",
-  "namespace std { class                  mutex;                      }",
-  "namespace std { typedef void          *nullptr_t;                  }",
-  "namespace std { class                  recursive_mutex;            }",
-  "namespace std { class                  recursive_timed_mutex;      }",
-  "namespace std { class                  regex;                      }",
-  "namespace std { class                 wregex;                      }",
-  "namespace std { struct                 regex_error;                }",
-  "namespace std { class                  shared_mutex;               }",
-  "namespace std { class                  shared_timed_mutex;         }",
-  "namespace std { class               u16string;                     }",
-  "namespace std { class               u32string;                     }",
-  "namespace std::chrono { class          steady_clock;               }",
-  "namespace std::chrono { class          system_clock;               }",
-  "namespace std { struct                 system_error;               }",
-  "namespace std { class                  thread;                     }",
-  "namespace std { class                  timed_mutex;                }",
-  "namespace std { struct                 try_to_lock_t;              }",
-
-  NULL
-};
+static char const PREDEFINED_STD_CPP_11[] =
+  "namespace std { struct                 adopt_lock_t;               }\0"
+  "namespace std { struct                 atomic_bool;                }\0"
+  "namespace std { struct                 atomic_char8_t;             }\0"
+  "namespace std { struct                 atomic_char16_t;            }\0"
+  "namespace std { struct                 atomic_char32_t;            }\0"
+  "namespace std { struct                 atomic_char;                }\0"
+  "namespace std { struct                 atomic_flag;                }\0"
+  "namespace std { struct                 atomic_int8_t;              }\0"
+  "namespace std { struct                 atomic_int16_t;             }\0"
+  "namespace std { struct                 atomic_int32_t;             }\0"
+  "namespace std { struct                 atomic_int64_t;             }\0"
+  "namespace std { struct                 atomic_int;                 }\0"
+  "namespace std { struct                 atomic_int_fast8_t;         }\0"
+  "namespace std { struct                 atomic_int_fast16_t;        }\0"
+  "namespace std { struct                 atomic_int_fast32_t;        }\0"
+  "namespace std { struct                 atomic_int_fast64_t;        }\0"
+  "namespace std { struct                 atomic_int_least8_t;        }\0"
+  "namespace std { struct                 atomic_int_least16_t;       }\0"
+  "namespace std { struct                 atomic_int_least32_t;       }\0"
+  "namespace std { struct                 atomic_int_least64_t;       }\0"
+  "namespace std { struct                 atomic_intmax_t;            }\0"
+  "namespace std { struct                 atomic_intptr_t;            }\0"
+  "namespace std { struct                 atomic_llong;               }\0"
+  "namespace std { struct                 atomic_long;                }\0"
+  "namespace std { struct                 atomic_ptrdiff_t;           }\0"
+  "namespace std { struct                 atomic_schar;               }\0"
+  "namespace std { struct                 atomic_short;               }\0"
+  "namespace std { struct                 atomic_signed_lock_free;    }\0"
+  "namespace std { struct                 atomic_size_t;              }\0"
+  "namespace std { struct                 atomic_uchar;               }\0"
+  "namespace std { struct                 atomic_uint16_t;            }\0"
+  "namespace std { struct                 atomic_uint32_t;            }\0"
+  "namespace std { struct                 atomic_uint64_t;            }\0"
+  "namespace std { struct                 atomic_uint8_t;             }\0"
+  "namespace std { struct                 atomic_uint;                }\0"
+  "namespace std { struct                 atomic_uint_fast8_t;        }\0"
+  "namespace std { struct                 atomic_uint_fast16_t;       }\0"
+  "namespace std { struct                 atomic_uint_fast32_t;       }\0"
+  "namespace std { struct                 atomic_uint_fast64_t;       }\0"
+  "namespace std { struct                 atomic_uint_least8_t;       }\0"
+  "namespace std { struct                 atomic_uint_least16_t;      }\0"
+  "namespace std { struct                 atomic_uint_least32_t;      }\0"
+  "namespace std { struct                 atomic_uint_least64_t;      }\0"
+  "namespace std { struct                 atomic_uintmax_t;           }\0"
+  "namespace std { struct                 atomic_uintptr_t;           }\0"
+  "namespace std { struct                 atomic_ullong;              }\0"
+  "namespace std { struct                 atomic_ulong;               }\0"
+  "namespace std { struct                 atomic_unsigned_lock_free;  }\0"
+  "namespace std { struct                 atomic_ushort;              }\0"
+  "namespace std { struct                 atomic_wchar_t;             }\0"
+
+  "namespace std { class                  bad_array_new_length;       }\0"
+  "namespace std { class                  bad_function_call;          }\0"
+  "namespace std { class                  bad_weak_ptr;               }\0"
+  "namespace std { class                  condition_variable;         }\0"
+  "namespace std { class                  condition_variable_any;     }\0"
+  "namespace std { enum class             cv_status;                  }\0"
+  "namespace std { struct                 defer_lock_t;               }\0"
+  "namespace std { struct             imaxdiv_t;                      }\0"
+  "namespace std { struct               lldiv_t;                      }\0"
+  "namespace std { class                  error_category;             }\0"
+  "namespace std { class                  error_code;                 }\0"
+  "namespace std { class                  error_condition;            }\0"
+  "namespace std { class ios_base { class failure;                 }; }\0"
+  "namespace std { enum class             future_errc;                }\0"
+  "namespace std { class                  future_error;               }\0"
+  "namespace std { enum class             future_status;              }\0"
+  "namespace std::chrono { class          high_resolution_clock;      }\0"
+  "namespace std { typedef long double    max_align_t;                }\0"
+  "namespace std { class                  mutex;                      }\0"
+  "namespace std { typedef void          *nullptr_t;                  }\0"
+  "namespace std { class                  recursive_mutex;            }\0"
+  "namespace std { class                  recursive_timed_mutex;      }\0"
+  "namespace std { class                  regex;                      }\0"
+  "namespace std { class                 wregex;                      }\0"
+  "namespace std { struct                 regex_error;                }\0"
+  "namespace std { class                  shared_mutex;               }\0"
+  "namespace std { class                  shared_timed_mutex;         }\0"
+  "namespace std { class               u16string;                     }\0"
+  "namespace std { class               u32string;                     }\0"
+  "namespace std::chrono { class          steady_clock;               }\0"
+  "namespace std::chrono { class          system_clock;               }\0"
+  "namespace std { struct                 system_error;               }\0"
+  "namespace std { class                  thread;                     }\0"
+  "namespace std { class                  timed_mutex;                }\0"
+  "namespace std { struct                 try_to_lock_t;              }\0";
 
 /**
  * Predefined types for C++17.
  */
-static char const *const PREDEFINED_STD_CPP_17[] = {
-  "namespace std { enum class             align_val_t;                  }",
-  "namespace std { class                  bad_any_cast;                 }",
-  "namespace std { class                  bad_optional_access;          }",
-  "namespace std { class                  bad_variant_access;           }",
-  "namespace std { enum                   byte;                         }",
-  "namespace std::filesystem { enum class copy_options;                 }",
-  "namespace std::filesystem { class      directory_entry;              }",
-  "namespace std::filesystem { class      directory_iterator;           }",
-  "namespace std::filesystem { enum class directory_options;            }",
-  "namespace std::filesystem { class      file_status;                  }",
-  "namespace std::filesystem { enum class file_type;                    }",
-  "namespace std::filesystem { class      filesystem_error;             }",
-  "namespace std::filesystem { class      path;                         }",
-  "namespace std::filesystem { enum class perms;                        }",
-  "namespace std::filesystem { enum class perm_options;                 }",
-  "namespace std::filesystem { class      recursive_directory_iterator; }",
-  "namespace std::filesystem { struct     space_info;                   }",
-  "namespace std { class                  string_view;                  }",
-  "namespace std { class               u16string_view;                  }",
-  "namespace std { class               u32string_view;                  }",
-  "namespace std { class                 wstring_view;                  }",
-
-  NULL
-};
+static char const PREDEFINED_STD_CPP_17[] =
+  "namespace std { enum class             align_val_t;                  }\0"
+  "namespace std { class                  bad_any_cast;                 }\0"
+  "namespace std { class                  bad_optional_access;          }\0"
+  "namespace std { class                  bad_variant_access;           }\0"
+  "namespace std { enum                   byte;                         }\0"
+  "namespace std::filesystem { enum class copy_options;                 }\0"
+  "namespace std::filesystem { class      directory_entry;              }\0"
+  "namespace std::filesystem { class      directory_iterator;           }\0"
+  "namespace std::filesystem { enum class directory_options;            }\0"
+  "namespace std::filesystem { class      file_status;                  }\0"
+  "namespace std::filesystem { enum class file_type;                    }\0"
+  "namespace std::filesystem { class      filesystem_error;             }\0"
+  "namespace std::filesystem { class      path;                         }\0"
+  "namespace std::filesystem { enum class perms;                        }\0"
+  "namespace std::filesystem { enum class perm_options;                 }\0"
+  "namespace std::filesystem { class      recursive_directory_iterator; }\0"
+  "namespace std::filesystem { struct     space_info;                   }\0"
+  "namespace std { class                  string_view;                  }\0"
+  "namespace std { class               u16string_view;                  }\0"
+  "namespace std { class               u32string_view;                  }\0"
+  "namespace std { class                 wstring_view;                  }\0";
 
 /**
  * Predefined types for C++20.
  */
-static char const *const PREDEFINED_STD_CPP_20[] = {
-  "namespace std { class              ambiguous_local_time;     }",
-  "namespace std::chrono { enum class choose;                   }",
-  "namespace std::chrono { class      day;                      }",
-  "namespace std { struct             destroying_delete_t;      }",
-  "namespace std::chrono { struct     file_clock;               }",
-  "namespace std { class              format_error;             }",
-  "namespace std::chrono { struct     gps_clock;                }",
-  "namespace std::chrono { struct     is_clock;                 }",
-  "namespace std { class              jthread;                  }",
-  "namespace std::chrono { struct     last_spec;                }",
-  "namespace std::chrono { class      leap_second;              }",
-  "namespace std::chrono { struct     local_info;               }",
-  "namespace std::chrono { struct     local_t;                  }",
-  "namespace std::chrono { class      month;                    }",
-  "namespace std::chrono { class      month_day;                }",
-  "namespace std::chrono { class      month_day_last;           }",
-  "namespace std::chrono { class      month_weekday;            }",
-  "namespace std::chrono { class      month_weekday_last;       }",
-  "namespace std::chrono { class      nonexistent_local_time;   }",
-  "namespace std { struct             nonstopstate_t;           }",
-  "namespace std { struct             partial_ordering;         }",
-  "namespace std { class            u8string_view;              }",
-  "namespace std { class              stop_source;              }",
-  "namespace std { class              stop_token;               }",
-  "namespace std { struct             strong_equality;          }",
-  "namespace std { struct             strong_ordering;          }",
-  "namespace std::chrono { struct     sys_info;                 }",
-  "namespace std::chrono { struct     tai_clock;                }",
-  "namespace std::chrono { struct     time_zone;                }",
-  "namespace std::chrono { class      time_zone_link;           }",
-  "namespace std::chrono { struct     tzdb;                     }",
-  "namespace std::chrono { struct     tzdb_list;                }",
-  "namespace std::chrono { struct     utc_clock;                }",
-  "namespace std::chrono { class      weekday;                  }",
-  "namespace std::chrono { class      weekday_indexed;          }",
-  "namespace std::chrono { class      weekday_last;             }",
-  "namespace std { struct             weak_equality;            }",
-  "namespace std { struct             weak_ordering;            }",
-  "namespace std::chrono { class      year;                     }",
-  "namespace std::chrono { class      year_month;               }",
-  "namespace std::chrono { class      year_month_day;           }",
-  "namespace std::chrono { class      year_month_day_last;      }",
-  "namespace std::chrono { class      year_month_weekday;       }",
-  "namespace std::chrono { class      year_month_weekday_last;  }",
-
-  NULL
-};
-
+static char const PREDEFINED_STD_CPP_20[] =
+  "namespace std { class              ambiguous_local_time;     }\0"
+  "namespace std::chrono { enum class choose;                   }\0"
+  "namespace std::chrono { class      day;                      }\0"
+  "namespace std { struct             destroying_delete_t;      }\0"
+  "namespace std::chrono { struct     file_clock;               }\0"
+  "namespace std { class              format_error;             }\0"
+  "namespace std::chrono { struct     gps_clock;                }\0"
+  "namespace std::chrono { struct     is_clock;                 }\0"
+  "namespace std { class              jthread;                  }\0"
+  "namespace std::chrono { struct     last_spec;                }\0"
+  "namespace std::chrono { class      leap_second;              }\0"
+  "namespace std::chrono { struct     local_info;               }\0"
+  "namespace std::chrono { struct     local_t;                  }\0"
+  "namespace std::chrono { class      month;                    }\0"
+  "namespace std::chrono { class      month_day;                }\0"
+  "namespace std::chrono { class      month_day_last;           }\0"
+  "namespace std::chrono { class      month_weekday;            }\0"
+  "namespace std::chrono { class      month_weekday_last;       }\0"
+  "namespace std::chrono { class      nonexistent_local_time;   }\0"
+  "namespace std { struct             nonstopstate_t;           }\0"
+  "namespace std { struct             partial_ordering;         }\0"
+  "namespace std { class            u8string_view;              }\0"
+  "namespace std { class              stop_source;              }\0"
+  "namespace std { class              stop_token;               }\0"
+  "namespace std { struct             strong_equality;          }\0"
+  "namespace std { struct             strong_ordering;          }\0"
+  "namespace std::chrono { struct     sys_info;                 }\0"
+  "namespace std::chrono { struct     tai_clock;                }\0"
+  "namespace std::chrono { struct     time_zone;                }\0"
+  "namespace std::chrono { class      time_zone_link;           }\0"
+  "namespace std::chrono { struct     tzdb;                     }\0"
+  "namespace std::chrono { struct     tzdb_list;                }\0"
+  "namespace std::chrono { struct     utc_clock;                }\0"
+  "namespace std::chrono { class      weekday;                  }\0"
+  "namespace std::chrono { class      weekday_indexed;          }\0"
+  "namespace std::chrono { class      weekday_last;             }\0"
+  "namespace std { struct             weak_equality;            }\0"
+  "namespace std { struct             weak_ordering;            }\0"
+  "namespace std::chrono { class      year;                     }\0"
+  "namespace std::chrono { class      year_month;               }\0"
+  "namespace std::chrono { class      year_month_day;           }\0"
+  "namespace std::chrono { class      year_month_day_last;      }\0"
+  "namespace std::chrono { class      year_month_weekday;       }\0"
+  "namespace std::chrono { class      year_month_weekday_last;  }\0";
+
+#if LANG_IS_LIVE(C_99)
 /**
  * Embedded C types.
  */
-static char const *const PREDEFINED_EMBEDDED_C[] = {
-  "typedef          short _Accum int_hk_t",
-  "typedef          short _Fract int_hr_t",
-  "typedef                _Accum int_k_t",
-  "typedef          long  _Accum int_lk_t",
-  "typedef          long  _Fract int_lr_t",
-  "typedef                _Fract int_r_t",
-  "typedef unsigned short _Accum uint_uhk_t",
-  "typedef unsigned short _Fract uint_uhr_t",
-  "typedef unsigned       _Accum uint_uk_t",
-  "typedef unsigned long  _Accum uint_ulk_t",
-  "typedef unsigned long  _Fract uint_ulr_t",
-  "typedef unsigned       _Fract uint_ur_t",
-
-  NULL
-};
+static char const PREDEFINED_EMBEDDED_C[] =
+  "typedef          short _Accum int_hk_t\0"
+  "typedef          short _Fract int_hr_t\0"
+  "typedef                _Accum int_k_t\0"
+  "typedef          long  _Accum int_lk_t\0"
+  "typedef          long  _Fract int_lr_t\0"
+  "typedef                _Fract int_r_t\0"
+  "typedef unsigned short _Accum uint_uhk_t\0"
+  "typedef unsigned short _Fract uint_uhr_t\0"
+  "typedef unsigned       _Accum uint_uk_t\0"
+  "typedef unsigned long  _Accum uint_ulk_t\0"
+  "typedef unsigned long  _Fract uint_ulr_t\0"
+  "typedef unsigned       _Fract uint_ur_t\0";
+#endif /* LANG_IS_LIVE(C_99) */
 
 /**
  * Predefined GNU C types.
@@ -571,11 +656,11 @@ static char const *const PREDEFINED_EMBEDDED_C[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_GNU_C[] = {
-  "typedef _Float128   __float128",
-  "typedef _Float16    __fp16",
-  "typedef long double __ibm128",
-  "typedef _Float64x   __float80",
+static char const PREDEFINED_GNU_C[] =
+  "typedef _Float128   __float128\0"
+  "typedef _Float16    __fp16\0"
+  "typedef long double __ibm128\0"
+  "typedef _Float64x   __float80\0"
   //
   // In GNU C, this is a distinct type, not a typedef, which means you can add
   // type modifiers:
@@ -604,10 +689,7 @@ static char const *const PREDEFINED_GNU_C[] = {
   // Hence, it's too much work to support this type as distinct and we'll live
   // with not being able to apply type modifiers.
   //
-  "typedef long long   __int128",
-
-  NULL
-};
+  "typedef long long   __int128\0";
 
 /**
  * Predefined miscellaneous standard-ish types.
@@ -615,238 +697,231 @@ static char const *const PREDEFINED_GNU_C[] = {
  * @note The underlying types used here are merely typical and do not
  * necessarily match the underlying type on any particular platform.
  */
-static char const *const PREDEFINED_MISC[] = {
-  "typedef  int32_t       blkcnt_t",
-  "typedef  int32_t       blksize_t",
-  "struct                 fd_set",
-  "typedef void          *iconv_t",
-  "struct                 locale_t",
-  "typedef  int32_t       mode_t",
-  "typedef unsigned long  nfds_t",
-  "typedef uint32_t       nlink_t",
-  "typedef uint32_t       rlim_t",
-  "typedef unsigned long  sigset_t",
-
-  "enum                   clockid_t",
-  "typedef  int64_t       suseconds_t",
-  "typedef uint32_t       useconds_t",
-
-  "typedef uint32_t       gid_t",
-  "typedef  int32_t       pid_t",
-  "typedef uint32_t       uid_t",
-
-  "typedef void           *posix_spawnattr_t",
-  "typedef void           *posix_spawn_file_actions_t",
-
-  "struct                 regex_t",
-  "struct                 regmatch_t",
-  "typedef size_t         regoff_t",
-
-  "typedef uint32_t       in_addr_t",
-  "typedef uint16_t       in_port_t",
-  "typedef uint32_t       sa_family_t",
-  "typedef uint32_t       socklen_t",
-
-  NULL
-};
+static char const PREDEFINED_MISC[] =
+  "typedef  int32_t       blkcnt_t\0"
+  "typedef  int32_t       blksize_t\0"
+  "struct                 fd_set\0"
+  "typedef void          *iconv_t\0"
+  "struct                 locale_t\0"
+  "typedef  int32_t       mode_t\0"
+  "typedef unsigned long  nfds_t\0"
+  "typedef uint32_t       nlink_t\0"
+  "typedef uint32_t       rlim_t\0"
+  "typedef unsigned long  sigset_t\0"
+
+  "enum                   clockid_t\0"
+  "typedef  int64_t       suseconds_t\0"
+  "typedef uint32_t       useconds_t\0"
+
+  "typedef uint32_t       gid_t\0"
+  "typedef  int32_t       pid_t\0"
+  "typedef uint32_t       uid_t\0"
+
+  "typedef void           *posix_spawnattr_t\0"
+  "typedef void           *posix_spawn_file_actions_t\0"
+
+  "struct                 regex_t\0"
+  "struct                 regmatch_t\0"
+  "typedef size_t         regoff_t\0"
+
+  "typedef uint32_t       in_addr_t\0"
+  "typedef uint16_t       in_port_t\0"
+  "typedef uint32_t       sa_family_t\0"
+  "typedef uint32_t       socklen_t\0";
 
 /**
  * Predefined types for Windows.
  *
  * @sa [Windows Data Types](https://docs.microsoft.com/en-us/windows/win32/winprog/windows-data-types)
  */
-static char const *const PREDEFINED_WIN32[] = {
+static char const PREDEFINED_WIN32[] =
   //
   // The comment about GNU C's __int128 type applies to these also.
   //
-  "typedef   signed char          __int8",
-  "typedef          short         __int16",
-  "typedef          int           __int32",
-  "typedef          long long     __int64",
-  "typedef          wchar_t       __wchar_t",
-
-  "typedef          int           BOOL",
-  "typedef BOOL                 *PBOOL",
-  "typedef BOOL                *LPBOOL",
-  "typedef          wchar_t       WCHAR",
-  "typedef WCHAR                *PWCHAR",
-  "typedef unsigned char          BYTE",
-  "typedef WCHAR                 TBYTE",
-  "typedef BYTE                 *PBYTE",
-  "typedef TBYTE               *PTBYTE",
-  "typedef BYTE                *LPBYTE",
-  "typedef BYTE                   BOOLEAN",
-  "typedef BOOLEAN              *PBOOLEAN",
-  "typedef          char          CHAR",
-  "typedef          char         CCHAR",
-  "typedef CHAR                 *PCHAR",
-  "typedef CHAR                *LPCHAR",
-  "typedef WCHAR                 TCHAR",
-  "typedef TCHAR               *PTCHAR",
-  "typedef          short         SHORT",
-  "typedef SHORT                *PSHORT",
-  "typedef          int           INT",
-  "typedef INT                  *PINT",
-  "typedef          int        *LPINT",
-  "typedef          long          LONG",
-  "typedef LONG                 *PLONG",
-  "typedef          long       *LPLONG",
-  "typedef          long long     LONGLONG",
-  "typedef LONGLONG             *PLONGLONG",
-  "typedef          float         FLOAT",
-  "typedef FLOAT                *PFLOAT",
-  "typedef          void        *PVOID",
-  "typedef          void       *LPVOID",
-  "typedef    const void      *LPCVOID",
-
-  "typedef unsigned char          UCHAR",
-  "typedef UCHAR                *PUCHAR",
-  "typedef unsigned short         USHORT",
-  "typedef USHORT               *PUSHORT",
-  "typedef unsigned int           UINT",
-  "typedef UINT                 *PUINT",
-  "typedef unsigned long          ULONG",
-  "typedef ULONG                *PULONG",
-  "typedef unsigned long long     ULONGLONG",
-  "typedef ULONGLONG            *PULONGLONG",
-
-  "typedef unsigned short         WORD",
-  "typedef WORD                 *PWORD",
-  "typedef WORD                *LPWORD",
-  "typedef unsigned long          DWORD",
-  "typedef DWORD                *PDWORD",
-  "typedef DWORD               *LPDWORD",
-  "typedef unsigned long          DWORDLONG",
-  "typedef DWORDLONG            *PDWORDLONG",
-  "typedef unsigned int           DWORD32",
-  "typedef DWORD32              *PDWORD32",
-  "typedef unsigned long          DWORD64",
-  "typedef DWORD64              *PDWORD64",
-  "typedef unsigned long long     QWORD",
-
-  "typedef   signed char          INT8",
-  "typedef INT8                 *PINT8",
-  "typedef          short         INT16",
-  "typedef INT16                *PINT16",
-  "typedef          int           INT32",
-  "typedef INT32                *PINT32",
-  "typedef          long          INT64",
-  "typedef INT64                *PINT64",
-  "typedef          int           HALF_PTR",
-  "typedef HALF_PTR             *PHALF_PTR",
-  "typedef        __int64         INT_PTR",
-  "typedef INT_PTR              *PINT_PTR",
-  "typedef          int           LONG32",
-  "typedef LONG32               *PLONG32",
-  "typedef        __int64         LONG64",
-  "typedef LONG64               *PLONG64",
-  "typedef        __int64         LONG_PTR",
-  "typedef LONG_PTR             *PLONG_PTR",
-
-  "typedef unsigned char          UINT8",
-  "typedef UINT8                *PUINT8",
-  "typedef unsigned short         UINT16",
-  "typedef UINT16               *PUINT16",
-  "typedef unsigned int           UINT32",
-  "typedef UINT32               *PUINT32",
-  "typedef unsigned long          UINT64",
-  "typedef UINT64               *PUINT64",
-  "typedef unsigned int           UHALF_PTR",
-  "typedef UHALF_PTR            *PUHALF_PTR",
-  "typedef unsigned long          UINT_PTR",
-  "typedef UINT_PTR             *PUINT_PTR",
-  "typedef unsigned int           ULONG32",
-  "typedef ULONG32              *PULONG32",
-  "typedef unsigned long          ULONG64",
-  "typedef ULONG64              *PULONG64",
-  "typedef unsigned long          ULONG_PTR",
-  "typedef ULONG_PTR            *PULONG_PTR",
-
-  "typedef ULONG_PTR              DWORD_PTR",
-  "typedef DWORD_PTR            *PDWORD_PTR",
-  "typedef ULONG_PTR              SIZE_T",
-  "typedef SIZE_T               *PSIZE_T",
-  "typedef LONG_PTR               SSIZE_T",
-  "typedef SSIZE_T              *PSSIZE_T",
-
-  "typedef PVOID                  HANDLE",
-  "typedef HANDLE               *PHANDLE",
-  "typedef HANDLE              *LPHANDLE",
-  "typedef HANDLE                 HBITMAP",
-  "typedef HANDLE                 HBRUSH",
-  "typedef HANDLE                 HCOLORSPACE",
-  "typedef HANDLE                 HCONV",
-  "typedef HANDLE                 HCONVLIST",
-  "typedef HANDLE                 HDC",
-  "typedef HANDLE                 HDDEDATA",
-  "typedef HANDLE                 HDESK",
-  "typedef HANDLE                 HDROP",
-  "typedef HANDLE                 HDWP",
-  "typedef HANDLE                 HENHMETAFILE",
-  "typedef HANDLE                 HFONT",
-  "typedef HANDLE                 HGDIOBJ",
-  "typedef HANDLE                 HGLOBAL",
-  "typedef HANDLE                 HHOOK",
-  "typedef HANDLE                 HICON",
-  "typedef HICON                  HCURSOR",
-  "typedef HANDLE                 HINSTANCE",
-  "typedef HANDLE                 HKEY",
-  "typedef HKEY                 *PHKEY",
-  "typedef HANDLE                 HKL",
-  "typedef HANDLE                 HLOCAL",
-  "typedef HANDLE                 HMENU",
-  "typedef HANDLE                 HMETAFILE",
-  "typedef HINSTANCE              HMODULE",
-  "typedef HANDLE                 HMONITOR",
-  "typedef HANDLE                 HPALETTE",
-  "typedef HANDLE                 HPEN",
-  "typedef HANDLE                 HRGN",
-  "typedef HANDLE                 HRSRC",
-  "typedef HANDLE                 HSZ",
-  "typedef HANDLE                 HWINSTA",
-  "typedef HANDLE                 HWND",
-
-  "typedef          CHAR        *PSTR",
-  "typedef   const  CHAR       *PCSTR",
-  "typedef          CHAR       *LPSTR",
-  "typedef   const  CHAR      *LPCSTR",
-  "typedef         WCHAR       *PWSTR",
-  "typedef   const WCHAR      *PCWSTR",
-  "typedef         WCHAR      *LPWSTR",
-  "typedef   const WCHAR     *LPCWSTR",
-  "typedef       LPWSTR         PTSTR",
-  "typedef       LPWSTR        LPTSTR",
-  "typedef      LPCWSTR        PCTSTR",
-  "typedef      LPCWSTR       LPCTSTR",
-
-  "typedef WORD                   ATOM",
-  "typedef DWORD                  COLORREF",
-  "typedef COLORREF            *LPCOLORREF",
-  "typedef          int           HFILE",
-  "typedef          long          HRESULT",
-  "typedef WORD                   LANGID",
-  "typedef union _LARGE_INTEGER   LARGE_INTEGER",
-  "typedef union _ULARGE_INTEGER ULARGE_INTEGER",
-  "typedef DWORD                  LCID",
-  "typedef PDWORD                PLCID",
-  "typedef DWORD                  LCTYPE",
-  "typedef DWORD                  LGRPID",
-  "typedef LONG_PTR               LRESULT",
-  "typedef HANDLE                 SC_HANDLE",
-  "typedef LPVOID                 SC_LOCK",
-  "typedef HANDLE                 SERVICE_STATUS_HANDLE",
-  "struct                         UNICODE_STRING",
-  "typedef LONGLONG               USN",
-  "typedef UINT_PTR               WPARAM",
-
-  NULL
-};
+  "typedef   signed char          __int8\0"
+  "typedef          short         __int16\0"
+  "typedef          int           __int32\0"
+  "typedef          long long     __int64\0"
+  "typedef          wchar_t       __wchar_t\0"
+
+  "typedef          int           BOOL\0"
+  "typedef BOOL                 *PBOOL\0"
+  "typedef BOOL                *LPBOOL\0"
+  "typedef          wchar_t       WCHAR\0"
+  "typedef WCHAR                *PWCHAR\0"
+  "typedef unsigned char          BYTE\0"
+  "typedef WCHAR                 TBYTE\0"
+  "typedef BYTE                 *PBYTE\0"
+  "typedef TBYTE               *PTBYTE\0"
+  "typedef BYTE                *LPBYTE\0"
+  "typedef BYTE                   BOOLEAN\0"
+  "typedef BOOLEAN              *PBOOLEAN\0"
+  "typedef          char          CHAR\0"
+  "typedef          char         CCHAR\0"
+  "typedef CHAR                 *PCHAR\0"
+  "typedef CHAR                *LPCHAR\0"
+  "typedef WCHAR                 TCHAR\0"
+  "typedef TCHAR               *PTCHAR\0"
+  "typedef          short         SHORT\0"
+  "typedef SHORT                *PSHORT\0"
+  "typedef          int           INT\0"
+  "typedef INT                  *PINT\0"
+  "typedef          int        *LPINT\0"
+  "typedef          long          LONG\0"
+  "typedef LONG                 *PLONG\0"
+  "typedef          long       *LPLONG\0"
+  "typedef          long long     LONGLONG\0"
+  "typedef LONGLONG             *PLONGLONG\0"
+  "typedef          float         FLOAT\0"
+  "typedef FLOAT                *PFLOAT\0"
+  "typedef          void        *PVOID\0"
+  "typedef          void       *LPVOID\0"
+  "typedef    const void      *LPCVOID\0"
+
+  "typedef unsigned char          UCHAR\0"
+  "typedef UCHAR                *PUCHAR\0"
+  "typedef unsigned short         USHORT\0"
+  "typedef USHORT               *PUSHORT\0"
+  "typedef unsigned int           UINT\0"
+  "typedef UINT                 *PUINT\0"
+  "typedef unsigned long          ULONG\0"
+  "typedef ULONG                *PULONG\0"
+  "typedef unsigned long long     ULONGLONG\0"
+  "typedef ULONGLONG            *PULONGLONG\0"
+
+  "typedef unsigned short         WORD\0"
+  "typedef WORD                 *PWORD\0"
+  "typedef WORD                *LPWORD\0"
+  "typedef unsigned long          DWORD\0"
+  "typedef DWORD                *PDWORD\0"
+  "typedef DWORD               *LPDWORD\0"
+  "typedef unsigned long          DWORDLONG\0"
+  "typedef DWORDLONG            *PDWORDLONG\0"
+  "typedef unsigned int           DWORD32\0"
+  "typedef DWORD32              *PDWORD32\0"
+  "typedef unsigned long          DWORD64\0"
+  "typedef DWORD64              *PDWORD64\0"
+  "typedef unsigned long long     QWORD\0"
+
+  "typedef   signed char          INT8\0"
+  "typedef INT8                 *PINT8\0"
+  "typedef          short         INT16\0"
+  "typedef INT16                *PINT16\0"
+  "typedef          int           INT32\0"
+  "typedef INT32                *PINT32\0"
+  "typedef          long          INT64\0"
+  "typedef INT64                *PINT64\0"
+  "typedef          int           HALF_PTR\0"
+  "typedef HALF_PTR             *PHALF_PTR\0"
+  "typedef        __int64         INT_PTR\0"
+  "typedef INT_PTR              *PINT_PTR\0"
+  "typedef          int           LONG32\0"
+  "typedef LONG32               *PLONG32\0"
+  "typedef        __int64         LONG64\0"
+  "typedef LONG64               *PLONG64\0"
+  "typedef        __int64         LONG_PTR\0"
+  "typedef LONG_PTR             *PLONG_PTR\0"
+
+  "typedef unsigned char          UINT8\0"
+  "typedef UINT8                *PUINT8\0"
+  "typedef unsigned short         UINT16\0"
+  "typedef UINT16               *PUINT16\0"
+  "typedef unsigned int           UINT32\0"
+  "typedef UINT32               *PUINT32\0"
+  "typedef unsigned long          UINT64\0"
+  "typedef UINT64               *PUINT64\0"
+  "typedef unsigned int           UHALF_PTR\0"
+  "typedef UHALF_PTR            *PUHALF_PTR\0"
+  "typedef unsigned long          UINT_PTR\0"
+  "typedef UINT_PTR             *PUINT_PTR\0"
+  "typedef unsigned int           ULONG32\0"
+  "typedef ULONG32              *PULONG32\0"
+  "typedef unsigned long          ULONG64\0"
+  "typedef ULONG64              *PULONG64\0"
+  "typedef unsigned long          ULONG_PTR\0"
+  "typedef ULONG_PTR            *PULONG_PTR\0"
+
+  "typedef ULONG_PTR              DWORD_PTR\0"
+  "typedef DWORD_PTR            *PDWORD_PTR\0"
+  "typedef ULONG_PTR              SIZE_T\0"
+  "typedef SIZE_T               *PSIZE_T\0"
+  "typedef LONG_PTR               SSIZE_T\0"
+  "typedef SSIZE_T              *PSSIZE_T\0"
+
+  "typedef PVOID                  HANDLE\0"
+  "typedef HANDLE               *PHANDLE\0"
+  "typedef HANDLE              *LPHANDLE\0"
+  "typedef HANDLE                 HBITMAP\0"
+  "typedef HANDLE                 HBRUSH\0"
+  "typedef HANDLE                 HCOLORSPACE\0"
+  "typedef HANDLE                 HCONV\0"
+  "typedef HANDLE                 HCONVLIST\0"
+  "typedef HANDLE                 HDC\0"
+  "typedef HANDLE                 HDDEDATA\0"
+  "typedef HANDLE                 HDESK\0"
+  "typedef HANDLE                 HDROP\0"
+  "typedef HANDLE                 HDWP\0"
+  "typedef HANDLE                 HENHMETAFILE\0"
+  "typedef HANDLE                 HFONT\0"
+  "typedef HANDLE                 HGDIOBJ\0"
+  "typedef HANDLE                 HGLOBAL\0"
+  "typedef HANDLE                 HHOOK\0"
+  "typedef HANDLE                 HICON\0"
+  "typedef HICON                  HCURSOR\0"
+  "typedef HANDLE                 HINSTANCE\0"
+  "typedef HANDLE                 HKEY\0"
+  "typedef HKEY                 *PHKEY\0"
+  "typedef HANDLE                 HKL\0"
+  "typedef HANDLE                 HLOCAL\0"
+  "typedef HANDLE                 HMENU\0"
+  "typedef HANDLE                 HMETAFILE\0"
+  "typedef HINSTANCE              HMODULE\0"
+  "typedef HANDLE                 HMONITOR\0"
+  "typedef HANDLE                 HPALETTE\0"
+  "typedef HANDLE                 HPEN\0"
+  "typedef HANDLE                 HRGN\0"
+  "typedef HANDLE                 HRSRC\0"
+  "typedef HANDLE                 HSZ\0"
+  "typedef HANDLE                 HWINSTA\0"
+  "typedef HANDLE                 HWND\0"
+
+  "typedef          CHAR        *PSTR\0"
+  "typedef   const  CHAR       *PCSTR\0"
+  "typedef          CHAR       *LPSTR\0"
+  "typedef   const  CHAR      *LPCSTR\0"
+  "typedef         WCHAR       *PWSTR\0"
+  "typedef   const WCHAR      *PCWSTR\0"
+  "typedef         WCHAR      *LPWSTR\0"
+  "typedef   const WCHAR     *LPCWSTR\0"
+  "typedef       LPWSTR         PTSTR\0"
+  "typedef       LPWSTR        LPTSTR\0"
+  "typedef      LPCWSTR        PCTSTR\0"
+  "typedef      LPCWSTR       LPCTSTR\0"
+
+  "typedef WORD                   ATOM\0"
+  "typedef DWORD                  COLORREF\0"
+  "typedef COLORREF            *LPCOLORREF\0"
+  "typedef          int           HFILE\0"
+  "typedef          long          HRESULT\0"
+  "typedef WORD                   LANGID\0"
+  "typedef union _LARGE_INTEGER   LARGE_INTEGER\0"
+  "typedef union _ULARGE_INTEGER ULARGE_INTEGER\0"
+  "typedef DWORD                  LCID\0"
+  "typedef PDWORD                PLCID\0"
+  "typedef DWORD                  LCTYPE\0"
+  "typedef DWORD                  LGRPID\0"
+  "typedef LONG_PTR               LRESULT\0"
+  "typedef HANDLE                 SC_HANDLE\0"
+  "typedef LPVOID                 SC_LOCK\0"
+  "typedef HANDLE                 SERVICE_STATUS_HANDLE\0"
+  "struct                         UNICODE_STRING\0"
+  "typedef LONGLONG               USN\0"
+  "typedef UINT_PTR               WPARAM\0";
 
 ////////// local functions ////////////////////////////////////////////////////
 
 /**
- * Comparison function for <code>\ref c_typedef</code> data used by the red-
- * black tree.
+ * Comparison function for <code>\ref c_typedef</code> data used by the set.
  *
  * @param i_data A pointer to data.
  * @param j_data A pointer to data.
@@ -863,6 +938,42 @@ static int c_typedef_cmp( void const *i_data, void const *j_data ) {
   return c_sname_cmp( &i_tdef->ast->sname, &j_tdef->ast->sname );
 }
 
+/**
+ * Duplicates a <code>\ref c_typedef</code> (but not its AST).
+ *
+ * @param tdef The <code>\ref c_typedef</code> to duplicate.
+ * @return Returns said duplicate.
+ */
+PJL_WARN_UNUSED_RESULT
+static c_typedef_t* c_typedef_dup( c_typedef_t const *tdef ) {
+  assert( tdef != NULL );
+  c_typedef_t *const dup_tdef =
+    MALLOC_SUB( ALLOC_SUB_TYPEDEF, c_typedef_t, 1 );
+  *dup_tdef = *tdef;
+  dup_tdef->cache = NULL;               // renderings aren't shared
+  return dup_tdef;
+}
+
+/**
+ * Frees a <code>\ref c_typedef</code> including its cached renderings, if
+ * any (but not its AST).
+ *
+ * @param data A pointer to the <code>\ref c_typedef</code> to free.
+ */
+static void c_typedef_free( void *data ) {
+  c_typedef_t *const tdef = data;
+  // This may be called by any later writer of the set, so don't assume the
+  // current allocator is the one tdef came from.
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  if ( tdef->cache != NULL ) {
+    for ( unsigned i = 0; i < C_TDEF_RENDER_N; ++i )
+      free( tdef->cache->rendered[i].text );  // allocated by open_memstream()
+    FREE( tdef->cache );
+  }
+  FREE_SUB( ALLOC_SUB_TYPEDEF, tdef, sizeof( c_typedef_t ) );
+  alloc_use( prev_a );
+}
+
 /**
  * Creates a new <code>\ref c_typedef</code>.
  *
@@ -872,7 +983,8 @@ static int c_typedef_cmp( void const *i_data, void const *j_data ) {
 PJL_WARN_UNUSED_RESULT
 static c_typedef_t* c_typedef_new( c_ast_t const *ast ) {
   assert( ast != NULL );
-  c_typedef_t *const tdef = MALLOC( c_typedef_t, 1 );
+  c_typedef_t *const tdef =
+    MALLOC_SUB( ALLOC_SUB_TYPEDEF, c_typedef_t, 1 );
   tdef->ast = ast;
   //
   // User-defined types are available in the current language and later;
@@ -881,60 +993,471 @@ static c_typedef_t* c_typedef_new( c_ast_t const *ast ) {
   //
   tdef->lang_ids = user_defined ? opt_lang_and_newer() : predefined_lang_ids;
   tdef->user_defined = user_defined;
+  tdef->cache = NULL;
+  tdef->equiv_hash =
+    td_equiv_walk( &(td_equiv_walk_t){ .visitor = NULL }, ast );
   return tdef;
 }
 
 /**
- * Parses an array of predefined `typedef` declarations.
+ * Parses a pool of predefined `typedef` declarations.
+ *
+ * @note A pool is a single character array rather than an array of pointers
+ * so it requires no relocations at load time and so stays in read-only memory
+ * shared among processes.
  *
- * @param types A pointer to the start of an array of pointers to `typedef`
- * strings.  The last element must be NULL.
+ * @param types A pointer to the start of consecutive null-terminated `typedef`
+ * strings.  The last string must be followed by an empty string.
  */
-static void c_typedef_parse_predefined( char const *const *types ) {
+static void c_typedef_parse_predefined( char const *types ) {
   extern bool parse_string( char const*, size_t );
   assert( types != NULL );
-  do {
-    if ( unlikely( !parse_string( *types, strlen( *types ) ) ) )
-      INTERNAL_ERR( "failed to parse predefined type \"%s\"\n", *types );
-  } while ( *++types != NULL );
+  for ( size_t len; (len = strlen( types )) > 0; types += len + 1 ) {
+    if ( unlikely( !parse_string( types, len ) ) )
+      INTERNAL_ERR( "failed to parse predefined type \"%s\"\n", types );
+  } // for
+}
+
+/**
+ * Gets the current settings that a rendering of a `typedef` depends on.
+ *
+ * @param key The key to initialize.
+ */
+static void c_tdef_render_key_init( c_tdef_render_key_t *key ) {
+  assert( key != NULL );
+  *key = (c_tdef_render_key_t){
+    .gen = atomic_load( &render_gen ),
+    .lang = opt_lang,
+    .graph = opt_graph,
+    .alt_tokens = opt_alt_tokens,
+    .east_const = opt_east_const,
+    .semicolon = opt_semicolon
+  };
+}
+
+/**
+ * Checks whether two rendering keys are equal.
+ *
+ * @param i_key The first key.
+ * @param j_key The second key.
+ * @return Returns `true` only if they're equal.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool c_tdef_render_key_eq( c_tdef_render_key_t const *i_key,
+                                  c_tdef_render_key_t const *j_key ) {
+  assert( i_key != NULL );
+  assert( j_key != NULL );
+  return  i_key->gen        == j_key->gen &&
+          i_key->lang       == j_key->lang &&
+          i_key->graph      == j_key->graph &&
+          i_key->alt_tokens == j_key->alt_tokens &&
+          i_key->east_const == j_key->east_const &&
+          i_key->semicolon  == j_key->semicolon;
 }
 
 /**
- * Red-black tree visitor function that forwards to the
+ * Set visitor function that forwards to the
  * <code>\ref c_typedef_visitor_t</code> function.
  *
- * @param node_data A pointer to the node's data.
+ * @param node_data A pointer to the element's data.
  * @param aux_data Optional data passed to to the visitor.
- * @return Returning `true` will cause traversal to stop and the current node
- * to be returned to the caller of rb_tree_visit().
+ * @return Returning `true` will cause traversal to stop and the current
+ * element to be returned to the caller of rcu_set_visit().
  */
 PJL_WARN_UNUSED_RESULT
-static bool rb_visitor( void *node_data, void *aux_data ) {
+static bool set_visitor( void *node_data, void *aux_data ) {
   assert( node_data != NULL );
   assert( aux_data != NULL );
 
   c_typedef_t const *const tdef = node_data;
-  td_rb_visitor_data_t const *const vd = aux_data;
+  td_set_visitor_data_t const *const vd = aux_data;
 
   return (*vd->visitor)( tdef, vd->data );
 }
 
+/**
+ * Calls the caller's sync function, if any.
+ *
+ * @param sd A pointer to the <code>\ref td_sync_data</code>.
+ * @param sync The kind of change.
+ * @param old_tdef The previous <code>\ref c_typedef</code>, if any.
+ * @param new_tdef The new <code>\ref c_typedef</code>, if any.
+ */
+static void sync_report( td_sync_data_t const *sd, c_tdef_sync_t sync,
+                         c_typedef_t const *old_tdef,
+                         c_typedef_t const *new_tdef ) {
+  if ( sd->sync_fn != NULL )
+    (*sd->sync_fn)( sync, old_tdef, new_tdef, sd->data );
+}
+
+/**
+ * Sync visitor function for `typedef`s in the previous set: removes those
+ * not in the new set and replaces those whose types changed.
+ *
+ * @param node_data A pointer to the element's data.
+ * @param aux_data A pointer to the <code>\ref td_sync_data</code>.
+ * @return Always returns `false`.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool sync_from_visitor( void *node_data, void *aux_data ) {
+  assert( node_data != NULL );
+  assert( aux_data != NULL );
+
+  c_typedef_t const *const old_tdef = node_data;
+  td_sync_data_t const *const sd = aux_data;
+  c_typedef_t *const new_tdef = rcu_set_find( &sd->to->typedefs, old_tdef );
+  c_typedef_t const *const cur_tdef =
+    rcu_set_find( &cur_scope->typedefs, old_tdef );
+
+  //
+  // The current overlay's typedef came from old_tdef only if it shares its
+  // AST; otherwise, e.g., old_tdef conflicted with an interactively defined
+  // typedef, so the current one isn't ours to remove or replace.
+  //
+  if ( cur_tdef == NULL || cur_tdef->ast != old_tdef->ast ) {
+    if ( cur_tdef != NULL && new_tdef != NULL &&
+         !c_ast_equiv( cur_tdef->ast, new_tdef->ast ) ) {
+      sync_report( sd, C_TDEF_SYNC_CONFLICT, cur_tdef, new_tdef );
+    }
+    return false;
+  }
+
+  if ( new_tdef == NULL ) {
+    td_index_remove( &cur_scope->index, cur_tdef );
+    rcu_set_remove( &cur_scope->typedefs, cur_tdef, &c_typedef_free );
+    sync_report( sd, C_TDEF_SYNC_REMOVED, old_tdef, NULL );
+  }
+  else if ( c_ast_equiv( old_tdef->ast, new_tdef->ast ) ) {
+    new_tdef->ast = old_tdef->ast;      // keep the existing AST
+  }
+  else {
+    c_typedef_t *const dup_tdef = c_typedef_dup( new_tdef );
+    td_index_remove( &cur_scope->index, cur_tdef );
+    td_index_add( &cur_scope->index, dup_tdef );
+    rcu_set_replace( &cur_scope->typedefs, dup_tdef, &c_typedef_free );
+    sync_report( sd, C_TDEF_SYNC_CHANGED, old_tdef, new_tdef );
+  }
+  return false;
+}
+
+/**
+ * Sync visitor function for `typedef`s in the new set: adds those not in the
+ * previous set unless one having the same name is already in the current
+ * overlay.
+ *
+ * @param node_data A pointer to the element's data.
+ * @param aux_data A pointer to the <code>\ref td_sync_data</code>.
+ * @return Always returns `false`.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool sync_to_visitor( void *node_data, void *aux_data ) {
+  assert( node_data != NULL );
+  assert( aux_data != NULL );
+
+  c_typedef_t const *const new_tdef = node_data;
+  td_sync_data_t const *const sd = aux_data;
+
+  if ( sd->from != NULL &&
+       rcu_set_find( &sd->from->typedefs, new_tdef ) != NULL ) {
+    return false;                       // handled by sync_from_visitor()
+  }
+
+  c_typedef_t const *const cur_tdef =
+    rcu_set_find( &cur_scope->typedefs, new_tdef );
+  if ( cur_tdef == NULL ) {
+    c_typedef_t *const dup_tdef = c_typedef_dup( new_tdef );
+    PJL_IGNORE_RV( rcu_set_insert( &cur_scope->typedefs, dup_tdef ) );
+    td_index_add( &cur_scope->index, dup_tdef );
+    sync_report( sd, C_TDEF_SYNC_ADDED, NULL, new_tdef );
+  }
+  else if ( !c_ast_equiv( cur_tdef->ast, new_tdef->ast ) ) {
+    sync_report( sd, C_TDEF_SYNC_CONFLICT, cur_tdef, new_tdef );
+  }
+  return false;
+}
+
+/**
+ * Initial value of a structural hash.
+ */
+#define TD_HASH_INIT              UINT64_C(0xCBF29CE484222325)
+
+/**
+ * Mixes \a value into \a hash (FNV-1a on whole values).
+ *
+ * @param hash The hash so far.
+ * @param value The value to mix in.
+ * @return Returns the new hash.
+ */
+PJL_WARN_UNUSED_RESULT
+static inline uint64_t td_hash_mix( uint64_t hash, uint64_t value ) {
+  return (hash ^ value) * UINT64_C(0x100000001B3);
+}
+
+/**
+ * Walks \a ast computing its structural hash such that ASTs that are
+ * equivalent per c_ast_equiv() have equal hashes; and, if there's a visitor,
+ * calls it for every subtree having an equivalent `typedef`.
+ *
+ * @param w The <code>\ref td_equiv_walk</code> to use.
+ * @param ast The AST to walk.  May be NULL.
+ * @return Returns said hash.
+ *
+ * @sa c_ast_equiv()
+ */
+PJL_WARN_UNUSED_RESULT
+static uint64_t td_equiv_walk( td_equiv_walk_t *w, c_ast_t const *ast ) {
+  assert( w != NULL );
+
+  if ( ast == NULL )
+    return TD_HASH_INIT;
+
+  if ( ast->kind_id == K_TYPEDEF ) {
+    //
+    // Since c_ast_equiv() looks through a typedef to the type it's for, so
+    // must the hash.  The type's hash was already computed when it was added
+    // unless this refers to a type that's since been replaced.
+    //
+    c_ast_t const *const for_ast = ast->as.tdef.for_ast;
+    c_typedef_t const *const tdef = c_typedef_find_sname( &for_ast->sname );
+    if ( tdef != NULL && tdef->ast == for_ast )
+      return tdef->equiv_hash;
+    return td_equiv_walk( &(td_equiv_walk_t){ .visitor = NULL }, for_ast );
+  }
+
+  if ( w->visitor != NULL ) {
+    if ( w->n_path == w->path_cap ) {
+      w->path_cap = w->path_cap == 0 ? 16 : w->path_cap * 2;
+      REALLOC( w->path, c_ast_t const*, w->path_cap );
+    }
+    w->path[ w->n_path++ ] = ast;
+  }
+
+  uint64_t hash = td_hash_mix( TD_HASH_INIT, ast->kind_id );
+
+  hash = td_hash_mix( hash, ast->align.kind );
+  switch ( ast->align.kind ) {
+    case C_ALIGNAS_NONE:
+      break;
+    case C_ALIGNAS_EXPR:
+      hash = td_hash_mix( hash, ast->align.as.expr );
+      break;
+    case C_ALIGNAS_TYPE:
+      hash = td_hash_mix( hash,
+        td_equiv_walk(
+          &(td_equiv_walk_t){ .visitor = NULL }, ast->align.as.type_ast
+        )
+      );
+      break;
+  } // switch
+
+  hash = td_hash_mix( hash, ast->type.base_tid );
+  //
+  // Qualifiers aren't hashed since those on a typedef AST apply to the type
+  // it's for: c_ast_equiv() sorts that out.
+  //
+  hash = td_hash_mix( hash, ast->type.store_tid & ~TS_MASK_QUALIFIER );
+  hash = td_hash_mix( hash, ast->type.attr_tid );
+
+  switch ( ast->kind_id ) {
+    case K_ARRAY:
+      hash = td_hash_mix( hash, (uint64_t)ast->as.array.size );
+      hash = td_hash_mix( hash, ast->as.array.store_tid );
+      break;
+
+    case K_BUILTIN:
+      hash = td_hash_mix( hash, ast->as.builtin.bit_width );
+      break;
+
+    case K_OPERATOR:
+      hash = td_hash_mix( hash, ast->as.oper.oper_id );
+      PJL_FALLTHROUGH;
+    case K_FUNCTION:
+      hash = td_hash_mix( hash, ast->as.func.flags );
+      PJL_FALLTHROUGH;
+    case K_APPLE_BLOCK:
+    case K_CONSTRUCTOR:
+    case K_USER_DEF_LITERAL:
+      FOREACH_PARAM( param, ast )
+        hash = td_hash_mix( hash, td_equiv_walk( w, c_param_ast( param ) ) );
+      break;
+
+    case K_ENUM_CLASS_STRUCT_UNION:
+    case K_POINTER_TO_MEMBER:
+      FOREACH_SCOPE( scope, &ast->as.ecsu.ecsu_sname, NULL ) {
+        for ( char const *s = c_scope_data( scope )->name; *s != '\0'; ++s )
+          hash = td_hash_mix( hash, (unsigned char)*s );
+        hash = td_hash_mix( hash, ':' );
+      } // for
+      break;
+
+    case K_DESTRUCTOR:
+    case K_NAME:                        // names don't matter
+    case K_NONE:
+    case K_PLACEHOLDER:
+    case K_POINTER:
+    case K_REFERENCE:
+    case K_RVALUE_REFERENCE:
+    case K_TYPEDEF:                     // handled above
+    case K_USER_DEF_CONVERSION:
+    case K_VARIADIC:
+      break;
+  } // switch
+
+  if ( c_ast_is_parent( ast ) )
+    hash = td_hash_mix( hash, td_equiv_walk( w, ast->as.parent.of_ast ) );
+
+  if ( w->visitor != NULL ) {
+    for ( c_typedef_scope_t const *scope = cur_scope; scope != NULL;
+          scope = scope->base ) {
+      td_index_t const *const index = &scope->index;
+      if ( index->n_buckets == 0 )
+        continue;
+      for ( td_index_entry_t const *entry =
+              index->buckets[ hash & (index->n_buckets - 1) ];
+            entry != NULL; entry = entry->next ) {
+        if ( entry->tdef->equiv_hash == hash &&
+             c_ast_equiv( ast, entry->tdef->ast ) ) {
+          (*w->visitor)( w->path, w->n_path, entry->tdef, w->data );
+        }
+      } // for
+    } // for
+    --w->n_path;
+  }
+
+  return hash;
+}
+
+/**
+ * Adds \a tdef to \a index.
+ *
+ * @param index The <code>\ref td_index</code> to add to.
+ * @param tdef The <code>\ref c_typedef</code> to add.
+ */
+static void td_index_add( td_index_t *index, c_typedef_t const *tdef ) {
+  assert( index != NULL );
+  assert( tdef != NULL );
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &index->mutex ) );
+
+  if ( index->n_entries >= index->n_buckets ) {
+    //
+    // Keep the load factor at most 1 by doubling the number of buckets and
+    // rehashing.
+    //
+    size_t const n_buckets = index->n_buckets == 0 ? 64 : index->n_buckets * 2;
+    td_index_entry_t **const buckets = MALLOC( td_index_entry_t*, n_buckets );
+    for ( size_t i = 0; i < n_buckets; ++i )
+      buckets[i] = NULL;
+    for ( size_t i = 0; i < index->n_buckets; ++i ) {
+      for ( td_index_entry_t *entry = index->buckets[i], *next;
+            entry != NULL; entry = next ) {
+        next = entry->next;
+        td_index_entry_t **const bucket =
+          &buckets[ entry->tdef->equiv_hash & (n_buckets - 1) ];
+        entry->next = *bucket;
+        *bucket = entry;
+      } // for
+    } // for
+    FREE( index->buckets );
+    index->buckets = buckets;
+    index->n_buckets = n_buckets;
+  }
+
+  td_index_entry_t **const bucket =
+    &index->buckets[ tdef->equiv_hash & (index->n_buckets - 1) ];
+  td_index_entry_t *const entry = MALLOC( td_index_entry_t, 1 );
+  entry->tdef = tdef;
+  entry->next = *bucket;
+  *bucket = entry;
+  ++index->n_entries;
+
+  PJL_IGNORE_RV( pthread_mutex_unlock( &index->mutex ) );
+}
+
+/**
+ * Frees all memory used by \a index.
+ *
+ * @param index The <code>\ref td_index</code> to free.
+ */
+static void td_index_free( td_index_t *index ) {
+  assert( index != NULL );
+  for ( size_t i = 0; i < index->n_buckets; ++i ) {
+    for ( td_index_entry_t *entry = index->buckets[i], *next;
+          entry != NULL; entry = next ) {
+      next = entry->next;
+      FREE( entry );
+    } // for
+  } // for
+  FREE( index->buckets );
+  PJL_IGNORE_RV( pthread_mutex_destroy( &index->mutex ) );
+}
+
+/**
+ * Initializes \a index.
+ *
+ * @param index The <code>\ref td_index</code> to initialize.
+ */
+static void td_index_init( td_index_t *index ) {
+  assert( index != NULL );
+  index->buckets = NULL;
+  index->n_buckets = index->n_entries = 0;
+  IF_EXIT( (errno = pthread_mutex_init( &index->mutex, NULL )) != 0,
+           EX_OSERR );
+}
+
+/**
+ * Removes the entry, if any, for \a tdef from \a index.
+ *
+ * @param index The <code>\ref td_index</code> to remove from.
+ * @param tdef The <code>\ref c_typedef</code> to remove.
+ */
+static void td_index_remove( td_index_t *index, c_typedef_t const *tdef ) {
+  assert( index != NULL );
+  assert( tdef != NULL );
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &index->mutex ) );
+  if ( index->n_buckets > 0 ) {
+    for ( td_index_entry_t **pentry =
+            &index->buckets[ tdef->equiv_hash & (index->n_buckets - 1) ];
+          *pentry != NULL; pentry = &(*pentry)->next ) {
+      td_index_entry_t *const entry = *pentry;
+      if ( entry->tdef == tdef ) {
+        *pentry = entry->next;
+        FREE( entry );
+        --index->n_entries;
+        break;
+      }
+    } // for
+  }
+  PJL_IGNORE_RV( pthread_mutex_unlock( &index->mutex ) );
+}
+
 ////////// extern functions ///////////////////////////////////////////////////
 
 c_typedef_t const* c_typedef_add( c_ast_t const *ast ) {
   assert( ast != NULL );
   assert( !c_ast_empty_name( ast ) );
 
-  c_typedef_t *const new_tdef = c_typedef_new( ast );
-  rb_node_t const *const old_rb = rb_tree_insert( &typedefs, new_tdef );
-  if ( old_rb == NULL )                 // type's name doesn't exist
-    return NULL;
-
-  //
-  // A typedef having the same name already exists, so we don't need the new
-  // c_typedef.
-  //
-  FREE( new_tdef );
+  assert( cur_scope->base != NULL || !user_defined );
+
+  c_typedef_t const *old_tdef = cur_scope->base == NULL ? NULL :
+    rcu_set_find( &cur_scope->base->typedefs, &C_TYPEDEF_LIT( ast->sname ) );
+  if ( old_tdef == NULL ) {
+    allocator_t *const prev_a = alloc_use( &alloc_libc );
+    c_typedef_t *const new_tdef = c_typedef_new( ast );
+    old_tdef = rcu_set_insert( &cur_scope->typedefs, new_tdef );
+    if ( old_tdef == NULL ) {           // type's name doesn't exist
+      td_index_add( &cur_scope->index, new_tdef );
+      alloc_use( prev_a );
+      return NULL;
+    }
+    //
+    // A typedef having the same name already exists, so we don't need the
+    // new c_typedef.
+    //
+    FREE_SUB( ALLOC_SUB_TYPEDEF, new_tdef, sizeof( c_typedef_t ) );
+    alloc_use( prev_a );
+  }
 
   //
   // In C, multiple typedef declarations having the same name are allowed only
@@ -944,18 +1467,31 @@ c_typedef_t const* c_typedef_add( c_ast_t const *ast ) {
   //      typedef int T;              // OK
   //      typedef double T;           // error: types aren't equivalent
   //
-  c_typedef_t const *const old_tdef = old_rb->data;
   static c_typedef_t const EMPTY_TYPEDEF;
   return c_ast_equiv( ast, old_tdef->ast ) ? &EMPTY_TYPEDEF : old_tdef;
 }
 
+void c_typedef_batch_begin( void ) {
+  rcu_set_batch_begin( &cur_scope->typedefs );
+}
+
+void c_typedef_batch_end( void ) {
+  rcu_set_batch_end( &cur_scope->typedefs );
+}
+
 void c_typedef_cleanup( void ) {
-  // There is no c_typedef_free() function because c_typedef_add() adds only
+  // c_typedef_free() doesn't free ASTs because c_typedef_add() adds only
   // c_typedef_t nodes pointing to pre-existing AST nodes.  The AST nodes are
   // freed independently in parser_cleanup().  Hence, this function frees only
-  // the red-black tree, its nodes, and the c_typedef_t data each node points
-  // to, but not the AST nodes the c_typedef_t data points to.
-  rb_tree_free( &typedefs, &free );
+  // the set and the c_typedef_t data each element points to (including cached
+  // renderings), but not the AST nodes the c_typedef_t data points to.
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  rcu_set_free( &global_scope.typedefs, &c_typedef_free );
+  rcu_set_free( &base_scope.typedefs, &c_typedef_free );
+  td_index_free( &global_scope.index );
+  td_index_free( &base_scope.index );
+  alloc_use( prev_a );
+  cur_scope = &global_scope;
 }
 
 c_typedef_t const* c_typedef_find_name( char const *name ) {
@@ -971,13 +1507,25 @@ c_typedef_t const* c_typedef_find_name( char const *name ) {
 
 c_typedef_t const* c_typedef_find_sname( c_sname_t const *sname ) {
   assert( sname != NULL );
-  rb_node_t const *const found_rb =
-    rb_tree_find( &typedefs, &C_TYPEDEF_LIT( *sname ) );
-  return found_rb != NULL ? found_rb->data : NULL;
+  c_typedef_t const *const tdef_lit = &C_TYPEDEF_LIT( *sname );
+  c_typedef_t const *const tdef = rcu_set_find( &cur_scope->typedefs, tdef_lit );
+  if ( tdef != NULL || cur_scope->base == NULL )
+    return tdef;
+  return rcu_set_find( &cur_scope->base->typedefs, tdef_lit );
 }
 
 void c_typedef_init( void ) {
-  rb_tree_init( &typedefs, &c_typedef_cmp );
+  // The sets use the allocator that's current when they're initialized.
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  rcu_set_init( &base_scope.typedefs, &c_typedef_cmp );
+  rcu_set_init( &global_scope.typedefs, &c_typedef_cmp );
+  td_index_init( &base_scope.index );
+  td_index_init( &global_scope.index );
+  alloc_use( prev_a );
+
+  // Predefined types go into the base layer.
+  cur_scope = &base_scope;
+  c_typedef_batch_begin();
 
   if ( opt_typedefs ) {
 #ifdef ENABLE_CDECL_DEBUG
@@ -1025,11 +1573,13 @@ void c_typedef_init( void ) {
     predefined_lang_ids = LANG_MIN(C_99);
     c_typedef_parse_predefined( PREDEFINED_STD_C_99 );
 
+#if LANG_IS_LIVE(C_99)
     // However, Embedded C extensions are available only in C99.
     opt_lang = LANG_C_99;
     predefined_lang_ids = LANG_C_99;
     c_typedef_parse_predefined( PREDEFINED_EMBEDDED_C );
     opt_lang = LANG_C_NEW;
+#endif /* LANG_IS_LIVE(C_99) */
 
     // Must be defined after C99.
     predefined_lang_ids = LANG_MIN(C_89);
@@ -1069,14 +1619,146 @@ void c_typedef_init( void ) {
 #endif /* YYDEBUG */
   }
 
+  c_typedef_batch_end();
+  cur_scope = &global_scope;
   user_defined = true;
 }
 
+void c_typedef_render( c_typedef_t const *tdef, c_tdef_render_t render,
+                       c_typedef_render_fn_t render_fn, void *data,
+                       FILE *out ) {
+  assert( tdef != NULL );
+  assert( render < C_TDEF_RENDER_N );
+  assert( render_fn != NULL );
+  assert( out != NULL );
+
+#ifdef HAVE_OPEN_MEMSTREAM
+  //
+  // The cache isn't part of the typedef's value, so it's OK to modify it, but
+  // typedefs are shared between threads, so it's accessed only while holding
+  // render_mutex.  A missing or stale rendering is rendered privately outside
+  // of it, then published.
+  //
+  // The key is taken from the same settings render_fn uses and is compared
+  // upon every lookup, so a rendering is never reused with other settings.
+  //
+  c_tdef_render_key_t key;
+  c_tdef_render_key_init( &key );
+  c_typedef_t *const cache_tdef = CONST_CAST( c_typedef_t*, tdef );
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &render_mutex ) );
+  c_tdef_rendered_t const *const r = cache_tdef->cache == NULL ? NULL :
+    &cache_tdef->cache->rendered[ render ];
+  if ( r != NULL && r->text != NULL && c_tdef_render_key_eq( &r->key, &key ) ) {
+    bool const ok = fwrite( r->text, 1, r->len, out ) == r->len;
+    PJL_IGNORE_RV( pthread_mutex_unlock( &render_mutex ) );
+    IF_EXIT( !ok, EX_IOERR );
+    return;
+  }
+  PJL_IGNORE_RV( pthread_mutex_unlock( &render_mutex ) );
+
+  c_tdef_rendered_t new_r = { .key = key };
+  FILE *const mem = open_memstream( &new_r.text, &new_r.len );
+  if ( unlikely( mem == NULL ) )
+    goto direct;
+  (*render_fn)( tdef, data, mem );
+  if ( unlikely( fclose( mem ) != 0 ) ) {
+    free( new_r.text );
+    goto direct;
+  }
+  if ( new_r.len > 0 )
+    IF_EXIT( fwrite( new_r.text, 1, new_r.len, out ) < new_r.len, EX_IOERR );
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &render_mutex ) );
+  if ( cache_tdef->cache == NULL ) {
+    // The cache lives as long as the typedef: see c_typedef_free().
+    allocator_t *const prev_a = alloc_use( &alloc_libc );
+    cache_tdef->cache = MALLOC( c_tdef_cache_t, 1 );
+    alloc_use( prev_a );
+    MEM_ZERO( cache_tdef->cache );
+  }
+  c_tdef_rendered_t const old_r = cache_tdef->cache->rendered[ render ];
+  cache_tdef->cache->rendered[ render ] = new_r;
+  PJL_IGNORE_RV( pthread_mutex_unlock( &render_mutex ) );
+  free( old_r.text );                   // allocated by open_memstream()
+  return;
+
+direct:
+#endif /* HAVE_OPEN_MEMSTREAM */
+  (*render_fn)( tdef, data, out );
+}
+
+void c_typedef_render_clear( void ) {
+  atomic_fetch_add( &render_gen, 1 );
+}
+
+c_typedef_scope_t* c_typedef_scope_new( void ) {
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  c_typedef_scope_t *const scope = MALLOC( c_typedef_scope_t, 1 );
+  rcu_set_init( &scope->typedefs, &c_typedef_cmp );
+  td_index_init( &scope->index );
+  alloc_use( prev_a );
+  scope->base = &base_scope;
+  return scope;
+}
+
+void c_typedef_scope_free( c_typedef_scope_t *scope ) {
+  if ( scope == NULL )
+    return;
+  assert( scope != &base_scope );
+  assert( scope != &global_scope );
+  if ( cur_scope == scope )
+    cur_scope = &global_scope;
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  rcu_set_free( &scope->typedefs, &c_typedef_free );
+  td_index_free( &scope->index );
+  FREE( scope );
+  alloc_use( prev_a );
+}
+
+void c_typedef_scope_sync( c_typedef_scope_t const *from,
+                           c_typedef_scope_t *to, c_typedef_sync_fn_t sync_fn,
+                           void *data ) {
+  assert( to != NULL );
+  assert( to != cur_scope );
+  assert( from != cur_scope );
+
+  td_sync_data_t sd = { from, to, sync_fn, data };
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  c_typedef_batch_begin();
+  if ( from != NULL )
+    PJL_IGNORE_RV( rcu_set_visit( &from->typedefs, &sync_from_visitor, &sd ) );
+  PJL_IGNORE_RV( rcu_set_visit( &to->typedefs, &sync_to_visitor, &sd ) );
+  c_typedef_batch_end();
+  alloc_use( prev_a );
+}
+
+c_typedef_scope_t* c_typedef_scope_use( c_typedef_scope_t *scope ) {
+  c_typedef_scope_t *const prev_scope = cur_scope;
+  cur_scope = scope != NULL ? scope : &global_scope;
+  return prev_scope;
+}
+
 c_typedef_t const* c_typedef_visit( c_typedef_visitor_t visitor, void *data ) {
   assert( visitor != NULL );
-  td_rb_visitor_data_t vd = { visitor, data };
-  rb_node_t const *const rb = rb_tree_visit( &typedefs, &rb_visitor, &vd );
-  return rb != NULL ? rb->data : NULL;
+  td_set_visitor_data_t vd = { visitor, data };
+  if ( cur_scope->base == NULL )
+    return rcu_set_visit( &cur_scope->typedefs, &set_visitor, &vd );
+  return rcu_set_visit_merge(
+    &cur_scope->base->typedefs, &cur_scope->typedefs, &set_visitor, &vd
+  );
+}
+
+void c_typedef_visit_equiv( c_ast_t const *ast,
+                            c_typedef_equiv_visitor_t visitor, void *data ) {
+  assert( ast != NULL );
+  assert( visitor != NULL );
+
+  td_equiv_walk_t w = { .visitor = visitor, .data = data };
+  PJL_IGNORE_RV( pthread_mutex_lock( &cur_scope->index.mutex ) );
+  PJL_IGNORE_RV( td_equiv_walk( &w, ast ) );
+  PJL_IGNORE_RV( pthread_mutex_unlock( &cur_scope->index.mutex ) );
+  FREE( w.path );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -35,6 +35,9 @@
 
 // standard
 #include <stdbool.h>
+#include <stddef.h>                     /* for size_t */
+#include <stdint.h>
+#include <stdio.h>
 
 /// @endcond
 
@@ -44,9 +47,33 @@
  * @defgroup c-typedef-group C/C++ Typedef Declarations
  * Types and functions for adding and looking up C/C++ `typedef` or `using`
  * declarations.
+ *
+ * `typedef`s are layered: an immutable base layer holds the predefined types
+ * and is shared by every overlay layer; each overlay holds the user-defined
+ * types of one context (e.g., one client).  Adds go into and lookups consult
+ * the calling thread's current overlay (see c_typedef_scope_use()) and then
+ * the base.  By default, the current overlay is a global one.
  * @{
  */
 
+/**
+ * Ways a <code>\ref c_typedef</code> can be rendered that are cached.
+ *
+ * @sa c_typedef_render()
+ */
+enum c_tdef_render {
+  C_TDEF_RENDER_ENGLISH,                ///< As `define` in pseudo-English.
+  C_TDEF_RENDER_TYPEDEF,                ///< As a `typedef` declaration.
+  C_TDEF_RENDER_USING,                  ///< As a `using` declaration.
+  C_TDEF_RENDER_N                       ///< Number of renderings.
+};
+typedef enum c_tdef_render c_tdef_render_t;
+
+/**
+ * Cached renderings of a <code>\ref c_typedef</code>.
+ */
+typedef struct c_tdef_cache c_tdef_cache_t;
+
 /**
  * C/C++ `typedef` or `using` information.
  */
@@ -54,8 +81,36 @@ struct c_typedef {
   c_ast_t const  *ast;                  ///< AST representing the type.
   c_lang_id_t     lang_ids;             ///< Language(s) available in.
   bool            user_defined;         ///< Is the type user-defined?
+  c_tdef_cache_t *cache;                ///< Cached renderings, if any.
+  uint64_t        equiv_hash;           ///< Structural hash of \ref ast.
 };
 
+/**
+ * The signature for a function passed to c_typedef_visit_equiv().
+ *
+ * @param path The ASTs from the root AST (`path[0]`) down to and including
+ * the one that's equivalent to \a tdef (`path[n-1]`).  Function-like
+ * parameters are children of their function.
+ * @param n The number of ASTs in \a path.
+ * @param tdef The <code>\ref c_typedef</code> that `path[n-1]` is equivalent
+ * to.
+ * @param data Optional data passed to the visitor.
+ */
+typedef void (*c_typedef_equiv_visitor_t)( c_ast_t const *const path[],
+                                           size_t n, c_typedef_t const *tdef,
+                                           void *data );
+
+/**
+ * The signature for a function passed to c_typedef_render() that renders a
+ * <code>\ref c_typedef</code>.
+ *
+ * @param tdef The <code>\ref c_typedef</code> to render.
+ * @param data Optional data passed to c_typedef_render().
+ * @param out The `FILE` to render to.
+ */
+typedef void (*c_typedef_render_fn_t)( c_typedef_t const *tdef, void *data,
+                                       FILE *out );
+
 /**
  * The signature for a function passed to c_typedef_visit().
  *
@@ -66,13 +121,53 @@ struct c_typedef {
  */
 typedef bool (*c_typedef_visitor_t)( c_typedef_t const *tdef, void *data );
 
+/**
+ * Kinds of changes made by c_typedef_scope_sync().
+ */
+enum c_tdef_sync {
+  C_TDEF_SYNC_ADDED,                    ///< A `typedef` was added.
+  C_TDEF_SYNC_CHANGED,                  ///< A `typedef`'s type was replaced.
+  C_TDEF_SYNC_CONFLICT,                 ///< Not changed: conflicts.
+  C_TDEF_SYNC_REMOVED                   ///< A `typedef` was removed.
+};
+typedef enum c_tdef_sync c_tdef_sync_t;
+
+/**
+ * The signature for a function passed to c_typedef_scope_sync() that's called
+ * for each change.
+ *
+ * @param sync The kind of change.
+ * @param old_tdef The previous <code>\ref c_typedef</code> or NULL if \a
+ * new_tdef was added.  For #C_TDEF_SYNC_CONFLICT, it's the existing
+ * `typedef` that was kept.
+ * @param new_tdef The new <code>\ref c_typedef</code> or NULL if \a old_tdef
+ * was removed.
+ * @param data Optional data passed to the function.
+ */
+typedef void (*c_typedef_sync_fn_t)( c_tdef_sync_t sync,
+                                     c_typedef_t const *old_tdef,
+                                     c_typedef_t const *new_tdef, void *data );
+
+/**
+ * An overlay layer of user-defined `typedef`s.
+ *
+ * @sa c_typedef_scope_new()
+ */
+typedef struct c_typedef_scope c_typedef_scope_t;
+
 ////////// extern functions ///////////////////////////////////////////////////
 
 /**
- * Adds a new `typedef` or `using` to the global set.
+ * Adds a new `typedef` or `using` to the current overlay.  If a type having
+ * the same name already exists in either the overlay or the base, the usual
+ * redefinition rules apply.
+ *
+ * @note This may be called concurrently with itself and all the lookup
+ * functions; concurrent adds are serialized.
  *
  * @param type_ast The AST of the type.  Ownership is taken only if the
- * function returns NULL.
+ * function returns NULL.  Since it outlives the current request, it must have
+ * been allocated from <code>\ref alloc_libc</code>.
  * @return If:
  * + \a type_ast was added, returns NULL; or:
  * + \a type_ast->name already exists and the types are equivalent, returns a
@@ -83,6 +178,21 @@ typedef bool (*c_typedef_visitor_t)( c_typedef_t const *tdef, void *data );
 PJL_WARN_UNUSED_RESULT
 c_typedef_t const* c_typedef_add( c_ast_t const *type_ast );
 
+/**
+ * Begins a batch of adds to the calling thread's current overlay, e.g., while
+ * reading a file of `typedef`s.  Until c_typedef_batch_end() is called, adds
+ * are O(log n) and visible only to the calling thread.
+ *
+ * @sa c_typedef_batch_end()
+ */
+void c_typedef_batch_begin( void );
+
+/**
+ * Ends a batch begun by c_typedef_batch_begin() and makes all its `typedef`s
+ * visible to other threads at once.
+ */
+void c_typedef_batch_end( void );
+
 /**
  * Cleans up <code>\ref c_typedef</code> data.
  *
@@ -103,7 +213,10 @@ PJL_WARN_UNUSED_RESULT
 c_typedef_t const* c_typedef_find_name( char const *name );
 
 /**
- * Gets the <code>\ref c_typedef</code> for \a sname.
+ * Gets the <code>\ref c_typedef</code> for \a sname, looking first in the
+ * current overlay, then in the base.
+ *
+ * @note This never blocks, even while another thread is adding a `typedef`.
  *
  * @param sname The scoped name to find.
  * @return Returns a pointer to the corresponding <code>\ref c_typedef</code>
@@ -122,7 +235,95 @@ c_typedef_t const* c_typedef_find_sname( c_sname_t const *sname );
 void c_typedef_init( void );
 
 /**
- * Does an in-order traversal of all <code>\ref c_typedef</code>s.
+ * Renders \a tdef via \a render_fn the first time; subsequently, until any
+ * setting that affects rendering changes, prints the same output again
+ * without rendering.  This works since a `typedef`'s AST never changes once
+ * it's been added.
+ *
+ * @note This may be called concurrently for the same \a tdef.
+ *
+ * @param tdef The <code>\ref c_typedef</code> to render.  It must have been
+ * added (by c_typedef_add() or the like) since its rendering is cached in it.
+ * @param render Which rendering \a render_fn does.
+ * @param render_fn The function to render \a tdef with.
+ * @param data Optional data passed to \a render_fn.  It must not affect the
+ * output other than how \a render implies.
+ * @param out The `FILE` to print to.
+ *
+ * @sa c_typedef_render_clear()
+ */
+void c_typedef_render( c_typedef_t const *tdef, c_tdef_render_t render,
+                       c_typedef_render_fn_t render_fn, void *data,
+                       FILE *out );
+
+/**
+ * Invalidates all cached renderings of all <code>\ref c_typedef</code>s.
+ * This must be called whenever any setting that affects rendering changes
+ * other than those checked by c_typedef_render() itself (`opt_alt_tokens`,
+ * `opt_east_const`, `opt_graph`, `opt_lang`, and `opt_semicolon`).
+ */
+void c_typedef_render_clear( void );
+
+/**
+ * Frees an overlay created by c_typedef_scope_new() including all the
+ * `typedef`s in it (but not their ASTs).  If \a scope is the calling thread's
+ * current overlay, the global overlay becomes current.
+ *
+ * @param scope The overlay to free.  If NULL, does nothing.
+ */
+void c_typedef_scope_free( c_typedef_scope_t *scope );
+
+/**
+ * Creates a new, empty overlay atop the shared base of predefined types.
+ * This is O(1).
+ *
+ * @return Returns said overlay.  The caller is responsible for freeing it via
+ * c_typedef_scope_free().
+ *
+ * @sa c_typedef_scope_use()
+ */
+PJL_WARN_UNUSED_RESULT
+c_typedef_scope_t* c_typedef_scope_new( void );
+
+/**
+ * Applies the differences between two sets of `typedef`s (e.g., those from
+ * two readings of a configuration file) to the current overlay:
+ *
+ *  + Those only in \a from are removed.
+ *  + Those only in \a to are added.
+ *  + Those in both whose types differ are replaced.
+ *  + Those in both whose types are equivalent are left alone and the ones in
+ *    \a to are made to refer to the existing ASTs.
+ *
+ * A `typedef` in the current overlay that didn't come from \a from, e.g., one
+ * defined interactively, is never removed or replaced.  If one in \a to has
+ * the same name but a different type, it's reported as a conflict instead.
+ *
+ * Other threads see all the changes at once.
+ *
+ * @param from The overlay containing the previous set of `typedef`s or NULL
+ * for none.
+ * @param to The overlay containing the new set of `typedef`s.
+ * @param sync_fn A pointer to a function called for each change or NULL.
+ * @param data Optional data passed to \a sync_fn.
+ */
+void c_typedef_scope_sync( c_typedef_scope_t const *from,
+                           c_typedef_scope_t *to, c_typedef_sync_fn_t sync_fn,
+                           void *data );
+
+/**
+ * Sets the calling thread's current overlay.
+ *
+ * @param scope The overlay to use or NULL for the global overlay.
+ * @return Returns the previously current overlay.
+ */
+PJL_NOWARN_UNUSED_RESULT
+c_typedef_scope_t* c_typedef_scope_use( c_typedef_scope_t *scope );
+
+/**
+ * Does an in-order traversal of all <code>\ref c_typedef</code>s in both the
+ * current overlay and the base.  This never blocks; `typedef`s added during
+ * traversal are not visited.
  *
  * @param visitor The visitor to use.
  * @param data Optional data passed to \a visitor.
@@ -132,6 +333,25 @@ void c_typedef_init( void );
 PJL_NOWARN_UNUSED_RESULT
 c_typedef_t const* c_typedef_visit( c_typedef_visitor_t visitor, void *data );
 
+/**
+ * Visits every subtree of \a ast that's equivalent (per c_ast_equiv()) to a
+ * `typedef` in either the current overlay or the base.
+ *
+ * @remarks Every `typedef` is indexed by a structural hash of its AST when
+ * it's added such that equivalent ASTs have equal hashes.  The hashes of all
+ * subtrees of \a ast are computed bottom-up in a single pass, so only
+ * `typedef`s having the same hash as a subtree are compared to it.
+ *
+ * @param ast The AST to visit.  Subtrees include \a ast itself and
+ * function-like parameters, but not the types that `typedef`s in \a ast are
+ * for.
+ * @param visitor The visitor to call for each subtree and `typedef` it's
+ * equivalent to.  Subtrees are visited in post-order.
+ * @param data Optional data passed to \a visitor.
+ */
+void c_typedef_visit_equiv( c_ast_t const *ast,
+                            c_typedef_equiv_visitor_t visitor, void *data );
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /** @} */
@@ -30,11 +30,20 @@
 #include "c_ast.h"
 #include "c_lang.h"
 #include "c_typedef.h"
+#include "checkpoint.h"
 #include "color.h"
+#include "coprocess.h"
+#include "gibberish.h"
+#include "isolate.h"
 #include "lexer.h"
 #include "literals.h"
 #include "options.h"
+#include "phase_prof.h"
+#include "prefetch.h"
+#include "print.h"
 #include "prompt.h"
+#include "render_plan.h"
+#include "rule_prof.h"
 #include "strbuf.h"
 #include "util.h"
 
@@ -44,7 +53,9 @@
 #include <ctype.h>
 #include <errno.h>
 #include <limits.h>                     /* for PATH_MAX */
+#include <signal.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -76,6 +87,7 @@ c_command_t const CDECL_COMMANDS[] = {
   { L_NAMESPACE,              C_COMMAND_FIRST_ARG,  LANG_CPP_ANY      },
   { L_QUIT,                   C_COMMAND_LANG_ONLY,  LANG_ANY          },
   { L_REINTERPRET /* cast */, C_COMMAND_FIRST_ARG,  LANG_CPP_ANY      },
+  { L_RELOAD,                 C_COMMAND_LANG_ONLY,  LANG_ANY          },
   { L_SET_COMMAND,            C_COMMAND_FIRST_ARG,  LANG_ANY          },
   { L_SHOW,                   C_COMMAND_FIRST_ARG,  LANG_ANY          },
   { L_STATIC /* cast */,      C_COMMAND_FIRST_ARG,  LANG_CPP_ANY      },
@@ -92,8 +104,22 @@ c_mode_t    c_mode;
 char const *command_line;               ///< Command from command line, if any.
 size_t      command_line_len;           ///< Length of `command_line`.
 size_t      inserted_len;               ///< Length of inserted string.
+char const *input_path = "-";           ///< Path of current input.
+unsigned    input_lineno;               ///< Line number within `input_path`.
 bool        is_input_a_tty;             ///< Is our input from a TTY?
 char const *me;
+volatile sig_atomic_t
+            c_reload_pending;
+
+// local variable definitions
+static unsigned           checkpoint_lines; ///< Lines since last checkpoint.
+static char const        *conf_path;    ///< Configuration file path, if any.
+
+/// User-defined types from the last reading of the configuration file.
+static c_typedef_scope_t *conf_scope;
+
+/// Position to resume at from \ref opt_resume_file, if any.
+static checkpoint_pos_t   resume_pos;
 
 // extern functions
 PJL_WARN_UNUSED_RESULT
@@ -109,19 +135,38 @@ extern void yyrestart( FILE* );
 // local functions
 static void cdecl_cleanup( void );
 
+static void checkpoint_maybe( off_t );
+
 PJL_WARN_UNUSED_RESULT
 static bool parse_argv( int, char const *const[] );
 
 PJL_WARN_UNUSED_RESULT
 static bool parse_command_line( char const*, int, char const *const[] );
 
+PJL_WARN_UNUSED_RESULT
+static bool parse_file_buf( char* );
+
 PJL_WARN_UNUSED_RESULT
 static bool parse_files( int, char const *const[] );
 
+PJL_WARN_UNUSED_RESULT
+static bool parse_path( char const* );
+
 PJL_WARN_UNUSED_RESULT
 static bool parse_stdin( void );
 
-static void read_conf_file( void );
+static void resume_skip( FILE* );
+
+static void init_conf_file( void );
+
+PJL_WARN_UNUSED_RESULT
+static bool read_conf_file( c_typedef_sync_fn_t );
+
+static void reload_conf_file( void );
+
+#ifdef SIGHUP
+static void sighup_handler( int );
+#endif /* SIGHUP */
 
 PJL_WARN_UNUSED_RESULT
 static bool starts_with_token( char const*, char const*, size_t );
@@ -136,17 +181,38 @@ static bool starts_with_token( char const*, char const*, size_t );
  * @return Returns 0 on success, non-zero on failure.
  */
 int main( int argc, char const *argv[] ) {
+#ifdef ENABLE_RULE_PROFILE
+  rule_prof_init();
+#endif /* ENABLE_RULE_PROFILE */
   atexit( cdecl_cleanup );
   options_init( &argc, &argv );
   c_typedef_init();
   lexer_reset( true );                  // resets line number
 
   if ( !opt_no_conf )
-    read_conf_file();
+    init_conf_file();
   opt_conf_file = NULL;                 // don't print in errors any more
   c_initialized = true;
+  phase_prof_init();                    // profile only commands, not startup
+
+  if ( opt_resume_file != NULL )
+    checkpoint_read( opt_resume_file, &resume_pos );
+
+#ifdef SIGHUP
+  struct sigaction sa;
+  IF_EXIT( sigaction( SIGHUP, NULL, &sa ) != 0, EX_OSERR );
+  if ( sa.sa_handler != SIG_IGN ) {     // e.g., by nohup(1): leave it alone
+    MEM_ZERO( &sa );
+    sa.sa_handler = &sighup_handler;
+    sa.sa_flags = SA_RESTART;           // don't make reads return EINTR
+    PJL_IGNORE_RV( sigemptyset( &sa.sa_mask ) );
+    IF_EXIT( sigaction( SIGHUP, &sa, NULL ) != 0, EX_OSERR );
+  }
+#endif /* SIGHUP */
 
   bool const ok = parse_argv( argc, argv );
+  if ( opt_check_only )
+    print_check_summary();
   exit( ok ? EX_OK : EX_DATAERR );
 }
 
@@ -271,14 +337,54 @@ static bool is_command( char const *s, c_command_kind_t command_kind ) {
 
 /**
  * Cleans up cdecl data.
+ *
+ * @note If \ref opt_memory_report is set, first prints the memory still live
+ * at exit.  Does nothing in a job started by isolate_files() since the parent
+ * does both.
  */
 static void cdecl_cleanup( void ) {
+  if ( isolate_in_job() )
+    return;
+  if ( opt_memory_report )
+    alloc_sub_print( stderr );
   free_now();
+  FREE( resume_pos.path );
+  c_typedef_scope_free( conf_scope );
   c_typedef_cleanup();
+  render_plan_cleanup();
   parser_cleanup();                     // must go before c_ast_cleanup()
   c_ast_cleanup();
 }
 
+/**
+ * Writes a checkpoint if \ref opt_checkpoint_every lines have been parsed
+ * since the last one.
+ *
+ * @note Checkpoints are written only for input: not for the configuration
+ * file.
+ *
+ * @param offset The byte offset within \ref input_path just after the line
+ * just parsed.
+ */
+static void checkpoint_maybe( off_t offset ) {
+  if ( opt_checkpoint_file == NULL || !c_initialized ||
+       ++checkpoint_lines < opt_checkpoint_every ) {
+    return;
+  }
+  checkpoint_lines = 0;
+  //
+  // Output up to this point must be out before the checkpoint is: if we're
+  // killed and later resumed, output continues from just after it.
+  //
+  FFLUSH( fout );
+  checkpoint_write(
+    opt_checkpoint_file,
+    &(checkpoint_pos_t){
+      CONST_CAST( char*, input_path ), offset, input_lineno
+    }
+  );
+}
+
 /**
  * Parses \a argv to figure out what kind of arguments were given.
  *
@@ -288,8 +394,12 @@ static void cdecl_cleanup( void ) {
  */
 PJL_WARN_UNUSED_RESULT
 static bool parse_argv( int argc, char const *const argv[] ) {
-  if ( argc == 0 )                      // cdecl
-    return parse_stdin();
+  if ( opt_coprocess )                  // cdecl --coprocess
+    return coprocess( fin, fout, &parse_file_buf );
+  if ( argc == 0 ) {                    // cdecl
+    return resume_pos.path != NULL ?
+      parse_files( 1, (char const*[]){ "-" } ) : parse_stdin();
+  }
   if ( is_command( me, C_COMMAND_PROG_NAME ) )
     return parse_command_line( me, argc, argv );
 
@@ -327,11 +437,34 @@ static bool parse_command_line( char const *command, int argc,
   for ( int i = 0; i < argc; ++i )
     strbuf_sepc_cats( &sbuf, ' ', &space, argv[i] );
 
+  input_path = "<command-line>";
+  input_lineno = 1;
   bool const ok = parse_string( sbuf.str, sbuf.len );
   strbuf_free( &sbuf );
   return ok;
 }
 
+/**
+ * Skips \a file to the position to resume at.
+ *
+ * @param file The FILE to skip.  If it's not seekable, e.g., a pipe, its
+ * bytes are read and discarded instead.
+ */
+static void resume_skip( FILE *file ) {
+  assert( file != NULL );
+  if ( fseeko( file, resume_pos.offset, SEEK_SET ) == 0 )
+    return;
+  for ( off_t n = resume_pos.offset; n > 0; --n ) {
+    if ( unlikely( getc( file ) == EOF ) ) {
+      FERROR( file );
+      PMESSAGE_EXIT( EX_DATAERR,
+        "%s: input shorter than checkpoint offset %jd\n",
+        input_path, (intmax_t)resume_pos.offset
+      );
+    }
+  } // for
+}
+
 /**
  * Parses cdecl commands from a file.
  *
@@ -346,11 +479,58 @@ static bool parse_file( FILE *file ) {
   // We don't just call yyrestart( file ) and yyparse() directly because
   // parse_string() also inserts "explain " for opt_explain.
 
-  for ( char buf[ 1024 ]; fgets( buf, sizeof buf, file ) != NULL; ) {
-    if ( !parse_string( buf, strlen( buf ) ) )
+  off_t offset = 0;
+  input_lineno = 0;
+  if ( resume_pos.path != NULL && c_initialized ) {
+    resume_skip( file );
+    offset = resume_pos.offset;
+    input_lineno = resume_pos.lineno;
+    FREE( resume_pos.path );
+    resume_pos.path = NULL;
+  }
+
+  char *line = NULL;
+  size_t line_cap = 0;
+  for ( ssize_t len; (len = getline( &line, &line_cap, file )) != -1; ) {
+    ++input_lineno;
+    if ( !parse_string( line, STATIC_CAST( size_t, len ) ) )
       ok = false;
+    checkpoint_maybe( offset += len );
   } // for
   FERROR( file );
+  free( line );                         // allocated by getline()
+
+  return ok;
+}
+
+/**
+ * Parses cdecl commands from a buffer containing the contents of a file.
+ *
+ * @param buf The null-terminated buffer to parse.  It's modified temporarily
+ * to null-terminate each line in turn.
+ * @return Returns `true` only upon success.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool parse_file_buf( char *buf ) {
+  assert( buf != NULL );
+  bool ok = true;
+
+  char const *const start = buf;
+  input_lineno = 0;
+  while ( *buf != '\0' ) {
+    ++input_lineno;
+    char *const nl = strchr( buf, '\n' );
+    char *const next = nl != NULL ? nl + 1 : buf + strlen( buf );
+    char const saved = *next;
+    *next = '\0';
+    if ( !parse_string( buf, STATIC_CAST( size_t, next - buf ) ) )
+      ok = false;
+    *next = saved;
+    buf = next;
+    checkpoint_maybe( buf - start );
+    if ( coprocess_quitting() )         // ignore lines following "quit"
+      break;
+  } // while
 
   return ok;
 }
@@ -358,6 +538,12 @@ static bool parse_file( FILE *file ) {
 /**
  * Parses cdecl commands from one or more files.
  *
+ * @note If opt_isolate_files is set, each file is parsed separately via
+ * isolate_files().  Otherwise, if there is more than one file, the ones after
+ * the current one are read ahead (up to opt_read_ahead of them) while the
+ * current one is parsed.  If resuming from a checkpoint, parsing starts at the
+ * file and position it records.
+ *
  * @param num_files The length of \a files.
  * @param files An array of file names.
  * @return Returns `true` only upon success.
@@ -366,23 +552,73 @@ PJL_WARN_UNUSED_RESULT
 static bool parse_files( int num_files, char const *const files[] ) {
   bool ok = true;
 
-  for ( int i = 0; i < num_files && ok; ++i ) {
-    if ( strcmp( files[i], "-" ) == 0 ) {
-      ok = parse_stdin();
-    }
-    else {
-      FILE *const file = fopen( files[i], "r" );
-      if ( unlikely( file == NULL ) )
-        PMESSAGE_EXIT( EX_NOINPUT, "%s: %s\n", files[i], STRERROR() );
-      if ( !parse_file( file ) )
-        ok = false;
-      PJL_IGNORE_RV( fclose( file ) );
+  if ( opt_isolate_files ) {
+    return isolate_files(
+      files, STATIC_CAST( size_t, num_files ), &parse_path
+    );
+  }
+
+  if ( resume_pos.path != NULL ) {
+    int i = 0;
+    while ( i < num_files && strcmp( files[i], resume_pos.path ) != 0 )
+      ++i;
+    if ( i == num_files ) {
+      PMESSAGE_EXIT( EX_USAGE,
+        "\"%s\": checkpoint is for \"%s\", which isn't among the input\n",
+        opt_resume_file, resume_pos.path
+      );
     }
-  } // for
+    ok = parse_path( files[i] );        // resumes at the checkpoint position
+    files += i + 1;
+    num_files -= i + 1;
+  }
+
+  if ( num_files > 1 && opt_read_ahead > 0 ) {
+    prefetch_t *const pf =
+      prefetch_new( files, STATIC_CAST( size_t, num_files ), opt_read_ahead );
+    for ( prefetch_file_t const *f; ok && (f = prefetch_next( pf )) != NULL; ) {
+      if ( strcmp( f->path, "-" ) == 0 ) {
+        ok = parse_stdin();
+      }
+      else {
+        if ( unlikely( f->err != 0 ) ) {
+          errno = f->err;
+          PMESSAGE_EXIT( EX_NOINPUT, "%s: %s\n", f->path, STRERROR() );
+        }
+        input_path = f->path;
+        ok = parse_file_buf( f->buf );
+      }
+    } // for
+    prefetch_free( pf );
+    return ok;
+  }
+
+  for ( int i = 0; i < num_files && ok; ++i )
+    ok = parse_path( files[i] );
 
   return ok;
 }
 
+/**
+ * Parses cdecl commands from a file given by its path.
+ *
+ * @param path The path of the file to parse; `-` means standard input.
+ * @return Returns `true` only upon success.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool parse_path( char const *path ) {
+  if ( strcmp( path, "-" ) == 0 )
+    return parse_stdin();
+
+  FILE *const file = fopen( path, "r" );
+  if ( unlikely( file == NULL ) )
+    PMESSAGE_EXIT( EX_NOINPUT, "%s: %s\n", path, STRERROR() );
+  input_path = path;
+  bool const ok = parse_file( file );
+  PJL_IGNORE_RV( fclose( file ) );
+  return ok;
+}
+
 /**
  * Parses cdecl commands from standard input.
  *
@@ -391,6 +627,7 @@ static bool parse_files( int num_files, char const *const files[] ) {
 PJL_WARN_UNUSED_RESULT
 static bool parse_stdin( void ) {
   bool ok = true;
+  input_path = "-";
   is_input_a_tty = isatty( fileno( fin ) );
 
   if ( is_input_a_tty || opt_interactive ) {
@@ -399,7 +636,8 @@ static bool parse_stdin( void ) {
     ok = true;
     for (;;) {
       strbuf_t sbuf;
-      if ( !cdecl_read_line( &sbuf, cdecl_prompt[0], cdecl_prompt[1] ) )
+      if ( !cdecl_read_line(
+              &sbuf, cdecl_prompt_get( false ), cdecl_prompt_get( true ) ) )
         break;
       ok = parse_string( sbuf.str, sbuf.len );
       strbuf_free( &sbuf );
@@ -425,6 +663,7 @@ static bool parse_stdin( void ) {
 PJL_WARN_UNUSED_RESULT
 bool parse_string( char const *s, size_t s_len ) {
   assert( s != NULL );
+  PHASE_PROF( PHASE_PROF_PARSE );
 
   // The code in print.c relies on command_line being set, so set it.
   command_line = s;
@@ -458,13 +697,16 @@ bool parse_string( char const *s, size_t s_len ) {
     inserted_len = 0;
   }
 
+  if ( unlikely( c_reload_pending ) && c_initialized )
+    reload_conf_file();
+
   return ok;
 }
 
 /**
- * Reads the configuration file, if any.
+ * Determines the configuration file path, if any, and reads it.
  */
-static void read_conf_file( void ) {
+static void init_conf_file( void ) {
   bool const is_explicit_conf_file = (opt_conf_file != NULL);
 
   if ( !is_explicit_conf_file ) {       // no explicit conf file: use default
@@ -477,12 +719,62 @@ static void read_conf_file( void ) {
     opt_conf_file = conf_path_buf;
   }
 
-  FILE *const fconf = fopen( opt_conf_file, "r" );
-  if ( fconf == NULL ) {
-    if ( is_explicit_conf_file )
-      PMESSAGE_EXIT( EX_NOINPUT, "%s: %s\n", opt_conf_file, STRERROR() );
-    return;
-  }
+  conf_path = opt_conf_file;
+  if ( !read_conf_file( NULL ) && is_explicit_conf_file )
+    PMESSAGE_EXIT( EX_NOINPUT, "%s: %s\n", conf_path, STRERROR() );
+}
+
+/**
+ * Prints a change to a `typedef` made by reloading the configuration file.
+ *
+ * @param sync The kind of change.
+ * @param old_tdef The previous `typedef` or NULL if \a new_tdef was added.
+ * @param new_tdef The new `typedef` or NULL if \a old_tdef was removed.
+ * @param data Not used.
+ */
+static void print_typedef_change( c_tdef_sync_t sync,
+                                  c_typedef_t const *old_tdef,
+                                  c_typedef_t const *new_tdef, void *data ) {
+  (void)data;
+  switch ( sync ) {
+    case C_TDEF_SYNC_ADDED:
+      FPUTS( "added: ", fout );
+      c_typedef_gibberish( new_tdef, C_GIB_TYPEDEF, fout );
+      break;
+    case C_TDEF_SYNC_CHANGED:
+      FPUTS( "changed: ", fout );
+      c_typedef_gibberish( new_tdef, C_GIB_TYPEDEF, fout );
+      break;
+    case C_TDEF_SYNC_CONFLICT:
+      EPRINTF( "%s: %s: \"%s\": \"typedef\" redefinition with different type;"
+        " kept: ", me, conf_path, c_ast_full_name( new_tdef->ast )
+      );
+      c_typedef_gibberish( old_tdef, C_GIB_TYPEDEF, stderr );
+      break;
+    case C_TDEF_SYNC_REMOVED:
+      FPUTS( "removed: ", fout );
+      c_typedef_gibberish( old_tdef, C_GIB_TYPEDEF, fout );
+      break;
+  } // switch
+}
+
+/**
+ * Reads the configuration file into a new set of user-defined types, then
+ * applies only the differences from the previous set, if any.
+ *
+ * @param sync_fn A pointer to a function called for each change or NULL.
+ * @return Returns `false` only if the configuration file could not be opened.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool read_conf_file( c_typedef_sync_fn_t sync_fn ) {
+  assert( conf_path != NULL );
+
+  FILE *const fconf = fopen( conf_path, "r" );
+  if ( fconf == NULL )
+    return false;
+
+  c_typedef_scope_t *const new_conf_scope = c_typedef_scope_new();
+  c_typedef_scope_t *const orig_scope = c_typedef_scope_use( new_conf_scope );
 
   //
   // Before reading the configuration file, temporarily set the language to the
@@ -491,11 +783,62 @@ static void read_conf_file( void ) {
   //
   c_lang_id_t const orig_lang = opt_lang;
   opt_lang = LANG_CPP_NEW;
+  c_typedef_batch_begin();
   PJL_IGNORE_RV( parse_file( fconf ) );
+  c_typedef_batch_end();
   opt_lang = orig_lang;
 
   PJL_IGNORE_RV( fclose( fconf ) );
+
+  c_typedef_scope_use( orig_scope );
+  c_typedef_scope_sync( conf_scope, new_conf_scope, sync_fn, NULL );
+  c_typedef_scope_free( conf_scope );
+  conf_scope = new_conf_scope;
+  return true;
+}
+
+/**
+ * Re-reads the configuration file and prints what `typedef`s changed.
+ */
+static void reload_conf_file( void ) {
+  c_reload_pending = false;
+  if ( conf_path == NULL ) {
+    EPRINTF( "%s: no configuration file\n", me );
+    return;
+  }
+
+  //
+  // Reading the configuration file clobbers the input position, but we're
+  // (usually) in the middle of reading input, so save and restore it.
+  //
+  char const *const orig_input_path = input_path;
+  unsigned const orig_input_lineno = input_lineno;
+
+  opt_conf_file = conf_path;            // print in errors again
+  c_initialized = false;
+  lexer_reset( true );                  // resets line number
+
+  if ( !read_conf_file( &print_typedef_change ) )
+    EPRINTF( "%s: %s: %s\n", me, conf_path, STRERROR() );
+
+  opt_conf_file = NULL;
+  c_initialized = true;
+  input_path = orig_input_path;
+  input_lineno = orig_input_lineno;
+}
+
+#ifdef SIGHUP
+/**
+ * Handles `SIGHUP` by requesting that the configuration file be reloaded
+ * after the current (or next) command.
+ *
+ * @param sig_num Not used.
+ */
+static void sighup_handler( int sig_num ) {
+  (void)sig_num;
+  c_reload_pending = true;
 }
+#endif /* SIGHUP */
 
 /**
  * Checks whether \a s starts with a token.  If so, the character following the
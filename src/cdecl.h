@@ -33,6 +33,7 @@
 /// @cond DOXYGEN_IGNORE
 
 // standard
+#include <signal.h>                     /* for sig_atomic_t */
 #include <stdbool.h>
 
 /// @endcond
@@ -54,6 +55,8 @@
 extern c_command_t const
                     CDECL_COMMANDS[];   ///< cdecl commands.
 extern c_mode_t     c_mode;             ///< Converting English or gibberish?
+extern volatile sig_atomic_t
+                    c_reload_pending;   ///< Reload configuration file?
 extern bool         c_initialized;      ///< Initialized (read conf. file)?
 extern char const  *me;                 ///< Program name.
 
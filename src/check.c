@@ -35,6 +35,7 @@
 #include "did_you_mean.h"
 #include "literals.h"
 #include "options.h"
+#include "phase_prof.h"
 #include "print.h"
 
 /// @cond DOXYGEN_IGNORE
@@ -2176,6 +2177,7 @@ static c_lang_id_t is_reserved_name( char const *name ) {
 
 bool c_ast_check_cast( c_ast_t const *ast ) {
   assert( ast != NULL );
+  PHASE_PROF( PHASE_PROF_CHECK );
   c_ast_t *const nonconst_ast = CONST_CAST( c_ast_t*, ast );
 
   c_ast_t const *const storage_ast = c_ast_find_type_any(
@@ -2211,6 +2213,7 @@ bool c_ast_check_cast( c_ast_t const *ast ) {
 
 bool c_ast_check_declaration( c_ast_t const *ast ) {
   assert( ast != NULL );
+  PHASE_PROF( PHASE_PROF_CHECK );
   if ( !c_ast_check_errors( ast, false ) )
     return false;
   PJL_IGNORE_RV( c_ast_check_visitor( ast, c_ast_visitor_warning, NULL ) );
@@ -0,0 +1,308 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/checkpoint.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions for checkpointing and resuming a run.
+ *
+ * A checkpoint file looks like:
+ *
+ *      cdecl checkpoint 1
+ *      path=big.cdecl
+ *      offset=1048576
+ *      lineno=31337
+ *      set lang=C89
+ *      typedef int T;
+ *      set lang=C++17
+ *      namespace N { typedef T U; }
+ *      set noalt-tokens
+ *      ...
+ *
+ * The first four lines are the header; the rest are ordinary cdecl commands.
+ * User-defined types are written grouped by the oldest language each is
+ * available in preceded by a `set lang` for that language so that, when read
+ * back, each is available in exactly the same languages as before.  The
+ * groups are written oldest language first: a type can depend only on types
+ * available in the language it was defined in, so a type's dependencies are
+ * always in its own group or an earlier one.  The `set` options are written
+ * last so they override the `set lang` commands.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "checkpoint.h"
+#include "c_lang.h"
+#include "c_typedef.h"
+#include "cdecl.h"
+#include "gibberish.h"
+#include "options.h"
+#include "set_options.h"
+#include "strbuf.h"
+#include "util.h"
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdnoreturn.h>
+#include <string.h>
+#include <sysexits.h>
+
+/// @endcond
+
+/// First line of every checkpoint file.
+#define CHECKPOINT_MAGIC          "cdecl checkpoint 1\n"
+
+/**
+ * Information for checkpoint_tdef_visitor().
+ */
+struct checkpoint_tdefs {
+  c_typedef_t const **tdefs;            ///< User-defined types so far.
+  size_t              n_tdefs;          ///< Number of types.
+  size_t              tdefs_cap;        ///< Capacity of \ref tdefs.
+};
+typedef struct checkpoint_tdefs checkpoint_tdefs_t;
+
+// extern variables
+extern char const        *input_path;
+extern unsigned           input_lineno;
+
+// extern functions
+PJL_WARN_UNUSED_RESULT
+extern bool parse_string( char const*, size_t );
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Prints an error message for an invalid checkpoint file and exits.
+ *
+ * @param ckpt_path The path of the checkpoint file.
+ * @param what What's invalid.
+ */
+noreturn
+static void checkpoint_invalid( char const *ckpt_path, char const *what ) {
+  PMESSAGE_EXIT( EX_DATAERR,
+    "\"%s\": invalid checkpoint file: %s\n", ckpt_path, what
+  );
+}
+
+/**
+ * Reads a header line of the form _name_`=`_value_ from a checkpoint file.
+ *
+ * @param file The checkpoint file to read from.
+ * @param ckpt_path The path of the checkpoint file.
+ * @param name The name the line must start with.
+ * @param pline A pointer to the line buffer for **getline**(3).
+ * @param pline_cap A pointer to the capacity of \a *pline.
+ * @return Returns the value with the trailing newline removed.
+ */
+PJL_WARN_UNUSED_RESULT
+static char* checkpoint_read_header( FILE *file, char const *ckpt_path,
+                                     char const *name, char **pline,
+                                     size_t *pline_cap ) {
+  ssize_t const len = getline( pline, pline_cap, file );
+  FERROR( file );
+  size_t const name_len = strlen( name );
+  if ( len <= 0 || (*pline)[ len - 1 ] != '\n' ||
+       strncmp( *pline, name, name_len ) != 0 ||
+       (*pline)[ name_len ] != '=' ) {
+    checkpoint_invalid( ckpt_path, name );
+  }
+  (*pline)[ len - 1 ] = '\0';
+  return *pline + name_len + 1/*=*/;
+}
+
+/**
+ * Parses a header value that must be a non-negative number.
+ *
+ * @param s The null-terminated string to parse.
+ * @param ckpt_path The path of the checkpoint file.
+ * @param name The name of the value.
+ * @return Returns said number.
+ */
+PJL_WARN_UNUSED_RESULT
+static uintmax_t checkpoint_parse_num( char const *s, char const *ckpt_path,
+                                       char const *name ) {
+  char *end;
+  errno = 0;
+  uintmax_t const n = strtoumax( s, &end, 10 );
+  if ( errno != 0 || *s == '\0' || *s == '-' || *end != '\0' )
+    checkpoint_invalid( ckpt_path, name );
+  return n;
+}
+
+/**
+ * Collects user-defined types for checkpoint_write().
+ *
+ * @param tdef The <code>\ref c_typedef</code> to check.
+ * @param data A pointer to a <code>\ref checkpoint_tdefs</code>.
+ * @return Always returns `false`.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool checkpoint_tdef_visitor( c_typedef_t const *tdef, void *data ) {
+  assert( tdef != NULL );
+  assert( data != NULL );
+
+  if ( tdef->user_defined ) {
+    checkpoint_tdefs_t *const ct = data;
+    if ( ct->n_tdefs == ct->tdefs_cap ) {
+      ct->tdefs_cap = ct->tdefs_cap == 0 ? 16 : ct->tdefs_cap * 2;
+      REALLOC( ct->tdefs, c_typedef_t const*, ct->tdefs_cap );
+    }
+    ct->tdefs[ ct->n_tdefs++ ] = tdef;
+  }
+
+  return false;
+}
+
+/**
+ * Prints all user-defined types grouped by the oldest language each is
+ * available in.
+ *
+ * @param out The `FILE` to print to.
+ */
+static void checkpoint_write_tdefs( FILE *out ) {
+  checkpoint_tdefs_t ct = { NULL, 0, 0 };
+  PJL_IGNORE_RV( c_typedef_visit( &checkpoint_tdef_visitor, &ct ) );
+
+  c_lang_id_t oldest_lang_ids = LANG_NONE;
+  for ( size_t i = 0; i < ct.n_tdefs; ++i )
+    oldest_lang_ids |= c_lang_oldest( ct.tdefs[i]->lang_ids );
+
+  //
+  // Print types using only ordinary tokens so they can be read back in any
+  // language.
+  //
+  opt_settings_t settings;
+  options_save( &settings );
+  opt_alt_tokens = false;
+  opt_graph = C_GRAPH_NONE;
+
+  c_typedef_t const **const group = MALLOC( c_typedef_t const*, ct.n_tdefs );
+  while ( oldest_lang_ids != LANG_NONE ) {
+    c_lang_id_t const lang_id = c_lang_oldest( oldest_lang_ids );
+    oldest_lang_ids &= ~lang_id;
+
+    size_t n_group = 0;
+    for ( size_t i = 0; i < ct.n_tdefs; ++i ) {
+      if ( c_lang_oldest( ct.tdefs[i]->lang_ids ) == lang_id )
+        group[ n_group++ ] = ct.tdefs[i];
+    } // for
+
+    opt_lang = lang_id;
+    FPRINTF( out, "set lang=%s\n", c_lang_name( lang_id ) );
+    c_typedef_header_gibberish( group, n_group, out );
+  } // while
+  FREE( group );
+
+  options_restore( &settings );
+  FREE( ct.tdefs );
+}
+
+////////// extern functions ///////////////////////////////////////////////////
+
+void checkpoint_read( char const *ckpt_path, checkpoint_pos_t *pos ) {
+  assert( ckpt_path != NULL );
+  assert( pos != NULL );
+
+  FILE *const file = fopen( ckpt_path, "r" );
+  if ( unlikely( file == NULL ) )
+    PMESSAGE_EXIT( EX_NOINPUT, "\"%s\": %s\n", ckpt_path, STRERROR() );
+
+  char *line = NULL;
+  size_t line_cap = 0;
+
+  ssize_t len = getline( &line, &line_cap, file );
+  FERROR( file );
+  if ( len <= 0 || strcmp( line, CHECKPOINT_MAGIC ) != 0 )
+    checkpoint_invalid( ckpt_path, "not a checkpoint file" );
+
+  pos->path = check_strdup(
+    checkpoint_read_header( file, ckpt_path, "path", &line, &line_cap )
+  );
+  uintmax_t const offset = checkpoint_parse_num(
+    checkpoint_read_header( file, ckpt_path, "offset", &line, &line_cap ),
+    ckpt_path, "offset"
+  );
+  if ( offset > INTMAX_MAX || (off_t)offset < 0 )
+    checkpoint_invalid( ckpt_path, "offset" );
+  pos->offset = (off_t)offset;
+  uintmax_t const lineno = checkpoint_parse_num(
+    checkpoint_read_header( file, ckpt_path, "lineno", &line, &line_cap ),
+    ckpt_path, "lineno"
+  );
+  if ( lineno > UINT_MAX )
+    checkpoint_invalid( ckpt_path, "lineno" );
+  pos->lineno = (unsigned)lineno;
+
+  char const *const orig_input_path = input_path;
+  input_path = ckpt_path;
+  input_lineno = 4;                     // the number of header lines
+  bool ok = true;
+  while ( (len = getline( &line, &line_cap, file )) != -1 ) {
+    ++input_lineno;
+    if ( !parse_string( line, (size_t)len ) )
+      ok = false;
+  } // while
+  FERROR( file );
+  input_path = orig_input_path;
+
+  free( line );                         // allocated by getline()
+  PJL_IGNORE_RV( fclose( file ) );
+
+  if ( !ok )
+    checkpoint_invalid( ckpt_path, "commands have errors" );
+}
+
+void checkpoint_write( char const *ckpt_path, checkpoint_pos_t const *pos ) {
+  assert( ckpt_path != NULL );
+  assert( pos != NULL );
+  assert( pos->path != NULL );
+
+  strbuf_t tmp_sbuf;
+  strbuf_init( &tmp_sbuf );
+  strbuf_catf( &tmp_sbuf, "%s.tmp", ckpt_path );
+
+  FILE *const file = fopen( tmp_sbuf.str, "w" );
+  if ( unlikely( file == NULL ) )
+    PMESSAGE_EXIT( EX_CANTCREAT, "\"%s\": %s\n", tmp_sbuf.str, STRERROR() );
+
+  FPUTS( CHECKPOINT_MAGIC, file );
+  FPRINTF( file,
+    "path=%s\noffset=%jd\nlineno=%u\n",
+    pos->path, (intmax_t)pos->offset, pos->lineno
+  );
+  checkpoint_write_tdefs( file );
+  print_set_commands( file );
+
+  if ( unlikely( fclose( file ) != 0 ) )
+    PMESSAGE_EXIT( EX_IOERR, "\"%s\": %s\n", tmp_sbuf.str, STRERROR() );
+  if ( unlikely( rename( tmp_sbuf.str, ckpt_path ) != 0 ) )
+    PMESSAGE_EXIT( EX_CANTCREAT, "\"%s\": %s\n", ckpt_path, STRERROR() );
+  strbuf_free( &tmp_sbuf );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,93 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/checkpoint.h
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef cdecl_checkpoint_H
+#define cdecl_checkpoint_H
+
+/**
+ * @file
+ * Declares types and functions for checkpointing the state of a run through
+ * input files so a later run can resume from where it left off.
+ *
+ * A checkpoint file records the input file and position just after the last
+ * line parsed followed by cdecl commands that, when parsed, recreate the
+ * state that has accumulated so far: the user-defined types and the values of
+ * all `set` options.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <sys/types.h>                  /* for off_t */
+
+/// @endcond
+
+/**
+ * @defgroup checkpoint-group Checkpoint & Resume
+ * Types and functions for checkpointing and resuming a run.
+ * @{
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A position within input.
+ */
+struct checkpoint_pos {
+  char     *path;                       ///< Input path; `-` means stdin.
+  off_t     offset;                     ///< Byte offset of the next line.
+  unsigned  lineno;                     ///< Number of the last line parsed.
+};
+typedef struct checkpoint_pos checkpoint_pos_t;
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Reads a checkpoint file written by checkpoint_write() and restores the state
+ * it records.
+ *
+ * @param ckpt_path The path of the checkpoint file.  If it can't be read or
+ * isn't a valid checkpoint file, prints an error message and exits.
+ * @param pos A pointer to receive the position to resume at.  The caller is
+ * responsible for freeing \a pos->path.
+ */
+void checkpoint_read( char const *ckpt_path, checkpoint_pos_t *pos );
+
+/**
+ * Writes a checkpoint file for the current state.
+ *
+ * @remarks The file is written under a temporary name and then renamed so a
+ * run killed while writing it leaves the previous checkpoint intact.
+ *
+ * @param ckpt_path The path of the checkpoint file.  If it can't be written,
+ * prints an error message and exits.
+ * @param pos The position to resume at.
+ */
+void checkpoint_write( char const *ckpt_path, checkpoint_pos_t const *pos );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** @} */
+
+#endif /* cdecl_checkpoint_H */
+/* vim:set et sw=2 ts=2: */
@@ -159,6 +159,17 @@ static bool sgr_is_valid( char const *sgr_color ) {
 
 ////////// extern functions ///////////////////////////////////////////////////
 
+void colors_init( void ) {
+  static bool initialized;
+  if ( initialized )
+    return;
+  initialized = true;
+  if ( !(colors_parse( getenv( "CDECL_COLORS" ) )
+      || colors_parse( getenv( "GCC_COLORS" ) )) ) {
+    PJL_IGNORE_RV( colors_parse( COLORS_DEFAULT ) );
+  }
+}
+
 bool colors_parse( char const *capabilities ) {
   bool set_something = false;
 
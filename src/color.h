@@ -91,6 +91,17 @@
 /** When to colorize default. */
 #define COLOR_WHEN_DEFAULT  COLOR_NOT_FILE
 
+/**
+ * Gets the predefined \a COLOR.  The color capabilities are parsed upon first
+ * use so that invocations that never print in color never parse them.
+ *
+ * @param COLOR The predefined color without the `sgr_` prefix.
+ * @return Returns said color or NULL if none.
+ *
+ * @sa colors_init()
+ */
+#define SGR_COLOR(COLOR)              (colors_init(), (sgr_ ## COLOR))
+
 /**
  * Starts printing in the predefined \a COLOR.
  *
@@ -101,7 +112,7 @@
  * @sa #SGR_STRBUF_START_COLOR
  */
 #define SGR_START_COLOR(STREAM,COLOR) BLOCK(  \
-  if ( colorize && (sgr_ ## COLOR) != NULL )  \
+  if ( colorize && SGR_COLOR(COLOR) != NULL ) \
     FPRINTF( (STREAM), SGR_START SGR_EL, (sgr_ ## COLOR) ); )
 
 /**
@@ -125,7 +136,7 @@
  * @sa #SGR_START_COLOR
  */
 #define SGR_STRBUF_START_COLOR(SBUF,COLOR) BLOCK( \
-  if ( colorize && (sgr_ ## COLOR) != NULL )  \
+  if ( colorize && SGR_COLOR(COLOR) != NULL ) \
     strbuf_catf( (SBUF), SGR_START SGR_EL, (sgr_ ## COLOR) ); )
 
 /**
@@ -167,6 +178,15 @@ extern char const  *sgr_warning;        ///< Color of `warning`.
 
 ////////// extern functions ///////////////////////////////////////////////////
 
+/**
+ * Initializes the `sgr_*` colors from either the `CDECL_COLORS` or
+ * `GCC_COLORS` environment variable, or #COLORS_DEFAULT, but only the first
+ * time it's called.
+ *
+ * @note This is called via #SGR_COLOR() and need not be called directly.
+ */
+void colors_init( void );
+
 /**
  * Parses and sets the sequence of gcc color capabilities.
  *
@@ -0,0 +1,344 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/coprocess.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions for running as a coprocess of another program.
+ *
+ * Requests are handled strictly in order.  The output and diagnostics of each
+ * request are collected in a pair of temporary files (reused for every
+ * request) and copied into the response once the request has been parsed.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "coprocess.h"
+#include "cdecl.h"
+#include "options.h"
+#include "strbuf.h"
+#include "util.h"
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+
+/// @endcond
+
+typedef struct coprocess_req coprocess_req_t;
+
+/**
+ * A parsed request header.
+ */
+struct coprocess_req {
+  char const *id;                       ///< Request ID.
+  size_t      id_len;                   ///< Length of \a id.
+  size_t      len;                      ///< Length of command text.
+  char const *options;                  ///< `set` options or NULL if none.
+};
+
+// local variables
+static coprocess_req_t  cp_req;         ///< Request being handled.
+static bool             cp_busy;        ///< Handling \ref cp_req?
+static FILE            *cp_out;         ///< `FILE` to write responses to.
+static bool             cp_quit;        ///< Was `quit` requested?
+static int              cp_stderr_fd;   ///< Duplicate of original `stderr`.
+static FILE            *cp_tmp_err;     ///< Diagnostics of \ref cp_req.
+static FILE            *cp_tmp_out;     ///< Output of \ref cp_req.
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Copies the contents of a temporary file to \a out, then empties it.
+ *
+ * @param tmp The temporary file.  It must have been flushed.
+ * @param len The length of its contents.
+ * @param out The `FILE` to copy to.
+ */
+static void coprocess_copy( FILE *tmp, size_t len, FILE *out ) {
+  int const fd = fileno( tmp );
+  char buf[ 4096 ];
+  for ( size_t off = 0; off < len; ) {
+    size_t const want = len - off < sizeof buf ? len - off : sizeof buf;
+    ssize_t const n = pread( fd, buf, want, (off_t)off );
+    if ( n == -1 && errno == EINTR )
+      continue;
+    IF_EXIT( n <= 0, EX_IOERR );
+    IF_EXIT( fwrite( buf, 1, (size_t)n, out ) < (size_t)n, EX_IOERR );
+    off += (size_t)n;
+  } // for
+  IF_EXIT( ftruncate( fd, 0 ) == -1, EX_IOERR );
+  IF_EXIT( fseek( tmp, 0L, SEEK_SET ) == -1, EX_IOERR );
+}
+
+/**
+ * Gets the length of the contents of a temporary file.
+ *
+ * @param tmp The temporary file.  It's flushed first.
+ * @return Returns said length.
+ */
+PJL_WARN_UNUSED_RESULT
+static size_t coprocess_len( FILE *tmp ) {
+  FFLUSH( tmp );
+  //
+  // Use the file descriptor since, for diagnostics, it's shared with standard
+  // error and so the stream's idea of its offset may be stale.
+  //
+  off_t const len = lseek( fileno( tmp ), 0, SEEK_END );
+  IF_EXIT( len == -1, EX_IOERR );
+  return (size_t)len;
+}
+
+/**
+ * Parses a request header line.
+ *
+ * @param line The null-terminated header line.  Its trailing newline, if
+ * any, is removed.
+ * @param req A pointer to the request to receive the header.  Even if the
+ * header is invalid, coprocess_req::id is set.
+ * @return Returns NULL only if the header is valid; otherwise an error
+ * message.
+ */
+PJL_WARN_UNUSED_RESULT
+static char const* coprocess_parse_header( char *line, coprocess_req_t *req ) {
+  static char const INVALID[] = "invalid request header";
+  MEM_ZERO( req );
+  req->id = "-";
+  req->id_len = 1;
+
+  char *const nl = strchr( line, '\n' );
+  if ( nl != NULL ) {
+    *nl = '\0';
+    if ( nl > line && nl[-1] == '\r' )
+      nl[-1] = '\0';
+  }
+
+  char *s = line + strspn( line, " \t" );
+  size_t const id_len = strcspn( s, " \t" );
+  if ( id_len == 0 )
+    return INVALID;
+  req->id = s;
+  req->id_len = id_len;
+  s += id_len;
+  s += strspn( s, " \t" );
+
+  if ( *s < '0' || *s > '9' )
+    return INVALID;
+  char *end;
+  errno = 0;
+  unsigned long long const len = strtoull( s, &end, 10 );
+  if ( errno != 0 || (*end != '\0' && *end != ' ' && *end != '\t') )
+    return INVALID;
+  //
+  // Check the length before it's used as a size to allocate so that, e.g.,
+  // ULLONG_MAX doesn't wrap around to 0 when 1 is added for the '\0'.
+  //
+  if ( len > COPROCESS_REQ_LEN_MAX )
+    return "request length exceeds maximum";
+  req->len = STATIC_CAST( size_t, len );
+
+  s = end + strspn( end, " \t" );
+  if ( *s != '\0' )
+    req->options = s;
+  return NULL;
+}
+
+/**
+ * Writes a response.
+ *
+ * @param out The `FILE` to write to.
+ * @param req The request being responded to.
+ * @param status The status.
+ * @param tmp_out The temporary file containing the output.
+ * @param tmp_err The temporary file containing the diagnostics.
+ */
+static void coprocess_respond( FILE *out, coprocess_req_t const *req,
+                               int status, FILE *tmp_out, FILE *tmp_err ) {
+  size_t const out_len = coprocess_len( tmp_out );
+  size_t const err_len = coprocess_len( tmp_err );
+
+  FPRINTF( out,
+    "%.*s %d %zu %zu\n", (int)req->id_len, req->id, status, out_len, err_len
+  );
+  coprocess_copy( tmp_out, out_len, out );
+  coprocess_copy( tmp_err, err_len, out );
+  FFLUSH( out );
+}
+
+/**
+ * Writes an error response for the request being handled, if any, so that a
+ * client waiting for it doesn't hang if cdecl exits because of a fatal error
+ * while handling it.  The response's diagnostics include the error message.
+ *
+ * @note This is called via **atexit**(3).  Since it must not call **exit**(3)
+ * itself, errors are ignored.
+ */
+static void coprocess_exit( void ) {
+  if ( !true_clear( &cp_busy ) )
+    return;
+
+  PJL_IGNORE_RV( fflush( stderr ) );
+  PJL_IGNORE_RV( fflush( cp_tmp_out ) );
+  PJL_IGNORE_RV( dup2( cp_stderr_fd, STDERR_FILENO ) );
+
+  int const fds[] = { fileno( cp_tmp_out ), fileno( cp_tmp_err ) };
+  off_t lens[ ARRAY_SIZE( fds ) ];
+  for ( size_t i = 0; i < ARRAY_SIZE( fds ); ++i ) {
+    lens[i] = lseek( fds[i], 0, SEEK_END );
+    if ( lens[i] == -1 )
+      lens[i] = 0;
+  } // for
+
+  PJL_IGNORE_RV( fprintf( cp_out,
+    "%.*s %d %zu %zu\n", (int)cp_req.id_len, cp_req.id, EX_SOFTWARE,
+    (size_t)lens[0], (size_t)lens[1]
+  ) );
+  for ( size_t i = 0; i < ARRAY_SIZE( fds ); ++i ) {
+    char buf[ 4096 ];
+    off_t off = 0;
+    while ( off < lens[i] ) {
+      size_t const left = (size_t)(lens[i] - off);
+      ssize_t const n =
+        pread( fds[i], buf, left < sizeof buf ? left : sizeof buf, off );
+      if ( n <= 0 )
+        break;
+      PJL_IGNORE_RV( fwrite( buf, 1, (size_t)n, cp_out ) );
+      off += n;
+    } // while
+    while ( off++ < lens[i] )           // keep the response's framing intact
+      PJL_IGNORE_RV( putc( ' ', cp_out ) );
+  } // for
+  PJL_IGNORE_RV( fflush( cp_out ) );
+}
+
+////////// extern functions ///////////////////////////////////////////////////
+
+bool coprocess( FILE *in, FILE *out, coprocess_parse_fn_t parse_fn ) {
+  assert( in != NULL );
+  assert( out != NULL );
+  assert( parse_fn != NULL );
+
+  FILE *const tmp_out = tmpfile();
+  IF_EXIT( tmp_out == NULL, EX_CANTCREAT );
+  FILE *const tmp_err = tmpfile();
+  IF_EXIT( tmp_err == NULL, EX_CANTCREAT );
+  int const stderr_fd = dup( STDERR_FILENO );
+  IF_EXIT( stderr_fd == -1, EX_OSERR );
+
+  cp_out = out;
+  cp_stderr_fd = stderr_fd;
+  cp_tmp_err = tmp_err;
+  cp_tmp_out = tmp_out;
+  atexit( &coprocess_exit );
+
+  FILE *const orig_fout = fout;
+  char *line = NULL;
+  size_t line_cap = 0;
+  bool ok = true;
+
+  while ( getline( &line, &line_cap, in ) != -1 ) {
+    coprocess_req_t req;
+    char const *const error = coprocess_parse_header( line, &req );
+    if ( error != NULL ) {
+      FPRINTF( tmp_err, "%s: %s\n", me, error );
+      coprocess_respond( out, &req, EX_USAGE, tmp_out, tmp_err );
+      ok = false;
+      //
+      // Since the header is invalid, where the command text ends and the next
+      // request starts can't be known, so stop.
+      //
+      break;
+    }
+
+    // Set before reading so even a fatal error while reading gets a response.
+    cp_req = req;
+    cp_busy = true;
+
+    char *const text = MALLOC( char, req.len + 1/*\0*/ );
+    size_t const got = fread( text, 1, req.len, in );
+    text[ got ] = '\0';
+    if ( got < req.len ) {
+      cp_busy = false;
+      FERROR( in );
+      FREE( text );
+      FPRINTF( tmp_err, "%s: unexpected end of request\n", me );
+      coprocess_respond( out, &req, EX_USAGE, tmp_out, tmp_err );
+      ok = false;
+      break;
+    }
+
+    fout = tmp_out;
+    FFLUSH( stderr );
+    IF_EXIT( dup2( fileno( tmp_err ), STDERR_FILENO ) == -1, EX_OSERR );
+
+    opt_settings_t settings;
+    options_save( &settings );
+
+    bool req_ok = true;
+    if ( req.options != NULL ) {
+      strbuf_t sbuf;
+      strbuf_init( &sbuf );
+      strbuf_catf( &sbuf, "set %s\n", req.options );
+      req_ok = (*parse_fn)( sbuf.str );
+      strbuf_free( &sbuf );
+    }
+    if ( req_ok )
+      req_ok = (*parse_fn)( text );
+    FREE( text );
+
+    cp_busy = false;
+    options_restore( &settings );
+
+    FFLUSH( stderr );
+    IF_EXIT( dup2( stderr_fd, STDERR_FILENO ) == -1, EX_OSERR );
+    fout = orig_fout;
+
+    coprocess_respond(
+      out, &req, req_ok ? EX_OK : EX_DATAERR, tmp_out, tmp_err
+    );
+    if ( !req_ok )
+      ok = false;
+    if ( cp_quit )
+      break;
+  } // while
+  FERROR( in );
+
+  free( line );                         // allocated by getline()
+  PJL_IGNORE_RV( close( stderr_fd ) );
+  PJL_IGNORE_RV( fclose( tmp_out ) );
+  PJL_IGNORE_RV( fclose( tmp_err ) );
+  return ok;
+}
+
+void coprocess_quit( void ) {
+  cp_quit = true;
+}
+
+bool coprocess_quitting( void ) {
+  return cp_quit;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,134 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/coprocess.h
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef cdecl_coprocess_H
+#define cdecl_coprocess_H
+
+/**
+ * @file
+ * Declares types and functions for running as a coprocess of another program
+ * that sends framed requests and receives framed responses over pipes.
+ *
+ * A request is a header line followed by command text:
+ *
+ *      <id> <length>[ <option>...]\n
+ *      <length bytes of command text>
+ *
+ * where _id_ is any sequence of non-whitespace characters chosen by the
+ * client, _length_ is the number of bytes of command text (at most
+ * #COPROCESS_REQ_LEN_MAX), and the optional _option_s are `set` options that
+ * apply to only that request.  The command text may contain any number of
+ * commands, one per line.
+ *
+ * Each request gets exactly one response, in request order:
+ *
+ *      <id> <status> <out-length> <err-length>\n
+ *      <out-length bytes of output><err-length bytes of diagnostics>
+ *
+ * where _status_ is 0 only upon success.  Hence, a client may write any number
+ * of requests without waiting for responses.
+ *
+ * If a request's header is invalid (including a _length_ that's too large),
+ * where the next request starts can't be known, so the request gets a
+ * response with a status of `EX_USAGE` and no more requests are read.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <stdbool.h>
+#include <stdio.h>
+
+/// @endcond
+
+/**
+ * @defgroup coprocess-group Coprocess Protocol
+ * Types and functions for running as a coprocess.
+ * @{
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Maximum length of a request's command text.
+ */
+#define COPROCESS_REQ_LEN_MAX     (16u * 1024 * 1024)
+
+/**
+ * The signature for a function that parses command text.
+ *
+ * @param buf The null-terminated text to parse.  It may be modified
+ * temporarily.
+ * @return Returns `true` only upon success.
+ */
+typedef bool (*coprocess_parse_fn_t)( char *buf );
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Reads requests and writes responses until end of input, until a request
+ * has an invalid header, or until a request contains a `quit` command.  In
+ * the latter cases, subsequent requests get no responses.
+ *
+ * @remarks While a request is being parsed, \ref fout and standard error are
+ * redirected to temporary files that become the response's output and
+ * diagnostics.  Anything else that changes (e.g., `typedef`s) persists for
+ * subsequent requests.
+ * @par
+ * If cdecl must exit because of a fatal error while parsing a request, the
+ * request still gets a response with a status of `EX_SOFTWARE` whose
+ * diagnostics include the error message.
+ *
+ * @param in The `FILE` to read requests from.
+ * @param out The `FILE` to write responses to.
+ * @param parse_fn The function to parse command text with.
+ * @return Returns `true` only if every request was well-formed and parsed
+ * successfully.
+ */
+PJL_WARN_UNUSED_RESULT
+bool coprocess( FILE *in, FILE *out, coprocess_parse_fn_t parse_fn );
+
+/**
+ * Requests that coprocess() return after responding to the current request
+ * rather than have cdecl exit immediately.
+ *
+ * @sa coprocess_quitting()
+ */
+void coprocess_quit( void );
+
+/**
+ * Gets whether coprocess_quit() has been called.
+ *
+ * @return Returns `true` only if it has.
+ *
+ * @sa coprocess_quit()
+ */
+PJL_WARN_UNUSED_RESULT
+bool coprocess_quitting( void );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** @} */
+
+#endif /* cdecl_coprocess_H */
+/* vim:set et sw=2 ts=2: */
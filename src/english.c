@@ -29,7 +29,11 @@
 #include "c_ast.h"
 #include "c_ast_util.h"
 #include "c_operator.h"
+#include "c_typedef.h"
 #include "literals.h"
+#include "options.h"
+#include "phase_prof.h"
+#include "render_plan.h"
 #include "util.h"
 
 /// @cond DOXYGEN_IGNORE
@@ -40,6 +44,8 @@
 /// @endcond
 
 // local functions
+static void c_ast_english_where( c_ast_t const *const[], size_t, FILE* );
+
 PJL_WARN_UNUSED_RESULT
 static bool c_ast_visitor_english( c_ast_t*, void* );
 
@@ -47,6 +53,22 @@ static void non_type_name( c_type_t const*, FILE* );
 
 ////////// local functions ////////////////////////////////////////////////////
 
+/**
+ * Finds the first AST node having a name, if any, starting at \a ast and
+ * going down.
+ *
+ * @param ast The AST to start from.
+ * @return Returns said node or NULL if none.
+ *
+ * @sa c_ast_find_name()
+ */
+PJL_WARN_UNUSED_RESULT
+static c_ast_t const* c_ast_find_named( c_ast_t const *ast ) {
+  while ( ast != NULL && c_ast_empty_name( ast ) )
+    ast = c_ast_is_parent( ast ) ? ast->as.parent.of_ast : NULL;
+  return ast;
+}
+
 /**
  * Helper function for c_ast_visitor_english() that prints a bit-field width,
  * if any.
@@ -59,8 +81,37 @@ static void c_ast_english_bit_width( c_ast_t const *ast, FILE *eout ) {
   assert( (ast->kind_id & (K_BUILTIN | K_TYPEDEF)) != K_NONE );
   assert( eout != NULL );
 
-  if ( ast->as.builtin.bit_width > 0 )
-    FPRINTF( eout, " %s %u %s", L_WIDTH, ast->as.builtin.bit_width, L_BITS );
+  if ( ast->as.builtin.bit_width > 0 ) {
+    FPRINTF( eout, " %s ", L_WIDTH );
+    render_slot( eout, ast, RENDER_BIT_WIDTH );
+    FPRINTF( eout, " %s", L_BITS );
+  }
+}
+
+/**
+ * Prints \a ast as pseudo-English for render_plan_render().
+ *
+ * @param ast The AST to print.
+ * @param data Not used.
+ * @param eout The `FILE` to emit to.
+ */
+static void c_ast_english_plan( c_ast_t const *ast, void *data, FILE *eout ) {
+  (void)data;
+  c_ast_t *const nonconst_ast = CONST_CAST( c_ast_t*, ast );
+  c_ast_visit( nonconst_ast, C_VISIT_DOWN, c_ast_visitor_english, eout );
+}
+
+/**
+ * Explains \a tdef as a type in pseudo-English for c_typedef_render().
+ *
+ * @param tdef The type to explain.
+ * @param data Not used.
+ * @param eout The `FILE` to print to.
+ */
+static void c_typedef_english_render( c_typedef_t const *tdef, void *data,
+                                      FILE *eout ) {
+  (void)data;
+  c_ast_explain_type( tdef->ast, eout );
 }
 
 /**
@@ -95,9 +146,9 @@ static void c_ast_english_func_params( c_ast_t const *ast, FILE *eout ) {
       //
       // there's no "as <english>" part.
       //
-      c_sname_t const *const sname = c_ast_find_name( param_ast, C_VISIT_DOWN );
-      if ( sname != NULL ) {
-        c_sname_english( sname, eout );
+      c_ast_t const *const name_ast = c_ast_find_named( param_ast );
+      if ( name_ast != NULL ) {
+        render_slot( eout, name_ast, RENDER_ENGLISH_NAME );
         FPRINTF( eout, " %s ", L_AS );
       } else {
         //
@@ -117,6 +168,73 @@ static void c_ast_english_func_params( c_ast_t const *ast, FILE *eout ) {
   FPUTC( ')', eout );
 }
 
+/**
+ * Prints where the last AST in \a path is within the first, e.g.,
+ * `parameter 2 of f`.
+ *
+ * @param path The ASTs from the root AST down to the one to print where it
+ * is.  Function-like parameters are children of their function.
+ * @param n The number of ASTs in \a path.
+ * @param eout The `FILE` to emit to.
+ */
+static void c_ast_english_where( c_ast_t const *const path[], size_t n,
+                                 FILE *eout ) {
+  assert( path != NULL );
+  assert( n > 0 );
+  assert( eout != NULL );
+
+  c_ast_t const *const ast = path[ n - 1 ];
+
+  if ( n == 1 ) {
+    c_sname_t const *const sname = c_ast_find_name( ast, C_VISIT_DOWN );
+    if ( ast->kind_id == K_OPERATOR )
+      FPRINTF( eout, "%s %s", L_OPERATOR,
+        c_oper_token_c( ast->as.oper.oper_id )
+      );
+    else if ( sname != NULL && !c_sname_empty( sname ) )
+      FPUTS( c_sname_full_name( sname ), eout );
+    else
+      FPUTS( "the declaration", eout );
+    return;
+  }
+
+  c_ast_t const *const parent_ast = path[ n - 2 ];
+
+  if ( c_ast_is_parent( parent_ast ) && parent_ast->as.parent.of_ast == ast ) {
+    switch ( parent_ast->kind_id ) {
+      case K_ARRAY:
+        FPUTS( "element type", eout );
+        break;
+      case K_POINTER:
+      case K_POINTER_TO_MEMBER:
+      case K_REFERENCE:
+      case K_RVALUE_REFERENCE:
+        FPUTS( "target type", eout );
+        break;
+      case K_USER_DEF_CONVERSION:
+        FPUTS( "conversion type", eout );
+        break;
+      default:
+        if ( (parent_ast->kind_id & K_ANY_FUNCTION_LIKE) != K_NONE )
+          FPUTS( "return type", eout );
+        else
+          FPUTS( "type", eout );
+    } // switch
+  }
+  else {
+    unsigned param_num = 1;
+    FOREACH_PARAM( param, parent_ast ) {
+      if ( c_param_ast( param ) == ast )
+        break;
+      ++param_num;
+    } // for
+    FPRINTF( eout, "parameter %u", param_num );
+  }
+
+  FPRINTF( eout, " %s ", L_OF );
+  c_ast_english_where( path, n - 1, eout );
+}
+
 /**
  * Visitor function that prints \a ast as pseudo-English.
  *
@@ -139,8 +257,10 @@ static bool c_ast_visitor_english( c_ast_t *ast, void *data ) {
       FPRINTF( eout, "%s ", L_ARRAY );
       if ( ast->as.array.store_tid != TS_NONE )
         FPRINTF( eout, "%s ", c_type_id_name_eng( ast->as.array.store_tid ) );
-      if ( ast->as.array.size >= 0 )
-        FPRINTF( eout, "%d ", ast->as.array.size );
+      if ( ast->as.array.size >= 0 ) {
+        render_slot( eout, ast, RENDER_ARRAY_SIZE );
+        FPUTC( ' ', eout );
+      }
       FPRINTF( eout, "%s ", L_OF );
       break;
 
@@ -185,13 +305,13 @@ static bool c_ast_visitor_english( c_ast_t *ast, void *data ) {
 
     case K_ENUM_CLASS_STRUCT_UNION:
       FPRINTF( eout, "%s ", c_type_name_english( &ast->type ) );
-      c_sname_english( &ast->as.ecsu.ecsu_sname, eout );
+      render_slot( eout, ast, RENDER_ECSU_ENGLISH_NAME );
       if ( ast->as.ecsu.of_ast != NULL )
         FPRINTF( eout, " %s %s ", L_OF, L_TYPE );
       break;
 
     case K_NAME:
-      c_sname_english( &ast->sname, eout );
+      render_slot( eout, ast, RENDER_ENGLISH_NAME );
       break;
 
     case K_NONE:                        // should not occur in completed AST
@@ -213,7 +333,7 @@ static bool c_ast_visitor_english( c_ast_t *ast, void *data ) {
       FPRINTF( eout, "%s %s %s %s ", L_POINTER, L_TO, L_MEMBER, L_OF );
       char const *const name = c_type_id_name_eng( ast->type.base_tid );
       FPRINTF( eout, "%s%s", SP_AFTER( name ) );
-      c_sname_english( &ast->as.ptr_mbr.class_sname, eout );
+      render_slot( eout, ast, RENDER_CLASS_ENGLISH_NAME );
       FPUTC( ' ', eout );
       break;
     }
@@ -221,7 +341,7 @@ static bool c_ast_visitor_english( c_ast_t *ast, void *data ) {
     case K_TYPEDEF:
       if ( !c_type_equal( &ast->type, &C_TYPE_LIT_B( TB_TYPEDEF ) ) )
         FPRINTF( eout, "%s ", c_type_name_english( &ast->type ) );
-      c_sname_english( &ast->as.tdef.for_ast->sname, eout );
+      render_slot( eout, ast, RENDER_TDEF_ENGLISH_NAME );
       c_ast_english_bit_width( ast, eout );
       break;
 
@@ -232,7 +352,7 @@ static bool c_ast_visitor_english( c_ast_t *ast, void *data ) {
         FPRINTF( eout,
           " %s %s ", L_OF, c_type_name_english( c_ast_local_type( ast ) )
         );
-        c_sname_english( &ast->sname, eout );
+        render_slot( eout, ast, RENDER_ENGLISH_NAME );
       }
       FPRINTF( eout, " %s ", L_RETURNING );
       break;
@@ -283,14 +403,48 @@ static void non_type_name( c_type_t const *type, FILE *eout ) {
     FPRINTF( eout, "%s ", c_type_name_english( &temp_type ) );
 }
 
+/**
+ * Prints which `typedef` a subtree of a declaration is equivalent to for
+ * c_typedef_visit_equiv().
+ *
+ * @param path The ASTs from the root AST down to the equivalent one.
+ * @param n The number of ASTs in \a path.
+ * @param tdef The <code>\ref c_typedef</code> the last AST is equivalent to.
+ * @param data The `FILE` to emit to.
+ */
+static void typedef_hint_visitor( c_ast_t const *const path[], size_t n,
+                                  c_typedef_t const *tdef, void *data ) {
+  assert( tdef != NULL );
+  assert( data != NULL );
+  FILE *const eout = data;
+
+  //
+  // Don't bother with predefined types (the user didn't ask for them), types
+  // that aren't any shorter as a typedef, e.g., every "int" being equivalent
+  // to "int32_t", or types that aren't valid in the current language.
+  //
+  if ( !tdef->user_defined ||
+       (path[ n - 1 ]->kind_id & (K_ANY_POINTER | K_ANY_REFERENCE | K_ARRAY |
+                                  K_APPLE_BLOCK | K_FUNCTION)) == K_NONE ||
+       (tdef->lang_ids & opt_lang) == LANG_NONE ) {
+    return;
+  }
+
+  FPUTS( "note: ", eout );
+  c_ast_english_where( path, n, eout );
+  FPRINTF( eout,
+    " is equivalent to %s\n", c_sname_full_name( &tdef->ast->sname )
+  );
+}
+
 ////////// extern functions ///////////////////////////////////////////////////
 
 void c_ast_english( c_ast_t const *ast, FILE *eout ) {
   assert( ast != NULL );
   assert( eout != NULL );
+  PHASE_PROF( PHASE_PROF_RENDER );
 
-  c_ast_t *const nonconst_ast = CONST_CAST( c_ast_t*, ast );
-  c_ast_visit( nonconst_ast, C_VISIT_DOWN, c_ast_visitor_english, eout );
+  render_plan_render( ast, &c_ast_english_plan, NULL, 0, eout );
 
   switch ( ast->align.kind ) {
     case C_ALIGNAS_NONE:
@@ -311,6 +465,7 @@ void c_ast_english( c_ast_t const *ast, FILE *eout ) {
 void c_ast_explain_declaration( c_ast_t const *ast, FILE *eout ) {
   assert( ast != NULL );
   assert( eout != NULL );
+  PHASE_PROF( PHASE_PROF_RENDER );
 
   FPRINTF( eout, "%s ", L_DECLARE );
   if ( ast->kind_id != K_USER_DEF_CONVERSION ) {
@@ -344,11 +499,15 @@ void c_ast_explain_declaration( c_ast_t const *ast, FILE *eout ) {
 
   c_ast_english( ast, eout );
   FPUTC( '\n', eout );
+
+  if ( opt_typedef_hints )
+    c_typedef_visit_equiv( ast, &typedef_hint_visitor, eout );
 }
 
 void c_ast_explain_type( c_ast_t const *ast, FILE *eout ) {
   assert( ast != NULL );
   assert( eout != NULL );
+  PHASE_PROF( PHASE_PROF_RENDER );
 
   FPRINTF( eout, "%s ", L_DEFINE );
   c_sname_english( &ast->sname, eout );
@@ -357,6 +516,15 @@ void c_ast_explain_type( c_ast_t const *ast, FILE *eout ) {
   FPUTC( '\n', eout );
 }
 
+void c_typedef_english( c_typedef_t const *tdef, FILE *eout ) {
+  assert( tdef != NULL );
+  assert( eout != NULL );
+  PHASE_PROF( PHASE_PROF_RENDER );
+  c_typedef_render(
+    tdef, C_TDEF_RENDER_ENGLISH, &c_typedef_english_render, NULL, eout
+  );
+}
+
 void c_sname_english( c_sname_t const *sname, FILE *eout ) {
   assert( sname != NULL );
   assert( eout != NULL );
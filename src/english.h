@@ -84,6 +84,19 @@ void c_ast_explain_declaration( c_ast_t const *ast, FILE *eout );
  */
 void c_ast_explain_type( c_ast_t const *ast, FILE *eout );
 
+/**
+ * Explains \a tdef as a type in pseudo-English the same as
+ * c_ast_explain_type(), but caches the result.
+ *
+ * @note A newline _is_ printed.
+ *
+ * @param tdef The type to explain.
+ * @param eout The `FILE` to print to.
+ *
+ * @sa c_typedef_gibberish()
+ */
+void c_typedef_english( c_typedef_t const *tdef, FILE *eout );
+
 /**
  * Prints \a sname in pseudo-English.
  *
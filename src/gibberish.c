@@ -32,6 +32,8 @@
 #include "c_typedef.h"
 #include "literals.h"
 #include "options.h"
+#include "phase_prof.h"
+#include "render_plan.h"
 #include "util.h"
 
 /// @cond DOXYGEN_IGNORE
@@ -40,6 +42,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
 
 /// @endcond
 
@@ -52,6 +55,7 @@
 struct g_state {
   c_gib_kind_t  gib_kind;               ///< Kind of gibberish to print.
   FILE         *gout;                   ///< Where to write the gibberish.
+  bool          full_tdef_names;        ///< Print `typedef`s' full names?
   bool          postfix;                ///< Doing postfix gibberish?
   bool          printed_space;          ///< Printed a space yet?
   bool          printing_typedef;       ///< Printing a `typedef`?
@@ -59,13 +63,41 @@ struct g_state {
 };
 typedef struct g_state g_state_t;
 
+/**
+ * Visit marks used by g_header_visit() for ordering `typedef`s.
+ */
+enum g_header_mark {
+  G_HEADER_UNVISITED,                   ///< Not visited yet.
+  G_HEADER_VISITING,                    ///< Dependencies being visited.
+  G_HEADER_DONE                         ///< Already ordered.
+};
+typedef enum g_header_mark g_header_mark_t;
+
+/**
+ * State maintained by c_typedef_header_gibberish() for ordering `typedef`s
+ * such that every `typedef` follows those it depends on.
+ */
+struct g_header {
+  c_typedef_t const *const *tdefs;      ///< `typedef`s sorted by name.
+  size_t                    n;          ///< Number of `typedef`s.
+  g_header_mark_t          *marks;      ///< Visit marks, one per `typedef`.
+  c_typedef_t const       **order;      ///< `typedef`s in dependency order.
+  size_t                    n_order;    ///< Number ordered so far.
+};
+typedef struct g_header g_header_t;
+
 // local functions
+static void g_header_visit( g_header_t*, size_t );
 static void g_init( g_state_t*, c_gib_kind_t, bool, FILE* );
 static void g_print_ast( g_state_t*, c_ast_t const* );
+static void g_print_ast_plan( c_ast_t const*, void*, FILE* );
 static void g_print_ast_name( g_state_t*, c_ast_t const* );
 static void g_print_postfix( g_state_t*, c_ast_t const* );
 static void g_print_qual_name( g_state_t*, c_ast_t const* );
 static void g_print_space_ast_name( g_state_t*, c_ast_t const* );
+static void g_print_typedef_decl( c_typedef_t const*, c_gib_kind_t, bool,
+                                  FILE* );
+static bool g_printing_typedef( c_typedef_t const*, c_gib_kind_t );
 
 ////////// inline functions ///////////////////////////////////////////////////
 
@@ -88,16 +120,233 @@ static inline void g_print_space_once( g_state_t *g ) {
  * @param ast The AST to print.
  * @param gib_kind The kind of gibberish to print as.
  * @param printing_typedef Printing a `typedef`?
+ * @param full_tdef_names If `true`, print the full names of `typedef`s
+ * referred to even when printing a `typedef`.
  * @param gout The `FILE` to print to.
  */
 static void c_ast_gibberish_impl( c_ast_t const *ast, c_gib_kind_t gib_kind,
-                                  bool printing_typedef, FILE *gout ) {
+                                  bool printing_typedef, bool full_tdef_names,
+                                  FILE *gout ) {
   assert( ast != NULL );
   assert( gout != NULL );
 
   g_state_t g;
   g_init( &g, gib_kind, printing_typedef, gout );
-  g_print_ast( &g, ast );
+  g.full_tdef_names = full_tdef_names;
+  render_plan_render(
+    ast, &g_print_ast_plan, &g,
+    ((uint64_t)gib_kind << 2) | ((uint64_t)full_tdef_names << 1) |
+      printing_typedef,
+    gout
+  );
+}
+
+/**
+ * Prints \a tdef as a C/C++ type declaration for c_typedef_render().
+ *
+ * @param tdef The type to print.
+ * @param data A pointer to the kind of gibberish to print as; must only be
+ * either #C_GIB_TYPEDEF or #C_GIB_USING.
+ * @param gout The `FILE` to print to.
+ */
+static void c_typedef_gibberish_render( c_typedef_t const *tdef, void *data,
+                                        FILE *gout ) {
+  assert( data != NULL );
+  c_gib_kind_t const gib_kind = *(c_gib_kind_t const*)data;
+
+  size_t scope_close_braces_to_print = 0;
+  c_type_t scope_type = T_NONE;
+
+  c_sname_t const *const sname = c_ast_find_name( tdef->ast, C_VISIT_DOWN );
+  if ( sname != NULL && c_sname_count( sname ) > 1 ) {
+    scope_type = c_scope_data( sname->head )->type;
+    //
+    // A type name can't be scoped in a typedef declaration, e.g.:
+    //
+    //      typedef int S::T::I;        // illegal
+    //
+    // so we have to wrap it in a scoped declaration, one of: class, namespace,
+    // struct, or union.
+    //
+    if ( scope_type.base_tid != TB_NAMESPACE ||
+         (opt_lang & (LANG_CPP_MIN(17) | LANG_C_ANY)) != LANG_NONE ) {
+      //
+      // All C++ versions support nested class/struct/union declarations, e.g.:
+      //
+      //      struct S::T { typedef int I; }
+      //
+      // However, only C++17 and later support nested namespace declarations:
+      //
+      //      namespace S::T { typedef int I; }
+      //
+      // If the current language is any version of C, also print in nested
+      // namespace form.
+      //
+      scope_type = *c_sname_scope_type( sname );
+      if ( scope_type.base_tid == TB_SCOPE )
+        scope_type.base_tid = TB_NAMESPACE;
+      FPRINTF( gout,
+        "%s %s { ", c_type_name_c( &scope_type ), c_sname_scope_name( sname )
+      );
+      scope_close_braces_to_print = 1;
+    }
+    else {
+      //
+      // Namespaces in C++14 and earlier require distinct declarations:
+      //
+      //      namespace S { namespace T { typedef int I; } }
+      //
+      FOREACH_SCOPE( scope, sname, sname->tail ) {
+        scope_type = c_scope_data( scope )->type;
+        if ( scope_type.base_tid == TB_SCOPE )
+          scope_type.base_tid = TB_NAMESPACE;
+        FPRINTF( gout,
+          "%s %s { ",
+          c_type_name_c( &scope_type ), c_scope_data( scope )->name
+        );
+      } // for
+      scope_close_braces_to_print = c_sname_count( sname ) - 1;
+    }
+  }
+
+  g_print_typedef_decl( tdef, gib_kind, /*full_tdef_names=*/false, gout );
+
+  if ( scope_close_braces_to_print > 0 ) {
+    FPUTC( ';', gout );
+    while ( scope_close_braces_to_print-- > 0 )
+      FPUTS( " }", gout );
+  }
+
+  if ( opt_semicolon && scope_type.base_tid != TB_NAMESPACE )
+    FPUTC( ';', gout );
+  FPUTC( '\n', gout );
+}
+
+/**
+ * Prints the closing braces for the scopes of \a sname from \a from_depth
+ * down to \a to_depth.
+ *
+ * @param sname The scoped name whose scopes are open.
+ * @param from_depth The number of scopes that are open.
+ * @param to_depth The number of scopes to leave open.
+ * @param gout The `FILE` to print to.
+ */
+static void g_header_close( c_sname_t const *sname, size_t from_depth,
+                            size_t to_depth, FILE *gout ) {
+  while ( from_depth-- > to_depth ) {
+    c_scope_data_t const *const data = slist_peek_at( sname, from_depth );
+    FPUTC( '}', gout );
+    //
+    // Unlike a namespace, a class, struct, or union declaration must be
+    // terminated by a semicolon.
+    //
+    if ( (data->type.base_tid & TB_ANY_CLASS) != TB_NONE )
+      FPUTC( ';', gout );
+    FPUTC( from_depth > 0 ? ' ' : '\n', gout );
+  } // while
+}
+
+/**
+ * Compares a name against that of a `typedef` for bsearch(3).
+ *
+ * @param key_data A pointer to the <code>\ref c_sname_t</code> to find.
+ * @param tdef_data A pointer to a pointer to the `typedef` to compare against.
+ * @return Returns a number less than 0, 0, or greater than 0 if \a key_data is
+ * less than, equal to, or greater than the `typedef`'s name, respectively.
+ */
+PJL_WARN_UNUSED_RESULT
+static int g_header_find_cmp( void const *key_data, void const *tdef_data ) {
+  c_sname_t const *const sname = key_data;
+  c_typedef_t const *const tdef =
+    *REINTERPRET_CAST( c_typedef_t const**, tdef_data );
+  return c_sname_cmp( sname, &tdef->ast->sname );
+}
+
+/**
+ * Checks whether the first \a depth scopes of two scoped names are the same.
+ *
+ * @param i_sname The first scoped name.
+ * @param j_sname The second scoped name.
+ * @param depth The number of scopes to check.
+ * @return Returns `true` only if the scopes are the same.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool g_header_same_scope( c_sname_t const *i_sname,
+                                 c_sname_t const *j_sname, size_t depth ) {
+  for ( size_t d = 0; d < depth; ++d ) {
+    c_scope_data_t const *const i_data = slist_peek_at( i_sname, d );
+    c_scope_data_t const *const j_data = slist_peek_at( j_sname, d );
+    if ( strcmp( i_data->name, j_data->name ) != 0 ||
+         !c_type_equal( &i_data->type, &j_data->type ) ) {
+      return false;
+    }
+  } // for
+  return true;
+}
+
+/**
+ * Visits the `typedef`s that \a ast depends on, if any.
+ *
+ * @param h The `g_header` to use.
+ * @param ast The AST to visit the dependencies of.
+ */
+static void g_header_visit_deps( g_header_t *h, c_ast_t const *ast ) {
+  assert( h != NULL );
+
+  for ( ; ast != NULL;
+        ast = c_ast_is_parent( ast ) ? ast->as.parent.of_ast : NULL ) {
+    c_sname_t const *dep_sname = NULL;
+
+    if ( ast->kind_id == K_TYPEDEF )
+      dep_sname = &ast->as.tdef.for_ast->sname;
+    else if ( (ast->kind_id & (K_ENUM_CLASS_STRUCT_UNION |
+                               K_POINTER_TO_MEMBER)) != K_NONE )
+      dep_sname = &ast->as.ecsu.ecsu_sname;
+
+    if ( dep_sname != NULL ) {
+      c_typedef_t const *const *const found = bsearch(
+        dep_sname, h->tdefs, h->n, sizeof( c_typedef_t* ), &g_header_find_cmp
+      );
+      if ( found != NULL )
+        g_header_visit( h, STATIC_CAST( size_t, found - h->tdefs ) );
+    }
+
+    if ( (ast->kind_id & K_ANY_FUNCTION_LIKE) != K_NONE ) {
+      //
+      // Parameters are distinct ASTs, so their dependencies have to be
+      // visited explicitly.
+      //
+      FOREACH_PARAM( param, ast )
+        g_header_visit_deps( h, c_param_ast( param ) );
+    }
+
+    if ( ast->kind_id == K_TYPEDEF )
+      break;                            // its own dependencies are its own
+  } // for
+}
+
+/**
+ * Visits the `typedef` at index \a i: visits its dependencies first, then
+ * appends it to the dependency order.
+ *
+ * @param h The `g_header` to use.
+ * @param i The index of the `typedef` to visit.
+ */
+static void g_header_visit( g_header_t *h, size_t i ) {
+  assert( h != NULL );
+  assert( i < h->n );
+
+  //
+  // A typedef that's being visited is either itself (e.g., "struct S" depends
+  // on S) or part of a cycle (that can only be via pointers to incomplete
+  // types), so just ignore it.
+  //
+  if ( h->marks[i] != G_HEADER_UNVISITED )
+    return;
+  h->marks[i] = G_HEADER_VISITING;
+  g_header_visit_deps( h, h->tdefs[i]->ast );
+  h->marks[i] = G_HEADER_DONE;
+  h->order[ h->n_order++ ] = h->tdefs[i];
 }
 
 /**
@@ -207,8 +456,10 @@ static void g_print_ast( g_state_t *g, c_ast_t const *ast ) {
       if ( !c_type_is_none( &type ) )
         FPRINTF( g->gout, "%s ", c_type_name_c( &type ) );
       if ( ast->kind_id == K_USER_DEF_CONVERSION ) {
-        if ( !c_ast_empty_name( ast ) )
-          FPRINTF( g->gout, "%s::", c_ast_full_name( ast ) );
+        if ( !c_ast_empty_name( ast ) ) {
+          render_slot( g->gout, ast, RENDER_FULL_NAME );
+          FPUTS( "::", g->gout );
+        }
         FPRINTF( g->gout, "%s ", L_OPERATOR );
       }
       if ( ast->as.parent.of_ast != NULL )
@@ -245,8 +496,10 @@ static void g_print_ast( g_state_t *g, c_ast_t const *ast ) {
     case K_BUILTIN:
       FPUTS( c_type_name_c( &ast->type ), g->gout );
       g_print_space_ast_name( g, ast );
-      if ( ast->as.builtin.bit_width > 0 )
-        FPRINTF( g->gout, " : %u", ast->as.builtin.bit_width );
+      if ( ast->as.builtin.bit_width > 0 ) {
+        FPUTS( " : ", g->gout );
+        render_slot( g->gout, ast, RENDER_BIT_WIDTH );
+      }
       break;
 
     case K_ENUM_CLASS_STRUCT_UNION:
@@ -285,9 +538,8 @@ static void g_print_ast( g_state_t *g, c_ast_t const *ast ) {
         //
         //          typedef struct S T; // ast->sname ="T"; escu_name = "S"
         //
-        FPRINTF( g->gout,
-          " %s", c_sname_full_name( &ast->as.ecsu.ecsu_sname )
-        );
+        FPUTC( ' ', g->gout );
+        render_slot( g->gout, ast, RENDER_ECSU_FULL_NAME );
       }
 
       if ( ast->as.ecsu.of_ast != NULL ) {
@@ -367,24 +619,29 @@ static void g_print_ast( g_state_t *g, c_ast_t const *ast ) {
         FPRINTF( g->gout, "%s ", c_type_name_c( &ast->type ) );
 
       //
-      // Temporarily set skip_name_for_using to false to force printing of the
-      // type's name.  This is necessary for when printing the name of a
-      // typedef of a typedef as a "using" declaration:
+      // Print the type's name regardless of skip_name_for_using.  This is
+      // necessary for when printing the name of a typedef of a typedef as a
+      // "using" declaration:
       //
       //      c++decl> typedef int32_t foo_t
       //      c++decl> show foo_t as using
       //      using foo_t = int32_t;
       //
-      bool const orig_skip_name_for_using = g->skip_name_for_using;
-      g->skip_name_for_using = false;
-      g_print_ast_name( g, ast->as.tdef.for_ast );
-      g->skip_name_for_using = orig_skip_name_for_using;
+      // The name is printed via this AST rather than for_ast since for_ast may
+      // be shared by other ASTs.
+      //
+      render_slot( g->gout, ast,
+        g->gib_kind == C_GIB_TYPEDEF && !g->full_tdef_names ?
+          RENDER_TDEF_LOCAL_NAME : RENDER_TDEF_FULL_NAME
+      );
 
       if ( is_more_than_plain_typedef && opt_east_const )
         FPRINTF( g->gout, " %s", c_type_name_c( &ast->type ) );
       g_print_space_ast_name( g, ast );
-      if ( ast->as.tdef.bit_width > 0 )
-        FPRINTF( g->gout, " : %u", ast->as.tdef.bit_width );
+      if ( ast->as.tdef.bit_width > 0 ) {
+        FPUTS( " : ", g->gout );
+        render_slot( g->gout, ast, RENDER_BIT_WIDTH );
+      }
       break;
     }
 
@@ -415,7 +672,7 @@ static void g_print_ast_array_size( g_state_t const *g, c_ast_t const *ast ) {
       FPUTC( '*', g->gout );
       break;
     default:
-      FPRINTF( g->gout, "%d", ast->as.array.size );
+      render_slot( g->gout, ast, RENDER_ARRAY_SIZE );
   } // switch
   FPUTS( graph_token_c( "]" ), g->gout );
 }
@@ -440,6 +697,7 @@ static void g_print_ast_func_params( g_state_t const *g, c_ast_t const *ast ) {
       FPUTS( ", ", g->gout );
     g_state_t params_g;
     g_init( &params_g, g->gib_kind, /*printing_typedef=*/false, g->gout );
+    params_g.full_tdef_names = g->full_tdef_names;
     g_print_ast( &params_g, c_param_ast( param ) );
   } // for
   FPUTC( ')', g->gout );
@@ -477,17 +735,29 @@ static void g_print_ast_name( g_state_t *g, c_ast_t const *ast ) {
     return;
   }
 
-  FPUTS(
+  render_slot( g->gout, ast,
     //
     // For typedefs, the scope names (if any) were already printed in
     // c_typedef_gibberish() so now we just print the local name.
     //
-    g->gib_kind == C_GIB_TYPEDEF ?
-      c_ast_local_name( ast ) : c_ast_full_name( ast ),
-    g->gout
+    g->gib_kind == C_GIB_TYPEDEF ? RENDER_LOCAL_NAME : RENDER_FULL_NAME
   );
 }
 
+/**
+ * Prints \a ast as gibberish for render_plan_render().
+ *
+ * @param ast The AST to print.
+ * @param data A pointer to the initialized `g_state` to use.
+ * @param gout The `FILE` to print to.
+ */
+static void g_print_ast_plan( c_ast_t const *ast, void *data, FILE *gout ) {
+  assert( data != NULL );
+  g_state_t *const g = data;
+  g->gout = gout;
+  g_print_ast( g, ast );
+}
+
 /**
  * Helper function for g_print_ast() that handles the printing of "postfix"
  * cases:
@@ -641,9 +911,8 @@ static void g_print_qual_name( g_state_t *g, c_ast_t const *ast ) {
       FPUTC( '*', g->gout );
       break;
     case K_POINTER_TO_MEMBER:
-      FPRINTF( g->gout,
-        "%s::*", c_sname_full_name( &ast->as.ptr_mbr.class_sname )
-      );
+      render_slot( g->gout, ast, RENDER_CLASS_FULL_NAME );
+      FPUTS( "::*", g->gout );
       break;
     case K_REFERENCE:
       if ( opt_alt_tokens ) {
@@ -701,21 +970,25 @@ static void g_print_space_ast_name( g_state_t *g, c_ast_t const *ast ) {
 
   switch ( ast->kind_id ) {
     case K_CONSTRUCTOR:
-      FPUTS( c_ast_full_name( ast ), g->gout );
+      render_slot( g->gout, ast, RENDER_FULL_NAME );
       break;
     case K_DESTRUCTOR:
-      if ( c_ast_count_name( ast ) > 1 )
-        FPRINTF( g->gout, "%s::", c_ast_scope_name( ast ) );
+      if ( c_ast_count_name( ast ) > 1 ) {
+        render_slot( g->gout, ast, RENDER_SCOPE_NAME );
+        FPUTS( "::", g->gout );
+      }
       if ( opt_alt_tokens )
         FPRINTF( g->gout, "%s ", L_COMPL );
       else
         FPUTC( '~', g->gout );
-      FPUTS( c_ast_local_name( ast ), g->gout );
+      render_slot( g->gout, ast, RENDER_LOCAL_NAME );
       break;
     case K_OPERATOR: {
       g_print_space_once( g );
-      if ( !c_ast_empty_name( ast ) )
-        FPRINTF( g->gout, "%s::", c_ast_full_name( ast ) );
+      if ( !c_ast_empty_name( ast ) ) {
+        render_slot( g->gout, ast, RENDER_FULL_NAME );
+        FPUTS( "::", g->gout );
+      }
       char const *const token = c_oper_token_c( ast->as.oper.oper_id );
       FPRINTF( g->gout,
         "%s%s%s", L_OPERATOR, isalpha( token[0] ) ? " " : "", token
@@ -727,9 +1000,12 @@ static void g_print_space_ast_name( g_state_t *g, c_ast_t const *ast ) {
       break;
     case K_USER_DEF_LITERAL:
       g_print_space_once( g );
-      if ( c_ast_count_name( ast ) > 1 )
-        FPRINTF( g->gout, "%s::", c_ast_scope_name( ast ) );
-      FPRINTF( g->gout, "%s\"\" %s", L_OPERATOR, c_ast_local_name( ast ) );
+      if ( c_ast_count_name( ast ) > 1 ) {
+        render_slot( g->gout, ast, RENDER_SCOPE_NAME );
+        FPUTS( "::", g->gout );
+      }
+      FPRINTF( g->gout, "%s\"\" ", L_OPERATOR );
+      render_slot( g->gout, ast, RENDER_LOCAL_NAME );
       break;
     default:
       if ( !c_ast_empty_name( ast ) ) {
@@ -741,12 +1017,83 @@ static void g_print_space_ast_name( g_state_t *g, c_ast_t const *ast ) {
   } // switch
 }
 
+/**
+ * Checks whether \a tdef would be printed preceded by `typedef`.
+ *
+ * @param tdef The type to check.
+ * @param gib_kind The kind of gibberish to print as.
+ * @return Returns `true` only if it would.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool g_printing_typedef( c_typedef_t const *tdef,
+                                c_gib_kind_t gib_kind ) {
+  assert( tdef != NULL );
+
+  //
+  // When printing a type, all types except enum, class, struct, or union types
+  // must be preceded by "typedef", e.g.:
+  //
+  //      typedef int int32_t;
+  //
+  // However, enum, class, struct, and union types are preceded by "typedef"
+  // only when the type was declared in C since those types in C without a
+  // typedef are merely in the tags namespace and not first-class types:
+  //
+  //      struct S;                     // In C, tag only -- not a type.
+  //      typedef struct S S;           // Now it's a type.
+  //
+  // In C++, such typedefs are unnecessary since such types are first-class
+  // types and not just tags, so we don't print "typedef".
+  //
+  return gib_kind == C_GIB_TYPEDEF &&
+    (tdef->ast->kind_id != K_ENUM_CLASS_STRUCT_UNION ||
+      c_lang_is_c( tdef->lang_ids ) ||
+      (OPT_LANG_IS(C_ANY) && !c_lang_is_cpp( tdef->lang_ids )));
+}
+
+/**
+ * Prints \a tdef as a `typedef` or `using` declaration without any enclosing
+ * scopes nor a terminating semicolon.
+ *
+ * @param tdef The type to print.
+ * @param gib_kind The kind of gibberish to print as; must only be either
+ * #C_GIB_TYPEDEF or #C_GIB_USING.
+ * @param full_tdef_names If `true`, print the full names of `typedef`s
+ * referred to.
+ * @param gout The `FILE` to print to.
+ */
+static void g_print_typedef_decl( c_typedef_t const *tdef,
+                                  c_gib_kind_t gib_kind, bool full_tdef_names,
+                                  FILE *gout ) {
+  assert( tdef != NULL );
+  assert( gout != NULL );
+
+  bool const is_ecsu = tdef->ast->kind_id == K_ENUM_CLASS_STRUCT_UNION;
+
+  bool const printing_typedef = g_printing_typedef( tdef, gib_kind );
+  bool const printing_using = gib_kind == C_GIB_USING && !is_ecsu;
+
+  if ( printing_typedef )
+    FPRINTF( gout, "%s ", L_TYPEDEF );
+  else if ( printing_using )
+    FPRINTF( gout,
+      "%s %s = ", L_USING,
+      c_sname_local_name( c_ast_find_name( tdef->ast, C_VISIT_DOWN ) )
+    );
+
+  c_ast_gibberish_impl(
+    tdef->ast, printing_using ? C_GIB_USING : C_GIB_TYPEDEF,
+    printing_typedef, full_tdef_names, gout
+  );
+}
+
 ////////// extern functions ///////////////////////////////////////////////////
 
 void c_ast_gibberish( c_ast_t const *ast, c_gib_kind_t gib_kind, FILE *gout ) {
   assert( ast != NULL );
   assert( (gib_kind & (C_GIB_CAST | C_GIB_DECL)) != C_GIB_NONE );
   assert( gout != NULL );
+  PHASE_PROF( PHASE_PROF_RENDER );
 
   switch ( ast->align.kind ) {
     case C_ALIGNAS_NONE:
@@ -761,7 +1108,9 @@ void c_ast_gibberish( c_ast_t const *ast, c_gib_kind_t gib_kind, FILE *gout ) {
       break;
   } // switch
 
-  c_ast_gibberish_impl( ast, gib_kind, /*printing_typedef=*/false, gout );
+  c_ast_gibberish_impl(
+    ast, gib_kind, /*printing_typedef=*/false, /*full_tdef_names=*/false, gout
+  );
 }
 
 void c_typedef_gibberish( c_typedef_t const *tdef, c_gib_kind_t gib_kind,
@@ -769,105 +1118,107 @@ void c_typedef_gibberish( c_typedef_t const *tdef, c_gib_kind_t gib_kind,
   assert( tdef != NULL );
   assert( (gib_kind & (C_GIB_TYPEDEF | C_GIB_USING)) != C_GIB_NONE );
   assert( gout != NULL );
+  PHASE_PROF( PHASE_PROF_RENDER );
 
-  size_t scope_close_braces_to_print = 0;
-  c_type_t scope_type = T_NONE;
+  c_typedef_render(
+    tdef, gib_kind == C_GIB_USING ? C_TDEF_RENDER_USING : C_TDEF_RENDER_TYPEDEF,
+    &c_typedef_gibberish_render, &gib_kind, gout
+  );
+}
 
-  c_sname_t const *const sname = c_ast_find_name( tdef->ast, C_VISIT_DOWN );
-  if ( sname != NULL && c_sname_count( sname ) > 1 ) {
-    scope_type = c_scope_data( sname->head )->type;
-    //
-    // A type name can't be scoped in a typedef declaration, e.g.:
-    //
-    //      typedef int S::T::I;        // illegal
-    //
-    // so we have to wrap it in a scoped declaration, one of: class, namespace,
-    // struct, or union.
-    //
-    if ( scope_type.base_tid != TB_NAMESPACE ||
-         (opt_lang & (LANG_CPP_MIN(17) | LANG_C_ANY)) != LANG_NONE ) {
-      //
-      // All C++ versions support nested class/struct/union declarations, e.g.:
-      //
-      //      struct S::T { typedef int I; }
-      //
-      // However, only C++17 and later support nested namespace declarations:
-      //
-      //      namespace S::T { typedef int I; }
-      //
-      // If the current language is any version of C, also print in nested
-      // namespace form.
-      //
-      scope_type = *c_sname_scope_type( sname );
-      if ( scope_type.base_tid == TB_SCOPE )
-        scope_type.base_tid = TB_NAMESPACE;
-      FPRINTF( gout,
-        "%s %s { ", c_type_name_c( &scope_type ), c_sname_scope_name( sname )
-      );
-      scope_close_braces_to_print = 1;
-    }
-    else {
-      //
-      // Namespaces in C++14 and earlier require distinct declarations:
-      //
-      //      namespace S { namespace T { typedef int I; } }
-      //
-      FOREACH_SCOPE( scope, sname, sname->tail ) {
-        scope_type = c_scope_data( scope )->type;
-        if ( scope_type.base_tid == TB_SCOPE )
-          scope_type.base_tid = TB_NAMESPACE;
-        FPRINTF( gout,
-          "%s %s { ",
-          c_type_name_c( &scope_type ), c_scope_data( scope )->name
-        );
-      } // for
-      scope_close_braces_to_print = c_sname_count( sname ) - 1;
-    }
-  }
+void c_typedef_gibberish_nocache( c_typedef_t const *tdef,
+                                  c_gib_kind_t gib_kind, FILE *gout ) {
+  assert( tdef != NULL );
+  assert( (gib_kind & (C_GIB_TYPEDEF | C_GIB_USING)) != C_GIB_NONE );
+  assert( gout != NULL );
+  PHASE_PROF( PHASE_PROF_RENDER );
 
-  bool const is_ecsu = tdef->ast->kind_id == K_ENUM_CLASS_STRUCT_UNION;
+  c_typedef_gibberish_render( tdef, &gib_kind, gout );
+}
+
+void c_typedef_header_gibberish( c_typedef_t const *const tdefs[], size_t n,
+                                 FILE *gout ) {
+  assert( tdefs != NULL || n == 0 );
+  assert( gout != NULL );
+  PHASE_PROF( PHASE_PROF_RENDER );
+
+  g_header_t h = {
+    .tdefs = tdefs,
+    .n = n,
+    .marks = MALLOC( g_header_mark_t, n ),
+    .order = MALLOC( c_typedef_t const*, n ),
+    .n_order = 0
+  };
+  for ( size_t i = 0; i < n; ++i )
+    h.marks[i] = G_HEADER_UNVISITED;
+  for ( size_t i = 0; i < n; ++i )
+    g_header_visit( &h, i );
+  assert( h.n_order == n );
 
   //
-  // When printing a type, all types except enum, class, struct, or union types
-  // must be preceded by "typedef", e.g.:
-  //
-  //      typedef int int32_t;
-  //
-  // However, enum, class, struct, and union types are preceded by "typedef"
-  // only when the type was declared in C since those types in C without a
-  // typedef are merely in the tags namespace and not first-class types:
-  //
-  //      struct S;                     // In C, tag only -- not a type.
-  //      typedef struct S S;           // Now it's a type.
+  // Since cdecl reads input a line at a time, all the declarations within
+  // the same top-level scope are printed on a single line, e.g.:
   //
-  // In C++, such typedefs are unnecessary since such types are first-class
-  // types and not just tags, so we don't print "typedef".
+  //      namespace N { typedef int I; struct S { typedef I J; }; }
   //
-  bool const printing_typedef = gib_kind == C_GIB_TYPEDEF &&
-    (!is_ecsu || c_lang_is_c( tdef->lang_ids ) ||
-    (OPT_LANG_IS(C_ANY) && !c_lang_is_cpp( tdef->lang_ids )));
+  c_sname_t const *open_sname = NULL;
+  size_t open_depth = 0;
 
-  bool const printing_using = gib_kind == C_GIB_USING && !is_ecsu;
+  for ( size_t i = 0; i < n; ++i ) {
+    c_typedef_t const *const tdef = h.order[i];
+    c_sname_t const *const sname = &tdef->ast->sname;
+    size_t const sname_count = c_sname_count( sname );
 
-  if ( printing_typedef )
-    FPRINTF( gout, "%s ", L_TYPEDEF );
-  else if ( printing_using )
-    FPRINTF( gout, "%s %s = ", L_USING, c_sname_local_name( sname ) );
+    if ( i + 1 < n && tdef->ast->kind_id == K_ENUM_CLASS_STRUCT_UNION &&
+         !g_printing_typedef( tdef, C_GIB_TYPEDEF ) ) {
+      //
+      // If the next typedef is within the scope of this class, struct, or
+      // union, the scope's declaration suffices, so this one is redundant:
+      //
+      //      struct S; struct S { typedef int I; };
+      //
+      c_sname_t const *const next_sname = &h.order[i+1]->ast->sname;
+      if ( c_sname_count( next_sname ) > sname_count &&
+           g_header_same_scope( sname, next_sname, sname_count ) ) {
+        continue;
+      }
+    }
 
-  c_ast_gibberish_impl(
-    tdef->ast, printing_using ? C_GIB_USING : C_GIB_TYPEDEF,
-    printing_typedef, gout
-  );
+    size_t const depth = sname_count - 1;
+    size_t common = 0;
+    while ( common < open_depth && common < depth &&
+            g_header_same_scope( open_sname, sname, common + 1 ) ) {
+      ++common;
+    } // while
+    if ( open_sname != NULL )
+      g_header_close( open_sname, open_depth, common, gout );
+
+    for ( size_t d = common; d < depth; ++d ) {
+      c_scope_data_t const *const data = slist_peek_at( sname, d );
+      c_type_t scope_type = data->type;
+      if ( scope_type.base_tid == TB_SCOPE )
+        scope_type.base_tid = TB_NAMESPACE;
+      FPRINTF( gout, "%s %s { ", c_type_name_c( &scope_type ), data->name );
+    } // for
 
-  if ( scope_close_braces_to_print > 0 ) {
-    FPUTC( ';', gout );
-    while ( scope_close_braces_to_print-- > 0 )
-      FPUTS( " }", gout );
-  }
+    //
+    // Types referred to are printed using their full names since they may be
+    // in other scopes.
+    //
+    g_print_typedef_decl(
+      tdef, C_GIB_TYPEDEF, /*full_tdef_names=*/true, gout
+    );
+    FPUTS( depth > 0 ? "; " : ";\n", gout );
 
-  if ( opt_semicolon && scope_type.base_tid != TB_NAMESPACE )
-    FPUTC( ';', gout );
-  FPUTC( '\n', gout );
+    open_sname = sname;
+    open_depth = depth;
+  } // for
+
+  if ( open_sname != NULL )
+    g_header_close( open_sname, open_depth, 0, gout );
+
+  FREE( h.marks );
+  FREE( h.order );
 }
 
 char const* graph_token_c( char const *token ) {
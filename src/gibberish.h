@@ -66,10 +66,43 @@ void c_ast_gibberish( c_ast_t const *ast, c_gib_kind_t kind, FILE *gout );
  * @param gout The `FILE` to print to.
  *
  * @sa c_ast_gibberish()
+ * @sa c_typedef_gibberish_nocache()
  */
 void c_typedef_gibberish( c_typedef_t const *tdef, c_gib_kind_t kind,
                           FILE *gout );
 
+/**
+ * Prints \a tdef as a C/C++ type declaration the same as
+ * c_typedef_gibberish() except that its rendering is never cached.  This
+ * must be used for a <code>\ref c_typedef</code> that hasn't been added,
+ * e.g., a temporary one.
+ *
+ * @param tdef The type to print.
+ * @param kind The kind of gibberish to print as; must only be either
+ * #C_GIB_TYPEDEF or #C_GIB_USING.
+ * @param gout The `FILE` to print to.
+ *
+ * @sa c_typedef_gibberish()
+ */
+void c_typedef_gibberish_nocache( c_typedef_t const *tdef, c_gib_kind_t kind,
+                                  FILE *gout );
+
+/**
+ * Prints \a tdefs as the declarations of a header: ordered such that every
+ * type follows the types it depends on and with the declarations in the same
+ * scope grouped within a single scope declaration (all on one line so the
+ * output can be read back by cdecl).
+ *
+ * @param tdefs The types to print sorted by name, i.e., in the order
+ * c_typedef_visit() visits them.
+ * @param n The number of types.
+ * @param gout The `FILE` to print to.
+ *
+ * @sa c_typedef_gibberish()
+ */
+void c_typedef_header_gibberish( c_typedef_t const *const tdefs[], size_t n,
+                                 FILE *gout );
+
 /**
  * Gets the digraph or trigraph (collectively, "graph") equivalent of \a token.
  *
@@ -145,12 +145,15 @@ static void print_help_commands( void ) {
   print_h( "  define <name> as <english>\n" );
   print_h( "  explain <gibberish>\n" );
   print_h( "  { help | ? } [command[s] | english]\n" );
+  print_h( "  reload\n" );
   print_h( "  set [<option> [= <value>] | options | <lang>]*\n" );
 
   print_h( "  show [<name>|[all] [predefined|user] [<glob>]] [[as] {english|typedef" );
   if ( OPT_LANG_IS(CPP_MIN(11)) )
     print_h( "|using" );
   print_h( "}]\n" );
+  print_h( "  show [all] [predefined|user] [<glob>] as header\n" );
+  print_h( "  show memory\n" );
 
   print_h( "  typedef <gibberish> [, <gibberish>]*\n" );
 
@@ -174,7 +177,7 @@ static void print_help_commands( void ) {
   print_h( "option:\n" );
   print_h( "  [no]alt-tokens [no]debug {di|tri|no}graphs [no]east-const\n" );
   print_h( "  [no]explain-by-default [no]explicit-int[=<types>] lang=<lang>\n" );
-  print_h( "  [no]prompt [no]semicolon\n" );
+  print_h( "  [no]prompt [no]semicolon [no]typedef-hints\n" );
 
   print_h( "lang: K[&|N]R[C] | C[K[&|N]R|78|89|95|99|11|17|2X] | C\\+\\+[98|03|11|14|17|20]\n" );
 
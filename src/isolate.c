@@ -0,0 +1,325 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/isolate.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions for processing files in isolation from each other and in
+ * parallel.
+ *
+ * The files are sorted largest first.  Up to one job per CPU runs at a time:
+ * whenever any job finishes, the next file in sorted order is started, so no
+ * CPU sits idle while files remain and a large file isn't left for last.
+ *
+ * Each job is a process forked from the parent, so it starts from the
+ * parent's state and nothing it does is seen by any other job.  A job's output
+ * and error output go to temporary files created by the parent, which reads
+ * them back once the job exits.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "isolate.h"
+#include "cdecl.h"
+#include "options.h"
+#include "strbuf.h"
+#include "util.h"
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>                      /* for open(2) */
+#include <signal.h>                     /* for kill(2) */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sysexits.h>
+#include <unistd.h>
+
+/// @endcond
+
+typedef struct isolate_job    isolate_job_t;
+typedef struct isolate_result isolate_result_t;
+
+/**
+ * A running job.
+ */
+struct isolate_job {
+  pid_t   pid;                          ///< Process ID or 0 if none.
+  size_t  index;                        ///< Index of the file into paths.
+  FILE   *out;                          ///< Output of the job.
+  FILE   *err;                          ///< Error output of the job.
+};
+
+/**
+ * The result of processing a file.
+ */
+struct isolate_result {
+  char   *out;                          ///< Output.
+  size_t  out_len;                      ///< Length of \a out.
+  char   *err;                          ///< Error output.
+  size_t  err_len;                      ///< Length of \a err.
+  int     status;                       ///< Exit status of the job.
+  bool    done;                         ///< Finished?
+};
+
+// local variable definitions
+static bool         isolate_job;        ///< Is this process a job?
+static off_t const *isolate_sizes;      ///< Used by isolate_size_cmp().
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Kills all running jobs and waits for them.
+ *
+ * @param jobs The array of jobs.
+ * @param n_jobs The number of elements in \a jobs.
+ */
+static void isolate_kill( isolate_job_t jobs[], size_t n_jobs ) {
+  for ( size_t j = 0; j < n_jobs; ++j ) {
+    if ( jobs[j].pid == 0 )
+      continue;
+    PJL_IGNORE_RV( kill( jobs[j].pid, SIGKILL ) );
+    while ( waitpid( jobs[j].pid, NULL, 0 ) == -1 && errno == EINTR )
+      ;
+    jobs[j].pid = 0;
+  } // for
+}
+
+/**
+ * Reads the entire contents of a temporary file.
+ *
+ * @param file The temporary file to read.  It's closed.
+ * @param plen A pointer to receive the length of the contents.
+ * @return Returns said contents.
+ */
+PJL_WARN_UNUSED_RESULT
+static char* isolate_slurp( FILE *file, size_t *plen ) {
+  int const fd = fileno( file );
+  struct stat st;
+  FSTAT( fd, &st );
+  size_t const len = (size_t)st.st_size;
+  char *const buf = MALLOC( char, len );
+
+  for ( size_t got = 0; got < len; ) {
+    ssize_t const n = pread( fd, buf + got, len - got, (off_t)got );
+    if ( n == -1 && errno == EINTR )
+      continue;
+    IF_EXIT( n <= 0, EX_IOERR );
+    got += (size_t)n;
+  } // for
+
+  PJL_IGNORE_RV( fclose( file ) );
+  *plen = len;
+  return buf;
+}
+
+/**
+ * Compares two file indices by the sizes of their files for sorting largest
+ * first.
+ *
+ * @param i_data A pointer to the first index.
+ * @param j_data A pointer to the second index.
+ * @return Returns a number less than 0, 0, or greater than 0 if the file of \a
+ * i_data is larger than, the same size as, or smaller than that of \a j_data.
+ */
+PJL_WARN_UNUSED_RESULT
+static int isolate_size_cmp( void const *i_data, void const *j_data ) {
+  size_t const i = *(size_t const*)i_data;
+  size_t const j = *(size_t const*)j_data;
+  if ( isolate_sizes[i] != isolate_sizes[j] )
+    return isolate_sizes[i] > isolate_sizes[j] ? -1 : 1;
+  return i < j ? -1 : i > j;
+}
+
+/**
+ * Starts a job to parse a file.
+ *
+ * @param job A pointer to the job to start.
+ * @param index The index of the file into \a paths.
+ * @param paths The array of paths of files to parse.
+ * @param parse_fn The function to parse a file with.
+ */
+static void isolate_start( isolate_job_t *job, size_t index,
+                           char const *const paths[],
+                           isolate_parse_fn_t parse_fn ) {
+  job->index = index;
+  job->out = tmpfile();
+  IF_EXIT( job->out == NULL, EX_CANTCREAT );
+  job->err = tmpfile();
+  IF_EXIT( job->err == NULL, EX_CANTCREAT );
+
+  // Flush so buffered output isn't also written by the child.
+  FFLUSH( fout );
+  FFLUSH( stderr );
+
+  job->pid = fork();
+  IF_EXIT( job->pid == -1, EX_OSERR );
+  if ( job->pid == 0 ) {
+    isolate_job = true;
+    fout = job->out;
+    IF_EXIT( dup2( fileno( job->err ), STDERR_FILENO ) == -1, EX_OSERR );
+    bool const ok = (*parse_fn)( paths[ index ] );
+    exit( ok ? EX_OK : EX_DATAERR );
+  }
+}
+
+/**
+ * Waits for any job to finish and gets its result.
+ *
+ * @param jobs The array of jobs.
+ * @param n_jobs The number of elements in \a jobs.
+ * @param paths The array of paths of files being parsed.
+ * @param results The array of results indexed the same as \a paths.
+ */
+static void isolate_wait( isolate_job_t jobs[], size_t n_jobs,
+                          char const *const paths[],
+                          isolate_result_t results[] ) {
+  for (;;) {
+    int status;
+    pid_t const pid = waitpid( -1, &status, 0 );
+    if ( pid == -1 ) {
+      IF_EXIT( errno != EINTR, EX_OSERR );
+      continue;
+    }
+
+    for ( size_t j = 0; j < n_jobs; ++j ) {
+      isolate_job_t *const job = &jobs[j];
+      if ( job->pid != pid )
+        continue;
+      isolate_result_t *const r = &results[ job->index ];
+      r->out = isolate_slurp( job->out, &r->out_len );
+      r->err = isolate_slurp( job->err, &r->err_len );
+      r->status = WIFEXITED( status ) ? WEXITSTATUS( status ) : EX_DATAERR;
+      if ( WIFSIGNALED( status ) ) {
+        strbuf_t sbuf;
+        strbuf_init( &sbuf );
+        strbuf_catsn( &sbuf, r->err, r->err_len );
+        strbuf_catf(
+          &sbuf, "%s: %s: terminated by signal %d\n",
+          me, paths[ job->index ], WTERMSIG( status )
+        );
+        FREE( r->err );
+        r->err = sbuf.str;
+        r->err_len = sbuf.len;
+      }
+      r->done = true;
+      job->pid = 0;
+      return;
+    } // for
+  } // for
+}
+
+////////// extern functions ///////////////////////////////////////////////////
+
+bool isolate_in_job( void ) {
+  return isolate_job;
+}
+
+bool isolate_files( char const *const paths[], size_t n_paths,
+                    isolate_parse_fn_t parse_fn ) {
+  assert( paths != NULL );
+  assert( parse_fn != NULL );
+
+  //
+  // Check that all files can be read (so we fail the same way as when not
+  // isolating files) and get their sizes so the largest can be started first.
+  //
+  off_t *const sizes = MALLOC( off_t, n_paths );
+  size_t *const order = MALLOC( size_t, n_paths );
+  for ( size_t i = 0; i < n_paths; ++i ) {
+    order[i] = i;
+    sizes[i] = 0;
+    if ( strcmp( paths[i], "-" ) == 0 )
+      continue;
+    int const fd = open( paths[i], O_RDONLY );
+    if ( unlikely( fd == -1 ) )
+      PMESSAGE_EXIT( EX_NOINPUT, "%s: %s\n", paths[i], STRERROR() );
+    struct stat st;
+    FSTAT( fd, &st );
+    PJL_IGNORE_RV( close( fd ) );
+    if ( unlikely( S_ISDIR( st.st_mode ) ) ) {
+      errno = EISDIR;
+      PMESSAGE_EXIT( EX_NOINPUT, "%s: %s\n", paths[i], STRERROR() );
+    }
+    sizes[i] = st.st_size;
+  } // for
+  isolate_sizes = sizes;
+  qsort( order, n_paths, sizeof order[0], &isolate_size_cmp );
+  FREE( sizes );
+
+  long const n_cpus = sysconf( _SC_NPROCESSORS_ONLN );
+  size_t const n_jobs = n_cpus > 1 ? (size_t)n_cpus : 1;
+  isolate_job_t *const jobs = MALLOC( isolate_job_t, n_jobs );
+  memset( jobs, 0, n_jobs * sizeof jobs[0] );
+  isolate_result_t *const results = MALLOC( isolate_result_t, n_paths );
+  memset( results, 0, n_paths * sizeof results[0] );
+
+  bool ok = true;
+  size_t next_start = 0, next_emit = 0;
+
+  while ( next_emit < n_paths ) {
+    for ( size_t j = 0; j < n_jobs && next_start < n_paths; ++j ) {
+      if ( jobs[j].pid == 0 )
+        isolate_start( &jobs[j], order[ next_start++ ], paths, parse_fn );
+    } // for
+
+    isolate_wait( jobs, n_jobs, paths, results );
+
+    //
+    // Emit the output of files done so far in order.
+    //
+    for ( ; next_emit < n_paths && results[ next_emit ].done; ++next_emit ) {
+      isolate_result_t *const r = &results[ next_emit ];
+      if ( r->out_len > 0 ) {
+        IF_EXIT(
+          fwrite( r->out, 1, r->out_len, fout ) < r->out_len, EX_IOERR
+        );
+        FFLUSH( fout );
+      }
+      if ( r->err_len > 0 )
+        PJL_IGNORE_RV( fwrite( r->err, 1, r->err_len, stderr ) );
+      if ( r->status != EX_OK && r->status != EX_DATAERR ) {
+        //
+        // The job exited because of an error that would have made cdecl exit
+        // had the file not been isolated, so exit likewise rather than go on
+        // to the files after it.
+        //
+        isolate_kill( jobs, n_jobs );
+        exit( r->status );
+      }
+      if ( r->status != EX_OK )
+        ok = false;
+      FREE( r->out );
+      FREE( r->err );
+    } // for
+  } // while
+
+  FREE( results );
+  FREE( jobs );
+  FREE( order );
+  return ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
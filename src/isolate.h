@@ -0,0 +1,102 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/isolate.h
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef cdecl_isolate_H
+#define cdecl_isolate_H
+
+/**
+ * @file
+ * Declares types and functions for processing files in isolation from each
+ * other and in parallel.
+ *
+ * Each file is processed by its own process forked after initialization, so
+ * every file starts from the same state (predefined types plus those from the
+ * configuration file) and can't see `typedef`s defined by any other file.
+ * The parser isn't reentrant, so processes are used rather than threads.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <stdbool.h>
+#include <stddef.h>                     /* for size_t */
+
+/// @endcond
+
+/**
+ * @defgroup isolate-group Isolated File Processing
+ * Types and functions for processing files in isolation from each other and
+ * in parallel.
+ * @{
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The signature for a function that parses a file.
+ *
+ * @param path The path of the file to parse; `-` means standard input.
+ * @return Returns `true` only upon success.
+ */
+typedef bool (*isolate_parse_fn_t)( char const *path );
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Gets whether the calling process is a job started by isolate_files().
+ *
+ * @remarks A job may exit via **exit**(3) from anywhere (e.g., upon a fatal
+ * error or the `quit` command), so functions called via **atexit**(3) that
+ * clean up or report on the run as a whole must do nothing in a job.
+ *
+ * @return Returns `true` only if it is.
+ */
+PJL_WARN_UNUSED_RESULT
+bool isolate_in_job( void );
+
+/**
+ * Parses files each in isolation and in parallel.
+ *
+ * @remarks Files are started largest first, one per CPU at a time, and the
+ * next file is started as soon as any finishes.  Each file's output (both
+ * normal and error) is buffered and emitted in the order given by \a paths.
+ *
+ * @param paths An array of paths of files to parse.  If any can't be opened,
+ * prints an error message and exits before any is parsed.  If parsing any
+ * fails because of an error that would make cdecl exit (e.g., an I/O error),
+ * exits with the same status after emitting the output of the files before
+ * it.
+ * @param n_paths The number of elements in \a paths.
+ * @param parse_fn The function to parse a file with.
+ * @return Returns `true` only if all files were parsed successfully.
+ */
+PJL_WARN_UNUSED_RESULT
+bool isolate_files( char const *const paths[], size_t n_paths,
+                    isolate_parse_fn_t parse_fn );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** @} */
+
+#endif /* cdecl_isolate_H */
+/* vim:set et sw=2 ts=2: */
@@ -106,7 +106,8 @@ void lexer_reset( bool hard_reset );
 /**
  * Gets the next token ID.
  *
- * @note The definition is provided by Flex.
+ * @note Common tokens are scanned by a hand-written fast path; everything
+ * else is scanned by Flex.
  *
  * @return Returns the token ID.
  */
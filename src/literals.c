@@ -52,11 +52,13 @@ char const L_EXIT[]               = "exit";
 char const L_EXPLAIN[]            = "explain";
 char const L_FUNC[]               = "func";
 char const L_FUNCTION[]           = "function";
+char const L_HEADER[]             = "header";
 char const L_HELP[]               = "help";
 char const L_INTO[]               = "into";
 char const L_LINKAGE[]            = "linkage";
 char const L_MBR[]                = "mbr";
 char const L_MEMBER[]             = "member";
+char const L_MEMORY[]             = "memory";
 char const H_NON_MBR[]            = "non-mbr";
 char const H_NON_MEMBER[]         = "non-member";
 char const L_OF[]                 = "of";
@@ -68,6 +70,7 @@ char const L_Q[]                  = "q";
 char const L_QUIT[]               = "quit";
 char const L_REF[]                = "ref";
 char const L_REFERENCE[]          = "reference";
+char const L_RELOAD[]             = "reload";
 char const L_RET[]                = "ret";
 char const L_RETURNING[]          = "returning";
 char const L_RVALUE[]             = "rvalue";
@@ -79,11 +79,13 @@ extern char const L_EXIT[];
 extern char const L_EXPLAIN[];
 extern char const L_FUNC[];               // synonym for "function"
 extern char const L_FUNCTION[];
+extern char const L_HEADER[];
 extern char const L_HELP[];
 extern char const L_INTO[];
 extern char const L_LINKAGE[];
 extern char const L_MBR[];                // synonym for "member"
 extern char const L_MEMBER[];
+extern char const L_MEMORY[];
 extern char const H_NON_MBR[];            // synonym for "non-member"
 extern char const H_NON_MEMBER[];
 extern char const L_OF[];
@@ -95,6 +97,7 @@ extern char const L_Q[];                  // synonym for "quit"
 extern char const L_QUIT[];
 extern char const L_REF[];                // synonym for "reference"
 extern char const L_REFERENCE[];
+extern char const L_RELOAD[];
 extern char const L_RET[];                // synonym for "returning"
 extern char const L_RETURNING[];
 extern char const L_RVALUE[];
@@ -28,9 +28,12 @@
 #include "options.h"
 #include "c_lang.h"
 #include "c_type.h"
+#include "c_typedef.h"
 #include "cdecl.h"
 #include "color.h"
 #include "print.h"
+#include "prompt.h"
+#include "render_plan.h"
 #include "strbuf.h"
 #include "util.h"
 
@@ -40,6 +43,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <stdnoreturn.h>
 #include <string.h>
@@ -67,9 +71,17 @@
 #define OPT_INTERACTIVE     i
 #define OPT_EXPLICIT_INT    I
 #define OPT_COLOR           k
+#define OPT_CHECKPOINT      K
+#define OPT_MEMORY_REPORT   M
+#define OPT_CHECK_ONLY      n
+#define OPT_CHECKPOINT_EVERY N
 #define OPT_OUTPUT          o
 #define OPT_NO_PROMPT       p
+#define OPT_COPROCESS       P
+#define OPT_READ_AHEAD      r
+#define OPT_RESUME          R
 #define OPT_NO_SEMICOLON    s
+#define OPT_ISOLATE_FILES   S
 #define OPT_NO_TYPEDEFS     t
 #define OPT_VERSION         v
 #define OPT_LANGUAGE        x
@@ -87,15 +99,24 @@ bool                opt_alt_tokens;
 #ifdef ENABLE_CDECL_DEBUG
 bool                opt_cdecl_debug;
 #endif /* ENABLE_CDECL_DEBUG */
+bool                opt_check_only;
+char const         *opt_checkpoint_file;
+unsigned            opt_checkpoint_every = CHECKPOINT_EVERY_DEFAULT;
 char const         *opt_conf_file;
+bool                opt_coprocess;
 bool                opt_east_const;
 bool                opt_explain;
 c_graph_t           opt_graph;
 bool                opt_interactive;
+bool                opt_isolate_files;
 c_lang_id_t         opt_lang;
+bool                opt_memory_report;
 bool                opt_no_conf;
 bool                opt_prompt = true;
+unsigned            opt_read_ahead = READ_AHEAD_DEFAULT;
+char const         *opt_resume_file;
 bool                opt_semicolon = true;
+bool                opt_typedef_hints;
 bool                opt_typedefs = true;
 
 // other extern variables
@@ -131,34 +152,42 @@ static struct option const CLI_OPTIONS_LONG[] = {
   // check_mutually_exclusive() in parse_options(), the message in usage(), and
   // the corresponding "set" option in SET_OPTIONS in set.c.
   //
-  { "alt-tokens",   no_argument,        NULL, COPT(ALT_TOKENS)    },
+  { "alt-tokens",    no_argument,        NULL, COPT(ALT_TOKENS)    },
 #ifdef YYDEBUG
-  { "bison-debug",  no_argument,        NULL, COPT(BISON_DEBUG)   },
+  { "bison-debug",   no_argument,        NULL, COPT(BISON_DEBUG)   },
 #endif /* YYDEBUG */
-  { "color",        required_argument,  NULL, COPT(COLOR)         },
-  { "config",       required_argument,  NULL, COPT(CONFIG)        },
+  { "check-only",    no_argument,        NULL, COPT(CHECK_ONLY)    },
+  { "checkpoint",    required_argument,  NULL, COPT(CHECKPOINT)    },
+  { "checkpoint-every", required_argument, NULL, COPT(CHECKPOINT_EVERY) },
+  { "color",         required_argument,  NULL, COPT(COLOR)         },
+  { "config",        required_argument,  NULL, COPT(CONFIG)        },
+  { "coprocess",     no_argument,        NULL, COPT(COPROCESS)     },
 #ifdef ENABLE_CDECL_DEBUG
-  { "debug",        no_argument,        NULL, COPT(CDECL_DEBUG)   },
+  { "debug",         no_argument,        NULL, COPT(CDECL_DEBUG)   },
 #endif /* ENABLE_CDECL_DEBUG */
-  { "digraphs",     no_argument,        NULL, COPT(DIGRAPHS)      },
-  { "east-const",   no_argument,        NULL, COPT(EAST_CONST)    },
-  { "explain",      no_argument,        NULL, COPT(EXPLAIN)       },
-  { "explicit-int", required_argument,  NULL, COPT(EXPLICIT_INT)  },
-  { "file",         required_argument,  NULL, COPT(FILE)          },
+  { "digraphs",      no_argument,        NULL, COPT(DIGRAPHS)      },
+  { "east-const",    no_argument,        NULL, COPT(EAST_CONST)    },
+  { "explain",       no_argument,        NULL, COPT(EXPLAIN)       },
+  { "explicit-int",  required_argument,  NULL, COPT(EXPLICIT_INT)  },
+  { "file",          required_argument,  NULL, COPT(FILE)          },
 #ifdef ENABLE_FLEX_DEBUG
-  { "flex-debug",   no_argument,        NULL, COPT(FLEX_DEBUG)    },
+  { "flex-debug",    no_argument,        NULL, COPT(FLEX_DEBUG)    },
 #endif /* ENABLE_FLEX_DEBUG */
-  { "help",         no_argument,        NULL, COPT(HELP)          },
-  { "interactive",  no_argument,        NULL, COPT(INTERACTIVE)   },
-  { "language",     required_argument,  NULL, COPT(LANGUAGE)      },
-  { "no-config",    no_argument,        NULL, COPT(NO_CONFIG)     },
-  { "no-prompt",    no_argument,        NULL, COPT(NO_PROMPT)     },
-  { "no-semicolon", no_argument,        NULL, COPT(NO_SEMICOLON)  },
-  { "no-typedefs",  no_argument,        NULL, COPT(NO_TYPEDEFS)   },
-  { "output",       required_argument,  NULL, COPT(OUTPUT)        },
-  { "trigraphs",    no_argument,        NULL, COPT(TRIGRAPHS)     },
-  { "version",      no_argument,        NULL, COPT(VERSION)       },
-  { NULL,           0,                  NULL, 0                   }
+  { "help",          no_argument,        NULL, COPT(HELP)          },
+  { "interactive",   no_argument,        NULL, COPT(INTERACTIVE)   },
+  { "isolate-files", no_argument,        NULL, COPT(ISOLATE_FILES) },
+  { "language",      required_argument,  NULL, COPT(LANGUAGE)      },
+  { "memory-report", no_argument,        NULL, COPT(MEMORY_REPORT) },
+  { "no-config",     no_argument,        NULL, COPT(NO_CONFIG)     },
+  { "no-prompt",     no_argument,        NULL, COPT(NO_PROMPT)     },
+  { "no-semicolon",  no_argument,        NULL, COPT(NO_SEMICOLON)  },
+  { "no-typedefs",   no_argument,        NULL, COPT(NO_TYPEDEFS)   },
+  { "output",        required_argument,  NULL, COPT(OUTPUT)        },
+  { "read-ahead",    required_argument,  NULL, COPT(READ_AHEAD)    },
+  { "resume",        required_argument,  NULL, COPT(RESUME)        },
+  { "trigraphs",     no_argument,        NULL, COPT(TRIGRAPHS)     },
+  { "version",       no_argument,        NULL, COPT(VERSION)       },
+  { NULL,            0,                  NULL, 0                   }
 };
 
 /// @cond DOXYGEN_IGNORE
@@ -183,8 +212,12 @@ static char const   CLI_OPTIONS_SHORT[] = ":"
 #ifdef ENABLE_CDECL_DEBUG
   SOPT(CDECL_DEBUG)   SOPT_NO_ARGUMENT
 #endif /* ENABLE_CDECL_DEBUG */
+  SOPT(CHECK_ONLY)    SOPT_NO_ARGUMENT
+  SOPT(CHECKPOINT)    SOPT_REQUIRED_ARGUMENT
+  SOPT(CHECKPOINT_EVERY) SOPT_REQUIRED_ARGUMENT
   SOPT(COLOR)         SOPT_REQUIRED_ARGUMENT
   SOPT(CONFIG)        SOPT_REQUIRED_ARGUMENT
+  SOPT(COPROCESS)     SOPT_NO_ARGUMENT
   SOPT(DIGRAPHS)      SOPT_NO_ARGUMENT
   SOPT(EAST_CONST)    SOPT_NO_ARGUMENT
   SOPT(EXPLAIN)       SOPT_NO_ARGUMENT
@@ -195,12 +228,16 @@ static char const   CLI_OPTIONS_SHORT[] = ":"
 #endif /* ENABLE_FLEX_DEBUG */
   SOPT(HELP)          SOPT_NO_ARGUMENT
   SOPT(INTERACTIVE)   SOPT_NO_ARGUMENT
+  SOPT(ISOLATE_FILES) SOPT_NO_ARGUMENT
   SOPT(LANGUAGE)      SOPT_REQUIRED_ARGUMENT
+  SOPT(MEMORY_REPORT) SOPT_NO_ARGUMENT
   SOPT(NO_CONFIG)     SOPT_NO_ARGUMENT
   SOPT(NO_PROMPT)     SOPT_NO_ARGUMENT
   SOPT(NO_SEMICOLON)  SOPT_NO_ARGUMENT
   SOPT(NO_TYPEDEFS)   SOPT_NO_ARGUMENT
   SOPT(OUTPUT)        SOPT_REQUIRED_ARGUMENT
+  SOPT(READ_AHEAD)    SOPT_REQUIRED_ARGUMENT
+  SOPT(RESUME)        SOPT_REQUIRED_ARGUMENT
   SOPT(TRIGRAPHS)     SOPT_NO_ARGUMENT
   SOPT(VERSION)       SOPT_NO_ARGUMENT
 ;
@@ -396,6 +433,54 @@ static c_lang_id_t parse_lang( char const *lang_name ) {
   );
 }
 
+/**
+ * Parses the number of lines between checkpoints.
+ *
+ * @param s The null-terminated string to parse.
+ * @return Returns said number or prints an error message and exits if \a s is
+ * invalid.
+ */
+PJL_WARN_UNUSED_RESULT
+static unsigned parse_checkpoint_every( char const *s ) {
+  assert( s != NULL );
+  char *end;
+  errno = 0;
+  unsigned long const n = strtoul( s, &end, 10 );
+  if ( errno == 0 && *s != '\0' && *s != '-' && *end == '\0' &&
+       n > 0 && n <= UINT_MAX ) {
+    return (unsigned)n;
+  }
+  strbuf_t opt_sbuf;
+  PMESSAGE_EXIT( EX_USAGE,
+    "\"%s\": invalid value for %s; must be 1-%u\n",
+    s, opt_format( COPT(CHECKPOINT_EVERY), &opt_sbuf ), UINT_MAX
+  );
+}
+
+/**
+ * Parses the number of files to read ahead.
+ *
+ * @param s The null-terminated string to parse.
+ * @return Returns said number or prints an error message and exits if \a s is
+ * invalid.
+ */
+PJL_WARN_UNUSED_RESULT
+static unsigned parse_read_ahead( char const *s ) {
+  assert( s != NULL );
+  char *end;
+  errno = 0;
+  unsigned long const n = strtoul( s, &end, 10 );
+  if ( errno == 0 && *s != '\0' && *s != '-' && *end == '\0' &&
+       n <= READ_AHEAD_MAX ) {
+    return (unsigned)n;
+  }
+  strbuf_t opt_sbuf;
+  PMESSAGE_EXIT( EX_USAGE,
+    "\"%s\": invalid value for %s; must be 0-%u\n",
+    s, opt_format( COPT(READ_AHEAD), &opt_sbuf ), READ_AHEAD_MAX
+  );
+}
+
 /**
  * Parses command-line options.
  *
@@ -438,6 +523,18 @@ static void parse_options( int argc, char const *argv[] ) {
       case COPT(CONFIG):
         opt_conf_file = optarg;
         break;
+      case COPT(COPROCESS):
+        opt_coprocess = true;
+        break;
+      case COPT(CHECK_ONLY):
+        opt_check_only = true;
+        break;
+      case COPT(CHECKPOINT):
+        opt_checkpoint_file = optarg;
+        break;
+      case COPT(CHECKPOINT_EVERY):
+        opt_checkpoint_every = parse_checkpoint_every( optarg );
+        break;
       case COPT(DIGRAPHS):
         opt_graph = C_GRAPH_DI;
         break;
@@ -464,9 +561,15 @@ static void parse_options( int argc, char const *argv[] ) {
       case COPT(INTERACTIVE):
         opt_interactive = true;
         break;
+      case COPT(ISOLATE_FILES):
+        opt_isolate_files = true;
+        break;
       case COPT(LANGUAGE):
         opt_lang = parse_lang( optarg );
         break;
+      case COPT(MEMORY_REPORT):
+        opt_memory_report = true;
+        break;
       case COPT(TRIGRAPHS):
         opt_graph = C_GRAPH_TRI;
         break;
@@ -485,6 +588,12 @@ static void parse_options( int argc, char const *argv[] ) {
       case COPT(OUTPUT):
         fout_path = optarg;
         break;
+      case COPT(READ_AHEAD):
+        opt_read_ahead = parse_read_ahead( optarg );
+        break;
+      case COPT(RESUME):
+        opt_resume_file = optarg;
+        break;
       case COPT(VERSION):
         print_version = true;
         break;
@@ -531,6 +640,19 @@ use_help:
   } // for
 
   check_mutually_exclusive( SOPT(DIGRAPHS), SOPT(TRIGRAPHS) );
+  check_mutually_exclusive( SOPT(COPROCESS),
+    SOPT(INTERACTIVE)
+    SOPT(ISOLATE_FILES)
+  );
+  check_mutually_exclusive( SOPT(CHECK_ONLY),
+    SOPT(INTERACTIVE)
+    SOPT(ISOLATE_FILES)
+  );
+  check_mutually_exclusive( SOPT(CHECKPOINT) SOPT(RESUME),
+    SOPT(COPROCESS)
+    SOPT(INTERACTIVE)
+    SOPT(ISOLATE_FILES)
+  );
 
   check_mutually_exclusive( SOPT(HELP),
     SOPT(ALT_TOKENS)
@@ -540,8 +662,12 @@ use_help:
 #ifdef ENABLE_CDECL_DEBUG
     SOPT(CDECL_DEBUG)
 #endif /* ENABLE_CDECL_DEBUG */
+    SOPT(CHECK_ONLY)
+    SOPT(CHECKPOINT)
+    SOPT(CHECKPOINT_EVERY)
     SOPT(COLOR)
     SOPT(CONFIG)
+    SOPT(COPROCESS)
     SOPT(DIGRAPHS)
     SOPT(EAST_CONST)
     SOPT(EXPLAIN)
@@ -551,12 +677,16 @@ use_help:
     SOPT(FLEX_DEBUG)
 #endif /* ENABLE_FLEX_DEBUG */
     SOPT(INTERACTIVE)
+    SOPT(ISOLATE_FILES)
     SOPT(LANGUAGE)
+    SOPT(MEMORY_REPORT)
     SOPT(NO_CONFIG)
     SOPT(NO_PROMPT)
     SOPT(NO_SEMICOLON)
     SOPT(NO_TYPEDEFS)
     SOPT(OUTPUT)
+    SOPT(READ_AHEAD)
+    SOPT(RESUME)
     SOPT(TRIGRAPHS)
     SOPT(VERSION)
   );
@@ -569,8 +699,12 @@ use_help:
 #ifdef ENABLE_CDECL_DEBUG
     SOPT(CDECL_DEBUG)
 #endif /* ENABLE_CDECL_DEBUG */
+    SOPT(CHECK_ONLY)
+    SOPT(CHECKPOINT)
+    SOPT(CHECKPOINT_EVERY)
     SOPT(COLOR)
     SOPT(CONFIG)
+    SOPT(COPROCESS)
     SOPT(DIGRAPHS)
     SOPT(EAST_CONST)
     SOPT(EXPLAIN)
@@ -581,18 +715,38 @@ use_help:
 #endif /* ENABLE_FLEX_DEBUG */
     SOPT(HELP)
     SOPT(INTERACTIVE)
+    SOPT(ISOLATE_FILES)
     SOPT(LANGUAGE)
+    SOPT(MEMORY_REPORT)
     SOPT(NO_CONFIG)
     SOPT(NO_PROMPT)
     SOPT(NO_SEMICOLON)
     SOPT(NO_TYPEDEFS)
     SOPT(OUTPUT)
+    SOPT(READ_AHEAD)
+    SOPT(RESUME)
     SOPT(TRIGRAPHS)
   );
 
   if ( print_usage )
     usage();
 
+  if ( opts_given[ COPT(CHECKPOINT_EVERY) ] && !opts_given[ COPT(CHECKPOINT) ] ) {
+    strbuf_t opt1_sbuf, opt2_sbuf;
+    PMESSAGE_EXIT( EX_USAGE,
+      "%s requires %s\n",
+      opt_format( COPT(CHECKPOINT_EVERY), &opt1_sbuf ),
+      opt_format( COPT(CHECKPOINT), &opt2_sbuf )
+    );
+  }
+
+  if ( opt_coprocess && optind < argc ) {
+    strbuf_t opt_sbuf;
+    PMESSAGE_EXIT( EX_USAGE,
+      "%s takes no arguments\n", opt_format( COPT(COPROCESS), &opt_sbuf )
+    );
+  }
+
   if ( print_version ) {
     if ( argc > 2 )                     // cdecl -v foo
       usage();
@@ -610,13 +764,8 @@ use_help:
   if ( fout == NULL )
     fout = stdout;
 
-  colorize = should_colorize( color_when );
-  if ( colorize ) {
-    if ( !(colors_parse( getenv( "CDECL_COLORS" ) )
-        || colors_parse( getenv( "GCC_COLORS" ) )) ) {
-      PJL_IGNORE_RV( colors_parse( COLORS_DEFAULT ) );
-    }
-  }
+  // Compact diagnostics are for machines, so never colorize them.
+  colorize = !opt_check_only && should_colorize( color_when );
 }
 
 /**
@@ -632,8 +781,12 @@ static void usage( void ) {
 #ifdef YYDEBUG
 "  --bison-debug       (-%c)  Enable Bison debug output.\n"
 #endif /* YYDEBUG */
+"  --check-only        (-%c)  Only check declarations; print compact diagnostics.\n"
+"  --checkpoint=FILE   (-%c)  Periodically save progress to FILE.\n"
+"  --checkpoint-every=N (-%c) Lines between checkpoints [default: %u].\n"
 "  --color=WHEN        (-%c)  When to colorize output [default: not_file].\n"
 "  --config=FILE       (-%c)  The configuration file [default: ~/" CONF_FILE_NAME_DEFAULT "].\n"
+"  --coprocess         (-%c)  Read framed requests; write framed responses.\n"
 #ifdef ENABLE_CDECL_DEBUG
 "  --debug             (-%c)  Enable debug output.\n"
 #endif /* ENABLE_CDECL_DEBUG */
@@ -647,12 +800,16 @@ static void usage( void ) {
 #endif /* ENABLE_FLEX_DEBUG */
 "  --help              (-%c)  Print this help and exit.\n"
 "  --interactive       (-%c)  Force interactive mode.\n"
+"  --isolate-files     (-%c)  Process each file separately and in parallel.\n"
 "  --language=LANG     (-%c)  Use LANG.\n"
+"  --memory-report     (-%c)  Print memory used by subsystem at exit.\n"
 "  --no-config         (-%c)  Suppress reading configuration file.\n"
 "  --no-prompt         (-%c)  Suppress prompt.\n"
 "  --no-semicolon      (-%c)  Suppress printing final semicolon for declarations.\n"
 "  --no-typedefs       (-%c)  Suppress predefining standard types.\n"
 "  --output=FILE       (-%c)  Write to this file [default: stdout].\n"
+"  --read-ahead=N      (-%c)  Files to read ahead [default: %u].\n"
+"  --resume=FILE       (-%c)  Resume from checkpoint FILE.\n"
 "  --trigraphs         (-%c)  Print trigraphs.\n"
 "  --version           (-%c)  Print version and exit.\n"
 "\n"
@@ -662,8 +819,12 @@ PACKAGE_NAME " home page: " PACKAGE_URL "\n",
 #ifdef YYDEBUG
     COPT(BISON_DEBUG),
 #endif /* YYDEBUG */
+    COPT(CHECK_ONLY),
+    COPT(CHECKPOINT),
+    COPT(CHECKPOINT_EVERY), CHECKPOINT_EVERY_DEFAULT,
     COPT(COLOR),
     COPT(CONFIG),
+    COPT(COPROCESS),
 #ifdef ENABLE_CDECL_DEBUG
     COPT(CDECL_DEBUG),
 #endif /* ENABLE_CDECL_DEBUG */
@@ -677,12 +838,16 @@ PACKAGE_NAME " home page: " PACKAGE_URL "\n",
 #endif /* ENABLE_FLEX_DEBUG */
     COPT(HELP),
     COPT(INTERACTIVE),
+    COPT(ISOLATE_FILES),
     COPT(LANGUAGE),
+    COPT(MEMORY_REPORT),
     COPT(NO_CONFIG),
     COPT(NO_PROMPT),
     COPT(NO_SEMICOLON),
     COPT(NO_TYPEDEFS),
     COPT(OUTPUT),
+    COPT(READ_AHEAD), READ_AHEAD_DEFAULT,
+    COPT(RESUME),
     COPT(TRIGRAPHS),
     COPT(VERSION)
   );
@@ -728,6 +893,10 @@ bool is_explicit_int( c_type_id_t tid ) {
 void parse_explicit_int( c_loc_t const *loc, char const *ei_format ) {
   assert( ei_format != NULL );
 
+  // Cached render plans and typedefs depend on which types are explicit.
+  render_plan_clear();
+  c_typedef_render_clear();
+
   c_type_id_t tid = TB_NONE;
 
   for ( char const *s = ei_format; *s != '\0'; ++s ) {
@@ -827,7 +996,9 @@ void options_init( int *pargc, char const **pargv[] ) {
   assert( pargv != NULL );
 
   me = base_name( (*pargv)[0] );
-  opt_lang = is_cppdecl( me ) ? LANG_CPP_NEW : LANG_C_NEW;
+  opt_lang = c_lang_find( is_cppdecl( me ) ? "C++" : "C" );
+  if ( opt_lang == LANG_NONE )          // only the other language is enabled
+    opt_lang = c_lang_newest( LANG_ENABLED );
 #ifdef ENABLE_FLEX_DEBUG
   //
   // When -d is specified, Flex enables debugging by default -- undo that.
@@ -840,5 +1011,58 @@ void options_init( int *pargc, char const **pargv[] ) {
   *pargv += optind;
 }
 
+void options_restore( opt_settings_t const *settings ) {
+  assert( settings != NULL );
+  opt_alt_tokens = settings->alt_tokens;
+#ifdef YYDEBUG
+  opt_bison_debug = settings->bison_debug;
+#endif /* YYDEBUG */
+#ifdef ENABLE_CDECL_DEBUG
+  opt_cdecl_debug = settings->cdecl_debug;
+#endif /* ENABLE_CDECL_DEBUG */
+  opt_east_const = settings->east_const;
+  opt_explain = settings->explain;
+  if ( opt_explicit_int[0] != settings->explicit_int[0] ||
+       opt_explicit_int[1] != settings->explicit_int[1] ) {
+    opt_explicit_int[0] = settings->explicit_int[0];
+    opt_explicit_int[1] = settings->explicit_int[1];
+    // Cached render plans and typedefs depend on which types are explicit.
+    render_plan_clear();
+    c_typedef_render_clear();
+  }
+#ifdef ENABLE_FLEX_DEBUG
+  opt_flex_debug = settings->flex_debug;
+#endif /* ENABLE_FLEX_DEBUG */
+  opt_graph = settings->graph;
+  if ( opt_lang != settings->lang )
+    c_lang_set( settings->lang );
+  cdecl_prompt_enable( settings->prompt );
+  opt_semicolon = settings->semicolon;
+  opt_typedef_hints = settings->typedef_hints;
+}
+
+void options_save( opt_settings_t *settings ) {
+  assert( settings != NULL );
+  settings->alt_tokens = opt_alt_tokens;
+#ifdef YYDEBUG
+  settings->bison_debug = opt_bison_debug;
+#endif /* YYDEBUG */
+#ifdef ENABLE_CDECL_DEBUG
+  settings->cdecl_debug = opt_cdecl_debug;
+#endif /* ENABLE_CDECL_DEBUG */
+  settings->east_const = opt_east_const;
+  settings->explain = opt_explain;
+  settings->explicit_int[0] = opt_explicit_int[0];
+  settings->explicit_int[1] = opt_explicit_int[1];
+#ifdef ENABLE_FLEX_DEBUG
+  settings->flex_debug = opt_flex_debug;
+#endif /* ENABLE_FLEX_DEBUG */
+  settings->graph = opt_graph;
+  settings->lang = opt_lang;
+  settings->prompt = cdecl_prompt_enabled();
+  settings->semicolon = opt_semicolon;
+  settings->typedef_hints = opt_typedef_hints;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /* vim:set et sw=2 ts=2: */
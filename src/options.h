@@ -49,6 +49,48 @@
 #define FOREACH_CLI_OPTION(VAR) \
   for ( struct option const *VAR = NULL; (VAR = cli_option_next( VAR )) != NULL; )
 
+/// Default number of lines between checkpoints.
+#define CHECKPOINT_EVERY_DEFAULT  1000u
+
+/// Default number of files to read ahead.
+#define READ_AHEAD_DEFAULT  8u
+
+/// Maximum number of files to read ahead.
+#define READ_AHEAD_MAX      256u
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Saved values of all the options that can be changed by the `set` command.
+ *
+ * @note When an option is added to the `set` command, it must be added here
+ * too.
+ *
+ * @sa options_restore()
+ * @sa options_save()
+ */
+struct opt_settings {
+  bool        alt_tokens;               ///< Saved \ref opt_alt_tokens.
+#ifdef YYDEBUG
+  int         bison_debug;              ///< Saved \ref opt_bison_debug.
+#endif /* YYDEBUG */
+#ifdef ENABLE_CDECL_DEBUG
+  bool        cdecl_debug;              ///< Saved \ref opt_cdecl_debug.
+#endif /* ENABLE_CDECL_DEBUG */
+  bool        east_const;               ///< Saved \ref opt_east_const.
+  bool        explain;                  ///< Saved \ref opt_explain.
+  c_type_id_t explicit_int[2];          ///< Saved explicit `int` types.
+#ifdef ENABLE_FLEX_DEBUG
+  int         flex_debug;               ///< Saved \ref opt_flex_debug.
+#endif /* ENABLE_FLEX_DEBUG */
+  c_graph_t   graph;                    ///< Saved \ref opt_graph.
+  c_lang_id_t lang;                     ///< Saved \ref opt_lang.
+  bool        prompt;                   ///< Saved prompt enablement.
+  bool        semicolon;                ///< Saved \ref opt_semicolon.
+  bool        typedef_hints;            ///< Saved \ref opt_typedef_hints.
+};
+typedef struct opt_settings opt_settings_t;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -62,15 +104,24 @@ extern bool         opt_alt_tokens;     ///< Print alternative tokens?
 #ifdef ENABLE_CDECL_DEBUG
 extern bool         opt_cdecl_debug;    ///< Print JSON-like debug output?
 #endif /* ENABLE_CDECL_DEBUG */
+extern bool         opt_check_only;     ///< Only check; don't print results?
+extern char const  *opt_checkpoint_file;///< Checkpoint file path, if any.
+extern unsigned     opt_checkpoint_every;///< Lines between checkpoints.
 extern char const  *opt_conf_file;      ///< Configuration file path.
+extern bool         opt_coprocess;      ///< Run as a coprocess?
 extern bool         opt_east_const;     ///< Print in "east const" form?
 extern bool         opt_explain;        ///< Assume `explain` if no command?
 extern c_graph_t    opt_graph;          ///< Di/Trigraph mode.
 extern bool         opt_interactive;    ///< Interactive mode?
+extern bool         opt_isolate_files;  ///< Process files in isolation?
 extern c_lang_id_t  opt_lang;           ///< Current language.
+extern bool         opt_memory_report;  ///< Print memory report at exit?
 extern bool         opt_no_conf;        ///< Do not read configuration file.
 extern bool         opt_prompt;         ///< Print the prompt?
+extern unsigned     opt_read_ahead;     ///< Number of files to read ahead.
+extern char const  *opt_resume_file;    ///< Checkpoint file to resume from.
 extern bool         opt_semicolon;      ///< Print `;` at end of gibberish?
+extern bool         opt_typedef_hints;  ///< Print equivalent `typedef`s?
 extern bool         opt_typedefs;       ///< Load C/C++ standard `typedef`s?
 
 // other extern variables
@@ -131,6 +182,22 @@ struct option const* cli_option_next( struct option const *opt );
  */
 void options_init( int *pargc, char const **pargv[] );
 
+/**
+ * Restores option settings previously saved by options_save().
+ *
+ * @param settings A pointer to the saved settings.
+ */
+void options_restore( opt_settings_t const *settings );
+
+/**
+ * Saves the current option settings.
+ *
+ * @param settings A pointer to receive the settings.
+ *
+ * @sa options_restore()
+ */
+void options_save( opt_settings_t *settings );
+
 /**
  * Parses the explicit `int` option.
  *
@@ -42,6 +42,7 @@
 #include "c_typedef.h"
 #include "cdecl.h"
 #include "color.h"
+#include "coprocess.h"
 #ifdef ENABLE_CDECL_DEBUG
 #include "dump.h"
 #endif /* ENABLE_CDECL_DEBUG */
@@ -52,6 +53,7 @@
 #include "literals.h"
 #include "options.h"
 #include "print.h"
+#include "rule_prof.h"
 #include "set_options.h"
 #include "slist.h"
 #include "types.h"
@@ -188,6 +190,11 @@
 #define IS_NESTED_TYPE_OK(TYPE_LOC) BLOCK( \
   if ( !fl_is_nested_type_ok( __FILE__, __LINE__, TYPE_LOC ) ) PARSE_ABORT(); )
 
+/**
+ * Initial capacity of an inherited attribute stack.
+ */
+#define IA_STACK_CAP_INIT         16
+
 /**
  * Aborts the current parse (presumably after an error message has been
  * printed).
@@ -343,6 +350,9 @@
  *  }
  * @endcode
  *
+ * When configured with `--enable-rule-profile`, this also starts profiling
+ * the rule's action.
+ *
  * @param NAME The grammar production name.
  * @param PROD The grammar production rule.
  *
@@ -357,10 +367,11 @@
  * @sa #DUMP_TYPE
  */
 #define DUMP_START(NAME,PROD)                           \
+  RULE_PROF_START( NAME, PROD );                        \
   bool dump_comma = false;                              \
   IF_DEBUG( PUTS( "\n" NAME " ::= " PROD " = {\n" ); )
 #else
-#define DUMP_START(NAME,PROD)     /* nothing */
+#define DUMP_START(NAME,PROD)     RULE_PROF_START( NAME, PROD )
 #endif
 
 /**
@@ -401,20 +412,6 @@
  * @{
  */
 
-/**
- * Inherited attributes.
- */
-struct in_attr {
-  c_alignas_t   align;            ///< Alignment, if any.
-  c_sname_t     current_scope;    ///< C++ only: current scope, if any.
-  slist_t       qualifier_stack;  ///< `c_qualifier` stack.
-  c_ast_list_t  type_ast_stack;   ///< Type AST stack.
-  c_ast_list_t  typedef_ast_list; ///< AST nodes of `typedef` being declared.
-  c_ast_t      *typedef_type_ast; ///< AST of `typedef` being declared.
-  bool          typename;         ///< C++ only: `typename` specified?
-};
-typedef struct in_attr in_attr_t;
-
 /**
  * Qualifier and its source location.
  */
@@ -424,6 +421,43 @@ struct c_qualifier {
 };
 typedef struct c_qualifier c_qualifier_t;
 
+/**
+ * A growable, contiguous stack of qualifiers.
+ */
+struct c_qualifier_stack {
+  c_qualifier_t  *qual;                 ///< Qualifiers; top is `qual[len-1]`.
+  size_t          len;                  ///< Number of qualifiers.
+  size_t          cap;                  ///< Capacity of \ref qual.
+};
+typedef struct c_qualifier_stack c_qualifier_stack_t;
+
+/**
+ * A growable, contiguous stack of AST pointers.
+ */
+struct c_ast_stack {
+  c_ast_t       **ast;                  ///< ASTs; top is `ast[len-1]`.
+  size_t          len;                  ///< Number of ASTs.
+  size_t          cap;                  ///< Capacity of \ref ast.
+};
+typedef struct c_ast_stack c_ast_stack_t;
+
+/**
+ * Inherited attributes.
+ *
+ * @note The stacks are only emptied (not freed) between parses so that, once
+ * they've grown large enough, pushing onto them no longer allocates memory.
+ */
+struct in_attr {
+  c_alignas_t         align;            ///< Alignment, if any.
+  c_sname_t           current_scope;    ///< C++ only: current scope, if any.
+  c_qualifier_stack_t qualifier_stack;  ///< Qualifier stack.
+  c_ast_stack_t       type_ast_stack;   ///< Type AST stack.
+  c_ast_list_t        typedef_ast_list; ///< AST nodes of `typedef` declared.
+  c_ast_t            *typedef_type_ast; ///< AST of `typedef` being declared.
+  bool                typename;         ///< C++ only: `typename` specified?
+};
+typedef struct in_attr in_attr_t;
+
 /**
  * Information for show_type_visitor().
  */
@@ -434,6 +468,17 @@ struct show_type_info {
 };
 typedef struct show_type_info show_type_info_t;
 
+/**
+ * Information for show_header_visitor().
+ */
+struct show_header_info {
+  show_type_info_t    sti;              ///< Which types to show.
+  c_typedef_t const **tdefs;            ///< Types to show so far.
+  size_t              n_tdefs;          ///< Number of types to show.
+  size_t              tdefs_cap;        ///< Capacity of \ref tdefs.
+};
+typedef struct show_header_info show_header_info_t;
+
 // local variables
 static c_ast_depth_t  ast_depth;        ///< Parentheses nesting depth.
 static bool           error_newlined = true;
@@ -485,7 +530,8 @@ static inline void gibberish_to_english( void ) {
  */
 PJL_WARN_UNUSED_RESULT
 static inline c_ast_t* ia_type_ast_peek( void ) {
-  return slist_peek_head( &in_attr.type_ast_stack );
+  c_ast_stack_t const *const stack = &in_attr.type_ast_stack;
+  return stack->len > 0 ? stack->ast[ stack->len - 1 ] : NULL;
 }
 
 /**
@@ -499,7 +545,8 @@ static inline c_ast_t* ia_type_ast_peek( void ) {
  */
 PJL_NOWARN_UNUSED_RESULT
 static inline c_ast_t* ia_type_ast_pop( void ) {
-  return slist_pop_head( &in_attr.type_ast_stack );
+  c_ast_stack_t *const stack = &in_attr.type_ast_stack;
+  return stack->len > 0 ? stack->ast[ --stack->len ] : NULL;
 }
 
 /**
@@ -512,7 +559,19 @@ static inline c_ast_t* ia_type_ast_pop( void ) {
  * @sa ia_type_ast_pop()
  */
 static inline void ia_type_ast_push( c_ast_t *ast ) {
-  slist_push_head( &in_attr.type_ast_stack, ast );
+  c_ast_stack_t *const stack = &in_attr.type_ast_stack;
+  if ( stack->len == stack->cap ) {
+    size_t const old_cap = stack->cap;
+    stack->cap = stack->cap > 0 ? stack->cap * 2 : IA_STACK_CAP_INIT;
+    // The stack is kept for reuse by later parses: see ia_free().
+    allocator_t *const prev_a = alloc_use( &alloc_libc );
+    REALLOC( stack->ast, c_ast_t*, stack->cap );
+    alloc_use( prev_a );
+    alloc_sub_add(
+      ALLOC_SUB_PARSER, old_cap == 0, (stack->cap - old_cap) * sizeof(c_ast_t*)
+    );
+  }
+  stack->ast[ stack->len++ ] = ast;
 }
 
 /**
@@ -529,7 +588,7 @@ static inline void ia_type_ast_push( c_ast_t *ast ) {
  * @sa ia_qual_push_tid()
  */
 #define ia_qual_peek_loc() \
-  (((c_qualifier_t*)slist_peek_head( &in_attr.qualifier_stack ))->loc)
+  (in_attr.qualifier_stack.qual[ in_attr.qualifier_stack.len - 1 ].loc)
 
 /**
  * Peeks at the qualifier at the top of the
@@ -543,21 +602,22 @@ static inline void ia_type_ast_push( c_ast_t *ast ) {
  */
 PJL_WARN_UNUSED_RESULT
 static inline c_type_id_t ia_qual_peek_tid( void ) {
-  c_qualifier_t const *const qual = slist_peek_head( &in_attr.qualifier_stack );
-  return qual->qual_tid;
+  c_qualifier_stack_t const *const stack = &in_attr.qualifier_stack;
+  assert( stack->len > 0 );
+  return stack->qual[ stack->len - 1 ].qual_tid;
 }
 
 /**
  * Pops a qualifier from the
- * \ref in_attr.qualifier_stack "qualifer inherited attribute stack" and frees
- * it.
+ * \ref in_attr.qualifier_stack "qualifer inherited attribute stack".
  *
  * @sa #ia_qual_peek_loc()
  * @sa ia_qual_peek_tid()
  * @sa ia_qual_push_tid()
  */
 static inline void ia_qual_pop( void ) {
-  FREE( slist_pop_head( &in_attr.qualifier_stack ) );
+  assert( in_attr.qualifier_stack.len > 0 );
+  --in_attr.qualifier_stack.len;
 }
 
 /**
@@ -593,7 +653,21 @@ static inline bool unsupported( c_lang_id_t lang_ids ) {
  * Cleans up parser data at program termination.
  */
 void parser_cleanup( void ) {
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
   c_ast_list_gc( &typedef_ast_list );
+  if ( in_attr.qualifier_stack.cap > 0 ) {
+    FREE_SUB(
+      ALLOC_SUB_PARSER, in_attr.qualifier_stack.qual,
+      in_attr.qualifier_stack.cap * sizeof(c_qualifier_t)
+    );
+  }
+  if ( in_attr.type_ast_stack.cap > 0 ) {
+    FREE_SUB(
+      ALLOC_SUB_PARSER, in_attr.type_ast_stack.ast,
+      in_attr.type_ast_stack.cap * sizeof(c_ast_t*)
+    );
+  }
+  alloc_use( prev_a );
 }
 
 ////////// local functions ////////////////////////////////////////////////////
@@ -615,16 +689,34 @@ static bool add_type( char const *decl_keyword, c_ast_t const *type_ast,
   assert( type_ast != NULL );
   assert( type_decl_loc != NULL );
 
-  c_typedef_t const *const old_tdef = c_typedef_add( type_ast );
+  //
+  // Types outlive the parse, so their ASTs must come from alloc_libc.  If the
+  // parse's ASTs come from some other allocator, the type is duplicated.
+  //
+  allocator_t *const parse_a = alloc_use( &alloc_libc );
+  c_ast_list_t dup_ast_list;
+  slist_init( &dup_ast_list );
+  c_ast_list_t *tdef_ast_list = &gc_ast_list;
+  c_ast_t const *tdef_ast = type_ast;
+  if ( parse_a != &alloc_libc ) {
+    tdef_ast = c_ast_dup( type_ast, &dup_ast_list );
+    tdef_ast_list = &dup_ast_list;
+  }
+
+  c_typedef_t const *const old_tdef = c_typedef_add( tdef_ast );
   if ( old_tdef == NULL ) {             // type was added
     //
-    // We have to move the AST from the gc_ast_list so it won't be garbage
-    // collected at the end of the parse to a separate typedef_ast_list that's
-    // freed only at program termination.
+    // We have to move the AST from its list so it won't be garbage collected
+    // at the end of the parse to a separate typedef_ast_list that's freed only
+    // at program termination.
     //
-    slist_push_list_tail( &typedef_ast_list, &gc_ast_list );
+    slist_push_list_tail( &typedef_ast_list, tdef_ast_list );
   }
-  else if ( old_tdef->ast != NULL ) {   // type exists and isn't equivalent
+  c_ast_list_gc( &dup_ast_list );       // only if the type wasn't added
+  alloc_use( parse_a );
+
+  if ( old_tdef != NULL && old_tdef->ast != NULL ) {
+    // type exists and isn't equivalent
     print_error( type_decl_loc,
       "\"%s\": \"%s\" redefinition with different type; original is: ",
       c_ast_full_name( type_ast ), decl_keyword
@@ -632,7 +724,7 @@ static bool add_type( char const *decl_keyword, c_ast_t const *type_ast,
 
     // The == works because this function is called with L_DEFINE.
     if ( decl_keyword == L_DEFINE ) {
-      c_ast_explain_type( old_tdef->ast, stderr );
+      c_typedef_english( old_tdef, stderr );
     } else {
       //
       // When printing the existing type in C/C++ as part of an error message,
@@ -749,16 +841,24 @@ static bool fl_is_nested_type_ok( char const *file, int line,
 }
 
 /**
- * Frees all resources used by \ref in_attr "inherited attributes".
+ * Frees all resources used by \ref in_attr "inherited attributes" except the
+ * memory of its stacks that are merely emptied for reuse by the next parse.
+ * Since the stacks outlive the parse, they're allocated from <code>\ref
+ * alloc_libc</code>.
  */
 static void ia_free( void ) {
   c_sname_free( &in_attr.current_scope );
-  slist_free( &in_attr.qualifier_stack, NULL, &free );
-  // Do _not_ pass &c_ast_free for the 3rd argument! All AST nodes were already
-  // free'd from the gc_ast_list in parse_cleanup(). Just free the slist nodes.
-  slist_free( &in_attr.type_ast_stack, NULL, NULL );
   c_ast_list_gc( &in_attr.typedef_ast_list );
+
+  // All AST nodes on type_ast_stack were already free'd from the gc_ast_list
+  // in parse_cleanup(), so there's nothing to free: just keep the memory.
+  c_qualifier_stack_t const qualifier_stack = in_attr.qualifier_stack;
+  c_ast_stack_t const type_ast_stack = in_attr.type_ast_stack;
   MEM_ZERO( &in_attr );
+  in_attr.qualifier_stack = (c_qualifier_stack_t){ qualifier_stack.qual, 0,
+                                                   qualifier_stack.cap };
+  in_attr.type_ast_stack = (c_ast_stack_t){ type_ast_stack.ast, 0,
+                                            type_ast_stack.cap };
 }
 
 /**
@@ -777,10 +877,20 @@ static void ia_qual_push_tid( c_type_id_t qual_tid, c_loc_t const *loc ) {
   assert( (qual_tid & c_type_id_compl( TS_MASK_QUALIFIER )) == TS_NONE );
   assert( loc != NULL );
 
-  c_qualifier_t *const qual = MALLOC( c_qualifier_t, 1 );
-  qual->qual_tid = qual_tid;
-  qual->loc = *loc;
-  slist_push_head( &in_attr.qualifier_stack, qual );
+  c_qualifier_stack_t *const stack = &in_attr.qualifier_stack;
+  if ( stack->len == stack->cap ) {
+    size_t const old_cap = stack->cap;
+    stack->cap = stack->cap > 0 ? stack->cap * 2 : IA_STACK_CAP_INIT;
+    // The stack is kept for reuse by later parses: see ia_free().
+    allocator_t *const prev_a = alloc_use( &alloc_libc );
+    REALLOC( stack->qual, c_qualifier_t, stack->cap );
+    alloc_use( prev_a );
+    alloc_sub_add(
+      ALLOC_SUB_PARSER, old_cap == 0,
+      (stack->cap - old_cap) * sizeof(c_qualifier_t)
+    );
+  }
+  stack->qual[ stack->len++ ] = (c_qualifier_t){ qual_tid, *loc };
 }
 
 /**
@@ -816,11 +926,82 @@ static void parse_init( void ) {
  * @note
  * This should be marked `noreturn` but isn't since that would generate a
  * warning that a `break` in the Bison-generated code won't be executed.
+ * @note
+ * In coprocess mode, this returns so the request containing `quit` still gets
+ * a response; coprocess() then returns.
  */
 static void quit( void ) {
+  if ( opt_coprocess ) {
+    coprocess_quit();
+    return;
+  }
   exit( EX_OK );
 }
 
+/**
+ * Checks whether a `typedef` should be shown.
+ *
+ * @param tdef The <code>\ref c_typedef</code> to check.
+ * @param sti The <code>\ref show_type_info</code> to use.
+ * @return Returns `true` only if \a tdef should be shown.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool show_type_matches( c_typedef_t const *tdef,
+                               show_type_info_t const *sti ) {
+  assert( tdef != NULL );
+  assert( sti != NULL );
+
+  bool const show_in_lang =
+    (sti->show_which & SHOW_ALL_TYPES) != 0 ||
+    (tdef->lang_ids & opt_lang) != LANG_NONE;
+
+  return show_in_lang &&
+    (sti->glob == NULL || c_sname_match( &tdef->ast->sname, sti->glob )) &&
+    (tdef->user_defined ?
+      (sti->show_which & SHOW_USER_TYPES) != 0 :
+      (sti->show_which & SHOW_PREDEFINED_TYPES) != 0);
+}
+
+/**
+ * Collects a `typedef` to print as part of a header.
+ *
+ * @param tdef The <code>\ref c_typedef</code> to collect.
+ * @param data Optional data passed to the visitor: in this case, a pointer to
+ * a <code>\ref show_header_info</code>.
+ * @return Always returns `false`.
+ *
+ * @sa c_typedef_header_gibberish()
+ */
+PJL_WARN_UNUSED_RESULT
+static bool show_header_visitor( c_typedef_t const *tdef, void *data ) {
+  assert( tdef != NULL );
+  assert( data != NULL );
+
+  show_header_info_t *const shi = data;
+  if ( show_type_matches( tdef, &shi->sti ) ) {
+    if ( shi->n_tdefs == shi->tdefs_cap ) {
+      shi->tdefs_cap = shi->tdefs_cap == 0 ? 16 : shi->tdefs_cap * 2;
+      REALLOC( shi->tdefs, c_typedef_t const*, shi->tdefs_cap );
+    }
+    shi->tdefs[ shi->n_tdefs++ ] = tdef;
+  }
+
+  return false;
+}
+
+/**
+ * Prints the definitions of `typedef`s as a header.
+ *
+ * @param show_which The bitmask of which `typedef`s to print.
+ * @param glob The glob pattern the names must match or NULL for all.
+ */
+static void show_header( unsigned show_which, char const *glob ) {
+  show_header_info_t shi = { { show_which, glob, C_GIB_TYPEDEF }, NULL, 0, 0 };
+  c_typedef_visit( &show_header_visitor, &shi );
+  c_typedef_header_gibberish( shi.tdefs, shi.n_tdefs, fout );
+  FREE( shi.tdefs );
+}
+
 /**
  * Prints the definition of a `typedef`.
  *
@@ -836,23 +1017,11 @@ static bool show_type_visitor( c_typedef_t const *tdef, void *data ) {
 
   show_type_info_t const *const sti = data;
 
-  bool const show_in_lang =
-    (sti->show_which & SHOW_ALL_TYPES) != 0 ||
-    (tdef->lang_ids & opt_lang) != LANG_NONE;
-
-  if ( show_in_lang ) {
-    bool const show_type =
-      (sti->glob == NULL || c_sname_match( &tdef->ast->sname, sti->glob )) &&
-      (tdef->user_defined ?
-        (sti->show_which & SHOW_USER_TYPES) != 0 :
-        (sti->show_which & SHOW_PREDEFINED_TYPES) != 0);
-
-    if ( show_type ) {
-      if ( sti->gib_kind == C_GIB_NONE )
-        c_ast_explain_type( tdef->ast, fout );
-      else
-        c_typedef_gibberish( tdef, sti->gib_kind, fout );
-    }
+  if ( show_type_matches( tdef, sti ) ) {
+    if ( sti->gib_kind == C_GIB_NONE )
+      c_typedef_english( tdef, fout );
+    else
+      c_typedef_gibberish( tdef, sti->gib_kind, fout );
   }
 
   return false;
@@ -883,6 +1052,9 @@ static void yyerror( char const *msg ) {
 
   c_loc_t const loc = lexer_loc();
   print_loc( &loc );
+  ++print_error_count;
+  if ( opt_check_only )                 // compact diagnostics need a severity
+    EPUTS( "error: " );
 
   SGR_START_COLOR( stderr, error );
   EPUTS( msg );                         // no newline
@@ -939,6 +1111,7 @@ static void yyerror( char const *msg ) {
 //                  Y_NAMESPACE         // covered in C++
 %token              Y_QUIT
 %token              Y_REINTERPRET
+%token              Y_RELOAD
 %token              Y_SET
 %token              Y_SHOW
 //                  Y_STATIC            // covered in K&R C
@@ -960,11 +1133,13 @@ static void yyerror( char const *msg ) {
 %token              Y_DESTRUCTOR
 %token              Y_ENGLISH
 %token              Y_FUNCTION
+%token              Y_HEADER
 %token              Y_INTO
 %token              Y_LENGTH
 %token              Y_LINKAGE
 %token              Y_LITERAL
 %token              Y_MEMBER
+%token              Y_MEMORY
 %token              Y_NON_MEMBER
 %token              Y_OF
 %token              Y_POINTER
@@ -1358,6 +1533,7 @@ static void yyerror( char const *msg ) {
 %type   <type_id>   restrict_qualifier_c_tid
 %type   <type_id>   restrict_qualifier_c_tid_opt
 %type   <type_id>   rparen_func_qualifier_list_c_tid_opt
+%type   <sname>     saved_scope_sname
 %type   <sname>     scope_sname_c_opt
 %type   <sname>     sname_c sname_c_exp sname_c_opt
 %type   <ast>       sname_c_ast
@@ -1449,6 +1625,7 @@ static void yyerror( char const *msg ) {
 %destructor { DTRACE; c_sname_free( &$$ ); } of_scope_english
 %destructor { DTRACE; c_sname_free( &$$ ); } of_scope_list_english
 %destructor { DTRACE; c_sname_free( &$$ ); } of_scope_list_english_opt
+%destructor { DTRACE; c_sname_free( &$$ ); } saved_scope_sname
 %destructor { DTRACE; c_sname_free( &$$ ); } scope_sname_c_opt
 %destructor { DTRACE; c_sname_free( &$$ ); } sname_c
 %destructor { DTRACE; c_sname_free( &$$ ); } sname_c_exp
@@ -1480,6 +1657,7 @@ command
   | explain_c semi_or_end
   | help_command semi_or_end
   | quit_command semi_or_end
+  | reload_command semi_or_end
   | scope_declaration_c
   | set_command semi_or_end
   | show_command semi_or_end
@@ -1513,7 +1691,7 @@ cast_english
       DUMP_END();
 
       bool const ok = c_ast_check_cast( $4 );
-      if ( ok ) {
+      if ( ok && !opt_check_only ) {
         FPUTC( '(', fout );
         c_ast_gibberish( $4, C_GIB_CAST, fout );
         FPRINTF( fout, ")%s\n", c_sname_full_name( &$2 ) );
@@ -1545,7 +1723,7 @@ cast_english
           "%s is not supported%s\n", $1, c_lang_which( LANG_CPP_11 )
         );
       }
-      else if ( (ok = c_ast_check_cast( $5 )) ) {
+      else if ( (ok = c_ast_check_cast( $5 )) && !opt_check_only ) {
         FPRINTF( fout, "%s<", $1 );
         c_ast_gibberish( $5, C_GIB_CAST, fout );
         FPRINTF( fout, ">(%s)\n", c_sname_full_name( &$3 ) );
@@ -1610,10 +1788,12 @@ declare_english
       DUMP_END();
 
       C_AST_CHECK_DECL( $5 );
-      c_ast_gibberish( $5, C_GIB_DECL, fout );
-      if ( opt_semicolon )
-        FPUTC( ';', fout );
-      FPUTC( '\n', fout );
+      if ( !opt_check_only ) {
+        c_ast_gibberish( $5, C_GIB_DECL, fout );
+        if ( opt_semicolon )
+          FPUTC( ';', fout );
+        FPUTC( '\n', fout );
+      }
     }
 
     /*
@@ -1640,10 +1820,12 @@ declare_english
       DUMP_END();
 
       C_AST_CHECK_DECL( $6 );
-      c_ast_gibberish( $6, C_GIB_DECL, fout );
-      if ( opt_semicolon )
-        FPUTC( ';', fout );
-      FPUTC( '\n', fout );
+      if ( !opt_check_only ) {
+        c_ast_gibberish( $6, C_GIB_DECL, fout );
+        if ( opt_semicolon )
+          FPUTC( ';', fout );
+        FPUTC( '\n', fout );
+      }
     }
 
     /*
@@ -1673,10 +1855,12 @@ declare_english
       DUMP_END();
 
       C_AST_CHECK_DECL( conv_ast );
-      c_ast_gibberish( conv_ast, C_GIB_DECL, fout );
-      if ( opt_semicolon )
-        FPUTC( ';', fout );
-      FPUTC( '\n', fout );
+      if ( !opt_check_only ) {
+        c_ast_gibberish( conv_ast, C_GIB_DECL, fout );
+        if ( opt_semicolon )
+          FPUTC( ';', fout );
+        FPUTC( '\n', fout );
+      }
     }
 
   | Y_DECLARE error
@@ -1763,7 +1947,7 @@ linkage_tid
         ok = false;
       }
 
-      free( $1 );
+      FREE( $1 );
       if ( !ok )
         PARSE_ABORT();
     }
@@ -1989,7 +2173,7 @@ explain_c
       DUMP_END();
 
       bool const ok = c_ast_check_cast( cast_ast );
-      if ( ok ) {
+      if ( ok && !opt_check_only ) {
         FPUTS( L_CAST, fout );
         if ( !c_sname_empty( &$7 ) ) {
           FPUTC( ' ', fout );
@@ -2034,7 +2218,7 @@ explain_c
       if ( unsupported( LANG_CPP_ANY ) ) {
         print_error( &@2, "%s_cast is not supported in C\n", $2 );
       }
-      else if ( (ok = c_ast_check_cast( cast_ast )) ) {
+      else if ( (ok = c_ast_check_cast( cast_ast )) && !opt_check_only ) {
         FPRINTF( fout, "%s %s ", $2, L_CAST );
         c_sname_english( &$9, fout );
         FPRINTF( fout, " %s ", L_INTO );
@@ -2099,7 +2283,8 @@ explain_c
       DUMP_END();
 
       C_AST_CHECK_DECL( $2 );
-      c_ast_explain_declaration( $2, fout );
+      if ( !opt_check_only )
+        c_ast_explain_declaration( $2, fout );
     }
 
     /*
@@ -2112,7 +2297,8 @@ explain_c
       DUMP_END();
 
       C_AST_CHECK_DECL( $2 );
-      c_ast_explain_declaration( $2, fout );
+      if ( !opt_check_only )
+        c_ast_explain_declaration( $2, fout );
     }
 
     /*
@@ -2125,7 +2311,8 @@ explain_c
       DUMP_END();
 
       C_AST_CHECK_DECL( $2 );
-      c_ast_explain_declaration( $2, fout );
+      if ( !opt_check_only )
+        c_ast_explain_declaration( $2, fout );
     }
 
     /*
@@ -2138,7 +2325,8 @@ explain_c
       DUMP_END();
 
       C_AST_CHECK_DECL( $2 );
-      c_ast_explain_declaration( $2, fout );
+      if ( !opt_check_only )
+        c_ast_explain_declaration( $2, fout );
     }
 
     /*
@@ -2161,7 +2349,8 @@ explain_c
       DUMP_END();
 
       C_AST_CHECK_DECL( $2.ast );
-      c_ast_explain_declaration( $2.ast, fout );
+      if ( !opt_check_only )
+        c_ast_explain_declaration( $2.ast, fout );
     }
 
     /*
@@ -2178,7 +2367,8 @@ explain_c
       C_TYPE_ADD_TID( &$3->type, $2, @2 );
 
       C_AST_CHECK_DECL( $3 );
-      c_ast_explain_declaration( $3, fout );
+      if ( !opt_check_only )
+        c_ast_explain_declaration( $3, fout );
     }
 
     /*
@@ -2304,7 +2494,8 @@ decl_list_c_opt
       c_ast_set_sname( type_ast, &temp_sname );
 
       C_AST_CHECK_DECL( type_ast );
-      c_ast_explain_type( type_ast, fout );
+      if ( !opt_check_only )
+        c_ast_explain_type( type_ast, fout );
     }
 
   | decl_list_c
@@ -2348,7 +2539,8 @@ decl_c
       if ( decl_ast == NULL )
         PARSE_ABORT();
       C_AST_CHECK_DECL( decl_ast );
-      c_ast_explain_declaration( decl_ast, fout );
+      if ( !opt_check_only )
+        c_ast_explain_declaration( decl_ast, fout );
 
       //
       // The type's AST takes on the name of the thing being declared, e.g.:
@@ -2405,7 +2597,32 @@ help_what_opt
 ///////////////////////////////////////////////////////////////////////////////
 
 quit_command
-  : Y_QUIT                        { quit(); }
+  : Y_QUIT
+    {
+      quit();
+      //
+      // We get here only in coprocess mode: stop parsing so nothing following
+      // "quit" is done.
+      //
+      parse_cleanup( true );
+      YYACCEPT;
+    }
+  ;
+
+///////////////////////////////////////////////////////////////////////////////
+//  reload
+///////////////////////////////////////////////////////////////////////////////
+
+reload_command
+  : Y_RELOAD
+    {
+      //
+      // The configuration file can't be parsed while we're in the middle of
+      // parsing, so just request a reload that parse_string() will do after
+      // this parse.
+      //
+      c_reload_pending = true;
+    }
   ;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2415,7 +2632,7 @@ quit_command
 asm_declaration_c
   : Y_ASM lparen_exp str_lit_exp rparen_exp
     {
-      free( $3 );
+      FREE( $3 );
       print_error( &@1,
         "%s declarations are not supported by %s\n",
         L_ASM, CDECL
@@ -2598,13 +2815,39 @@ brace_in_scope_declaration_c_opt
 
 brace_in_scope_declaration_c
   : '{' '}'
-  | '{' in_scope_declaration_c semi_opt rbrace_exp
+  | '{' in_scope_declaration_list_c rbrace_exp
+  ;
+
+in_scope_declaration_list_c
+  : in_scope_declaration_list_c in_scope_declaration_c
+  | in_scope_declaration_c
   ;
 
 in_scope_declaration_c
-  : scope_declaration_c
-  | typedef_declaration_c semi_exp
-  | using_declaration_c semi_exp
+  : saved_scope_sname scope_member_declaration_c
+    { //
+      // A nested class, namespace, struct, or union declaration leaves its
+      // scope appended to the current scope, so restore the latter for any
+      // subsequent declarations in the same scope, e.g.:
+      //
+      //      namespace N { struct S { typedef int I; }; typedef int J; }
+      //
+      c_sname_free( &in_attr.current_scope );
+      in_attr.current_scope = $1;
+    }
+  ;
+
+saved_scope_sname
+  : /* empty */
+    {
+      $$ = c_sname_dup( &in_attr.current_scope );
+    }
+  ;
+
+scope_member_declaration_c
+  : scope_declaration_c semi_opt
+  | typedef_declaration_c semi_exp semi_opt
+  | using_declaration_c semi_exp semi_opt
   ;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2625,8 +2868,8 @@ set_option
   : Y_SET_OPTION set_option_value_opt
     {
       option_set( $1, &@1, $2, &@2 );
-      free( $1 );
-      free( $2 );
+      FREE( $1 );
+      FREE( $2 );
     }
   ;
 
@@ -2653,7 +2896,7 @@ show_command
       DUMP_END();
 
       if ( $3 == C_GIB_NONE )
-        c_ast_explain_type( $2->ast, fout );
+        c_typedef_english( $2, fout );
       else
         c_typedef_gibberish( $2, $3, fout );
     }
@@ -2671,13 +2914,24 @@ show_command
   | Y_SHOW show_which_types_mask_opt glob_opt show_format_opt
     {
       c_typedef_visit( &show_type_visitor, &(show_type_info_t){ $2, $3, $4 } );
-      free( $3 );
+      FREE( $3 );
     }
 
   | Y_SHOW show_which_types_mask_opt glob_opt Y_AS show_format_exp
     {
       c_typedef_visit( &show_type_visitor, &(show_type_info_t){ $2, $3, $5 } );
-      free( $3 );
+      FREE( $3 );
+    }
+
+  | Y_SHOW show_which_types_mask_opt glob_opt Y_AS Y_HEADER
+    {
+      show_header( $2, $3 );
+      FREE( $3 );
+    }
+
+  | Y_SHOW Y_MEMORY
+    {
+      alloc_sub_print( fout );
     }
 
   | Y_SHOW Y_NAME
@@ -2695,15 +2949,15 @@ show_command
       }
       print_suggestions( DYM_C_TYPES, $2 );
       EPUTC( '\n' );
-      free( $2 );
+      FREE( $2 );
       PARSE_ABORT();
     }
 
   | Y_SHOW error
     {
       elaborate_error(
-        "type name or \"%s\", \"%s\", or \"%s\" expected",
-        L_ALL, L_PREDEFINED, L_USER
+        "type name or \"%s\", \"%s\", \"%s\", or \"%s\" expected",
+        L_ALL, L_MEMORY, L_PREDEFINED, L_USER
       );
     }
   ;
@@ -2794,6 +3048,17 @@ typedef_declaration_c
       // types: I and PI.  Hence, we keep a pristine copy and then duplicate it
       // so every type gets a pristine copy.
       //
+      // The duplicate is cheap: the base type is (almost always) a single AST
+      // node that's always modified (it gets patched, named, and added as a
+      // type), so it must be copied; but if it's a typedef, e.g.:
+      //
+      //      typedef size_t S, *PS;
+      //
+      // the AST it's a typedef for is immutable and so is shared by every
+      // duplicate rather than copied.  Only the names (the scope prepended
+      // below and the one from c_ast_dup_name()) are copied per type since
+      // every AST owns its name.
+      //
       assert( slist_empty( &in_attr.typedef_ast_list ) );
       slist_push_list_tail( &in_attr.typedef_ast_list, &gc_ast_list );
       in_attr.typedef_type_ast = $4;
@@ -2802,6 +3067,14 @@ typedef_declaration_c
     typedef_decl_list_c
     {
       ia_type_ast_pop();
+      //
+      // Every type has its own copy of the pristine AST, so it's no longer
+      // needed; and another typedef may follow in the same scope, e.g.:
+      //
+      //      namespace N { typedef int I; typedef char C; }
+      //
+      c_ast_list_gc( &in_attr.typedef_ast_list );
+      in_attr.typedef_type_ast = NULL;
     }
   ;
 
@@ -2840,9 +3113,14 @@ typedef_decl_c
         //      typedef int int32_t;
         //      typedef int32_t int_least32_t;
         //
-        // that is: any type name followed by an existing typedef name.
+        // that is: any type name followed by an existing typedef name.  The
+        // type may have been patched by declarators, e.g.:
+        //
+        //      typedef char *int32_t;
+        //
+        // so the type being defined is its root.
         //
-        typedef_ast = type_ast;
+        typedef_ast = c_ast_root( type_ast );
         if ( c_ast_empty_name( typedef_ast ) )
           typedef_ast->sname = c_ast_dup_name( $1.ast->as.tdef.for_ast );
       }
@@ -3570,9 +3848,9 @@ decl2_c_astp
   | oper_decl_c_astp
   | sname_c_ast gnu_attribute_specifier_list_c_opt
     {
-      $$ = (c_ast_pair_t){ $1, NULL };
+      $$ = (c_ast_pair_t){ $1, NULL, NULL };
     }
-  | typedef_type_decl_c_ast       { $$ = (c_ast_pair_t){ $1, NULL }; }
+  | typedef_type_decl_c_ast       { $$ = (c_ast_pair_t){ $1, NULL, NULL }; }
   | user_defined_conversion_decl_c_astp
   | user_defined_literal_decl_c_astp
   ;
@@ -3591,11 +3869,13 @@ array_decl_c_astp
       array_ast->as.array.size = $2;
       c_ast_set_parent( c_ast_new_gc( K_PLACEHOLDER, &@1 ), array_ast );
 
+      $$.tail_ast = $1.tail_ast;
       if ( $1.target_ast != NULL ) {    // array-of or function/block-ret type
         $$.ast = $1.ast;
-        $$.target_ast = c_ast_add_array( $1.target_ast, array_ast );
+        $$.target_ast =
+          c_ast_add_array( $1.target_ast, &$$.tail_ast, array_ast );
       } else {
-        $$.ast = c_ast_add_array( $1.ast, array_ast );
+        $$.ast = c_ast_add_array( $1.ast, &$$.tail_ast, array_ast );
         $$.target_ast = NULL;
       }
 
@@ -3639,6 +3919,7 @@ block_decl_c_astp                       // Apple extension
       block_ast->as.block.param_ast_list = $8;
       $$.ast = c_ast_add_func( $5.ast, ia_type_ast_peek(), block_ast );
       $$.target_ast = block_ast->as.block.ret_ast;
+      $$.tail_ast = NULL;
 
       DUMP_AST( "block_decl_c_astp", $$.ast );
       DUMP_END();
@@ -3841,6 +4122,7 @@ func_decl_c_astp
       }
 
       $$.target_ast = func_ast->as.func.ret_ast;
+      $$.tail_ast = NULL;
 
       DUMP_AST( "func_decl_c_astp", $$.ast );
       DUMP_END();
@@ -4082,6 +4364,7 @@ nested_decl_c_astp
       DUMP_AST( "decl_c_astp", $3.ast );
 
       $$ = $3;
+      $$.tail_ast = NULL;             // arrays within () are deeper anyway
 
       DUMP_AST( "nested_decl_c_astp", $$.ast );
       DUMP_END();
@@ -4134,6 +4417,7 @@ oper_decl_c_astp
       );
 
       $$.target_ast = oper_ast->as.oper.ret_ast;
+      $$.tail_ast = NULL;
 
       DUMP_AST( "oper_decl_c_astp", $$.ast );
       DUMP_END();
@@ -4305,7 +4589,15 @@ typedef_type_decl_c_ast
       DUMP_AST( "(type_c_ast)", ia_type_ast_peek() );
       DUMP_AST( "typedef_type_c_ast", $1 );
 
-      if ( c_type_is_tid_any( &ia_type_ast_peek()->type, TS_TYPEDEF ) ) {
+      //
+      // The type may already be modified by declarators, e.g., the pointer in:
+      //
+      //      typedef char *T;
+      //
+      // so look for "typedef" below it as well.
+      //
+      if ( c_ast_find_type_any( ia_type_ast_peek(), C_VISIT_DOWN,
+                                &T_TS_TYPEDEF ) != NULL ) {
         //
         // If we're defining a type, return the type as-is.
         //
@@ -4354,6 +4646,7 @@ user_defined_conversion_decl_c_astp
         c_type_or_eq( &$$.ast->type, &ia_type_ast_peek()->type );
       $$.ast->as.udef_conv.conv_ast = $5 != NULL ? $5 : $3;
       $$.target_ast = $$.ast->as.udef_conv.conv_ast;
+      $$.tail_ast = NULL;
 
       DUMP_AST( "user_defined_conversion_decl_c_astp", $$.ast );
       DUMP_END();
@@ -4390,6 +4683,7 @@ user_defined_literal_decl_c_astp
       );
 
       $$.target_ast = udl_ast->as.udef_lit.ret_ast;
+      $$.tail_ast = NULL;
 
       DUMP_AST( "user_defined_literal_decl_c_astp", $$.ast );
       DUMP_END();
@@ -5087,7 +5381,7 @@ using_opt
         "\"%s\" in attributes is not supported by %s (ignoring)\n",
         L_USING, CDECL
       );
-      free( $2 );
+      FREE( $2 );
     }
   ;
 
@@ -5165,7 +5459,7 @@ attribute_str_arg_c_opt
       print_warning( &@1,
         "attribute arguments are not supported by %s (ignoring)\n", CDECL
       );
-      free( $2 );
+      FREE( $2 );
     }
   ;
 
@@ -5215,7 +5509,7 @@ gnu_attribuet_list_c
 gnu_attribute_c
   : Y_NAME gnu_attribute_decl_arg_list_c_opt
     {
-      free( $1 );
+      FREE( $1 );
     }
   | error
     {
@@ -5239,10 +5533,10 @@ gnu_attribute_arg_list_c
   ;
 
 gnu_attribute_arg_c
-  : Y_NAME                        { free( $1 ); }
+  : Y_NAME                        { FREE( $1 ); }
   | Y_INT_LIT
-  | Y_CHAR_LIT                    { free( $1 ); }
-  | Y_STR_LIT                     { free( $1 ); }
+  | Y_CHAR_LIT                    { FREE( $1 ); }
+  | Y_STR_LIT                     { FREE( $1 ); }
   | '(' gnu_attribute_arg_list_c rparen_exp
   | Y_LEXER_ERROR
     {
@@ -5255,15 +5549,15 @@ gnu_attribute_arg_c
 ///////////////////////////////////////////////////////////////////////////////
 
 cast_c_astp_opt
-  : /* empty */                   { $$ = (c_ast_pair_t){ NULL, NULL }; }
+  : /* empty */                   { $$ = (c_ast_pair_t){ NULL, NULL, NULL }; }
   | cast_c_astp
   ;
 
 cast_c_astp
   : cast2_c_astp
-  | pointer_cast_c_ast            { $$ = (c_ast_pair_t){ $1, NULL }; }
-  | pointer_to_member_cast_c_ast  { $$ = (c_ast_pair_t){ $1, NULL }; }
-  | reference_cast_c_ast          { $$ = (c_ast_pair_t){ $1, NULL }; }
+  | pointer_cast_c_ast            { $$ = (c_ast_pair_t){ $1, NULL, NULL }; }
+  | pointer_to_member_cast_c_ast  { $$ = (c_ast_pair_t){ $1, NULL, NULL }; }
+  | reference_cast_c_ast          { $$ = (c_ast_pair_t){ $1, NULL, NULL }; }
   ;
 
 cast2_c_astp
@@ -5271,7 +5565,7 @@ cast2_c_astp
   | block_cast_c_astp
   | func_cast_c_astp
   | nested_cast_c_astp
-  | sname_c_ast                   { $$ = (c_ast_pair_t){ $1, NULL }; }
+  | sname_c_ast                   { $$ = (c_ast_pair_t){ $1, NULL, NULL }; }
 //| typedef_type_decl_c_ast             // you can't cast a type
   ;
 
@@ -5287,12 +5581,13 @@ array_cast_c_astp
 
       c_ast_set_parent( c_ast_new_gc( K_PLACEHOLDER, &@1 ), $2 );
 
+      $$.tail_ast = $1.tail_ast;
       if ( $1.target_ast != NULL ) {    // array-of or function-like-ret type
         $$.ast = $1.ast;
-        $$.target_ast = c_ast_add_array( $1.target_ast, $2 );
+        $$.target_ast = c_ast_add_array( $1.target_ast, &$$.tail_ast, $2 );
       } else {
         c_ast_t *const ast = $1.ast != NULL ? $1.ast : ia_type_ast_peek();
-        $$.ast = c_ast_add_array( ast, $2 );
+        $$.ast = c_ast_add_array( ast, &$$.tail_ast, $2 );
         $$.target_ast = NULL;
       }
 
@@ -5364,6 +5659,7 @@ block_cast_c_astp                       // Apple extension
       block_ast->as.block.param_ast_list = $8;
       $$.ast = c_ast_add_func( $5.ast, ia_type_ast_peek(), block_ast );
       $$.target_ast = block_ast->as.block.ret_ast;
+      $$.tail_ast = NULL;
 
       DUMP_AST( "block_cast_c_astp", $$.ast );
       DUMP_END();
@@ -5411,6 +5707,7 @@ func_cast_c_astp
       }
 
       $$.target_ast = func_ast->as.func.ret_ast;
+      $$.tail_ast = NULL;
 
       DUMP_AST( "func_cast_c_astp", $$.ast );
       DUMP_END();
@@ -5432,6 +5729,7 @@ nested_cast_c_astp
       DUMP_AST( "cast_c_astp_opt", $3.ast );
 
       $$ = $3;
+      $$.tail_ast = NULL;             // arrays within () are deeper anyway
 
       DUMP_AST( "nested_cast_c_astp", $$.ast );
       DUMP_END();
@@ -5636,7 +5934,7 @@ typedef_type_c_ast
 
       $$ = c_ast_new_gc( K_TYPEDEF, &@$ );
       $$->type.base_tid = TB_TYPEDEF;
-      $$->as.tdef.for_ast = $1->ast;
+      c_ast_set_typedef( $$, $1->ast );
 
       DUMP_AST( "typedef_type_c_ast", $$ );
       DUMP_END();
@@ -5884,7 +6182,7 @@ sname_english_ast
       if ( tdef != NULL ) {
         $$ = c_ast_new_gc( K_TYPEDEF, &@$ );
         $$->type.base_tid = TB_TYPEDEF;
-        $$->as.tdef.for_ast = tdef->ast;
+        c_ast_set_typedef( $$, tdef->ast );
         c_sname_free( &sname );
       } else {
         $$ = c_ast_new_gc( K_NAME, &@$ );
@@ -6102,7 +6400,7 @@ glob
     {
       if ( OPT_LANG_IS(C_ANY) && strchr( $1, ':' ) != NULL ) {
         print_error( &@1, "scoped names are not supported in C\n" );
-        free( $1 );
+        FREE( $1 );
         PARSE_ABORT();
       }
       $$ = $1;
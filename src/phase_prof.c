@@ -0,0 +1,214 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/phase_prof.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions for profiling the phases of commands.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "phase_prof.h"
+#include "cdecl.h"
+#include "isolate.h"
+#include "util.h"
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif /* HAVE_LINUX_PERF_EVENT_H */
+
+/// @endcond
+
+/// Maximum number of nested phases that are profiled.
+#define PHASE_PROF_DEPTH_MAX      16
+
+/// Number of <code>\ref phase_prof_phase</code> values.
+#define PHASE_PROF_NUM            (PHASE_PROF_RENDER + 1)
+
+// local functions
+PJL_WARN_UNUSED_RESULT
+static uint64_t phase_prof_read( void );
+
+static void     phase_prof_charge( uint64_t );
+static void     phase_prof_switch( void );
+
+// extern variable definitions
+_Thread_local bool phase_prof_enabled;
+
+/**
+ * Names of phases indexed by <code>\ref phase_prof_phase</code>.
+ */
+static char const *const PHASE_PROF_NAME[] = {
+  NULL,                                 // PHASE_PROF_NONE (not reported)
+  "lex",                                // PHASE_PROF_LEX
+  "parse",                              // PHASE_PROF_PARSE
+  "check",                              // PHASE_PROF_CHECK
+  "render",                             // PHASE_PROF_RENDER
+};
+
+// local variable definitions
+static uint64_t           phase_prof_count[ PHASE_PROF_NUM ];
+static unsigned           phase_prof_depth; ///< Index of current phase.
+static int                phase_prof_errno; ///< Why counting is unavailable.
+static int                phase_prof_fd = -1; ///< Instruction counter.
+static uint64_t           phase_prof_last;  ///< Count at last phase switch.
+static char const        *phase_prof_path;  ///< Report path, if any.
+static phase_prof_phase_t phase_prof_stack[ PHASE_PROF_DEPTH_MAX ];
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Reads the instruction counter.
+ *
+ * @return Returns the number of instructions retired so far.
+ */
+static uint64_t phase_prof_read( void ) {
+  uint64_t n;
+  IF_EXIT(
+    read( phase_prof_fd, &n, sizeof n ) != (ssize_t)sizeof n, EX_OSERR
+  );
+  return n;
+}
+
+/**
+ * Prints the profile report.
+ *
+ * @note This is called via **atexit**(3), so it must never call **exit**(3):
+ * errors are ignored.  It does nothing in a job started by isolate_files().
+ */
+static void phase_prof_report( void ) {
+  if ( isolate_in_job() )
+    return;
+  FILE *out = stderr;
+  if ( phase_prof_path[0] != '\0' &&
+       (out = fopen( phase_prof_path, "w" )) == NULL ) {
+    EPRINTF( "%s: \"%s\": %s\n", me, phase_prof_path, STRERROR() );
+    out = stderr;
+  }
+
+  if ( phase_prof_fd == -1 ) {
+    PJL_IGNORE_RV(
+      fprintf( out, "unavailable: %s\n", strerror( phase_prof_errno ) )
+    );
+  }
+  else {
+    uint64_t now;                       // charge any phase exit() left
+    if ( read( phase_prof_fd, &now, sizeof now ) == (ssize_t)sizeof now )
+      phase_prof_charge( now );
+    for ( unsigned phase = PHASE_PROF_LEX; phase < PHASE_PROF_NUM; ++phase ) {
+      PJL_IGNORE_RV(
+        fprintf( out,
+          "%s %" PRIu64 "\n", PHASE_PROF_NAME[ phase ],
+          phase_prof_count[ phase ]
+        )
+      );
+    } // for
+  }
+
+  if ( out != stderr )
+    PJL_IGNORE_RV( fclose( out ) );
+}
+
+/**
+ * Charges the instructions retired since the last switch to the current
+ * phase.
+ *
+ * @param now The current instruction count.
+ */
+static void phase_prof_charge( uint64_t now ) {
+  phase_prof_count[ phase_prof_stack[ phase_prof_depth ] ] +=
+    now - phase_prof_last;
+  phase_prof_last = now;
+}
+
+/**
+ * Reads the instruction counter and charges the instructions retired since
+ * the last switch to the current phase.
+ */
+static void phase_prof_switch( void ) {
+  phase_prof_charge( phase_prof_read() );
+}
+
+////////// extern functions ///////////////////////////////////////////////////
+
+void phase_prof_end( bool const *pushed ) {
+  assert( pushed != NULL );
+  if ( *pushed ) {
+    assert( phase_prof_depth > 0 );
+    phase_prof_switch();
+    --phase_prof_depth;
+  }
+}
+
+void phase_prof_init( void ) {
+  phase_prof_path = getenv( "CDECL_PHASE_PROFILE" );
+  if ( phase_prof_path == NULL )
+    return;
+  atexit( &phase_prof_report );
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+  struct perf_event_attr attr;
+  MEM_ZERO( &attr );
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof attr;
+  attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  phase_prof_fd = (int)syscall(
+    SYS_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, /*group_fd=*/-1,
+    PERF_FLAG_FD_CLOEXEC
+  );
+  if ( phase_prof_fd == -1 ) {
+    phase_prof_errno = errno;
+    return;
+  }
+  phase_prof_last = phase_prof_read();
+  phase_prof_enabled = true;
+#else
+  phase_prof_errno = ENOSYS;
+#endif /* HAVE_LINUX_PERF_EVENT_H */
+}
+
+bool phase_prof_start( phase_prof_phase_t phase ) {
+  assert( phase > PHASE_PROF_NONE && phase < PHASE_PROF_NUM );
+  if ( phase_prof_stack[ phase_prof_depth ] == phase ||
+       phase_prof_depth + 1 == PHASE_PROF_DEPTH_MAX ) {
+    return false;
+  }
+  phase_prof_switch();
+  phase_prof_stack[ ++phase_prof_depth ] = phase;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,128 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/phase_prof.h
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef cdecl_phase_prof_H
+#define cdecl_phase_prof_H
+
+/**
+ * @file
+ * Declares types, macros, and functions for profiling the phases of commands,
+ * i.e., counting, per phase (lexing, parsing, checking, and rendering), the
+ * number of user-space instructions retired.
+ *
+ * Unlike time, instruction counts are (nearly) deterministic, so they can be
+ * compared against budgets to catch performance regressions even on noisy
+ * machines.  Counting uses **perf_event_open**(2), hence is available only on
+ * Linux (and only if permitted).
+ *
+ * Phases nest (e.g., lexing happens during parsing), so instructions are
+ * attributed to only the innermost phase.  A phase is profiled from its
+ * #PHASE_PROF() to the end of the enclosing block by whatever means it's
+ * left.
+ *
+ * Profiling is enabled only if the `CDECL_PHASE_PROFILE` environment variable
+ * is set when phase_prof_init() is called and only for the calling thread.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <stdbool.h>
+
+/// @endcond
+
+/**
+ * @defgroup phase-prof-group Command Phase Profiling
+ * Types, macros, and functions for profiling the phases of commands.
+ * @{
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Phases of a command.
+ */
+enum phase_prof_phase {
+  PHASE_PROF_NONE,                      ///< Not in any phase.
+  PHASE_PROF_LEX,                       ///< Lexing.
+  PHASE_PROF_PARSE,                     ///< Parsing.
+  PHASE_PROF_CHECK,                     ///< Semantic checking.
+  PHASE_PROF_RENDER                     ///< Rendering English or gibberish.
+};
+typedef enum phase_prof_phase phase_prof_phase_t;
+
+/**
+ * Profiles \a PHASE until the end of the enclosing block.
+ *
+ * @param PHASE The <code>\ref phase_prof_phase</code> to profile.
+ */
+#define PHASE_PROF(PHASE)                                       \
+  bool const phase_prof_pushed __attribute__((cleanup(phase_prof_end))) = \
+    phase_prof_enabled && phase_prof_start( (PHASE) )
+
+/**
+ * Whether phase profiling is enabled for the current thread.
+ */
+extern _Thread_local bool phase_prof_enabled;
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Ends profiling a phase.
+ *
+ * @note This is called only via #PHASE_PROF().
+ *
+ * @param pushed A pointer to the value returned by phase_prof_start().
+ */
+void phase_prof_end( bool const *pushed );
+
+/**
+ * Initializes phase profiling: if the `CDECL_PHASE_PROFILE` environment
+ * variable is set, starts counting instructions for the calling thread and
+ * arranges for a report to be printed upon exit to the file it names (or to
+ * standard error if it's empty).
+ *
+ * The report has one line per phase of the form _phase_ _count_.  If counting
+ * isn't available, it instead has a single line of the form `unavailable:`
+ * _reason_.
+ */
+void phase_prof_init( void );
+
+/**
+ * Starts profiling a phase.
+ *
+ * @note This is called only via #PHASE_PROF().
+ *
+ * @param phase The phase to start.
+ * @return Returns `true` only if \a phase was pushed, i.e., it's not the
+ * current phase already.
+ */
+PJL_WARN_UNUSED_RESULT
+bool phase_prof_start( phase_prof_phase_t phase );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** @} */
+
+#endif /* cdecl_phase_prof_H */
+/* vim:set et sw=2 ts=2: */
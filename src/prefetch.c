@@ -0,0 +1,507 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/prefetch.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions for reading a sequence of files ahead of when they're
+ * needed.
+ *
+ * File _i_ is read into slot _i_ % _window_.  A file is started only once the
+ * file _window_ before it has been consumed, so its slot is free.
+ *
+ * With io_uring, everything happens on the caller's thread: opens and reads
+ * are submitted asynchronously and their completions are reaped whenever the
+ * caller asks for the next file.  Otherwise, worker threads each take the next
+ * file to start, read it via **pread**(2), then signal that its slot is done.
+ *
+ * Buffers are allocated via **malloc**(3) directly (not the current allocator)
+ * since worker threads allocate them.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "prefetch.h"
+#include "util.h"
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>                      /* for open(2) */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>                   /* for fstat(2) */
+#include <sysexits.h>
+#include <unistd.h>                     /* for close(2), pread(2) */
+
+#ifdef WITH_LIBURING
+# include <liburing.h>
+#endif /* WITH_LIBURING */
+
+/// @endcond
+
+/// Initial buffer size when a file's size can't be determined up front.
+#define PREFETCH_BUF_SIZE_DEFAULT 4096
+
+/// Maximum number of worker threads.
+#define PREFETCH_THREADS_MAX      4
+
+typedef struct prefetch_slot prefetch_slot_t;
+
+/**
+ * A slot for a file being (or having been) read.
+ */
+struct prefetch_slot {
+  prefetch_file_t file;                 ///< The file.
+  size_t          cap;                  ///< Capacity of prefetch_file::buf.
+  int             fd;                   ///< File descriptor (io_uring only).
+  bool            done;                 ///< Finished reading?
+};
+
+/**
+ * A prefetcher.
+ */
+struct prefetch {
+  char const *const  *paths;            ///< Paths of files to read.
+  size_t              n_paths;          ///< Number of paths.
+  size_t              next_consume;     ///< Index of next file to return.
+  size_t              next_start;       ///< Index of next file to start.
+  unsigned            window;           ///< Number of slots.
+  prefetch_slot_t    *slots;            ///< Slots for files being read.
+  prefetch_file_t     cur;              ///< File last returned.
+
+#ifdef WITH_LIBURING
+  bool                use_uring;        ///< Using io_uring?
+  struct io_uring     ring;             ///< The io_uring.
+  unsigned            in_flight;        ///< Number of submitted operations.
+  bool                stopping;         ///< Don't submit more operations.
+#endif /* WITH_LIBURING */
+
+  pthread_mutex_t     mutex;            ///< Protects everything below.
+  pthread_cond_t      work_cond;        ///< Signaled when a slot frees up.
+  pthread_cond_t      done_cond;        ///< Signaled when a slot is done.
+  pthread_t          *threads;          ///< Worker threads.
+  unsigned            n_threads;        ///< Number of worker threads.
+  bool                shutdown;         ///< Tells workers to exit.
+};
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Ensures a slot's buffer has room for at least one more byte.
+ *
+ * @param slot A pointer to the slot.
+ * @return Returns `true` only if successful.
+ */
+PJL_WARN_UNUSED_RESULT
+static bool prefetch_slot_grow( prefetch_slot_t *slot ) {
+  if ( slot->file.len < slot->cap )
+    return true;
+  size_t const new_cap =
+    slot->cap == 0 ? PREFETCH_BUF_SIZE_DEFAULT : slot->cap * 2;
+  char *const new_buf = realloc( slot->file.buf, new_cap );
+  if ( new_buf == NULL ) {
+    slot->file.err = ENOMEM;
+    return false;
+  }
+  slot->file.buf = new_buf;
+  slot->cap = new_cap;
+  return true;
+}
+
+/**
+ * Null-terminates a slot's buffer if the file was read successfully.  If
+ * nothing was ever read (e.g., the read was abandoned before it started), the
+ * buffer is allocated first so prefetch_file::buf is never NULL on success.
+ *
+ * @param slot A pointer to the slot.
+ */
+static void prefetch_slot_terminate( prefetch_slot_t *slot ) {
+  if ( slot->file.err == 0 && prefetch_slot_grow( slot ) )
+    slot->file.buf[ slot->file.len ] = '\0';
+}
+
+/**
+ * Reads a file entirely into a slot.
+ *
+ * @param slot A pointer to the slot whose prefetch_file::path is the file to
+ * read.
+ */
+static void prefetch_read( prefetch_slot_t *slot ) {
+  int const fd = open( slot->file.path, O_RDONLY );
+  if ( fd == -1 ) {
+    slot->file.err = errno;
+    return;
+  }
+
+  struct stat st;
+  if ( fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+    // +1 so the read that returns 0 at EOF needn't grow the buffer.
+    slot->cap = (size_t)st.st_size + 1;
+    slot->file.buf = malloc( slot->cap );
+    if ( slot->file.buf == NULL )
+      slot->cap = 0;
+  }
+
+  while ( prefetch_slot_grow( slot ) ) {
+    ssize_t const n = pread(
+      fd, slot->file.buf + slot->file.len, slot->cap - slot->file.len,
+      (off_t)slot->file.len
+    );
+    if ( n == -1 ) {
+      if ( errno == EINTR )
+        continue;
+      slot->file.err = errno;
+      break;
+    }
+    if ( n == 0 )
+      break;
+    slot->file.len += (size_t)n;
+  } // while
+
+  prefetch_slot_terminate( slot );
+  PJL_IGNORE_RV( close( fd ) );
+}
+
+/**
+ * Initializes the slot for the next file to start and advances to the file
+ * after it.
+ *
+ * @param pf A pointer to the prefetcher.
+ * @return Returns said slot.
+ */
+PJL_WARN_UNUSED_RESULT
+static prefetch_slot_t* prefetch_start_next( prefetch_t *pf ) {
+  size_t const i = pf->next_start++;
+  prefetch_slot_t *const slot = &pf->slots[ i % pf->window ];
+  *slot = (prefetch_slot_t){ .file = { .path = pf->paths[i] }, .fd = -1 };
+  return slot;
+}
+
+/**
+ * Checks whether another file can be started.
+ *
+ * @param pf A pointer to the prefetcher.
+ * @return Returns `true` only if there is another file and its slot is free.
+ */
+PJL_WARN_UNUSED_RESULT
+static inline bool prefetch_can_start( prefetch_t const *pf ) {
+  return  pf->next_start < pf->n_paths &&
+          pf->next_start < pf->next_consume + pf->window;
+}
+
+/**
+ * Checks whether \a path is `-` meaning standard input.
+ *
+ * @param path The path to check.
+ * @return Returns `true` only if it is.
+ */
+PJL_WARN_UNUSED_RESULT
+static inline bool is_stdin_path( char const *path ) {
+  return path[0] == '-' && path[1] == '\0';
+}
+
+/**
+ * Worker thread main function.
+ *
+ * @param arg A pointer to the prefetcher.
+ * @return Always returns NULL.
+ */
+static void* prefetch_thread_main( void *arg ) {
+  prefetch_t *const pf = arg;
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &pf->mutex ) );
+  for (;;) {
+    while ( !pf->shutdown && !prefetch_can_start( pf ) )
+      PJL_IGNORE_RV( pthread_cond_wait( &pf->work_cond, &pf->mutex ) );
+    if ( pf->shutdown )
+      break;
+    prefetch_slot_t *const slot = prefetch_start_next( pf );
+    PJL_IGNORE_RV( pthread_mutex_unlock( &pf->mutex ) );
+
+    if ( !is_stdin_path( slot->file.path ) )
+      prefetch_read( slot );
+
+    PJL_IGNORE_RV( pthread_mutex_lock( &pf->mutex ) );
+    slot->done = true;
+    PJL_IGNORE_RV( pthread_cond_broadcast( &pf->done_cond ) );
+  } // for
+  PJL_IGNORE_RV( pthread_mutex_unlock( &pf->mutex ) );
+
+  return NULL;
+}
+
+#ifdef WITH_LIBURING
+/**
+ * Gets a submission queue entry.  Since each slot has at most one operation
+ * in flight and the ring has at least as many entries as slots, there's
+ * always one available.
+ *
+ * @param pf A pointer to the prefetcher.
+ * @param slot A pointer to the slot the operation is for.
+ * @return Returns said entry.
+ */
+PJL_WARN_UNUSED_RESULT
+static struct io_uring_sqe* uring_get_sqe( prefetch_t *pf,
+                                           prefetch_slot_t *slot ) {
+  struct io_uring_sqe *const sqe = io_uring_get_sqe( &pf->ring );
+  assert( sqe != NULL );
+  io_uring_sqe_set_data( sqe, slot );
+  ++pf->in_flight;
+  return sqe;
+}
+
+/**
+ * Marks a slot as done, closing its file, if open.
+ *
+ * @param slot A pointer to the slot.
+ * @param err The error number or 0 if none.
+ */
+static void uring_done( prefetch_slot_t *slot, int err ) {
+  if ( slot->fd != -1 ) {
+    PJL_IGNORE_RV( close( slot->fd ) );
+    slot->fd = -1;
+  }
+  if ( slot->file.err == 0 )
+    slot->file.err = err;
+  prefetch_slot_terminate( slot );
+  slot->done = true;
+}
+
+/**
+ * Submits a read of the rest of a slot's file.
+ *
+ * @param pf A pointer to the prefetcher.
+ * @param slot A pointer to the slot.
+ */
+static void uring_read( prefetch_t *pf, prefetch_slot_t *slot ) {
+  if ( pf->stopping || !prefetch_slot_grow( slot ) ) {
+    uring_done( slot, 0 );
+    return;
+  }
+  io_uring_prep_read(
+    uring_get_sqe( pf, slot ), slot->fd, slot->file.buf + slot->file.len,
+    (unsigned)(slot->cap - slot->file.len), (__u64)slot->file.len
+  );
+}
+
+/**
+ * Starts opening as many files as there are free slots.
+ *
+ * @param pf A pointer to the prefetcher.
+ */
+static void uring_start( prefetch_t *pf ) {
+  while ( prefetch_can_start( pf ) ) {
+    prefetch_slot_t *const slot = prefetch_start_next( pf );
+    if ( is_stdin_path( slot->file.path ) )
+      slot->done = true;
+    else
+      io_uring_prep_openat(
+        uring_get_sqe( pf, slot ), AT_FDCWD, slot->file.path, O_RDONLY, 0
+      );
+  } // while
+}
+
+/**
+ * Handles the completion of an operation.
+ *
+ * @param pf A pointer to the prefetcher.
+ * @param slot A pointer to the slot the operation was for.
+ * @param res The operation's result.
+ */
+static void uring_complete( prefetch_t *pf, prefetch_slot_t *slot, int res ) {
+  --pf->in_flight;
+  if ( res < 0 ) {
+    if ( slot->fd != -1 && (res == -EINTR || res == -EAGAIN) )
+      uring_read( pf, slot );
+    else
+      uring_done( slot, -res );
+    return;
+  }
+  if ( slot->fd == -1 )                 // open completed
+    slot->fd = res;
+  else if ( res == 0 ) {                // read hit EOF
+    uring_done( slot, 0 );
+    return;
+  }
+  else
+    slot->file.len += (size_t)res;
+  uring_read( pf, slot );
+}
+
+/**
+ * Reaps completed operations and submits follow-on ones.
+ *
+ * @param pf A pointer to the prefetcher.
+ * @param until_slot If not NULL, waits until this slot is done; if NULL,
+ * doesn't wait at all.
+ */
+static void uring_reap( prefetch_t *pf, prefetch_slot_t const *until_slot ) {
+  for (;;) {
+    PJL_IGNORE_RV( io_uring_submit( &pf->ring ) );
+    struct io_uring_cqe *cqe;
+    bool const wait = until_slot != NULL && !until_slot->done;
+    int const rv = wait ?
+      io_uring_wait_cqe( &pf->ring, &cqe ) :
+      io_uring_peek_cqe( &pf->ring, &cqe );
+    if ( rv == -EINTR )
+      continue;
+    if ( rv == -EAGAIN && !wait )
+      break;
+    if ( rv < 0 ) {
+      errno = -rv;
+      perror_exit( EX_OSERR );
+    }
+    prefetch_slot_t *const slot = io_uring_cqe_get_data( cqe );
+    int const res = cqe->res;
+    io_uring_cqe_seen( &pf->ring, cqe );
+    uring_complete( pf, slot, res );
+  } // for
+}
+#endif /* WITH_LIBURING */
+
+////////// extern functions ///////////////////////////////////////////////////
+
+void prefetch_free( prefetch_t *pf ) {
+  if ( pf == NULL )
+    return;
+
+#ifdef WITH_LIBURING
+  if ( pf->use_uring ) {
+    pf->stopping = true;
+    while ( pf->in_flight > 0 ) {
+      struct io_uring_cqe *cqe;
+      int const rv = io_uring_wait_cqe( &pf->ring, &cqe );
+      if ( rv == -EINTR )
+        continue;
+      if ( rv < 0 )
+        break;
+      prefetch_slot_t *const slot = io_uring_cqe_get_data( cqe );
+      int const res = cqe->res;
+      io_uring_cqe_seen( &pf->ring, cqe );
+      uring_complete( pf, slot, res );
+    } // while
+    io_uring_queue_exit( &pf->ring );
+  }
+#endif /* WITH_LIBURING */
+
+  if ( pf->n_threads > 0 ) {
+    PJL_IGNORE_RV( pthread_mutex_lock( &pf->mutex ) );
+    pf->shutdown = true;
+    PJL_IGNORE_RV( pthread_cond_broadcast( &pf->work_cond ) );
+    PJL_IGNORE_RV( pthread_mutex_unlock( &pf->mutex ) );
+    for ( unsigned i = 0; i < pf->n_threads; ++i )
+      PJL_IGNORE_RV( pthread_join( pf->threads[i], NULL ) );
+    FREE( pf->threads );
+  }
+
+  for ( size_t i = pf->next_consume; i < pf->next_start; ++i )
+    free( pf->slots[ i % pf->window ].file.buf );
+  free( pf->cur.buf );
+
+  PJL_IGNORE_RV( pthread_cond_destroy( &pf->done_cond ) );
+  PJL_IGNORE_RV( pthread_cond_destroy( &pf->work_cond ) );
+  PJL_IGNORE_RV( pthread_mutex_destroy( &pf->mutex ) );
+  FREE( pf->slots );
+  FREE( pf );
+}
+
+prefetch_t* prefetch_new( char const *const paths[], size_t n_paths,
+                          unsigned window ) {
+  assert( paths != NULL );
+  assert( window > 0 );
+
+  prefetch_t *const pf = MALLOC( prefetch_t, 1 );
+  MEM_ZERO( pf );
+  pf->paths = paths;
+  pf->n_paths = n_paths;
+  pf->window = window;
+  pf->slots = MALLOC( prefetch_slot_t, window );
+  IF_EXIT( (errno = pthread_mutex_init( &pf->mutex, NULL )) != 0, EX_OSERR );
+  IF_EXIT( (errno = pthread_cond_init( &pf->work_cond, NULL )) != 0,
+           EX_OSERR );
+  IF_EXIT( (errno = pthread_cond_init( &pf->done_cond, NULL )) != 0,
+           EX_OSERR );
+
+#ifdef WITH_LIBURING
+  //
+  // If io_uring isn't available at run-time (e.g., an old kernel or it's
+  // disabled in a container), fall back to threads.
+  //
+  pf->use_uring = io_uring_queue_init( window, &pf->ring, 0 ) == 0;
+  if ( pf->use_uring ) {
+    uring_start( pf );
+    uring_reap( pf, NULL );
+    return pf;
+  }
+#endif /* WITH_LIBURING */
+
+  unsigned n_threads = window < PREFETCH_THREADS_MAX ?
+    window : PREFETCH_THREADS_MAX;
+  if ( n_threads > n_paths )
+    n_threads = (unsigned)n_paths;
+  pf->threads = MALLOC( pthread_t, n_threads );
+  for ( ; pf->n_threads < n_threads; ++pf->n_threads ) {
+    errno = pthread_create(
+      &pf->threads[ pf->n_threads ], NULL, &prefetch_thread_main, pf
+    );
+    IF_EXIT( errno != 0, EX_OSERR );
+  } // for
+
+  return pf;
+}
+
+prefetch_file_t const* prefetch_next( prefetch_t *pf ) {
+  assert( pf != NULL );
+
+  free( pf->cur.buf );
+  pf->cur.buf = NULL;
+  if ( pf->next_consume == pf->n_paths )
+    return NULL;
+
+  prefetch_slot_t *const slot = &pf->slots[ pf->next_consume % pf->window ];
+
+#ifdef WITH_LIBURING
+  if ( pf->use_uring ) {
+    uring_reap( pf, slot );
+    pf->cur = slot->file;
+    ++pf->next_consume;
+    uring_start( pf );
+    uring_reap( pf, NULL );
+    return &pf->cur;
+  }
+#endif /* WITH_LIBURING */
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &pf->mutex ) );
+  while ( pf->next_start <= pf->next_consume || !slot->done )
+    PJL_IGNORE_RV( pthread_cond_wait( &pf->done_cond, &pf->mutex ) );
+  pf->cur = slot->file;
+  ++pf->next_consume;
+  PJL_IGNORE_RV( pthread_cond_broadcast( &pf->work_cond ) );
+  PJL_IGNORE_RV( pthread_mutex_unlock( &pf->mutex ) );
+
+  return &pf->cur;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
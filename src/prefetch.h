@@ -0,0 +1,110 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/prefetch.h
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef cdecl_prefetch_H
+#define cdecl_prefetch_H
+
+/**
+ * @file
+ * Declares types and functions for reading a sequence of files ahead of when
+ * they're needed.
+ *
+ * While the caller processes one file, the next few files in the sequence
+ * (the _window_) are opened and read in the background.  If cdecl was
+ * configured `--with-liburing` and io_uring is available at run-time, it's
+ * used; otherwise, a small pool of threads is.  Either way, files are returned
+ * strictly in order.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <stddef.h>                     /* for size_t */
+
+/// @endcond
+
+/**
+ * @defgroup prefetch-group File Prefetching
+ * Types and functions for reading a sequence of files ahead of when they're
+ * needed.
+ * @{
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct prefetch       prefetch_t;
+typedef struct prefetch_file  prefetch_file_t;
+
+/**
+ * A prefetched file.
+ */
+struct prefetch_file {
+  char const *path;                     ///< The file's path.
+  char       *buf;                      ///< Null-terminated contents.
+  size_t      len;                      ///< Length of \a buf.
+  int         err;                      ///< Error number or 0 if none.
+};
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Frees a prefetcher, waiting for any files being read to finish first.
+ *
+ * @param pf A pointer to the prefetcher to free.  If NULL, does nothing.
+ */
+void prefetch_free( prefetch_t *pf );
+
+/**
+ * Creates a new prefetcher.
+ *
+ * @param paths An array of paths of files to read.  A path of `-` is not read
+ * and is returned as-is so the caller can read standard input itself.  The
+ * array must remain valid until prefetch_free() is called.
+ * @param n_paths The number of elements in \a paths.
+ * @param window The maximum number of files to read ahead; must be &gt; 0.
+ * @return Returns said prefetcher.
+ *
+ * @sa prefetch_free()
+ * @sa prefetch_next()
+ */
+PJL_WARN_UNUSED_RESULT
+prefetch_t* prefetch_new( char const *const paths[], size_t n_paths,
+                          unsigned window );
+
+/**
+ * Gets the next file in order, waiting for it to be read, if necessary.
+ *
+ * @param pf A pointer to the prefetcher.
+ * @return Returns a pointer to said file (valid only until the next call to
+ * this function or prefetch_free()) or NULL if there are no more files.  If
+ * the file could not be opened or read, prefetch_file::err is set.
+ */
+PJL_WARN_UNUSED_RESULT
+prefetch_file_t const* prefetch_next( prefetch_t *pf );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** @} */
+
+#endif /* cdecl_prefetch_H */
+/* vim:set et sw=2 ts=2: */
@@ -50,8 +50,14 @@
 extern char const        *command_line;
 extern size_t             command_line_len;
 extern size_t             inserted_len;
+extern char const        *input_path;
+extern unsigned           input_lineno;
 extern bool               is_input_a_tty;
 
+// extern variable definitions
+size_t                    print_error_count;
+size_t                    print_warning_count;
+
 /// @cond DOXYGEN_IGNORE
 
 // local constants
@@ -242,6 +248,7 @@ void fl_print_error( char const *file, int line, c_loc_t const *loc,
   assert( format != NULL );
 
   if ( loc != NULL ) {
+    ++print_error_count;
     print_loc( loc );
     SGR_START_COLOR( stderr, error );
     EPUTS( "error" );
@@ -304,6 +311,7 @@ void fl_print_warning( char const *file, int line, c_loc_t const *loc,
   assert( file != NULL );
   assert( format != NULL );
 
+  ++print_warning_count;
   if ( loc != NULL )
     print_loc( loc );
   SGR_START_COLOR( stderr, warning );
@@ -319,6 +327,14 @@ void fl_print_warning( char const *file, int line, c_loc_t const *loc,
   va_end( args );
 }
 
+void print_check_summary( void ) {
+  EPRINTF( "%s: %zu error%s, %zu warning%s\n",
+    me,
+    print_error_count, print_error_count == 1 ? "" : "s",
+    print_warning_count, print_warning_count == 1 ? "" : "s"
+  );
+}
+
 void print_debug_file_line( char const *file, int line ) {
   assert( file != NULL );
 #ifdef ENABLE_CDECL_DEBUG
@@ -342,13 +358,27 @@ void print_hint( char const *format, ... ) {
 
 void print_loc( c_loc_t const *loc ) {
   assert( loc != NULL );
+  size_t column = (size_t)loc->first_column;
+  if ( column >= inserted_len )
+    column -= inserted_len;
+
+  if ( opt_check_only ) {
+    //
+    // Print compact diagnostics in the conventional path:line:column form
+    // without the input line and caret.
+    //
+    if ( opt_conf_file != NULL )
+      EPRINTF( "%s:%d:", opt_conf_file, loc->first_line + 1 );
+    else
+      EPRINTF( "%s:%u:", input_path, input_lineno );
+    EPRINTF( "%zu: ", column + 1 );
+    return;
+  }
+
   print_caret( (size_t)loc->first_column );
   SGR_START_COLOR( stderr, locus );
   if ( opt_conf_file != NULL )
     EPRINTF( "%s:%d,", opt_conf_file, loc->first_line + 1 );
-  size_t column = (size_t)loc->first_column;
-  if ( column >= inserted_len )
-    column -= inserted_len;
   EPRINTF( "%zu", column + 1 );
   SGR_END_COLOR( stderr );
   EPUTS( ": " );
@@ -33,6 +33,7 @@
 
 // standard
 #include <stdbool.h>
+#include <stddef.h>                     /* for size_t */
 
 /**
  * @defgroup printing-errors-warnings-group Printing Hints, Errors, & Warnings
@@ -82,6 +83,10 @@
 #define print_warning(...) \
   fl_print_warning( __FILE__, __LINE__, __VA_ARGS__ )
 
+// extern variables
+extern size_t print_error_count;        ///< Number of errors printed.
+extern size_t print_warning_count;      ///< Number of warnings printed.
+
 ////////// extern functions ///////////////////////////////////////////////////
 
 /**
@@ -90,6 +95,9 @@
  * from.
  *
  * @note
+ * If \a loc is not NULL, this counts as an error for print_check_summary().
+ *
+ * @note
  * This function isn't normally called directly; use the #print_error() macro
  * instead.
  *
@@ -163,6 +171,13 @@ void fl_print_warning( char const *file, int line, c_loc_t const *loc,
  */
 void print_debug_file_line( char const *file, int line );
 
+/**
+ * Prints the number of errors and warnings printed so far to standard error.
+ *
+ * @note This is used only for `--check-only`.
+ */
+void print_check_summary( void );
+
 /**
  * Prints a help message.
  *
@@ -192,6 +207,9 @@ void print_hint( char const *format, ... );
  *  + A `^` (in color, if possible and requested) under the offending token.
  *  + The error column.
  *
+ * If `--check-only` was given, prints only the location in the compact form
+ * of _path_`:`_line_`:`_column_`: ` instead.
+ *
  * @note
  * A newline is _not_ printed.
  *
@@ -53,11 +53,15 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
-// extern variable definitions
-char const         *cdecl_prompt[2];
-
 // local variable definitions
 static char        *prompt_buf[2];      ///< Buffers for prompts.
+static bool         prompt_enabled = true;  ///< Is the prompt enabled?
+
+/**
+ * Whether \ref prompt_buf was created for C (vs. C++); only meaningful when
+ * \ref prompt_buf is non-NULL.
+ */
+static bool         prompt_is_c;
 
 ////////// inline functions ///////////////////////////////////////////////////
 
@@ -100,7 +104,7 @@ static char* prompt_create( char suffix ) {
   strbuf_init( &sbuf );
 
 #ifdef WITH_READLINE
-  if ( have_genuine_gnu_readline() && sgr_prompt != NULL ) {
+  if ( have_genuine_gnu_readline() && colorize && SGR_COLOR(prompt) != NULL ) {
     strbuf_catc( &sbuf, RL_PROMPT_START_IGNORE );
     SGR_STRBUF_START_COLOR( &sbuf, prompt );
     strbuf_catc( &sbuf, RL_PROMPT_END_IGNORE );
@@ -110,7 +114,7 @@ static char* prompt_create( char suffix ) {
   strbuf_catf( &sbuf, "%s%c", OPT_LANG_IS(C_ANY) ? CDECL : CPPDECL, suffix );
 
 #ifdef WITH_READLINE
-  if ( have_genuine_gnu_readline() && sgr_prompt != NULL ) {
+  if ( have_genuine_gnu_readline() && colorize && SGR_COLOR(prompt) != NULL ) {
     strbuf_catc( &sbuf, RL_PROMPT_START_IGNORE );
     SGR_STRBUF_END_COLOR( &sbuf );
     strbuf_catc( &sbuf, RL_PROMPT_END_IGNORE );
@@ -124,20 +128,33 @@ static char* prompt_create( char suffix ) {
 ////////// extern functions ///////////////////////////////////////////////////
 
 void cdecl_prompt_enable( bool enable ) {
-  if ( enable ) {
-    cdecl_prompt[0] = prompt_buf[0];
-    cdecl_prompt[1] = prompt_buf[1];
-  } else {
-    cdecl_prompt[0] = cdecl_prompt[1] = "";
-  }
+  prompt_enabled = enable;
 }
 
-void cdecl_prompt_init( void ) {
-  free( prompt_buf[0] );
-  free( prompt_buf[1] );
+bool cdecl_prompt_enabled( void ) {
+  return prompt_enabled;
+}
 
-  cdecl_prompt[0] = prompt_buf[0] = prompt_create( '>' );
-  cdecl_prompt[1] = prompt_buf[1] = prompt_create( '+' );
+char const* cdecl_prompt_get( bool is_cont ) {
+  if ( !prompt_enabled )
+    return "";
+
+  //
+  // The prompt depends on the current language, so (re)create the prompts
+  // only upon first use or a change between C and C++.  This means one-shot
+  // command-line invocations never create them at all.
+  //
+  bool const is_c = OPT_LANG_IS(C_ANY);
+  if ( prompt_buf[0] == NULL || is_c != prompt_is_c ) {
+    allocator_t *const prev_a = alloc_use( &alloc_libc );
+    FREE( prompt_buf[0] );
+    FREE( prompt_buf[1] );
+    prompt_buf[0] = prompt_create( '>' );
+    prompt_buf[1] = prompt_create( '+' );
+    alloc_use( prev_a );
+    prompt_is_c = is_c;
+  }
+  return prompt_buf[ is_cont ];
 }
 
 ///////////////////////////////////////////////////////////////////////////////
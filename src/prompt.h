@@ -44,32 +44,41 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
-/**
- * The prompt strings:
- *
- *  + 0 = The primary prompt.
- *  + 1 = The secondary prompt (used for continuation lines).
- *
- * @note These may contain SGR color codes.
- */
-extern char const  *cdecl_prompt[2];
-
 ////////// extern functions ///////////////////////////////////////////////////
 
 /**
  * Enables or disables the prompt.
  *
  * @param enable If `true`, enables the prompt; else disables it.
+ *
+ * @sa cdecl_prompt_enabled()
  */
 void cdecl_prompt_enable( bool enable );
 
 /**
- * Initializes the prompt.
+ * Gets whether the prompt is enabled.
+ *
+ * @return Returns `true` only if the prompt is enabled.
+ *
+ * @sa cdecl_prompt_enable()
+ */
+PJL_WARN_UNUSED_RESULT
+bool cdecl_prompt_enabled( void );
+
+/**
+ * Gets a prompt for the current language, creating it upon first use.
+ *
+ * @note This is called `cdecl_prompt_get` and not `prompt_get` so as to be
+ * consistent with the other functions that can't be called `prompt_*` so as
+ * not to conflict with functions in `libedit`.
  *
- * @note This is called `cdecl_prompt_init` and not `prompt_init` so as not to
- * conflict with the latter function in `libedit`.
+ * @param is_cont If `true`, gets the secondary prompt (used for continuation
+ * lines); otherwise gets the primary prompt.
+ * @return Returns said prompt (that may contain SGR color codes) or the empty
+ * string if the prompt is disabled.
  */
-void cdecl_prompt_init( void );
+PJL_WARN_UNUSED_RESULT
+char const* cdecl_prompt_get( bool is_cont );
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,681 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/rcu_set.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions for manipulating read-mostly ordered sets.
+ *
+ * Reclamation works as follows.  There is a global epoch counter and a table
+ * of reader slots.  The first time a thread reads, it claims a slot.  While
+ * reading, its slot holds the epoch at the time the read began; otherwise 0.
+ * When a writer publishes a new version, it retires the old one stamped with
+ * the then-current epoch and increments the epoch.  A reader that could still
+ * be using a retired version must have begun reading no later than that
+ * epoch, so a retired version can be freed once no slot holds a non-zero
+ * epoch &le; its stamp.  Threads beyond the number of slots fall back to a
+ * shared counter of such readers; while it's non-zero, nothing is freed.
+ *
+ * All atomic operations are sequentially consistent: a reader's slot store
+ * precedes its load of the version, and a writer's version exchange precedes
+ * its scan of the slots.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "rcu_set.h"
+#include "util.h"
+
+// standard
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>                     /* for memcpy(3) */
+
+/// Maximum number of threads that can read concurrently using reader slots.
+#define RCU_READERS_MAX           64
+
+/// Size of a cache line so each reader slot gets its own.
+#define RCU_CACHE_LINE_SIZE       64
+
+/**
+ * Data removed from a set that's freed once no reader can still be using it.
+ */
+struct rcu_retired {
+  void             *data;               ///< The removed data.
+  rcu_data_free_t   data_free_fn;       ///< Frees \ref data, if not NULL.
+};
+
+/**
+ * An immutable version of a set.
+ */
+struct rcu_set_version {
+  rcu_set_version_t  *next_retired;     ///< Next retired version, if any.
+  uint_fast64_t       retired_epoch;    ///< Epoch at which it was retired.
+  rcu_retired_t      *retired_data;     ///< Data removed by its successor.
+  size_t              n_retired_data;   ///< Number of \ref retired_data.
+  size_t              len;              ///< Number of elements.
+  void               *data[];           ///< Sorted data.
+};
+
+/**
+ * An in-order cursor over either a version of a set or, if the set is in the
+ * calling thread's batch, the batch.
+ */
+struct rcu_cursor {
+  rcu_set_version_t const  *v;          ///< Version or NULL for the batch.
+  size_t                    i;          ///< Index of the next element of \ref v.
+  rb_iter_t                 iter;       ///< Iterator over the batch.
+};
+typedef struct rcu_cursor rcu_cursor_t;
+
+/**
+ * A reader slot.
+ */
+struct rcu_reader {
+  /// Epoch at which the current outermost read began or 0 if not reading.
+  _Atomic uint_fast64_t epoch;
+
+  _Atomic bool          in_use;         ///< Claimed by a thread?
+
+  /// Pads the slot to a cache line to prevent false sharing.
+  char pad[ RCU_CACHE_LINE_SIZE - sizeof(uint_fast64_t) - sizeof(bool) ];
+};
+typedef struct rcu_reader rcu_reader_t;
+
+// local variables
+static _Atomic uint_fast64_t  rcu_epoch = 1;
+static _Atomic unsigned       rcu_overflow_readers;
+static rcu_reader_t           rcu_readers[ RCU_READERS_MAX ];
+static pthread_key_t          rcu_reader_key;
+static pthread_once_t         rcu_reader_key_once = PTHREAD_ONCE_INIT;
+
+/// This thread's reader slot, if any.
+static _Thread_local rcu_reader_t  *rcu_this_reader;
+
+/// Whether this thread has tried to claim a reader slot.
+static _Thread_local bool           rcu_this_reader_claimed;
+
+/// Read nesting depth of this thread (for visitors that read).
+static _Thread_local unsigned       rcu_this_read_depth;
+
+/// The set this thread has a batch for, if any.
+static _Thread_local rcu_set_t     *rcu_this_batch;
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Releases a thread's reader slot when the thread exits.
+ *
+ * @param data A pointer to the reader slot.
+ */
+static void rcu_reader_release( void *data ) {
+  rcu_reader_t *const reader = data;
+  atomic_store( &reader->epoch, 0 );
+  atomic_store( &reader->in_use, false );
+}
+
+/**
+ * Creates the key whose destructor releases a thread's reader slot.
+ */
+static void rcu_reader_key_create( void ) {
+  IF_EXIT(
+    (errno = pthread_key_create( &rcu_reader_key, &rcu_reader_release )) != 0,
+    EX_OSERR
+  );
+}
+
+/**
+ * Claims a reader slot for this thread, if one is available.
+ *
+ * @return Returns said slot or NULL if all slots are in use.
+ */
+PJL_WARN_UNUSED_RESULT
+static rcu_reader_t* rcu_reader_claim( void ) {
+  pthread_once( &rcu_reader_key_once, &rcu_reader_key_create );
+  for ( size_t i = 0; i < RCU_READERS_MAX; ++i ) {
+    rcu_reader_t *const reader = &rcu_readers[i];
+    bool expected = false;
+    if ( atomic_compare_exchange_strong( &reader->in_use, &expected, true ) ) {
+      PJL_IGNORE_RV( pthread_setspecific( rcu_reader_key, reader ) );
+      return reader;
+    }
+  } // for
+  return NULL;
+}
+
+/**
+ * Begins a read of \a set.
+ *
+ * @param set A pointer to the set to read.
+ * @return Returns the current version of \a set that may be used until
+ * rcu_read_end() is called.
+ */
+PJL_WARN_UNUSED_RESULT
+static rcu_set_version_t const* rcu_read_begin( rcu_set_t const *set ) {
+  if ( rcu_this_read_depth++ == 0 ) {
+    if ( !rcu_this_reader_claimed ) {
+      rcu_this_reader = rcu_reader_claim();
+      rcu_this_reader_claimed = true;
+    }
+    if ( rcu_this_reader != NULL )
+      atomic_store( &rcu_this_reader->epoch, atomic_load( &rcu_epoch ) );
+    else
+      atomic_fetch_add( &rcu_overflow_readers, 1 );
+  }
+  rcu_set_t *const nonconst_set = CONST_CAST( rcu_set_t*, set );
+  return atomic_load( &nonconst_set->version );
+}
+
+/**
+ * Ends a read begun by rcu_read_begin().
+ */
+static void rcu_read_end( void ) {
+  assert( rcu_this_read_depth > 0 );
+  if ( --rcu_this_read_depth == 0 ) {
+    if ( rcu_this_reader != NULL )
+      atomic_store( &rcu_this_reader->epoch, 0 );
+    else
+      atomic_fetch_sub( &rcu_overflow_readers, 1 );
+  }
+}
+
+/**
+ * Gets the number of bytes allocated for a version.
+ *
+ * @param len The number of elements.
+ * @return Returns said number of bytes.
+ */
+PJL_WARN_UNUSED_RESULT
+static inline size_t rcu_set_version_size( size_t len ) {
+  return sizeof(rcu_set_version_t) + len * sizeof(void*);
+}
+
+/**
+ * Frees a retired version of \a set and the data removed by its successor,
+ * if any.
+ *
+ * @param set A pointer to the set.
+ * @param v A pointer to the version to free.
+ */
+static void rcu_set_version_free( rcu_set_t *set, rcu_set_version_t *v ) {
+  for ( size_t i = 0; i < v->n_retired_data; ++i ) {
+    rcu_retired_t const *const r = &v->retired_data[i];
+    if ( r->data_free_fn != NULL )
+      (*r->data_free_fn)( r->data );
+  } // for
+  if ( v->retired_data != NULL )
+    (*set->alloc->free_fn)( set->alloc, v->retired_data );
+  alloc_sub_remove( ALLOC_SUB_RCU_SET, 1, rcu_set_version_size( v->len ) );
+  (*set->alloc->free_fn)( set->alloc, v );
+}
+
+/**
+ * Frees retired versions of \a set that no reader can still be using.
+ * The caller must hold the set's write mutex.
+ *
+ * @param set A pointer to the set.
+ */
+static void rcu_set_reclaim( rcu_set_t *set ) {
+  if ( set->retired == NULL || atomic_load( &rcu_overflow_readers ) > 0 )
+    return;
+
+  uint_fast64_t min_epoch = UINT_FAST64_MAX;
+  for ( size_t i = 0; i < RCU_READERS_MAX; ++i ) {
+    uint_fast64_t const epoch = atomic_load( &rcu_readers[i].epoch );
+    if ( epoch != 0 && epoch < min_epoch )
+      min_epoch = epoch;
+  } // for
+
+  for ( rcu_set_version_t **pv = &set->retired; *pv != NULL; ) {
+    rcu_set_version_t *const v = *pv;
+    if ( v->retired_epoch < min_epoch ) {
+      *pv = v->next_retired;
+      rcu_set_version_free( set, v );
+    } else {
+      pv = &v->next_retired;
+    }
+  } // for
+}
+
+/**
+ * Publishes \a new_v as the current version of \a set and retires the
+ * previous one.  The caller must hold the set's write mutex.
+ *
+ * @param set A pointer to the set.
+ * @param new_v A pointer to the new version.
+ * @param retired_data An array of the data no longer in \a set allocated by
+ * \a set's allocator or NULL if none.  Ownership is taken.
+ * @param n_retired_data The number of elements of \a retired_data.
+ */
+static void rcu_set_publish( rcu_set_t *set, rcu_set_version_t *new_v,
+                             rcu_retired_t *retired_data,
+                             size_t n_retired_data ) {
+  rcu_set_version_t *const old_v = atomic_exchange( &set->version, new_v );
+  old_v->retired_epoch = atomic_fetch_add( &rcu_epoch, 1 );
+  old_v->retired_data = retired_data;
+  old_v->n_retired_data = n_retired_data;
+  old_v->next_retired = set->retired;
+  set->retired = old_v;
+  rcu_set_reclaim( set );
+}
+
+/**
+ * Publishes \a new_v as the current version of \a set and retires the
+ * previous one along with one datum no longer in \a set.  The caller must
+ * hold the set's write mutex.
+ *
+ * @param set A pointer to the set.
+ * @param new_v A pointer to the new version.
+ * @param old_data The data no longer in \a set.
+ * @param data_free_fn A pointer to a function used to free \a old_data once
+ * no reader can still be using it or NULL if unnecessary.
+ */
+static void rcu_set_publish1( rcu_set_t *set, rcu_set_version_t *new_v,
+                              void *old_data, rcu_data_free_t data_free_fn ) {
+  rcu_retired_t *const r =
+    (*set->alloc->realloc_fn)( set->alloc, NULL, sizeof( rcu_retired_t ) );
+  if ( unlikely( r == NULL ) )
+    alloc_oom( sizeof( rcu_retired_t ) );
+  *r = (rcu_retired_t){ old_data, data_free_fn };
+  rcu_set_publish( set, new_v, r, 1 );
+}
+
+/**
+ * Adds \a data removed from \a set during the calling thread's batch to the
+ * data to free once no reader can still be using it.
+ *
+ * @param set A pointer to the set.
+ * @param data The data no longer in \a set.
+ * @param data_free_fn A pointer to a function used to free \a data or NULL
+ * if unnecessary.
+ */
+static void rcu_set_batch_retire( rcu_set_t *set, void *data,
+                                  rcu_data_free_t data_free_fn ) {
+  if ( set->batch_n_retired == set->batch_retired_cap ) {
+    set->batch_retired_cap = set->batch_retired_cap == 0 ?
+      8 : set->batch_retired_cap * 2;
+    size_t const size = set->batch_retired_cap * sizeof( rcu_retired_t );
+    set->batch_retired =
+      (*set->alloc->realloc_fn)( set->alloc, set->batch_retired, size );
+    if ( unlikely( set->batch_retired == NULL ) )
+      alloc_oom( size );
+  }
+  set->batch_retired[ set->batch_n_retired++ ] =
+    (rcu_retired_t){ data, data_free_fn };
+}
+
+/**
+ * Initializes an in-order cursor over \a set.  Unless \a set is in the
+ * calling thread's batch, this begins a read of \a set.
+ *
+ * @param c A pointer to the cursor to initialize.
+ * @param set A pointer to the set to iterate over.
+ *
+ * @sa rcu_cursor_end()
+ * @sa rcu_cursor_next()
+ */
+static void rcu_cursor_init( rcu_cursor_t *c, rcu_set_t const *set ) {
+  MEM_ZERO( c );
+  if ( rcu_this_batch == set )
+    rb_iter_init( &c->iter, &set->batch );
+  else
+    c->v = rcu_read_begin( set );
+}
+
+/**
+ * Ends a cursor initialized by rcu_cursor_init().
+ *
+ * @param c A pointer to the cursor to end.
+ */
+static void rcu_cursor_end( rcu_cursor_t const *c ) {
+  if ( c->v != NULL )
+    rcu_read_end();
+}
+
+/**
+ * Gets the next element of a cursor.
+ *
+ * @param c A pointer to the cursor to advance.
+ * @return Returns a pointer to the next element's data or NULL if there are
+ * no more.
+ */
+PJL_WARN_UNUSED_RESULT
+static void* rcu_cursor_next( rcu_cursor_t *c ) {
+  if ( c->v != NULL )
+    return c->i < c->v->len ? c->v->data[ c->i++ ] : NULL;
+  rb_node_t const *const node = rb_iter_next( &c->iter );
+  return node != NULL ? node->data : NULL;
+}
+
+/**
+ * Searches \a v for \a data.
+ *
+ * @param v A pointer to the version to search.
+ * @param data_cmp_fn A pointer to the data comparison function.
+ * @param data A pointer to the data to search for.
+ * @param found Set to `true` only if \a data was found.
+ * @return Returns the index of \a data if found or the index at which it
+ * would be inserted if not.
+ */
+PJL_WARN_UNUSED_RESULT
+static size_t rcu_set_version_search( rcu_set_version_t const *v,
+                                      rcu_data_cmp_t data_cmp_fn,
+                                      void const *data, bool *found ) {
+  size_t lo = 0, hi = v->len;
+  while ( lo < hi ) {
+    size_t const mid = lo + (hi - lo) / 2;
+    int const cmp = (*data_cmp_fn)( data, v->data[ mid ] );
+    if ( cmp == 0 ) {
+      *found = true;
+      return mid;
+    }
+    if ( cmp < 0 )
+      hi = mid;
+    else
+      lo = mid + 1;
+  } // while
+  *found = false;
+  return lo;
+}
+
+/**
+ * Allocates a new version.
+ *
+ * @param set A pointer to the set the version is for.
+ * @param len The number of elements.
+ * @return Returns said version.
+ */
+PJL_WARN_UNUSED_RESULT
+static rcu_set_version_t* rcu_set_version_new( rcu_set_t const *set,
+                                               size_t len ) {
+  size_t const size = rcu_set_version_size( len );
+  rcu_set_version_t *const v =
+    (*set->alloc->realloc_fn)( set->alloc, NULL, size );
+  if ( unlikely( v == NULL ) )
+    alloc_oom( size );
+  alloc_sub_add( ALLOC_SUB_RCU_SET, 1, size );
+  v->next_retired = NULL;
+  v->retired_epoch = 0;
+  v->retired_data = NULL;
+  v->n_retired_data = 0;
+  v->len = len;
+  return v;
+}
+
+////////// extern functions ///////////////////////////////////////////////////
+
+void rcu_set_batch_begin( rcu_set_t *set ) {
+  assert( set != NULL );
+  assert( rcu_this_batch == NULL );
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &set->write_mutex ) );
+  rcu_this_batch = set;
+
+  rcu_set_version_t *const v = atomic_load( &set->version );
+  rb_tree_init( &set->batch, set->data_cmp_fn );
+  rb_tree_build( &set->batch, v->data, v->len );
+  set->batch_len = v->len;
+}
+
+void rcu_set_batch_end( rcu_set_t *set ) {
+  assert( set != NULL );
+  assert( rcu_this_batch == set );
+
+  rcu_set_version_t *const new_v = rcu_set_version_new( set, set->batch_len );
+  rb_iter_t iter;
+  rb_iter_init( &iter, &set->batch );
+  size_t i = 0;
+  for ( rb_node_t const *node; (node = rb_iter_next( &iter )) != NULL; )
+    new_v->data[ i++ ] = node->data;
+  assert( i == set->batch_len );
+  rb_tree_free( &set->batch, /*data_free_fn=*/NULL );
+
+  rcu_set_publish( set, new_v, set->batch_retired, set->batch_n_retired );
+  set->batch_retired = NULL;
+  set->batch_n_retired = set->batch_retired_cap = 0;
+
+  rcu_this_batch = NULL;
+  PJL_IGNORE_RV( pthread_mutex_unlock( &set->write_mutex ) );
+}
+
+void* rcu_set_find( rcu_set_t const *set, void const *data ) {
+  assert( set != NULL );
+  assert( data != NULL );
+
+  if ( rcu_this_batch == set ) {
+    rb_node_t const *const node =
+      rb_tree_find( &CONST_CAST( rcu_set_t*, set )->batch, data );
+    return node != NULL ? node->data : NULL;
+  }
+
+  rcu_set_version_t const *const v = rcu_read_begin( set );
+  bool found;
+  size_t const i = rcu_set_version_search( v, set->data_cmp_fn, data, &found );
+  void *const rv = found ? v->data[i] : NULL;
+  rcu_read_end();
+  return rv;
+}
+
+void rcu_set_free( rcu_set_t *set, rcu_data_free_t data_free_fn ) {
+  if ( set == NULL )
+    return;
+  assert( rcu_this_batch != set );
+  rcu_set_version_t *const v = atomic_load( &set->version );
+  if ( v != NULL ) {
+    if ( data_free_fn != NULL ) {
+      for ( size_t i = 0; i < v->len; ++i )
+        (*data_free_fn)( v->data[i] );
+    }
+    alloc_sub_remove( ALLOC_SUB_RCU_SET, 1, rcu_set_version_size( v->len ) );
+    (*set->alloc->free_fn)( set->alloc, v );
+  }
+  for ( rcu_set_version_t *r = set->retired; r != NULL; ) {
+    rcu_set_version_t *const next = r->next_retired;
+    rcu_set_version_free( set, r );
+    r = next;
+  } // for
+  PJL_IGNORE_RV( pthread_mutex_destroy( &set->write_mutex ) );
+  MEM_ZERO( set );
+}
+
+void rcu_set_init( rcu_set_t *set, rcu_data_cmp_t data_cmp_fn ) {
+  assert( set != NULL );
+  assert( data_cmp_fn != NULL );
+  MEM_ZERO( set );
+  set->data_cmp_fn = data_cmp_fn;
+  set->alloc = alloc_current();
+  atomic_init( &set->version, rcu_set_version_new( set, 0 ) );
+  IF_EXIT( (errno = pthread_mutex_init( &set->write_mutex, NULL )) != 0,
+           EX_OSERR );
+}
+
+void* rcu_set_insert( rcu_set_t *set, void *data ) {
+  assert( set != NULL );
+  assert( data != NULL );
+
+  if ( rcu_this_batch == set ) {
+    rb_node_t const *const node = rb_tree_insert( &set->batch, data );
+    if ( node != NULL )
+      return node->data;
+    ++set->batch_len;
+    return NULL;
+  }
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &set->write_mutex ) );
+
+  rcu_set_version_t *const old_v = atomic_load( &set->version );
+  bool found;
+  size_t const i =
+    rcu_set_version_search( old_v, set->data_cmp_fn, data, &found );
+  if ( found ) {
+    void *const old_data = old_v->data[i];
+    PJL_IGNORE_RV( pthread_mutex_unlock( &set->write_mutex ) );
+    return old_data;
+  }
+
+  rcu_set_version_t *const new_v = rcu_set_version_new( set, old_v->len + 1 );
+  memcpy( new_v->data, old_v->data, i * sizeof(void*) );
+  new_v->data[i] = data;
+  memcpy( new_v->data + i + 1, old_v->data + i,
+          (old_v->len - i) * sizeof(void*) );
+
+  rcu_set_publish( set, new_v, NULL, 0 );
+
+  PJL_IGNORE_RV( pthread_mutex_unlock( &set->write_mutex ) );
+  return NULL;
+}
+
+bool rcu_set_remove( rcu_set_t *set, void const *data,
+                     rcu_data_free_t data_free_fn ) {
+  assert( set != NULL );
+  assert( data != NULL );
+
+  if ( rcu_this_batch == set ) {
+    rb_node_t *const node = rb_tree_find( &set->batch, data );
+    if ( node == NULL )
+      return false;
+    rcu_set_batch_retire(
+      set, rb_tree_delete( &set->batch, node ), data_free_fn
+    );
+    --set->batch_len;
+    return true;
+  }
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &set->write_mutex ) );
+
+  rcu_set_version_t *const old_v = atomic_load( &set->version );
+  bool found;
+  size_t const i =
+    rcu_set_version_search( old_v, set->data_cmp_fn, data, &found );
+  if ( found ) {
+    rcu_set_version_t *const new_v = rcu_set_version_new( set, old_v->len - 1 );
+    memcpy( new_v->data, old_v->data, i * sizeof(void*) );
+    memcpy( new_v->data + i, old_v->data + i + 1,
+            (old_v->len - i - 1) * sizeof(void*) );
+    rcu_set_publish1( set, new_v, old_v->data[i], data_free_fn );
+  }
+
+  PJL_IGNORE_RV( pthread_mutex_unlock( &set->write_mutex ) );
+  return found;
+}
+
+bool rcu_set_replace( rcu_set_t *set, void *data,
+                      rcu_data_free_t data_free_fn ) {
+  assert( set != NULL );
+  assert( data != NULL );
+
+  if ( rcu_this_batch == set ) {
+    rb_node_t *const node = rb_tree_insert( &set->batch, data );
+    if ( node == NULL ) {
+      ++set->batch_len;
+      return false;
+    }
+    rcu_set_batch_retire( set, node->data, data_free_fn );
+    node->data = data;
+    return true;
+  }
+
+  PJL_IGNORE_RV( pthread_mutex_lock( &set->write_mutex ) );
+
+  rcu_set_version_t *const old_v = atomic_load( &set->version );
+  bool found;
+  size_t const i =
+    rcu_set_version_search( old_v, set->data_cmp_fn, data, &found );
+  rcu_set_version_t *const new_v =
+    rcu_set_version_new( set, old_v->len + !found );
+  memcpy( new_v->data, old_v->data, old_v->len * sizeof(void*) );
+  if ( found ) {
+    new_v->data[i] = data;
+    rcu_set_publish1( set, new_v, old_v->data[i], data_free_fn );
+  } else {
+    new_v->data[i] = data;
+    memcpy( new_v->data + i + 1, old_v->data + i,
+            (old_v->len - i) * sizeof(void*) );
+    rcu_set_publish( set, new_v, NULL, 0 );
+  }
+
+  PJL_IGNORE_RV( pthread_mutex_unlock( &set->write_mutex ) );
+  return found;
+}
+
+size_t rcu_set_size( rcu_set_t const *set ) {
+  assert( set != NULL );
+  if ( rcu_this_batch == set )
+    return set->batch_len;
+  rcu_set_version_t const *const v = rcu_read_begin( set );
+  size_t const len = v->len;
+  rcu_read_end();
+  return len;
+}
+
+void* rcu_set_visit( rcu_set_t const *set, rcu_visitor_t visitor,
+                     void *aux_data ) {
+  assert( set != NULL );
+  assert( visitor != NULL );
+
+  rcu_cursor_t c;
+  rcu_cursor_init( &c, set );
+  void *data;
+  while ( (data = rcu_cursor_next( &c )) != NULL ) {
+    if ( (*visitor)( data, aux_data ) )
+      break;
+  } // while
+  rcu_cursor_end( &c );
+  return data;
+}
+
+void* rcu_set_visit_merge( rcu_set_t const *set1, rcu_set_t const *set2,
+                           rcu_visitor_t visitor, void *aux_data ) {
+  assert( set1 != NULL );
+  assert( set2 != NULL );
+  assert( set1->data_cmp_fn == set2->data_cmp_fn );
+  assert( visitor != NULL );
+
+  rcu_cursor_t c1, c2;
+  rcu_cursor_init( &c1, set1 );
+  rcu_cursor_init( &c2, set2 );
+  void *data1 = rcu_cursor_next( &c1 );
+  void *data2 = rcu_cursor_next( &c2 );
+  void *rv = NULL;
+  while ( data1 != NULL || data2 != NULL ) {
+    void *data;
+    if ( data2 == NULL ||
+         (data1 != NULL && (*set1->data_cmp_fn)( data1, data2 ) <= 0) ) {
+      data = data1;
+      data1 = rcu_cursor_next( &c1 );
+    } else {
+      data = data2;
+      data2 = rcu_cursor_next( &c2 );
+    }
+    if ( (*visitor)( data, aux_data ) ) {
+      rv = data;
+      break;
+    }
+  } // while
+  rcu_cursor_end( &c2 );
+  rcu_cursor_end( &c1 );
+  return rv;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,267 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/rcu_set.h
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef cdecl_rcu_set_H
+#define cdecl_rcu_set_H
+
+/**
+ * @file
+ * Declares types to represent a read-mostly ordered set as well as functions
+ * for manipulating said sets.
+ *
+ * Readers never block nor write to shared memory: they search an immutable,
+ * sorted version of the set.  Writers are serialized by a mutex and publish a
+ * new version (read-copy-update); old versions are freed only once no reader
+ * that could still be using them remains (epoch-based reclamation).
+ *
+ * @sa [Read-copy-update](https://en.wikipedia.org/wiki/Read-copy-update)
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "alloc.h"
+#include "red_black.h"
+#include "util.h"
+
+// standard
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>                     /* for size_t */
+
+/**
+ * @defgroup rcu-set-group Read-Copy-Update Set
+ * Types and functions for manipulating read-mostly ordered sets.
+ * @{
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct rcu_retired      rcu_retired_t;
+typedef struct rcu_set          rcu_set_t;
+typedef struct rcu_set_version  rcu_set_version_t;
+
+/**
+ * The signature for a function passed to rcu_set_init() used to compare data.
+ *
+ * @param i_data A pointer to data.
+ * @param j_data A pointer to data.
+ * @return Returns an integer less than, equal to, or greater than 0, according
+ * to whether the data pointed to by \a i_data is less than, equal to, or
+ * greater than the data pointed to by \a j_data.
+ */
+typedef int (*rcu_data_cmp_t)( void const *i_data, void const *j_data );
+
+/**
+ * The signature for a function passed to rcu_set_free() used to free data
+ * associated with each element (if necessary).
+ *
+ * @param data A pointer to the data to free.
+ */
+typedef void (*rcu_data_free_t)( void *data );
+
+/**
+ * The signature for a function passed to rcu_set_visit().
+ *
+ * @param data A pointer to the element's data.
+ * @param aux_data Optional data passed to to the visitor.
+ * @return Returning `true` will cause traversal to stop and the current
+ * element's data to be returned to the caller of rcu_set_visit().
+ */
+typedef bool (*rcu_visitor_t)( void *data, void *aux_data );
+
+/**
+ * A read-mostly ordered set.
+ *
+ * @sa rcu_set_init()
+ */
+struct rcu_set {
+  /// Current version (internal use only).
+  _Atomic(rcu_set_version_t*) version;
+
+  rcu_data_cmp_t      data_cmp_fn;      ///< Data comparison function.
+  allocator_t        *alloc;            ///< Allocator for versions.
+  pthread_mutex_t     write_mutex;      ///< Serializes writers.
+  rcu_set_version_t  *retired;          ///< Retired versions not yet freed.
+
+  // The rest are used only during a batch (internal use only).
+  rb_tree_t           batch;            ///< Elements of the batch.
+  size_t              batch_len;        ///< Number of elements in \ref batch.
+  rcu_retired_t      *batch_retired;    ///< Data removed during the batch.
+  size_t              batch_n_retired;  ///< Number of \ref batch_retired.
+  size_t              batch_retired_cap;///< Capacity of \ref batch_retired.
+};
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Begins a batch of changes to \a set by the calling thread.  Until
+ * rcu_set_batch_end() is called:
+ *
+ *  + Inserts, removals, and replacements by the calling thread are O(log n)
+ *    and visible only to it.
+ *  + Other threads continue to read the version current as of the call.
+ *  + Other writers block.
+ *  + \a set must not be modified by a visitor passed to rcu_set_visit() or
+ *    rcu_set_visit_merge() for \a set.
+ *
+ * This is O(n).  A thread may have only one batch at a time.
+ *
+ * @param set A pointer to the set to begin the batch for.
+ *
+ * @sa rcu_set_batch_end()
+ */
+void rcu_set_batch_begin( rcu_set_t *set );
+
+/**
+ * Ends the calling thread's batch of changes to \a set begun by
+ * rcu_set_batch_begin() and publishes them at once.  This is O(n).
+ *
+ * @param set A pointer to the set to end the batch for.
+ */
+void rcu_set_batch_end( rcu_set_t *set );
+
+/**
+ * Attempts to find \a data in \a set.  This never blocks and may be called
+ * concurrently with itself, rcu_set_insert(), and rcu_set_visit().
+ *
+ * @param set A pointer to the set to search through.
+ * @param data A pointer to the data to search for.
+ * @return Returns a pointer to the element's data or NULL if not found.
+ */
+PJL_WARN_UNUSED_RESULT
+void* rcu_set_find( rcu_set_t const *set, void const *data );
+
+/**
+ * Frees all memory associated with \a set but _not_ \a set itself.  There
+ * must be no concurrent access to \a set.
+ *
+ * @param set A pointer to the set to free.
+ * @param data_free_fn A pointer to a function used to free data associated
+ * with each element or NULL if unnecessary.
+ *
+ * @sa rcu_set_init()
+ */
+void rcu_set_free( rcu_set_t *set, rcu_data_free_t data_free_fn );
+
+/**
+ * Initializes a set.  The set's internal memory comes from the calling
+ * thread's current allocator (see alloc_use()) regardless of which thread
+ * later modifies it.
+ *
+ * @param set A pointer to the set to initialize.
+ * @param data_cmp_fn A pointer to a function used to compare data.
+ *
+ * @sa rcu_set_free()
+ */
+void rcu_set_init( rcu_set_t *set, rcu_data_cmp_t data_cmp_fn );
+
+/**
+ * Inserts \a data into \a set.  This is O(n) since it copies the current
+ * version unless done in a batch.  Concurrent writers are serialized.
+ *
+ * @sa rcu_set_batch_begin()
+ *
+ * @param set A pointer to the set to insert into.
+ * @param data A pointer to the data to insert.
+ * @return Returns NULL if \a data is inserted or a pointer to the existing
+ * element's data if \a data already exists.
+ */
+PJL_WARN_UNUSED_RESULT
+void* rcu_set_insert( rcu_set_t *set, void *data );
+
+/**
+ * Removes the element equal to \a data from \a set.  This is O(n) since it
+ * copies the current version unless done in a batch.  Concurrent writers are
+ * serialized.
+ *
+ * @param set A pointer to the set to remove from.
+ * @param data A pointer to data equal to that of the element to remove.
+ * @param data_free_fn A pointer to a function used to free the removed
+ * element's data once no reader can still be using it or NULL if unnecessary.
+ * @return Returns `true` only if an element was removed.
+ */
+PJL_NOWARN_UNUSED_RESULT
+bool rcu_set_remove( rcu_set_t *set, void const *data,
+                     rcu_data_free_t data_free_fn );
+
+/**
+ * Inserts \a data into \a set replacing the existing element equal to it, if
+ * any.  This is O(n) since it copies the current version unless done in a
+ * batch.  Concurrent writers are serialized.
+ *
+ * @param set A pointer to the set to insert into.
+ * @param data A pointer to the data to insert.
+ * @param data_free_fn A pointer to a function used to free the replaced
+ * element's data once no reader can still be using it or NULL if unnecessary.
+ * @return Returns `true` only if an element was replaced.
+ */
+PJL_NOWARN_UNUSED_RESULT
+bool rcu_set_replace( rcu_set_t *set, void *data,
+                      rcu_data_free_t data_free_fn );
+
+/**
+ * Gets the number of elements in \a set.
+ *
+ * @param set A pointer to the set.
+ * @return Returns said number.
+ */
+PJL_WARN_UNUSED_RESULT
+size_t rcu_set_size( rcu_set_t const *set );
+
+/**
+ * Performs an in-order traversal of the version of \a set current as of the
+ * call.  This never blocks; elements inserted during traversal (including by
+ * \a visitor itself) are not visited.
+ *
+ * @param set A pointer to the set to visit.
+ * @param visitor The visitor to use.
+ * @param aux_data Optional data passed to \a visitor.
+ * @return Returns a pointer to the element's data at which visiting stopped
+ * or NULL if the entire set was visited.
+ */
+PJL_WARN_UNUSED_RESULT
+void* rcu_set_visit( rcu_set_t const *set, rcu_visitor_t visitor,
+                     void *aux_data );
+
+/**
+ * Performs an in-order traversal of the union of the versions of \a set1 and
+ * \a set2 current as of the call.  Both sets must use the same comparison
+ * function.  If an element compares equal in both, the one in \a set1 is
+ * visited first.  This never blocks.
+ *
+ * @param set1 A pointer to a set to visit.
+ * @param set2 A pointer to another set to visit.
+ * @param visitor The visitor to use.
+ * @param aux_data Optional data passed to \a visitor.
+ * @return Returns a pointer to the element's data at which visiting stopped
+ * or NULL if both sets were entirely visited.
+ *
+ * @sa rcu_set_visit()
+ */
+PJL_WARN_UNUSED_RESULT
+void* rcu_set_visit_merge( rcu_set_t const *set1, rcu_set_t const *set2,
+                           rcu_visitor_t visitor, void *aux_data );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** @} */
+
+#endif /* cdecl_rcu_set_H */
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,469 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/rcu_set_test.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "rcu_set.h"
+#include "util.h"
+
+// standard
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <time.h>
+
+///////////////////////////////////////////////////////////////////////////////
+
+// extern variable definitions
+char const       *me;                   ///< Program name.
+
+/**
+ * Prints that \a EXPR failed and increments the test failure count.
+ *
+ * @param EXPR The stringified expression that failed.
+ * @return Always returns `false`.
+ */
+#define FAILED(EXPR) (                                 \
+  EPRINTF( "%s:%d: %s\n", me, __LINE__, (EXPR) ),       \
+  !(atomic_fetch_add( &test_failures, 1 ) + 1) )
+
+/**
+ * Tests \a EXPR and prints that it failed only if it failed.
+ *
+ * @param EXPR The expression to evaluate.
+ * @return Returns `true` only if \a EXPR is non-zero; `false` only if zero.
+ */
+#define TEST(EXPR)                ( !!(EXPR) || FAILED( #EXPR ) )
+
+/// Number of keys in the set for the benchmark.
+#define RCU_TEST_BENCH_KEYS       1024
+
+/// Number of keys the writer adds during the concurrent test.
+#define RCU_TEST_STRESS_KEYS      2000
+
+/// Number of reader threads in the concurrent test.
+#define RCU_TEST_STRESS_READERS   4
+
+/**
+ * Data shared by the threads of the concurrent test and benchmark.
+ */
+struct rcu_test_thread {
+  pthread_t     thread;                 ///< The thread.
+  rcu_set_t    *set;                    ///< The set to read or write.
+  long const   *value;                  ///< Values to look up or insert.
+  size_t        n;                      ///< Number of values.
+  unsigned long lookups;                ///< Number of lookups to do.
+  _Atomic bool *done;                   ///< Set when the writer is done.
+};
+typedef struct rcu_test_thread rcu_test_thread_t;
+
+static _Atomic unsigned test_failures;
+static unsigned         test_frees;     ///< Calls to rcu_test_count_free().
+
+////////// local functions ////////////////////////////////////////////////////
+
+static int rcu_test_data_cmp( void const *i_data, void const *j_data ) {
+  char const *const i_str = i_data;
+  char const *const j_str = j_data;
+  return strcmp( i_str, j_str );
+}
+
+static int rcu_test_int_cmp( void const *i_data, void const *j_data ) {
+  long const *const i_ptr = i_data;
+  long const *const j_ptr = j_data;
+  return (*i_ptr > *j_ptr) - (*i_ptr < *j_ptr);
+}
+
+static void rcu_test_count_free( void *data ) {
+  (void)data;
+  ++test_frees;
+}
+
+static bool rcu_test_stop_visitor( void *data, void *aux_data ) {
+  char const *const str = data;
+  char const *const stop_str = aux_data;
+  return strcmp( str, stop_str ) == 0;
+}
+
+static bool rcu_test_visitor( void *data, void *aux_data ) {
+  char const *const str = data;
+  unsigned *const letter_offset_ptr = aux_data;
+  if ( TEST( str != NULL ) )
+    TEST( str[0] == (char)('A' + *letter_offset_ptr) );
+  ++*letter_offset_ptr;
+  return false;
+}
+
+static bool rcu_test_int_visitor( void *data, void *aux_data ) {
+  long const *const value = data;
+  long *const prev_ptr = aux_data;
+  TEST( *value == *prev_ptr + 1 );
+  *prev_ptr = *value;
+  return false;
+}
+
+static noreturn void usage( void ) {
+  EPRINTF( "usage: %s [lookups-per-thread [max-threads]]\n", me );
+  exit( EX_USAGE );
+}
+
+/**
+ * Gets the number of milliseconds of wall-clock time elapsed since \a start.
+ *
+ * @param start The start time.
+ * @return Returns said number of milliseconds.
+ */
+static double elapsed_ms( struct timespec const *start ) {
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return (double)(now.tv_sec - start->tv_sec) * 1000.0 +
+         (double)(now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/**
+ * Benchmark reader thread: does its lookups of all the values round-robin.
+ *
+ * @param arg A pointer to the thread's <code>\ref rcu_test_thread</code>.
+ * @return Always returns NULL.
+ */
+static void* rcu_test_bench_reader( void *arg ) {
+  rcu_test_thread_t const *const t = arg;
+  size_t i = 0;
+  for ( unsigned long n = 0; n < t->lookups; ++n ) {
+    TEST( rcu_set_find( t->set, &t->value[i] ) != NULL );
+    if ( ++i == t->n )
+      i = 0;
+  } // for
+  return NULL;
+}
+
+/**
+ * Benchmarks concurrent lookups with 1, 2, 4, ... \a max_threads reader
+ * threads while another thread occasionally inserts.
+ *
+ * @param lookups The number of lookups per reader thread.
+ * @param max_threads The maximum number of reader threads.
+ */
+static void rcu_test_benchmark( unsigned long lookups, unsigned max_threads ) {
+  size_t const n = RCU_TEST_BENCH_KEYS;
+  long *const value = MALLOC( long, n * 2 );
+  for ( size_t i = 0; i < n * 2; ++i )
+    value[i] = (long)i;
+
+  rcu_set_t set;
+  rcu_set_init( &set, &rcu_test_int_cmp );
+  for ( size_t i = 0; i < n; ++i )
+    PJL_IGNORE_RV( rcu_set_insert( &set, &value[i] ) );
+
+  rcu_test_thread_t *const t = MALLOC( rcu_test_thread_t, max_threads );
+  double base_rate = 0;
+  size_t next_insert = n;
+
+  printf( "%7s %12s %14s %8s\n", "threads", "ms", "lookups/s", "speedup" );
+  for ( unsigned threads = 1; threads <= max_threads; threads *= 2 ) {
+    struct timespec start;
+    clock_gettime( CLOCK_MONOTONIC, &start );
+    for ( unsigned i = 0; i < threads; ++i ) {
+      t[i] = (rcu_test_thread_t){
+        .set = &set, .value = value, .n = n, .lookups = lookups
+      };
+      IF_EXIT(
+        pthread_create( &t[i].thread, NULL, &rcu_test_bench_reader, &t[i] ),
+        EX_OSERR
+      );
+    } // for
+    // Occasionally insert while the readers are running.
+    for ( unsigned i = 0; i < 16 && next_insert < n * 2; ++i )
+      PJL_IGNORE_RV( rcu_set_insert( &set, &value[ next_insert++ ] ) );
+    for ( unsigned i = 0; i < threads; ++i )
+      PJL_IGNORE_RV( pthread_join( t[i].thread, NULL ) );
+    double const ms = elapsed_ms( &start );
+
+    double const rate = (double)lookups * threads * 1000.0 / ms;
+    if ( threads == 1 )
+      base_rate = rate;
+    printf( "%7u %12.3f %14.0f %8.2f\n", threads, ms, rate, rate / base_rate );
+  } // for
+
+  rcu_set_free( &set, NULL );
+  free( t );
+  free( value );
+}
+
+/**
+ * Batch test reader thread: checks that the values are found only if
+ * rcu_test_thread::done is set.
+ *
+ * @param arg A pointer to the thread's <code>\ref rcu_test_thread</code>.
+ * @return Always returns NULL.
+ */
+static void* rcu_test_batch_reader( void *arg ) {
+  rcu_test_thread_t const *const t = arg;
+  bool const done = atomic_load( t->done );
+  for ( size_t i = 0; i < t->n; ++i ) {
+    long const *const found = rcu_set_find( t->set, &t->value[i] );
+    TEST( found == (done ? &t->value[i] : NULL) );
+  } // for
+  return NULL;
+}
+
+/**
+ * Runs rcu_test_batch_reader() in another thread and waits for it.
+ *
+ * @param t A pointer to the thread's <code>\ref rcu_test_thread</code>.
+ */
+static void rcu_test_batch_read( rcu_test_thread_t *t ) {
+  IF_EXIT(
+    pthread_create( &t->thread, NULL, &rcu_test_batch_reader, t ), EX_OSERR
+  );
+  PJL_IGNORE_RV( pthread_join( t->thread, NULL ) );
+}
+
+/**
+ * Tests that changes made during a batch are visible to only the batching
+ * thread until the batch ends.
+ */
+static void rcu_test_batch( void ) {
+  size_t const n = RCU_TEST_STRESS_KEYS;
+  long *const value = MALLOC( long, n );
+  for ( size_t i = 0; i < n; ++i )
+    value[i] = (long)(n - i);           // descending: worst case for arrays
+
+  rcu_set_t set;
+  rcu_set_init( &set, &rcu_test_int_cmp );
+  static long const ZERO = 0;
+  TEST( rcu_set_insert( &set, CONST_CAST( long*, &ZERO ) ) == NULL );
+
+  rcu_set_batch_begin( &set );
+  for ( size_t i = 0; i < n; ++i )
+    TEST( rcu_set_insert( &set, &value[i] ) == NULL );
+  TEST( rcu_set_insert( &set, &value[0] ) == &value[0] );
+  TEST( rcu_set_size( &set ) == n + 1 );
+  for ( size_t i = 0; i < n; ++i )
+    TEST( rcu_set_find( &set, &value[i] ) == &value[i] );
+
+  _Atomic bool done = false;
+  rcu_test_thread_t t = { .set = &set, .value = value, .n = n, .done = &done };
+  rcu_test_batch_read( &t );
+
+  // test replace and remove
+  long const ONE = 1;
+  TEST( rcu_set_replace( &set, CONST_CAST( long*, &ONE ),
+                         &rcu_test_count_free ) );
+  TEST( rcu_set_find( &set, &ONE ) == &ONE );
+  TEST( rcu_set_remove( &set, &ZERO, &rcu_test_count_free ) );
+  TEST( rcu_set_find( &set, &ZERO ) == NULL );
+  TEST( rcu_set_size( &set ) == n );
+  unsigned const orig_frees = test_frees;
+
+  // test that visiting during a batch visits the batch in order
+  rcu_set_t empty;
+  rcu_set_init( &empty, &rcu_test_int_cmp );
+  long prev = 0;
+  TEST( rcu_set_visit_merge( &empty, &set, &rcu_test_int_visitor, &prev )
+          == NULL );
+  TEST( prev == (long)n );
+  rcu_set_free( &empty, NULL );
+
+  rcu_set_batch_end( &set );
+  TEST( rcu_set_find( &set, &ONE ) == &ONE );
+  atomic_store( &done, true );
+  t.n = n - 1;                          // value[n-1] was replaced by ONE
+  rcu_test_batch_read( &t );
+
+  rcu_set_free( &set, NULL );
+  TEST( test_frees == orig_frees + 2 );
+  free( value );
+}
+
+/**
+ * Concurrent test reader thread: until the writer is done, repeatedly checks
+ * that every even value (inserted before the writer started) is always found
+ * and that any odd value found is the right one.
+ *
+ * @param arg A pointer to the thread's <code>\ref rcu_test_thread</code>.
+ * @return Always returns NULL.
+ */
+static void* rcu_test_stress_reader( void *arg ) {
+  rcu_test_thread_t const *const t = arg;
+  do {
+    for ( size_t i = 0; i < t->n; ++i ) {
+      long const *const found = rcu_set_find( t->set, &t->value[i] );
+      if ( i % 2 == 0 )
+        TEST( found == &t->value[i] );
+      else
+        TEST( found == NULL || found == &t->value[i] );
+    } // for
+  } while ( !atomic_load( t->done ) );
+  return NULL;
+}
+
+/**
+ * Concurrent test writer thread: inserts all the odd values.
+ *
+ * @param arg A pointer to the thread's <code>\ref rcu_test_thread</code>.
+ * @return Always returns NULL.
+ */
+static void* rcu_test_stress_writer( void *arg ) {
+  rcu_test_thread_t const *const t = arg;
+  for ( size_t i = 1; i < t->n; i += 2 ) {
+    long *const value = CONST_CAST( long*, &t->value[i] );
+    TEST( rcu_set_insert( t->set, value ) == NULL );
+  } // for
+  atomic_store( t->done, true );
+  return NULL;
+}
+
+/**
+ * Tests that readers always see consistent versions while a writer inserts.
+ */
+static void rcu_test_stress( void ) {
+  size_t const n = RCU_TEST_STRESS_KEYS;
+  long *const value = MALLOC( long, n );
+  for ( size_t i = 0; i < n; ++i )
+    value[i] = (long)i;
+
+  rcu_set_t set;
+  rcu_set_init( &set, &rcu_test_int_cmp );
+  for ( size_t i = 0; i < n; i += 2 )
+    TEST( rcu_set_insert( &set, &value[i] ) == NULL );
+
+  _Atomic bool done = false;
+  rcu_test_thread_t t[ RCU_TEST_STRESS_READERS + 1 ];
+  for ( size_t i = 0; i < ARRAY_SIZE( t ); ++i ) {
+    t[i] = (rcu_test_thread_t){
+      .set = &set, .value = value, .n = n, .done = &done
+    };
+    IF_EXIT(
+      pthread_create(
+        &t[i].thread, NULL,
+        i == 0 ? &rcu_test_stress_writer : &rcu_test_stress_reader, &t[i]
+      ),
+      EX_OSERR
+    );
+  } // for
+  for ( size_t i = 0; i < ARRAY_SIZE( t ); ++i )
+    PJL_IGNORE_RV( pthread_join( t[i].thread, NULL ) );
+
+  TEST( rcu_set_size( &set ) == n );
+  for ( size_t i = 0; i < n; ++i )
+    TEST( rcu_set_find( &set, &value[i] ) == &value[i] );
+
+  rcu_set_free( &set, NULL );
+  free( value );
+}
+
+////////// main ///////////////////////////////////////////////////////////////
+
+int main( int argc, char const *argv[] ) {
+  me = base_name( argv[0] );
+  if ( argc > 3 )
+    usage();
+  if ( argc >= 2 ) {
+    char *end;
+    unsigned long const lookups = strtoul( argv[1], &end, 10 );
+    if ( *end != '\0' || lookups == 0 )
+      usage();
+    unsigned long max_threads = 8;
+    if ( argc == 3 ) {
+      max_threads = strtoul( argv[2], &end, 10 );
+      if ( *end != '\0' || max_threads == 0 )
+        usage();
+    }
+    rcu_test_benchmark( lookups, (unsigned)max_threads );
+    printf( "%u failures\n", atomic_load( &test_failures ) );
+    exit( test_failures > 0 ? EX_SOFTWARE : EX_OK );
+  }
+
+  rcu_set_t set;
+  rcu_set_init( &set, &rcu_test_data_cmp );
+
+  // test insertion (out of order)
+  TEST( rcu_set_insert( &set, (void*)"C" ) == NULL );
+  TEST( rcu_set_insert( &set, (void*)"A" ) == NULL );
+  TEST( rcu_set_insert( &set, (void*)"D" ) == NULL );
+  TEST( rcu_set_insert( &set, (void*)"B" ) == NULL );
+  TEST( rcu_set_size( &set ) == 4 );
+
+  // test insertion with existing data
+  char const *str = rcu_set_insert( &set, (void*)"A" );
+  if ( TEST( str != NULL ) )
+    TEST( strcmp( str, "A" ) == 0 );
+  TEST( rcu_set_size( &set ) == 4 );
+
+  // test visitor
+  unsigned letter_offset = 0;
+  TEST( rcu_set_visit( &set, &rcu_test_visitor, &letter_offset ) == NULL );
+  TEST( letter_offset == 4 );
+
+  // test visitor early exit
+  str = rcu_set_visit( &set, &rcu_test_stop_visitor, (void*)"B" );
+  if ( TEST( str != NULL ) )
+    TEST( strcmp( str, "B" ) == 0 );
+
+  // test find
+  str = rcu_set_find( &set, "C" );
+  if ( TEST( str != NULL ) )
+    TEST( strcmp( str, "C" ) == 0 );
+  TEST( rcu_set_find( &set, "E" ) == NULL );
+
+  // test replace and remove
+  static char const C2[] = "C";
+  TEST( rcu_set_replace( &set, (void*)C2, &rcu_test_count_free ) );
+  TEST( rcu_set_find( &set, "C" ) == C2 );
+  TEST( !rcu_set_replace( &set, (void*)"H", &rcu_test_count_free ) );
+  TEST( rcu_set_size( &set ) == 5 );
+  TEST( rcu_set_remove( &set, "H", &rcu_test_count_free ) );
+  TEST( !rcu_set_remove( &set, "H", &rcu_test_count_free ) );
+  TEST( rcu_set_find( &set, "H" ) == NULL );
+  TEST( rcu_set_size( &set ) == 4 );
+
+  // test merged visitor
+  rcu_set_t set2;
+  rcu_set_init( &set2, &rcu_test_data_cmp );
+  TEST( rcu_set_insert( &set2, (void*)"F" ) == NULL );
+  TEST( rcu_set_insert( &set2, (void*)"E" ) == NULL );
+  TEST( rcu_set_insert( &set, (void*)"G" ) == NULL );
+  letter_offset = 0;
+  TEST(
+    rcu_set_visit_merge( &set, &set2, &rcu_test_visitor, &letter_offset )
+      == NULL
+  );
+  TEST( letter_offset == 7 );
+  str = rcu_set_visit_merge( &set2, &set, &rcu_test_stop_visitor, (void*)"F" );
+  if ( TEST( str != NULL ) )
+    TEST( strcmp( str, "F" ) == 0 );
+
+  rcu_set_free( &set2, NULL );
+  rcu_set_free( &set, NULL );
+  TEST( test_frees == 2 );
+
+  rcu_test_batch();
+  rcu_test_stress();
+
+  printf( "%u failures\n", atomic_load( &test_failures ) );
+  exit( test_failures > 0 ? EX_SOFTWARE : EX_OK );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -80,6 +80,7 @@
 
 // standard
 #include <assert.h>
+#include <limits.h>                     /* for UINT_MAX */
 #include <stdio.h>                      /* for NULL */
 
 #define RB_FIRST(TREE)  (RB_ROOT(TREE)->child[RB_L])
@@ -97,6 +98,22 @@ enum rb_dir {
 };
 typedef enum rb_dir rb_dir_t;
 
+/**
+ * A slab of nodes allocated at once and owned by an `rb_tree`.  Nodes are
+ * never freed individually: unused nodes are kept on the tree's free list and
+ * all slabs are freed by rb_tree_free().
+ */
+struct rb_slab {
+  rb_slab_t  *next;                     ///< Next slab.
+  size_t      size;                     ///< Number of nodes.
+  rb_node_t   node[];                   ///< Nodes.
+};
+
+/**
+ * Number of nodes per slab allocated by rb_node_alloc().
+ */
+static size_t const RB_SLAB_SIZE = 64;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // local functions
@@ -152,22 +169,68 @@ static inline bool is_red( rb_node_t const *node ) {
 ////////// local functions ////////////////////////////////////////////////////
 
 /**
- * Frees all memory associated with \a node.
+ * Allocates a new slab of nodes and links it into \a tree.  All nodes are
+ * unused, i.e., have NULL data.
  *
- * @param node A pointer to the `rb_node` to free.
- * @param data_free_fn A pointer to a function used to free data associated
- * with \a node or NULL if unnecessary.
+ * @param tree A pointer to the red-black tree to allocate the slab for.
+ * @param size The number of nodes in the slab.
+ * @return Returns a pointer to the new slab.
  */
-static void rb_node_free( rb_node_t *node, rb_data_free_t data_free_fn ) {
-  assert( node != NULL );
+PJL_WARN_UNUSED_RESULT
+static rb_slab_t* rb_slab_new( rb_tree_t *tree, size_t size ) {
+  assert( tree != NULL );
+  assert( size > 0 );
+
+  rb_slab_t *const slab =
+    check_realloc( NULL, sizeof(rb_slab_t) + size * sizeof(rb_node_t) );
+  slab->next = tree->slabs;
+  slab->size = size;
+  for ( size_t i = 0; i < size; ++i )
+    slab->node[i].data = NULL;
+  tree->slabs = slab;
+  return slab;
+}
 
-  if ( node != RB_NIL ) {
-    rb_node_free( node->child[RB_L], data_free_fn );
-    rb_node_free( node->child[RB_R], data_free_fn );
-    if ( data_free_fn != NULL )
-      (*data_free_fn)( node->data );
-    free( node );
+/**
+ * Allocates a node from \a tree's pool, allocating a new slab if necessary.
+ *
+ * @param tree A pointer to the red-black tree to allocate the node from.
+ * @return Returns a pointer to the (uninitialized) node.
+ *
+ * @sa rb_node_release()
+ */
+PJL_WARN_UNUSED_RESULT
+static rb_node_t* rb_node_alloc( rb_tree_t *tree ) {
+  assert( tree != NULL );
+
+  if ( tree->free_nodes == NULL ) {
+    rb_slab_t *const slab = rb_slab_new( tree, RB_SLAB_SIZE );
+    for ( size_t i = slab->size; i-- > 0; ) {
+      slab->node[i].child[RB_L] = tree->free_nodes;
+      tree->free_nodes = &slab->node[i];
+    } // for
   }
+
+  rb_node_t *const node = tree->free_nodes;
+  tree->free_nodes = node->child[RB_L];
+  return node;
+}
+
+/**
+ * Returns \a node to \a tree's pool of free nodes.
+ *
+ * @param tree A pointer to the red-black tree that owns \a node.
+ * @param node A pointer to the `rb_node` to release.
+ *
+ * @sa rb_node_alloc()
+ */
+static void rb_node_release( rb_tree_t *tree, rb_node_t *node ) {
+  assert( tree != NULL );
+  assert( node != NULL );
+
+  node->data = NULL;
+  node->child[RB_L] = tree->free_nodes;
+  tree->free_nodes = node;
 }
 
 /**
@@ -182,6 +245,37 @@ static void rb_node_init( rb_node_t *node ) {
   node->data = NULL;
 }
 
+/**
+ * Builds a balanced sub-tree of a red-black tree from sorted data.
+ *
+ * @param node An array of \a n nodes to use, one per element of \a data.
+ * @param data An array of pointers to data sorted in strictly ascending order.
+ * @param n The number of elements in \a data.
+ * @param parent A pointer to the parent of the sub-tree's root.
+ * @param depth The depth of the sub-tree's root.
+ * @param red_depth The depth at which nodes are colored red.
+ * @return Returns a pointer to the root of the sub-tree.
+ */
+PJL_WARN_UNUSED_RESULT
+static rb_node_t* rb_tree_build_node( rb_node_t *node, void *data[], size_t n,
+                                      rb_node_t *parent, unsigned depth,
+                                      unsigned red_depth ) {
+  if ( n == 0 )
+    return RB_NIL;
+
+  size_t const mid = n / 2;
+  rb_node_t *const mid_node = &node[ mid ];
+  mid_node->data = data[ mid ];
+  mid_node->parent = parent;
+  mid_node->color = depth == red_depth ? RB_RED : RB_BLACK;
+  mid_node->child[RB_L] =
+    rb_tree_build_node( node, data, mid, mid_node, depth + 1, red_depth );
+  mid_node->child[RB_R] = rb_tree_build_node(
+    node + mid + 1, data + mid + 1, n - mid - 1, mid_node, depth + 1, red_depth
+  );
+  return mid_node;
+}
+
 /**
  * Gets the successor of \a node.
  *
@@ -220,8 +314,8 @@ static void rb_tree_repair_node( rb_tree_t *tree, rb_node_t *node ) {
   assert( tree != NULL );
   assert( node != NULL );
 
-  while ( is_black( node ) ) {
-    rb_dir_t const dir = is_dir( node->parent, RB_R );
+  while ( node != RB_FIRST(tree) && is_black( node ) ) {
+    rb_dir_t const dir = is_dir( node, RB_L );  // direction of sibling
     rb_node_t *sibling = node->parent->child[dir];
     if ( is_red( sibling ) ) {
       sibling->color = RB_BLACK;
@@ -230,7 +324,7 @@ static void rb_tree_repair_node( rb_tree_t *tree, rb_node_t *node ) {
       sibling = node->parent->child[dir];
     }
     if ( is_red( sibling->child[RB_L] ) || is_red( sibling->child[RB_R] ) ) {
-      if ( is_black( sibling ) ) {
+      if ( is_black( sibling->child[dir] ) ) {
         sibling->child[!dir]->color = RB_BLACK;
         sibling->color = RB_RED;
         rb_tree_rotate_node( tree, sibling, dir );
@@ -245,6 +339,7 @@ static void rb_tree_repair_node( rb_tree_t *tree, rb_node_t *node ) {
     sibling->color = RB_RED;
     node = node->parent;
   } // while
+  node->color = RB_BLACK;
 }
 
 /**
@@ -270,37 +365,60 @@ static void rb_tree_rotate_node( rb_tree_t *tree, rb_node_t *node,
   node->parent = temp;
 }
 
-/**
- * Performs an in-order traversal of the red-black tree starting at \a node.
- *
- * @param tree A pointer to the red-black tree to visit.
- * @param node A pointer to the `rb_node` to start visiting at.
- * @param visitor The visitor to use.
- * @param aux_data Optional data passed to \a visitor.
- * @return Returns a pointer to the `rb_node` at which visiting stopped or NULL
- * if the entire sub-tree was visited.
- */
-PJL_WARN_UNUSED_RESULT
-static rb_node_t* rb_tree_visit_node( rb_tree_t const *tree, rb_node_t *node,
-                                      rb_visitor_t visitor, void *aux_data ) {
+////////// extern functions ///////////////////////////////////////////////////
+
+void rb_iter_init( rb_iter_t *iter, rb_tree_t const *tree ) {
+  assert( iter != NULL );
   assert( tree != NULL );
-  assert( node != NULL );
 
+  iter->tree = CONST_CAST( rb_tree_t*, tree );
+  rb_node_t *node = RB_FIRST(iter->tree);
+  if ( node != RB_NIL ) {
+    while ( node->child[RB_L] != RB_NIL )
+      node = node->child[RB_L];
+  }
+  iter->next = node;
+}
+
+rb_node_t* rb_iter_next( rb_iter_t *iter ) {
+  assert( iter != NULL );
+
+  rb_node_t *const node = iter->next;
   if ( node == RB_NIL )
     return NULL;
+  iter->next = rb_tree_node_successor( iter->tree, node );
+  return node;
+}
 
-  rb_node_t *const stopped_node =
-    rb_tree_visit_node( tree, node->child[RB_L], visitor, aux_data );
-  if ( stopped_node != NULL )
-    return stopped_node;
+void rb_tree_build( rb_tree_t *tree, void *data[], size_t n ) {
+  assert( tree != NULL );
+  assert( RB_FIRST(tree) == RB_NIL );
+  assert( data != NULL || n == 0 );
 
-  if ( visitor( node->data, aux_data ) )
-    return node;
+  if ( n == 0 )
+    return;
 
-  return rb_tree_visit_node( tree, node->child[RB_R], visitor, aux_data );
-}
+#ifndef NDEBUG
+  for ( size_t i = 1; i < n; ++i )
+    assert( (*tree->data_cmp_fn)( data[i-1], data[i] ) < 0 );
+#endif /* NDEBUG */
 
-////////// extern functions ///////////////////////////////////////////////////
+  //
+  // Splitting at the midpoint yields a tree whose leaves differ in depth by at
+  // most 1.  If the bottom level isn't full, coloring just its nodes red gives
+  // every path the same number of black nodes.
+  //
+  unsigned full_levels = 0;
+  for ( size_t m = n + 1; m > 1; m >>= 1 )
+    ++full_levels;
+  bool const is_perfect = ((n + 1) & n) == 0;
+  unsigned const red_depth = is_perfect ? UINT_MAX : full_levels;
+
+  rb_slab_t *const slab = rb_slab_new( tree, n );
+  RB_FIRST(tree) = rb_tree_build_node(
+    slab->node, data, n, RB_ROOT(tree), 0, red_depth
+  );
+}
 
 void* rb_tree_delete( rb_tree_t *tree, rb_node_t *delete_node ) {
   assert( tree != NULL );
@@ -332,7 +450,7 @@ void* rb_tree_delete( rb_tree_t *tree, rb_node_t *delete_node ) {
     delete_node->parent->child[ is_dir( delete_node, RB_R ) ] = y;
   }
 
-  free( delete_node );
+  rb_node_release( tree, delete_node );
   return data;
 }
 
@@ -350,11 +468,25 @@ rb_node_t* rb_tree_find( rb_tree_t *tree, void const *data ) {
 }
 
 void rb_tree_free( rb_tree_t *tree, rb_data_free_t data_free_fn ) {
-  if ( tree != NULL && RB_FIRST(tree) != NULL ) {
-    rb_node_free( RB_FIRST(tree), data_free_fn );
-    rb_node_init( RB_ROOT(tree) );
-    tree->data_cmp_fn = NULL;
-  }
+  if ( tree == NULL )
+    return;
+
+  for ( rb_slab_t *slab = tree->slabs, *next_slab; slab != NULL;
+        slab = next_slab ) {
+    next_slab = slab->next;
+    if ( data_free_fn != NULL ) {
+      for ( size_t i = 0; i < slab->size; ++i ) {
+        if ( slab->node[i].data != NULL )
+          (*data_free_fn)( slab->node[i].data );
+      } // for
+    }
+    FREE( slab );
+  } // for
+
+  rb_node_init( RB_ROOT(tree) );
+  tree->data_cmp_fn = NULL;
+  tree->free_nodes = NULL;
+  tree->slabs = NULL;
 }
 
 void rb_tree_init( rb_tree_t *tree, rb_data_cmp_t data_cmp_fn ) {
@@ -363,6 +495,8 @@ void rb_tree_init( rb_tree_t *tree, rb_data_cmp_t data_cmp_fn ) {
 
   rb_node_init( RB_ROOT(tree) );
   tree->data_cmp_fn = data_cmp_fn;
+  tree->free_nodes = NULL;
+  tree->slabs = NULL;
 }
 
 rb_node_t* rb_tree_insert( rb_tree_t *tree, void *data ) {
@@ -381,7 +515,7 @@ rb_node_t* rb_tree_insert( rb_tree_t *tree, void *data ) {
     node = node->child[ cmp > 0 ];
   } // while
 
-  node = MALLOC( rb_node_t, 1 );
+  node = rb_node_alloc( tree );
   node->color = RB_RED;
   node->child[RB_L] = node->child[RB_R] = RB_NIL;
   node->data = data;
@@ -415,7 +549,7 @@ rb_node_t* rb_tree_insert( rb_tree_t *tree, void *data ) {
   // worry about replacing the root.
   //
   while ( is_red( node->parent ) ) {
-    dir = is_dir( node->parent, RB_R );
+    dir = is_dir( node->parent, RB_L );   // direction of uncle
     rb_node_t *const uncle = node->parent->parent->child[dir];
     if ( is_red( uncle ) ) {
       node->parent->color = RB_BLACK;
@@ -441,10 +575,13 @@ rb_node_t* rb_tree_visit( rb_tree_t const *tree, rb_visitor_t visitor,
                           void *aux_data ) {
   assert( visitor != NULL );
 
-  rb_tree_t *const nonconst_tree = CONST_CAST( rb_tree_t*, tree );
-  return rb_tree_visit_node(
-    nonconst_tree, RB_FIRST(nonconst_tree), visitor, aux_data
-  );
+  rb_iter_t iter;
+  rb_iter_init( &iter, tree );
+  for ( rb_node_t *node; (node = rb_iter_next( &iter )) != NULL; ) {
+    if ( visitor( node->data, aux_data ) )
+      return node;
+  } // for
+  return NULL;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -56,6 +56,9 @@
 #include "pjl_config.h"                 /* must go first */
 #include "util.h"
 
+// standard
+#include <stddef.h>                     /* for size_t */
+
 /**
  * @defgroup red-black-group Red-Black Tree
  * Types and functions for manipulating red-black trees.
@@ -64,7 +67,9 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+typedef struct rb_iter  rb_iter_t;
 typedef struct rb_node  rb_node_t;
+typedef struct rb_slab  rb_slab_t;
 typedef struct rb_tree  rb_tree_t;
 typedef enum   rb_color rb_color_t;
 
@@ -124,10 +129,60 @@ struct rb_node {
 struct rb_tree {
   rb_node_t     root;                   ///< Root node.
   rb_data_cmp_t data_cmp_fn;            ///< Data comparison function.
+  rb_node_t    *free_nodes;             ///< Free nodes (internal use only).
+  rb_slab_t    *slabs;                  ///< Node slabs (internal use only).
+};
+
+/**
+ * A red-black tree in-order iterator.
+ *
+ * @sa rb_iter_init()
+ * @sa rb_iter_next()
+ */
+struct rb_iter {
+  rb_tree_t  *tree;                     ///< Tree (internal use only).
+  rb_node_t  *next;                     ///< Next node (internal use only).
 };
 
 ////////// extern functions ///////////////////////////////////////////////////
 
+/**
+ * Initializes an in-order iterator over \a tree.
+ *
+ * @param iter A pointer to the iterator to initialize.
+ * @param tree A pointer to the red-black tree to iterate over.  It must not
+ * be modified while \a iter is in use.
+ *
+ * @sa rb_iter_next()
+ */
+void rb_iter_init( rb_iter_t *iter, rb_tree_t const *tree );
+
+/**
+ * Gets the next node of an in-order iteration.  Iteration may be stopped at
+ * any point simply by not calling this function again.
+ *
+ * @param iter A pointer to the iterator to advance.
+ * @return Returns a pointer to the next node or NULL if there are no more.
+ *
+ * @sa rb_iter_init()
+ */
+PJL_WARN_UNUSED_RESULT
+rb_node_t* rb_iter_next( rb_iter_t *iter );
+
+/**
+ * Builds \a tree from an array of data in O(n) time.
+ *
+ * @param tree A pointer to the red-black tree to build.  It must have been
+ * initialized and be empty.
+ * @param data An array of pointers to data that must be sorted in strictly
+ * ascending order according to the tree's data comparison function.
+ * @param n The number of elements in \a data.
+ *
+ * @sa rb_tree_init()
+ * @sa rb_tree_insert()
+ */
+void rb_tree_build( rb_tree_t *tree, void *data[], size_t n );
+
 /**
  * Deletes \a node from \a tree.
  *
@@ -28,14 +28,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sysexits.h>
+#include <time.h>
 
 ///////////////////////////////////////////////////////////////////////////////
 
 // extern variable definitions
 char const       *me;                   ///< Program name.
 
-////////// local functions ////////////////////////////////////////////////////
-
 /**
  * Prints that \a EXPR failed and increments the test failure count.
  *
@@ -57,12 +56,62 @@ static unsigned test_failures;
 
 ////////// local functions ////////////////////////////////////////////////////
 
+/**
+ * Checks that the sub-tree rooted at \a node satisfies the red-black tree
+ * properties.
+ *
+ * @param node A pointer to the `rb_node` to check.
+ * @return Returns the black height of the sub-tree or -1 if invalid.
+ */
+static int rb_test_check_node( rb_node_t const *node ) {
+  if ( node->data == NULL )             // NIL sentinel
+    return node->color == RB_BLACK ? 1 : -1;
+  for ( unsigned i = 0; i < 2; ++i ) {
+    rb_node_t const *const child = node->child[i];
+    if ( child->data == NULL )
+      continue;
+    if ( child->parent != node )
+      return -1;
+    if ( node->color == RB_RED && child->color == RB_RED )
+      return -1;
+  } // for
+  int const l_height = rb_test_check_node( node->child[0] );
+  int const r_height = rb_test_check_node( node->child[1] );
+  if ( l_height < 0 || l_height != r_height )
+    return -1;
+  return l_height + (node->color == RB_BLACK);
+}
+
+/**
+ * Checks that \a tree satisfies the red-black tree properties.
+ *
+ * @param tree A pointer to the red-black tree to check.
+ * @return Returns `true` only if \a tree is valid.
+ */
+static bool rb_test_check_tree( rb_tree_t const *tree ) {
+  rb_node_t const *const first = tree->root.child[0];
+  return  (first->data == NULL || first->color == RB_BLACK) &&
+          rb_test_check_node( first ) > 0;
+}
+
 static int rb_test_data_cmp( void const *i_data, void const *j_data ) {
   char const *const i_str = i_data;
   char const *const j_str = j_data;
   return strcmp( i_str, j_str );
 }
 
+static int rb_test_int_cmp( void const *i_data, void const *j_data ) {
+  long const *const i_ptr = i_data;
+  long const *const j_ptr = j_data;
+  return (*i_ptr > *j_ptr) - (*i_ptr < *j_ptr);
+}
+
+static bool rb_test_stop_visitor( void *node_data, void *aux_data ) {
+  char const *const str = node_data;
+  char const *const stop_str = aux_data;
+  return strcmp( str, stop_str ) == 0;
+}
+
 static bool rb_test_visitor( void *node_data, void *aux_data ) {
   char const *const str = node_data;
   unsigned *const letter_offset_ptr = aux_data;
@@ -73,16 +122,173 @@ static bool rb_test_visitor( void *node_data, void *aux_data ) {
 }
 
 static noreturn void usage( void ) {
-  EPRINTF( "usage: %s\n", me );
+  EPRINTF( "usage: %s [benchmark-count]\n", me );
   exit( EX_USAGE );
 }
 
+/**
+ * Gets the number of milliseconds elapsed since \a start.
+ *
+ * @param start The start time.
+ * @return Returns said number of milliseconds.
+ */
+static double elapsed_ms( clock_t start ) {
+  return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+/**
+ * Benchmarks building a tree of \a n sorted elements by insertion versus by
+ * rb_tree_build(), then iterating over and finding every element.
+ *
+ * @param n The number of elements.
+ */
+static void rb_test_benchmark( size_t n ) {
+  long *const value = MALLOC( long, n );
+  void **const data = MALLOC( void*, n );
+  for ( size_t i = 0; i < n; ++i ) {
+    value[i] = (long)i;
+    data[i] = &value[i];
+  } // for
+
+  rb_tree_t tree;
+  rb_tree_init( &tree, &rb_test_int_cmp );
+  clock_t start = clock();
+  for ( size_t i = 0; i < n; ++i )
+    PJL_IGNORE_RV( rb_tree_insert( &tree, data[i] ) );
+  printf( "insert %zu sorted: %.3f ms\n", n, elapsed_ms( start ) );
+  TEST( rb_test_check_tree( &tree ) );
+  rb_tree_free( &tree, NULL );
+
+  rb_tree_init( &tree, &rb_test_int_cmp );
+  start = clock();
+  rb_tree_build( &tree, data, n );
+  printf( "build %zu sorted: %.3f ms\n", n, elapsed_ms( start ) );
+  TEST( rb_test_check_tree( &tree ) );
+
+  start = clock();
+  size_t count = 0;
+  rb_iter_t iter;
+  rb_iter_init( &iter, &tree );
+  while ( rb_iter_next( &iter ) != NULL )
+    ++count;
+  printf( "iterate %zu: %.3f ms\n", count, elapsed_ms( start ) );
+  TEST( count == n );
+
+  start = clock();
+  for ( size_t i = 0; i < n; ++i )
+    TEST( rb_tree_find( &tree, data[i] ) != NULL );
+  printf( "find %zu: %.3f ms\n", n, elapsed_ms( start ) );
+
+  rb_tree_free( &tree, NULL );
+  free( data );
+  free( value );
+}
+
+/**
+ * Tests that inserting and deleting \a n elements in pseudo-random order keeps
+ * the tree valid.
+ *
+ * @param n The number of elements.
+ */
+static void rb_test_insert_delete( size_t n ) {
+  long *const value = MALLOC( long, n );
+  for ( size_t i = 0; i < n; ++i )
+    value[i] = (long)i;
+  for ( size_t i = n - 1; i > 0; --i ) {
+    size_t const j = (size_t)rand() % (i + 1);
+    long const t = value[i];
+    value[i] = value[j];
+    value[j] = t;
+  } // for
+
+  rb_tree_t tree;
+  rb_tree_init( &tree, &rb_test_int_cmp );
+  for ( size_t i = 0; i < n; ++i )
+    TEST( rb_tree_insert( &tree, &value[i] ) == NULL );
+  TEST( rb_test_check_tree( &tree ) );
+
+  for ( size_t i = 0; i < n; i += 2 ) {
+    rb_node_t *const node = rb_tree_find( &tree, &value[i] );
+    if ( TEST( node != NULL ) )
+      TEST( rb_tree_delete( &tree, node ) == &value[i] );
+  } // for
+  TEST( rb_test_check_tree( &tree ) );
+
+  for ( size_t i = 0; i < n; ++i )
+    TEST( (rb_tree_find( &tree, &value[i] ) == NULL) == (i % 2 == 0) );
+
+  rb_tree_free( &tree, NULL );
+  free( value );
+}
+
+/**
+ * Tests rb_tree_build() for all sizes up to \a max_n.
+ *
+ * @param max_n The maximum number of elements.
+ */
+static void rb_test_build( size_t max_n ) {
+  long *const value = MALLOC( long, max_n );
+  void **const data = MALLOC( void*, max_n );
+  for ( size_t i = 0; i < max_n; ++i ) {
+    value[i] = (long)i * 2;
+    data[i] = &value[i];
+  } // for
+
+  for ( size_t n = 0; n <= max_n; ++n ) {
+    rb_tree_t tree;
+    rb_tree_init( &tree, &rb_test_int_cmp );
+    rb_tree_build( &tree, data, n );
+    TEST( rb_test_check_tree( &tree ) );
+
+    // test iterator yields all data in order
+    rb_iter_t iter;
+    rb_iter_init( &iter, &tree );
+    size_t i = 0;
+    for ( rb_node_t *node; (node = rb_iter_next( &iter )) != NULL; ++i ) {
+      if ( !TEST( i < n ) )
+        break;
+      TEST( node->data == data[i] );
+    } // for
+    TEST( i == n );
+
+    // test find, insert, and delete still work after building
+    for ( i = 0; i < n; ++i )
+      TEST( rb_tree_find( &tree, data[i] ) != NULL );
+    long odd = 1;
+    TEST( rb_tree_find( &tree, &odd ) == NULL );
+    TEST( rb_tree_insert( &tree, &odd ) == NULL );
+    TEST( rb_test_check_tree( &tree ) );
+    if ( n > 0 ) {
+      rb_node_t *const node = rb_tree_find( &tree, data[ n / 2 ] );
+      if ( TEST( node != NULL ) ) {
+        TEST( rb_tree_delete( &tree, node ) == data[ n / 2 ] );
+        TEST( rb_test_check_tree( &tree ) );
+        TEST( rb_tree_find( &tree, data[ n / 2 ] ) == NULL );
+      }
+    }
+
+    rb_tree_free( &tree, NULL );
+  } // for
+
+  free( data );
+  free( value );
+}
+
 ////////// main ///////////////////////////////////////////////////////////////
 
 int main( int argc, char const *argv[] ) {
   me = base_name( argv[0] );
-  if ( --argc != 0 )
+  if ( argc > 2 )
     usage();
+  if ( argc == 2 ) {
+    char *end;
+    unsigned long const n = strtoul( argv[1], &end, 10 );
+    if ( *end != '\0' || n == 0 )
+      usage();
+    rb_test_benchmark( n );
+    printf( "%u failures\n", test_failures );
+    exit( test_failures > 0 ? EX_SOFTWARE : EX_OK );
+  }
 
   rb_tree_t tree;
   rb_tree_init( &tree, &rb_test_data_cmp );
@@ -93,6 +299,7 @@ int main( int argc, char const *argv[] ) {
   TEST( rb_tree_insert( &tree, (void*)"B" ) == NULL );
   TEST( rb_tree_insert( &tree, (void*)"C" ) == NULL );
   TEST( rb_tree_insert( &tree, (void*)"D" ) == NULL );
+  TEST( rb_test_check_tree( &tree ) );
 
   // test insertion with existing data
   node = rb_tree_insert( &tree, (void*)"A" );
@@ -103,6 +310,11 @@ int main( int argc, char const *argv[] ) {
   unsigned letter_offset = 0;
   TEST( rb_tree_visit( &tree, &rb_test_visitor, &letter_offset ) == NULL );
 
+  // test visitor early exit
+  node = rb_tree_visit( &tree, &rb_test_stop_visitor, (void*)"B" );
+  if ( TEST( node != NULL ) )
+    TEST( strcmp( node->data, "B" ) == 0 );
+
   // test find
   node = rb_tree_find( &tree, "A" );
   if ( TEST( node != NULL ) ) {
@@ -116,11 +328,21 @@ int main( int argc, char const *argv[] ) {
       // test visitor again
       letter_offset = 1; // skip "A"
       TEST( rb_tree_visit( &tree, &rb_test_visitor, &letter_offset ) == NULL );
+      TEST( rb_test_check_tree( &tree ) );
     }
   }
 
+  // test reuse of a released node
+  TEST( rb_tree_insert( &tree, (void*)"E" ) == NULL );
+  letter_offset = 1;
+  TEST( rb_tree_visit( &tree, &rb_test_visitor, &letter_offset ) == NULL );
+  TEST( letter_offset == 5 );
+
   rb_tree_free( &tree, NULL );
 
+  rb_test_insert_delete( 1000 );
+  rb_test_build( 130 );
+
   printf( "%u failures\n", test_failures );
   exit( test_failures > 0 ? EX_SOFTWARE : EX_OK );
 }
@@ -0,0 +1,581 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/render_plan.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions for caching how ASTs are rendered by their shape.
+ *
+ * An AST's shape is encoded as a sequence of words by a pre-order walk of it
+ * (including function parameters) that also collects pointers to its nodes in
+ * walk order.  A slot in a plan refers to a node by its index into that order,
+ * so executing a plan for a different AST of the same shape prints that AST's
+ * values.
+ *
+ * A plan is recorded by rendering into an in-memory stream and noting where
+ * render_slot() is called.  If a slot refers to a node that isn't part of the
+ * walk (or is reachable more than once), the plan isn't cached.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "render_plan.h"
+#include "c_ast.h"
+#include "c_sname.h"
+#include "english.h"
+#include "options.h"
+#include "util.h"
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @endcond
+
+/**
+ * Number of hash buckets for plans.
+ */
+#define RENDER_PLAN_BUCKETS       256u
+
+/**
+ * Maximum number of cached plans.  When exceeded, all plans are freed.
+ */
+#define RENDER_PLAN_MAX           1024u
+
+/**
+ * Word marking the absence of an AST in a shape key.  It's
+ * <code>\ref K_NONE</code> since that never occurs in a completed AST.
+ */
+#define RENDER_KEY_NO_AST         ((uint64_t)K_NONE)
+
+typedef struct render_op    render_op_t;
+typedef struct render_plan  render_plan_t;
+typedef struct render_rec   render_rec_t;
+typedef struct render_walk  render_walk_t;
+
+/**
+ * A render plan operation.
+ */
+struct render_op {
+  render_slot_t slot;                   ///< What to print.
+  size_t        node;                   ///< Node index for a slot.
+  size_t        text_off;               ///< Text offset for #RENDER_TEXT.
+  size_t        text_len;               ///< Text length for #RENDER_TEXT.
+};
+
+/**
+ * A render plan.
+ */
+struct render_plan {
+  render_plan_t  *next;                 ///< Next plan in the same bucket.
+  uint64_t        hash;                 ///< Hash of \a key.
+  uint64_t       *key;                  ///< Shape key.
+  size_t          key_len;              ///< Number of words in \a key.
+  render_op_t    *ops;                  ///< Operations.
+  size_t          n_ops;                ///< Number of operations.
+  char           *text;                 ///< All literal text.
+};
+
+/**
+ * The state of recording a plan.
+ */
+struct render_rec {
+  FILE         *mem;                    ///< In-memory stream rendered to.
+  char         *buf;                    ///< Buffer of \a mem.
+  size_t        size;                   ///< Size of \a buf.
+  size_t        mark;                   ///< Offset of next literal text.
+  render_op_t  *ops;                    ///< Operations recorded so far.
+  size_t        n_ops;                  ///< Number of operations.
+  size_t        ops_cap;                ///< Capacity of \a ops.
+  bool          ok;                     ///< Is the plan cacheable?
+};
+
+/**
+ * The result of walking an AST: its shape key and its nodes in walk order.
+ */
+struct render_walk {
+  uint64_t       *words;                ///< Shape key.
+  size_t          n_words;              ///< Number of words in \a words.
+  size_t          words_cap;            ///< Capacity of \a words.
+  c_ast_t const **nodes;                ///< Nodes in walk order.
+  size_t          n_nodes;              ///< Number of nodes in \a nodes.
+  size_t          nodes_cap;            ///< Capacity of \a nodes.
+  bool            ok;                   ///< Is the AST's shape cacheable?
+};
+
+// local variable definitions
+static render_plan_t *render_buckets[ RENDER_PLAN_BUCKETS ];
+static size_t         render_n_plans;   ///< Number of cached plans.
+static render_rec_t  *render_rec;       ///< Current recording, if any.
+static render_walk_t  render_walk;      ///< Current walk (reused).
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Hashes a shape key via FNV-1a.
+ *
+ * @param words The key to hash.
+ * @param n_words The number of words in \a words.
+ * @return Returns said hash.
+ */
+PJL_WARN_UNUSED_RESULT
+static uint64_t render_hash( uint64_t const *words, size_t n_words ) {
+  uint64_t hash = 0xCBF29CE484222325u;
+  for ( size_t i = 0; i < n_words; ++i ) {
+    for ( uint64_t w = words[i], b = 0; b < 8; ++b, w >>= 8 ) {
+      hash ^= w & 0xFFu;
+      hash *= 0x100000001B3u;
+    } // for
+  } // for
+  return hash;
+}
+
+/**
+ * Appends an operation to the current recording.
+ *
+ * @param slot What to print.
+ * @param node The node index for a slot.
+ * @param text_off The text offset for #RENDER_TEXT.
+ * @param text_len The text length for #RENDER_TEXT.
+ */
+static void render_rec_push( render_slot_t slot, size_t node, size_t text_off,
+                             size_t text_len ) {
+  render_rec_t *const rec = render_rec;
+  if ( rec->n_ops == rec->ops_cap ) {
+    rec->ops_cap = rec->ops_cap == 0 ? 16 : rec->ops_cap * 2;
+    REALLOC( rec->ops, render_op_t, rec->ops_cap );
+  }
+  rec->ops[ rec->n_ops++ ] = (render_op_t){ slot, node, text_off, text_len };
+}
+
+/**
+ * Appends the literal text rendered since the last operation, if any, to the
+ * current recording.
+ */
+static void render_rec_text( void ) {
+  render_rec_t *const rec = render_rec;
+  FFLUSH( rec->mem );
+  if ( rec->size > rec->mark ) {
+    render_rec_push( RENDER_TEXT, 0, rec->mark, rec->size - rec->mark );
+    rec->mark = rec->size;
+  }
+}
+
+/**
+ * Creates a plan from the current recording and caches it.
+ *
+ * @param hash The hash of the current walk's key.
+ */
+static void render_plan_add( uint64_t hash ) {
+  render_rec_t const *const rec = render_rec;
+
+  if ( render_n_plans == RENDER_PLAN_MAX )
+    render_plan_clear();
+
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  render_plan_t *const plan = MALLOC( render_plan_t, 1 );
+  plan->hash = hash;
+  plan->key_len = render_walk.n_words;
+  plan->key = MALLOC( uint64_t, plan->key_len );
+  memcpy( plan->key, render_walk.words, plan->key_len * sizeof plan->key[0] );
+  plan->n_ops = rec->n_ops;
+  plan->ops = MALLOC( render_op_t, plan->n_ops );
+
+  //
+  // Copy only the literal text (not the values printed for slots) and adjust
+  // the text operations' offsets accordingly.
+  //
+  size_t text_len = 0;
+  for ( size_t i = 0; i < rec->n_ops; ++i ) {
+    if ( rec->ops[i].slot == RENDER_TEXT )
+      text_len += rec->ops[i].text_len;
+  } // for
+  plan->text = MALLOC( char, text_len + 1/*\0*/ );
+  text_len = 0;
+  for ( size_t i = 0; i < rec->n_ops; ++i ) {
+    render_op_t op = rec->ops[i];
+    if ( op.slot == RENDER_TEXT ) {
+      memcpy( plan->text + text_len, rec->buf + op.text_off, op.text_len );
+      op.text_off = text_len;
+      text_len += op.text_len;
+    }
+    plan->ops[i] = op;
+  } // for
+
+  render_plan_t **const bucket = &render_buckets[ hash % RENDER_PLAN_BUCKETS ];
+  plan->next = *bucket;
+  *bucket = plan;
+  ++render_n_plans;
+  alloc_use( prev_a );
+}
+
+/**
+ * Finds the cached plan for the current walk's key, if any.
+ *
+ * @param hash The hash of the current walk's key.
+ * @return Returns said plan or NULL if none.
+ */
+PJL_WARN_UNUSED_RESULT
+static render_plan_t const* render_plan_find( uint64_t hash ) {
+  for ( render_plan_t const *plan = render_buckets[ hash % RENDER_PLAN_BUCKETS ];
+        plan != NULL; plan = plan->next ) {
+    if ( plan->hash == hash && plan->key_len == render_walk.n_words &&
+         memcmp( plan->key, render_walk.words,
+                 plan->key_len * sizeof plan->key[0] ) == 0 ) {
+      return plan;
+    }
+  } // for
+  return NULL;
+}
+
+/**
+ * Executes \a plan for the nodes of the current walk.
+ *
+ * @param plan The plan to execute.
+ * @param out The `FILE` to render to.
+ */
+static void render_plan_exec( render_plan_t const *plan, FILE *out ) {
+  for ( size_t i = 0; i < plan->n_ops; ++i ) {
+    render_op_t const *const op = &plan->ops[i];
+    if ( op->slot == RENDER_TEXT ) {
+      IF_EXIT(
+        fwrite( plan->text + op->text_off, 1, op->text_len, out ) <
+          op->text_len,
+        EX_IOERR
+      );
+    } else {
+      render_slot( out, render_walk.nodes[ op->node ], op->slot );
+    }
+  } // for
+}
+
+/**
+ * Frees a plan.
+ *
+ * @param plan The plan to free.
+ */
+static void render_plan_free( render_plan_t *plan ) {
+  FREE( plan->key );
+  FREE( plan->ops );
+  FREE( plan->text );
+  FREE( plan );
+}
+
+/**
+ * Prints a value of an AST.
+ *
+ * @param out The `FILE` to print to.
+ * @param ast The AST whose value to print.
+ * @param slot Which value to print.
+ */
+static void render_value( FILE *out, c_ast_t const *ast, render_slot_t slot ) {
+  switch ( slot ) {
+    case RENDER_TEXT:
+      assert( slot != RENDER_TEXT );
+      break;
+    case RENDER_ARRAY_SIZE:
+      assert( ast->kind_id == K_ARRAY );
+      FPRINTF( out, "%d", ast->as.array.size );
+      break;
+    case RENDER_BIT_WIDTH:
+      assert( (ast->kind_id & (K_BUILTIN | K_TYPEDEF)) != K_NONE );
+      FPRINTF( out, "%u",
+        ast->kind_id == K_BUILTIN ?
+          ast->as.builtin.bit_width : ast->as.tdef.bit_width
+      );
+      break;
+    case RENDER_CLASS_ENGLISH_NAME:
+      assert( ast->kind_id == K_POINTER_TO_MEMBER );
+      c_sname_english( &ast->as.ptr_mbr.class_sname, out );
+      break;
+    case RENDER_CLASS_FULL_NAME:
+      assert( ast->kind_id == K_POINTER_TO_MEMBER );
+      FPUTS( c_sname_full_name( &ast->as.ptr_mbr.class_sname ), out );
+      break;
+    case RENDER_ECSU_ENGLISH_NAME:
+      assert( ast->kind_id == K_ENUM_CLASS_STRUCT_UNION );
+      c_sname_english( &ast->as.ecsu.ecsu_sname, out );
+      break;
+    case RENDER_ECSU_FULL_NAME:
+      assert( ast->kind_id == K_ENUM_CLASS_STRUCT_UNION );
+      FPUTS( c_sname_full_name( &ast->as.ecsu.ecsu_sname ), out );
+      break;
+    case RENDER_ENGLISH_NAME:
+      c_sname_english( &ast->sname, out );
+      break;
+    case RENDER_FULL_NAME:
+      FPUTS( c_ast_full_name( ast ), out );
+      break;
+    case RENDER_LOCAL_NAME:
+      FPUTS( c_ast_local_name( ast ), out );
+      break;
+    case RENDER_SCOPE_NAME:
+      FPUTS( c_ast_scope_name( ast ), out );
+      break;
+    case RENDER_TDEF_ENGLISH_NAME:
+      assert( ast->kind_id == K_TYPEDEF );
+      c_sname_english( &ast->as.tdef.for_ast->sname, out );
+      break;
+    case RENDER_TDEF_FULL_NAME:
+      assert( ast->kind_id == K_TYPEDEF );
+      FPUTS( c_ast_full_name( ast->as.tdef.for_ast ), out );
+      break;
+    case RENDER_TDEF_LOCAL_NAME:
+      assert( ast->kind_id == K_TYPEDEF );
+      FPUTS( c_ast_local_name( ast->as.tdef.for_ast ), out );
+      break;
+  } // switch
+}
+
+/**
+ * Appends a word to the current walk's key.
+ *
+ * @param word The word to append.
+ */
+static void render_walk_push( uint64_t word ) {
+  render_walk_t *const w = &render_walk;
+  if ( w->n_words == w->words_cap ) {
+    w->words_cap = w->words_cap == 0 ? 64 : w->words_cap * 2;
+    REALLOC( w->words, uint64_t, w->words_cap );
+  }
+  w->words[ w->n_words++ ] = word;
+}
+
+/**
+ * Appends \a type to the current walk's key.
+ *
+ * @param type The type to append.
+ */
+static void render_walk_push_type( c_type_t const *type ) {
+  render_walk_push( type->base_tid );
+  render_walk_push( type->store_tid );
+  render_walk_push( type->attr_tid );
+}
+
+/**
+ * Walks \a ast appending its shape to the current walk's key and its nodes to
+ * the current walk's nodes.
+ *
+ * @param ast The AST to walk.
+ * @param parent_ast The AST that \a ast was reached from, if any.
+ */
+static void render_walk_ast( c_ast_t const *ast, c_ast_t const *parent_ast ) {
+  render_walk_t *const w = &render_walk;
+
+  if ( w->n_nodes == w->nodes_cap ) {
+    w->nodes_cap = w->nodes_cap == 0 ? 16 : w->nodes_cap * 2;
+    REALLOC( w->nodes, c_ast_t const*, w->nodes_cap );
+  }
+  w->nodes[ w->n_nodes++ ] = ast;
+
+  render_walk_push( ast->kind_id );
+  render_walk_push_type( &ast->type );
+
+  //
+  // Renderers follow parent_ast upwards, so it must either be absent or the
+  // node we came from; otherwise the output depends on nodes outside the walk.
+  //
+  if ( ast->parent_ast == NULL )
+    render_walk_push( 0 );
+  else if ( ast->parent_ast == parent_ast )
+    render_walk_push( 1 );
+  else
+    w->ok = false;
+
+  //
+  // Whether a name is present or scoped and the scopes' types affect the
+  // output; the names themselves are slots.
+  //
+  render_walk_push( c_sname_count( &ast->sname ) );
+  FOREACH_SCOPE( scope, &ast->sname, NULL )
+    render_walk_push_type( &c_scope_data( scope )->type );
+
+  switch ( ast->kind_id ) {
+    case K_ARRAY:
+      render_walk_push(
+        ast->as.array.size >= 0 ? 0 : (uint64_t)-ast->as.array.size
+      );
+      render_walk_push( ast->as.array.store_tid );
+      break;
+    case K_BUILTIN:
+      render_walk_push( ast->as.builtin.bit_width > 0 );
+      break;
+    case K_FUNCTION:
+      render_walk_push( ast->as.func.flags );
+      break;
+    case K_OPERATOR:
+      render_walk_push( ast->as.oper.oper_id );
+      render_walk_push( ast->as.oper.flags );
+      break;
+    case K_TYPEDEF:
+      render_walk_push( ast->as.tdef.bit_width > 0 );
+      break;
+    default:
+      /* suppress warning */;
+  } // switch
+
+  if ( (ast->kind_id & K_ANY_FUNCTION_LIKE) != K_NONE &&
+       ast->kind_id != K_USER_DEF_CONVERSION ) {
+    render_walk_push( c_ast_params_count( ast ) );
+    FOREACH_PARAM( param, ast )
+      render_walk_ast( c_param_ast( param ), ast );
+  }
+
+  if ( c_ast_is_parent( ast ) ) {
+    if ( ast->as.parent.of_ast != NULL )
+      render_walk_ast( ast->as.parent.of_ast, ast );
+    else
+      render_walk_push( RENDER_KEY_NO_AST );
+  }
+}
+
+////////// extern functions ///////////////////////////////////////////////////
+
+void render_plan_clear( void ) {
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  for ( size_t i = 0; i < RENDER_PLAN_BUCKETS; ++i ) {
+    for ( render_plan_t *plan = render_buckets[i], *next; plan != NULL;
+          plan = next ) {
+      next = plan->next;
+      render_plan_free( plan );
+    } // for
+    render_buckets[i] = NULL;
+  } // for
+  render_n_plans = 0;
+  alloc_use( prev_a );
+}
+
+void render_plan_cleanup( void ) {
+  render_plan_clear();
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  FREE( render_walk.words );
+  FREE( render_walk.nodes );
+  alloc_use( prev_a );
+  MEM_ZERO( &render_walk );
+}
+
+void render_plan_render( c_ast_t const *ast, render_fn_t render_fn,
+                         void *data, uint64_t key, FILE *out ) {
+  assert( ast != NULL );
+  assert( render_fn != NULL );
+  assert( out != NULL );
+
+#ifdef HAVE_OPEN_MEMSTREAM
+  if ( render_rec != NULL || ast->parent_ast != NULL )
+    goto direct;
+
+  //
+  // Plans and the walk are kept across requests, so they're allocated from
+  // alloc_libc regardless of the current allocator.
+  //
+  allocator_t *const prev_a = alloc_use( &alloc_libc );
+  render_walk.n_words = render_walk.n_nodes = 0;
+  render_walk.ok = true;
+  render_walk_push( REINTERPRET_CAST( uintptr_t, render_fn ) );
+  render_walk_push( key );
+  render_walk_push( opt_lang );
+  render_walk_push( opt_alt_tokens );
+  render_walk_push( opt_east_const );
+  render_walk_push( opt_graph );
+  render_walk_ast( ast, NULL );
+  alloc_use( prev_a );
+  if ( !render_walk.ok )
+    goto direct;
+
+  uint64_t const hash = render_hash( render_walk.words, render_walk.n_words );
+  render_plan_t const *const plan = render_plan_find( hash );
+  if ( plan != NULL ) {
+    render_plan_exec( plan, out );
+    return;
+  }
+
+  render_rec_t rec;
+  MEM_ZERO( &rec );
+  rec.mem = open_memstream( &rec.buf, &rec.size );
+  if ( unlikely( rec.mem == NULL ) )
+    goto direct;
+  rec.ok = true;
+
+  render_rec = &rec;
+  (*render_fn)( ast, data, rec.mem );
+  render_rec_text();
+  render_rec = NULL;
+
+  if ( rec.size > 0 )
+    IF_EXIT( fwrite( rec.buf, 1, rec.size, out ) < rec.size, EX_IOERR );
+  if ( rec.ok ) {
+    render_rec = &rec;
+    render_plan_add( hash );
+    render_rec = NULL;
+  }
+
+  PJL_IGNORE_RV( fclose( rec.mem ) );
+  free( rec.buf );                      // allocated by open_memstream()
+  FREE( rec.ops );
+  return;
+
+direct:
+#endif /* HAVE_OPEN_MEMSTREAM */
+  (*render_fn)( ast, data, out );
+}
+
+void render_slot( FILE *out, c_ast_t const *ast, render_slot_t slot ) {
+  assert( out != NULL );
+  assert( ast != NULL );
+  assert( slot != RENDER_TEXT );
+
+  render_rec_t *const rec = render_rec;
+  if ( rec == NULL || out != rec->mem ) {
+    render_value( out, ast, slot );
+    return;
+  }
+
+  render_rec_text();
+
+  //
+  // Find the node's index in the walk: it must be there exactly once for the
+  // plan to be correct for other ASTs of the same shape.
+  //
+  size_t node = render_walk.n_nodes;
+  for ( size_t i = 0; i < render_walk.n_nodes; ++i ) {
+    if ( render_walk.nodes[i] != ast )
+      continue;
+    if ( node < render_walk.n_nodes ) {
+      rec->ok = false;
+      break;
+    }
+    node = i;
+  } // for
+  if ( node == render_walk.n_nodes )
+    rec->ok = false;
+
+  render_rec_push( slot, node, 0, 0 );
+  render_value( out, ast, slot );
+
+  // The value printed isn't part of the plan's literal text.
+  FFLUSH( rec->mem );
+  rec->mark = rec->size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,134 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/render_plan.h
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef cdecl_render_plan_H
+#define cdecl_render_plan_H
+
+/**
+ * @file
+ * Declares types and functions for caching how ASTs are rendered (as either
+ * gibberish or English) by their shape.
+ *
+ * The output of a renderer for an AST depends only on the AST's _shape_
+ * (kinds, types, structure, and how many scopes each name has) plus the
+ * _values_ of its names, array sizes, and bit-field widths.  The first time an
+ * AST of a given shape is rendered, the renderer is run normally while its
+ * output is recorded as a _plan_: a flat sequence of operations that are
+ * either literal text or a _slot_ that refers to a value in the AST by its
+ * position.  Subsequent ASTs of the same shape are rendered by just executing
+ * the plan.
+ *
+ * For this to work, renderers must print every value via render_slot().
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "types.h"
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <stdint.h>
+#include <stdio.h>
+
+/// @endcond
+
+/**
+ * @defgroup render-plan-group Render Plans
+ * Types and functions for caching how ASTs are rendered by their shape.
+ * @{
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Values of an AST that are printed via render_slot().
+ */
+enum render_slot {
+  RENDER_TEXT,                          ///< Literal text (internal use only).
+  RENDER_ARRAY_SIZE,                    ///< Array size.
+  RENDER_BIT_WIDTH,                     ///< Bit-field width.
+  RENDER_CLASS_ENGLISH_NAME,            ///< Pointer-to-member class in English.
+  RENDER_CLASS_FULL_NAME,               ///< Pointer-to-member class full name.
+  RENDER_ECSU_ENGLISH_NAME,             ///< `enum`, etc., name in English.
+  RENDER_ECSU_FULL_NAME,                ///< `enum`, etc., full name.
+  RENDER_ENGLISH_NAME,                  ///< Name in English.
+  RENDER_FULL_NAME,                     ///< Full name.
+  RENDER_LOCAL_NAME,                    ///< Local name.
+  RENDER_SCOPE_NAME,                    ///< Scope name.
+  RENDER_TDEF_ENGLISH_NAME,             ///< `typedef` type's name in English.
+  RENDER_TDEF_FULL_NAME,                ///< `typedef` type's full name.
+  RENDER_TDEF_LOCAL_NAME,               ///< `typedef` type's local name.
+};
+typedef enum render_slot render_slot_t;
+
+/**
+ * The signature for a function that renders an AST.
+ *
+ * @param ast The AST to render.
+ * @param data Optional data passed to render_plan_render().
+ * @param out The `FILE` to render to.
+ */
+typedef void (*render_fn_t)( c_ast_t const *ast, void *data, FILE *out );
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Frees all cached render plans.  This must be called whenever any setting
+ * that affects rendering changes other than those included in the key
+ * (`opt_alt_tokens`, `opt_east_const`, `opt_graph`, and `opt_lang`).
+ */
+void render_plan_clear( void );
+
+/**
+ * Frees all memory used by render plans.
+ */
+void render_plan_cleanup( void );
+
+/**
+ * Renders \a ast via a cached plan for its shape, if any; otherwise calls \a
+ * render_fn and records a plan for the next AST of the same shape.
+ *
+ * @param ast The AST to render.
+ * @param render_fn The function to render \a ast with.
+ * @param data Optional data passed to \a render_fn.  It must not affect the
+ * output unless it's also reflected in \a key.
+ * @param key Additional caller-specific key for the plan.
+ * @param out The `FILE` to render to.
+ */
+void render_plan_render( c_ast_t const *ast, render_fn_t render_fn,
+                         void *data, uint64_t key, FILE *out );
+
+/**
+ * Prints a value of an AST.  A renderer must print all values only via this
+ * function.
+ *
+ * @param out The `FILE` to print to.
+ * @param ast The AST whose value to print.
+ * @param slot Which value to print.
+ */
+void render_slot( FILE *out, c_ast_t const *ast, render_slot_t slot );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** @} */
+
+#endif /* cdecl_render_plan_H */
+/* vim:set et sw=2 ts=2: */
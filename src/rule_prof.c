@@ -0,0 +1,206 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/rule_prof.c
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * Defines functions for profiling grammar rules.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+#include "rule_prof.h"
+#include "alloc.h"
+#include "cdecl.h"
+#include "isolate.h"
+#include "util.h"
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <time.h>
+
+/// @endcond
+
+// local functions
+PJL_WARN_UNUSED_RESULT
+static void*  rule_prof_realloc( allocator_t*, void*, size_t );
+
+static void   rule_prof_free( allocator_t*, void* );
+
+// extern variable definitions
+size_t rule_prof_asts;
+
+// local variable definitions
+static allocator_t  rule_prof_alloc = { &rule_prof_realloc, &rule_prof_free };
+static allocator_t *rule_prof_alloc_parent;
+static size_t       rule_prof_allocs;   ///< (Re)allocations so far.
+static size_t       rule_prof_bytes;    ///< Bytes (re)allocated so far.
+static rule_prof_t *rule_prof_head;     ///< Rules profiled so far.
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Compares two rules for sorting by descending time, then by rule name and
+ * production.
+ *
+ * @param i_data A pointer to a pointer to the first rule.
+ * @param j_data A pointer to a pointer to the second rule.
+ * @return Returns a number less than 0, 0, or greater than 0 if \a i_data is
+ * less than, equal to, or greater than \a j_data, respectively.
+ */
+PJL_WARN_UNUSED_RESULT
+static int rule_prof_cmp( void const *i_data, void const *j_data ) {
+  rule_prof_t const *const i = *REINTERPRET_CAST( rule_prof_t const**, i_data );
+  rule_prof_t const *const j = *REINTERPRET_CAST( rule_prof_t const**, j_data );
+  if ( i->nsec != j->nsec )
+    return i->nsec > j->nsec ? -1 : 1;
+  int const cmp = strcmp( i->name, j->name );
+  return cmp != 0 ? cmp : strcmp( i->prod, j->prod );
+}
+
+/**
+ * Frees memory via the parent allocator.
+ *
+ * @param a Not used.
+ * @param p The pointer to the memory to free.
+ */
+static void rule_prof_free( allocator_t *a, void *p ) {
+  (void)a;
+  (*rule_prof_alloc_parent->free_fn)( rule_prof_alloc_parent, p );
+}
+
+/**
+ * Gets the current time.
+ *
+ * @return Returns said time in nanoseconds.
+ */
+PJL_WARN_UNUSED_RESULT
+static uint64_t rule_prof_now( void ) {
+  struct timespec now;
+  IF_EXIT( clock_gettime( CLOCK_MONOTONIC, &now ) == -1, EX_OSERR );
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * Reallocates memory via the parent allocator counting the allocation.
+ *
+ * @param a Not used.
+ * @param p The pointer to reallocate or NULL to allocate new memory.
+ * @param size The number of bytes to allocate.
+ * @return Returns a pointer to the allocated memory or NULL if it could not
+ * be allocated.
+ */
+static void* rule_prof_realloc( allocator_t *a, void *p, size_t size ) {
+  (void)a;
+  ++rule_prof_allocs;
+  rule_prof_bytes += size;
+  return (*rule_prof_alloc_parent->realloc_fn)(
+    rule_prof_alloc_parent, p, size
+  );
+}
+
+/**
+ * Prints the profile report sorted by descending time.
+ *
+ * @note This is called via **atexit**(3).  It does nothing in a job started by
+ * isolate_files().
+ */
+static void rule_prof_report( void ) {
+  if ( isolate_in_job() )
+    return;
+  FILE *out = stderr;
+  char const *const path = getenv( "CDECL_RULE_PROFILE" );
+  if ( path != NULL && (out = fopen( path, "w" )) == NULL ) {
+    EPRINTF( "%s: \"%s\": %s\n", me, path, STRERROR() );
+    out = stderr;
+  }
+
+  size_t n = 0;
+  for ( rule_prof_t const *rule = rule_prof_head; rule != NULL;
+        rule = rule->next ) {
+    ++n;
+  } // for
+
+  rule_prof_t **const rules = MALLOC( rule_prof_t*, n );
+  n = 0;
+  for ( rule_prof_t *rule = rule_prof_head; rule != NULL; rule = rule->next )
+    rules[ n++ ] = rule;
+  qsort( rules, n, sizeof( rule_prof_t* ), &rule_prof_cmp );
+
+  FPRINTF( out,
+    "%10s %10s %8s %8s %10s  %s\n",
+    "REDUCTIONS", "MSEC", "ASTS", "ALLOCS", "BYTES", "RULE ::= PRODUCTION"
+  );
+  for ( size_t i = 0; i < n; ++i ) {
+    rule_prof_t const *const rule = rules[i];
+    FPRINTF( out,
+      "%10zu %10.3f %8zu %8zu %10zu  %s ::= %s\n",
+      rule->n_reductions, (double)rule->nsec / 1e6,
+      rule->n_asts, rule->n_allocs, rule->n_bytes,
+      rule->name, rule->prod
+    );
+  } // for
+
+  FREE( rules );
+  if ( out != stderr )
+    PJL_IGNORE_RV( fclose( out ) );
+}
+
+////////// extern functions ///////////////////////////////////////////////////
+
+void rule_prof_end( rule_prof_frame_t *frame ) {
+  assert( frame != NULL );
+  rule_prof_t *const rule = frame->rule;
+  rule->nsec     += rule_prof_now() - frame->start_nsec;
+  rule->n_asts   += rule_prof_asts - frame->start_asts;
+  rule->n_allocs += rule_prof_allocs - frame->start_allocs;
+  rule->n_bytes  += rule_prof_bytes - frame->start_bytes;
+}
+
+void rule_prof_init( void ) {
+  rule_prof_alloc_parent = alloc_use( &rule_prof_alloc );
+  atexit( rule_prof_report );
+}
+
+rule_prof_frame_t rule_prof_start( rule_prof_t *rule ) {
+  assert( rule != NULL );
+  if ( rule->n_reductions++ == 0 ) {
+    rule->next = rule_prof_head;
+    rule_prof_head = rule;
+  }
+  rule_prof_frame_t frame = {
+    .rule = rule,
+    .start_asts = rule_prof_asts,
+    .start_allocs = rule_prof_allocs,
+    .start_bytes = rule_prof_bytes
+  };
+  // Get the time last so as little of our own overhead is counted.
+  frame.start_nsec = rule_prof_now();
+  return frame;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,155 @@
+/*
+**      cdecl -- C gibberish translator
+**      src/rule_prof.h
+**
+**      Copyright (C) 2021  Paul J. Lucas
+**
+**      This program is free software: you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation, either version 3 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef cdecl_rule_prof_H
+#define cdecl_rule_prof_H
+
+/**
+ * @file
+ * Declares types, macros, and functions for profiling grammar rules, i.e.,
+ * accumulating, per grammar rule and production, the number of reductions,
+ * the time spent in their actions, and the number of AST nodes and bytes
+ * allocated by their actions.
+ *
+ * A rule's action is profiled from its #RULE_PROF_START() (that's part of
+ * `DUMP_START()`) to the end of its action's block by whatever means it's
+ * left.  Times are inclusive of any nested parsing (e.g., via `reload`).
+ *
+ * All this is compiled in only if configured with `--enable-rule-profile`.
+ */
+
+// local
+#include "pjl_config.h"                 /* must go first */
+
+/// @cond DOXYGEN_IGNORE
+
+// standard
+#include <stddef.h>                     /* for size_t */
+#include <stdint.h>
+
+/// @endcond
+
+/**
+ * @defgroup rule-prof-group Grammar Rule Profiling
+ * Types, macros, and functions for profiling grammar rules.
+ * @{
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef ENABLE_RULE_PROFILE
+
+typedef struct rule_prof        rule_prof_t;
+typedef struct rule_prof_frame  rule_prof_frame_t;
+
+/**
+ * Profile data for one grammar rule's production.
+ */
+struct rule_prof {
+  char const   *name;                   ///< Grammar rule name.
+  char const   *prod;                   ///< Grammar production.
+  rule_prof_t  *next;                   ///< Next rule profiled.
+  size_t        n_reductions;           ///< Number of reductions.
+  uint64_t      nsec;                   ///< Nanoseconds spent in action.
+  size_t        n_asts;                 ///< AST nodes allocated.
+  size_t        n_allocs;               ///< Number of (re)allocations.
+  size_t        n_bytes;                ///< Bytes (re)allocated.
+};
+
+/**
+ * The state of one in-progress profiled action.
+ */
+struct rule_prof_frame {
+  rule_prof_t  *rule;                   ///< Rule being profiled.
+  uint64_t      start_nsec;             ///< Time the action started.
+  size_t        start_asts;             ///< AST nodes at start.
+  size_t        start_allocs;           ///< Allocations at start.
+  size_t        start_bytes;            ///< Bytes at start.
+};
+
+/**
+ * Starts profiling the current grammar rule's action until the end of the
+ * enclosing block.
+ *
+ * @param NAME The grammar rule name.
+ * @param PROD The grammar production.
+ *
+ * @sa #RULE_PROF_AST_NEW()
+ */
+#define RULE_PROF_START(NAME,PROD)                                  \
+  static rule_prof_t rule_prof = { (NAME), (PROD), NULL, 0, 0, 0, 0, 0 }; \
+  rule_prof_frame_t rule_prof_frame                                 \
+    __attribute__((cleanup(rule_prof_end))) = rule_prof_start( &rule_prof )
+
+/**
+ * Counts a newly allocated AST node.
+ *
+ * @sa #RULE_PROF_START()
+ */
+#define RULE_PROF_AST_NEW()       (++rule_prof_asts)
+
+/**
+ * The number of AST nodes allocated so far.
+ */
+extern size_t rule_prof_asts;
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Ends profiling a grammar rule's action.
+ *
+ * @note This is called only via #RULE_PROF_START().
+ *
+ * @param frame A pointer to the frame started by rule_prof_start().
+ */
+void rule_prof_end( rule_prof_frame_t *frame );
+
+/**
+ * Initializes grammar rule profiling: installs an allocator that counts
+ * allocations and arranges for a report, sorted by time, to be printed upon
+ * exit either to the file named by the `CDECL_RULE_PROFILE` environment
+ * variable, if set, or to standard error.
+ */
+void rule_prof_init( void );
+
+/**
+ * Starts profiling a grammar rule's action.
+ *
+ * @note This is called only via #RULE_PROF_START().
+ *
+ * @param rule A pointer to the rule to profile.
+ * @return Returns a new frame.
+ */
+PJL_WARN_UNUSED_RESULT
+rule_prof_frame_t rule_prof_start( rule_prof_t *rule );
+
+#else /* ENABLE_RULE_PROFILE */
+
+#define RULE_PROF_START(NAME,PROD)  /* nothing */
+#define RULE_PROF_AST_NEW()         ((void)0)
+
+#endif /* ENABLE_RULE_PROFILE */
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** @} */
+
+#endif /* cdecl_rule_prof_H */
+/* vim:set et sw=2 ts=2: */
@@ -81,6 +81,7 @@ DECLARE_SET_OPTION_FN( lang );
 DECLARE_SET_OPTION_FN( prompt );
 DECLARE_SET_OPTION_FN( semicolon );
 DECLARE_SET_OPTION_FN( trigraphs );
+DECLARE_SET_OPTION_FN( typedef_hints );
 
 PJL_WARN_UNUSED_RESULT
 static bool set_lang_impl( char const* );
@@ -89,6 +90,9 @@ static bool set_lang_impl( char const* );
 
 /**
  * cdecl `set` options.
+ *
+ * @note Every option's value must also be saved and restored by
+ * options_save() and options_restore().
  */
 static set_option_t const SET_OPTIONS[] = {
   { "alt-tokens",         SET_OPT_TOGGLE,   false,  &set_alt_tokens         },
@@ -110,6 +114,7 @@ static set_option_t const SET_OPTIONS[] = {
   { "prompt",             SET_OPT_TOGGLE,   false,  &set_prompt             },
   { "semicolon",          SET_OPT_TOGGLE,   false,  &set_semicolon          },
   { "trigraphs",          SET_OPT_AFF_ONLY, false,  &set_trigraphs          },
+  { "typedef-hints",      SET_OPT_TOGGLE,   false,  &set_typedef_hints      },
   { NULL,                 SET_OPT_TOGGLE,   false,  NULL                    }
 };
 
@@ -156,8 +161,9 @@ static void print_options( FILE *out ) {
 #endif /* ENABLE_FLEX_DEBUG */
   FPRINTF( out, " %sgraphs\n", opt_graph == C_GRAPH_DI ? " di" : opt_graph == C_GRAPH_TRI ? "tri" : " no" );
   FPRINTF( out, "    lang=%s\n", c_lang_name( opt_lang ) );
-  FPRINTF( out, "  %sprompt\n", maybe_no( cdecl_prompt[0][0] != '\0' ) );
+  FPRINTF( out, "  %sprompt\n", maybe_no( cdecl_prompt_enabled() ) );
   FPRINTF( out, "  %ssemicolon\n", maybe_no( opt_semicolon ) );
+  FPRINTF( out, "  %stypedef-hints\n", maybe_no( opt_typedef_hints ) );
 }
 
 /**
@@ -317,6 +323,15 @@ static void set_trigraphs( set_option_fn_args_t const *args ) {
   }
 }
 
+/**
+ * Sets the typedef-hints option.
+ *
+ * @param args The set option arguments.
+ */
+static void set_typedef_hints( set_option_fn_args_t const *args ) {
+  opt_typedef_hints = args->opt_enabled;
+}
+
 /**
  * Compares strings for at most \a n characters ignoring hyphens for equality.
  *
@@ -432,6 +447,28 @@ void option_set( char const *opt_name, c_loc_t const *opt_name_loc,
   (*found_opt->set_fn)( &args );
 }
 
+void print_set_commands( FILE *out ) {
+  FPRINTF( out, "set %salt-tokens\n", opt_alt_tokens ? "" : "no" );
+  FPRINTF( out, "set %seast-const\n", opt_east_const ? "" : "no" );
+  FPRINTF( out, "set %sexplain-by-default\n", opt_explain ? "" : "no" );
+
+  if ( any_explicit_int() ) {
+    FPUTS( "set explicit-int=", out );
+    print_explicit_int( out );
+    FPUTC( '\n', out );
+  } else {
+    FPUTS( "set noexplicit-int\n", out );
+  }
+
+  FPRINTF( out, "set %sgraphs\n",
+    opt_graph == C_GRAPH_DI ? "di" : opt_graph == C_GRAPH_TRI ? "tri" : "no"
+  );
+  FPRINTF( out, "set lang=%s\n", c_lang_name( opt_lang ) );
+  FPRINTF( out, "set %sprompt\n", cdecl_prompt_enabled() ? "" : "no" );
+  FPRINTF( out, "set %ssemicolon\n", opt_semicolon ? "" : "no" );
+  FPRINTF( out, "set %stypedef-hints\n", opt_typedef_hints ? "" : "no" );
+}
+
 set_option_t const* set_option_next( set_option_t const *opt ) {
   if ( opt == NULL )
     opt = SET_OPTIONS;
@@ -34,6 +34,7 @@
 
 // standard
 #include <stdbool.h>
+#include <stdio.h>                      /* for FILE */
 
 /// @endcond
 
@@ -93,6 +94,14 @@ typedef struct set_option set_option_t;
 void option_set( char const *opt_name, c_loc_t const *opt_name_loc,
                  char const *opt_value, c_loc_t const *opt_value_loc );
 
+/**
+ * Prints the current values of all options that affect output as `set`
+ * commands that, when parsed, restore them.
+ *
+ * @param out The `FILE` to print to.
+ */
+void print_set_commands( FILE *out );
+
 /**
  * Iterates to the next cdecl `set` option.
  *
@@ -92,8 +92,10 @@ bool strbuf_reserve( strbuf_t *sbuf, size_t res_len ) {
   size_t const buf_rem = sbuf->cap - sbuf->len;
   if ( res_len >= buf_rem ) {
     size_t const new_len = sbuf->len + res_len;
+    size_t const old_cap = sbuf->cap;
     sbuf->cap = next_pow_2( new_len );
     REALLOC( sbuf->str, char, sbuf->cap );
+    alloc_sub_add( ALLOC_SUB_STRBUF, old_cap == 0, sbuf->cap - old_cap );
     return true;
   }
   return false;
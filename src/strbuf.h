@@ -35,7 +35,6 @@
 // standard
 #include <stdbool.h>
 #include <stddef.h>                     /* for size_t */
-#include <stdlib.h>                     /* for free(3) */
 #include <string.h>
 
 _GL_INLINE_HEADER_BEGIN
@@ -148,7 +147,8 @@ void strbuf_init( strbuf_t *sbuf ) {
  */
 STRBUF_INLINE
 void strbuf_free( strbuf_t *sbuf ) {
-  free( sbuf->str );
+  if ( sbuf->cap > 0 )
+    FREE_SUB( ALLOC_SUB_STRBUF, sbuf->str, sbuf->cap );
   strbuf_init( sbuf );
 }
 
@@ -260,6 +260,8 @@ void strbuf_sepc_cats( strbuf_t *sbuf, char sep, bool *sep_flag,
 STRBUF_INLINE PJL_WARN_UNUSED_RESULT
 char* strbuf_take( strbuf_t *sbuf ) {
   char *const str = sbuf->str;
+  if ( sbuf->cap > 0 )
+    alloc_sub_remove( ALLOC_SUB_STRBUF, 1, sbuf->cap );
   strbuf_init( sbuf );
   return str;
 }
@@ -122,6 +122,14 @@ struct c_ast_pair {
    * subsequent additions to the AST.
    */
   c_ast_t *target_ast;
+
+  /**
+   * If not NULL, the array most recently added to the end of the chain of
+   * arrays of \ref target_ast (if not NULL) or \ref ast.  A subsequent array
+   * at the same depth can be appended directly to it rather than walking the
+   * chain again.
+   */
+  c_ast_t *tail_ast;
 };
 
 /**
@@ -100,26 +100,17 @@ char const* base_name( char const *path_name ) {
 }
 
 void* check_realloc( void *p, size_t size ) {
-  //
-  // Autoconf, 5.5.1:
-  //
-  // realloc
-  //    The C standard says a call realloc(NULL, size) is equivalent to
-  //    malloc(size), but some old systems don't support this (e.g., NextStep).
-  //
-  if ( unlikely( size == 0 ) )
-    size = 1;
-  p = p != NULL ? realloc( p, size ) : malloc( size );
-  IF_EXIT( p == NULL, EX_OSERR );
-  return p;
+  void *const new_p = alloc_realloc( p, size );
+  if ( unlikely( new_p == NULL ) )
+    alloc_oom( size );
+  return new_p;
 }
 
 char* check_strdup( char const *s ) {
   if ( s == NULL )
     return NULL;
-  char *const dup_s = strdup( s );
-  IF_EXIT( dup_s == NULL, EX_OSERR );
-  return dup_s;
+  size_t const size = strlen( s ) + 1/*\0*/;
+  return memcpy( MALLOC( char, size ), s, size );
 }
 
 char* check_strdup_tolower( char const *s ) {
@@ -134,8 +125,10 @@ char* check_strdup_tolower( char const *s ) {
 char* check_strndup( char const *s, size_t n ) {
   if ( s == NULL )
     return NULL;
-  char *const dup_s = strndup( s, n );
-  IF_EXIT( dup_s == NULL, EX_OSERR );
+  n = strnlen( s, n );
+  char *const dup_s = MALLOC( char, n + 1/*\0*/ );
+  memcpy( dup_s, s, n );
+  dup_s[ n ] = '\0';
   return dup_s;
 }
 
@@ -162,11 +155,14 @@ FILE* fmemopen( void *buf, size_t size, char const *mode ) {
 void* free_later( void *p ) {
   assert( p != NULL );
   slist_push_tail( &free_later_list, p );
+  alloc_sub_add( ALLOC_SUB_FREE_LATER, 1, sizeof(slist_node_t) );
   return p;
 }
 
 void free_now( void ) {
-  slist_free( &free_later_list, NULL, &free );
+  size_t const len = slist_len( &free_later_list );
+  alloc_sub_remove( ALLOC_SUB_FREE_LATER, len, len * sizeof(slist_node_t) );
+  slist_free( &free_later_list, NULL, &alloc_free );
 }
 
 #ifdef ENABLE_TERM_SIZE
@@ -28,6 +28,7 @@
 
 // local
 #include "pjl_config.h"                 /* must go first */
+#include "alloc.h"
 
 /// @cond DOXYGEN_IGNORE
 
@@ -276,14 +277,30 @@ _GL_INLINE_HEADER_BEGIN
   IF_EXIT( fputs( (S), (STREAM) ) == EOF, EX_IOERR )
 
 /**
- * Frees the given memory.
+ * Frees the given memory using the current allocator.
  *
  * @param PTR The pointer to the memory to free.
  *
  * @remarks
  * This macro exists since free'ing a pointer to `const` generates a warning.
+ *
+ * @sa alloc_free()
+ */
+#define FREE(PTR)                 alloc_free( CONST_CAST( void*, (PTR) ) )
+
+/**
+ * Frees the given memory like #FREE() and accounts for it as freed by a
+ * subsystem.
+ *
+ * @param SUB The <code>\ref alloc_sub</code> that allocated the memory.
+ * @param PTR The pointer to the memory to free.
+ * @param SIZE The number of bytes \a PTR was allocated with.
+ *
+ * @sa alloc_sub_remove()
+ * @sa #MALLOC_SUB()
  */
-#define FREE(PTR)                 free( CONST_CAST( void*, (PTR) ) )
+#define FREE_SUB(SUB,PTR,SIZE) \
+  BLOCK( alloc_sub_remove( (SUB), 1, (SIZE) ); FREE( PTR ); )
 
 /**
  * Calls **fstat**(3), checks for an error, and exits if there was one.
@@ -335,6 +352,21 @@ _GL_INLINE_HEADER_BEGIN
  */
 #define MALLOC(TYPE,N)            check_realloc( NULL, sizeof(TYPE) * (N) )
 
+/**
+ * Allocates memory like #MALLOC() and accounts for it as one object allocated
+ * by a subsystem.
+ *
+ * @param SUB The <code>\ref alloc_sub</code> allocating the memory.
+ * @param TYPE The type to allocate.
+ * @param N The number of objects of \a TYPE to allocate.
+ * @return Returns a pointer to \a N uninitialized objects of \a TYPE.
+ *
+ * @sa alloc_sub_add()
+ * @sa #FREE_SUB()
+ */
+#define MALLOC_SUB(SUB,TYPE,N) \
+  ( alloc_sub_add( (SUB), 1, sizeof(TYPE) * (N) ), MALLOC( TYPE, (N) ) )
+
 /**
  * Zeros the memory pointed to by \a PTR.  The number of bytes to zero is given
  * by `sizeof *(PTR)`.
@@ -574,8 +606,8 @@ PJL_WARN_UNUSED_RESULT
 char const* base_name( char const *path_name );
 
 /**
- * Calls **realloc**(3) and checks for failure.
- * If reallocation fails, prints an error message and exits.
+ * Reallocates memory using the current allocator and checks for failure.
+ * If reallocation fails, calls alloc_oom().
  *
  * @param p The pointer to reallocate.  If NULL, new memory is allocated.
  * @param size The number of bytes to allocate.
@@ -588,8 +620,8 @@ PJL_WARN_UNUSED_RESULT
 void* check_realloc( void *p, size_t size );
 
 /**
- * Calls **strdup**(3) and checks for failure.
- * If memory allocation fails, prints an error message and exits.
+ * Duplicates \a s using the current allocator and checks for failure.
+ * If memory allocation fails, calls alloc_oom().
  *
  * @param s The null-terminated string to duplicate or NULL.
  * @return Returns a copy of \a s or NULL if \a s is NULL.
@@ -602,7 +634,7 @@ char* check_strdup( char const *s );
 
 /**
  * Duplicates \a s and checks for failure, but converts all characters to
- * lower-case.  If memory allocation fails, prints an error message and exits.
+ * lower-case.  If memory allocation fails, calls alloc_oom().
  *
  * @param s The null-terminated string to duplicate or NULL.
  * @return Returns a copy of \a s with all characters converted to lower-case
@@ -615,8 +647,8 @@ PJL_WARN_UNUSED_RESULT
 char* check_strdup_tolower( char const *s );
 
 /**
- * Calls **strndup**(3) and checks for failure.
- * If memory allocation fails, prints an error message and exits.
+ * Duplicates at most \a n characters of \a s using the current allocator and
+ * checks for failure.  If memory allocation fails, calls alloc_oom().
  *
  * @param s The null-terminated string to duplicate or NULL.
  * @param n The number of characters of \a s to duplicate.
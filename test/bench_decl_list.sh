@@ -0,0 +1,150 @@
+#! /bin/sh
+##
+#       cdecl -- C gibberish translator
+#       test/bench_decl_list.sh
+#
+#       Copyright (C) 2021  Paul J. Lucas
+#
+#       This program is free software: you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation, either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# Times defining types via a single typedef having thousands of declarators
+# and, for comparison, via as many separate typedefs.  Each time the number of
+# declarators doubles, the time should (roughly) double too; if it
+# quadruples, something has gone quadratic.  With -t, the base type is itself
+# a typedef (of a non-trivial type) rather than a built-in type.
+
+# Uncomment the following line for shell tracing.
+#set -x
+
+########## Functions ##########################################################
+
+error() {
+  exit_status=$1; shift
+  echo $ME: $*
+  exit $exit_status
+}
+
+local_basename() {
+  ##
+  # Autoconf, 11.15:
+  #
+  # basename
+  #   Not all hosts have a working basename. You can use expr instead.
+  ##
+  expr "//$1" : '.*/\(.*\)'
+}
+
+##
+# Prints typedefs of $2 declarators, either all in one typedef if $1 is "list"
+# or each in its own typedef otherwise.  If $3 is non-empty, the base type is a
+# typedef.
+##
+decl_list() {
+  awk -v kind=$1 -v n=$2 -v td=$3 'BEGIN {
+    base = "typedef unsigned long long "
+    if ( td != "" ) {
+      printf( "typedef int (*(*TD)(char, long))[4];\n" )
+      base = "typedef TD "
+    }
+    for ( i = 0; i < n; ++i ) {
+      if ( i % 3 == 0 ) d = "T" i
+      else if ( i % 3 == 1 ) d = "*P" i
+      else d = "(*F" i ")(int)"
+      if ( kind == "list" )
+        printf( "%s%s", i == 0 ? base : ", ", d )
+      else
+        printf( "%s%s;\n", base, d )
+    }
+    if ( kind == "list" )
+      printf( ";\n" )
+  }'
+}
+
+##
+# Prints the current time in milliseconds.
+##
+now_ms() {
+  expr `date +%s%N` / 1000000
+}
+
+##
+# Prints the average time in milliseconds to run cdecl on file $1 $RUNS times.
+##
+time_ms() {
+  START=`now_ms`
+  i=0
+  while [ $i -lt $RUNS ]
+  do
+    "$CDECL" --no-config --no-typedefs "$1" >/dev/null 2>&1 ||
+      error 65 "$KIND $COUNT: cdecl failed"
+    i=`expr $i + 1`
+  done
+  END=`now_ms`
+  expr \( $END - $START \) / $RUNS
+}
+
+usage() {
+  cat >&2 <<END
+usage: $ME [-n runs] [-t] [count ...]
+END
+  exit 1
+}
+
+########## Begin ##############################################################
+
+ME=`local_basename "$0"`
+
+[ "$BUILD_SRC" ] || BUILD_SRC=../src
+CDECL="$BUILD_SRC/cdecl"
+[ -x "$CDECL" ] || error 66 $CDECL: not found or not executable
+
+case `date +%N` in
+[0-9]*) ;;
+*) error 69 "date(1) does not support %N" ;;
+esac
+
+DECL_FILE=/tmp/cdecl_decl_list_$$_
+
+trap "x=$?; rm -f /tmp/*_$$_* 2>/dev/null; exit $x" EXIT HUP INT TERM
+
+########## Process command-line ###############################################
+
+RUNS=5
+TYPEDEF_BASE=
+while getopts n:t opt
+do
+  case $opt in
+  n) RUNS=$OPTARG ;;
+  t) TYPEDEF_BASE=1 ;;
+  ?) usage ;;
+  esac
+done
+shift `expr $OPTIND - 1`
+
+COUNTS=${*:-1000 2000 4000 8000 16000}
+
+########## Run benchmarks #####################################################
+
+printf "%-8s %6s %10s\n" KIND COUNT MSEC
+for KIND in list separate
+do
+  for COUNT in $COUNTS
+  do
+    decl_list $KIND $COUNT $TYPEDEF_BASE > $DECL_FILE
+    printf "%-8s %6d %10d\n" $KIND $COUNT `time_ms $DECL_FILE`
+  done
+done
+
+# vim:set et sw=2 ts=2:
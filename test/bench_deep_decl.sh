@@ -0,0 +1,137 @@
+#! /bin/sh
+##
+#       cdecl -- C gibberish translator
+#       test/bench_deep_decl.sh
+#
+#       Copyright (C) 2021  Paul J. Lucas
+#
+#       This program is free software: you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation, either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# Times explaining declarations whose declarators are nested hundreds of
+# levels deep.  Each time the depth doubles, the time should (roughly) double
+# too; if it quadruples, something has gone quadratic.
+
+# Uncomment the following line for shell tracing.
+#set -x
+
+########## Functions ##########################################################
+
+error() {
+  exit_status=$1; shift
+  echo $ME: $*
+  exit $exit_status
+}
+
+local_basename() {
+  ##
+  # Autoconf, 11.15:
+  #
+  # basename
+  #   Not all hosts have a working basename. You can use expr instead.
+  ##
+  expr "//$1" : '.*/\(.*\)'
+}
+
+##
+# Prints a declaration of kind $1 nested $2 levels deep.
+##
+deep_decl() {
+  awk -v kind=$1 -v n=$2 'BEGIN {
+    d = "int "
+    if ( kind == "array" ) {
+      d = d "a"
+      for ( i = 0; i < n; ++i ) d = d "[2]"
+    }
+    else if ( kind == "func" ) {
+      for ( i = 0; i < n; ++i ) d = d "(*"
+      d = d "f"
+      for ( i = 0; i < n; ++i ) d = d ")()"
+    }
+    else if ( kind == "nested" ) {
+      for ( i = 0; i < n; ++i ) d = d "(*"
+      d = d "p"
+      for ( i = 0; i < n; ++i ) d = d ")"
+    }
+    else if ( kind == "pointer" ) {
+      for ( i = 0; i < n; ++i ) d = d "*"
+      d = d "p"
+    }
+    print d
+  }'
+}
+
+##
+# Prints the current time in milliseconds.
+##
+now_ms() {
+  expr `date +%s%N` / 1000000
+}
+
+usage() {
+  cat >&2 <<END
+usage: $ME [-n runs] [depth ...]
+END
+  exit 1
+}
+
+########## Begin ##############################################################
+
+ME=`local_basename "$0"`
+
+[ "$BUILD_SRC" ] || BUILD_SRC=../src
+CDECL="$BUILD_SRC/cdecl"
+[ -x "$CDECL" ] || error 66 $CDECL: not found or not executable
+
+case `date +%N` in
+[0-9]*) ;;
+*) error 69 "date(1) does not support %N" ;;
+esac
+
+########## Process command-line ###############################################
+
+RUNS=5
+while getopts n: opt
+do
+  case $opt in
+  n) RUNS=$OPTARG ;;
+  ?) usage ;;
+  esac
+done
+shift `expr $OPTIND - 1`
+
+DEPTHS=${*:-100 200 400 800 1600}
+
+########## Run benchmarks #####################################################
+
+printf "%-8s %6s %10s\n" KIND DEPTH MSEC
+for KIND in array func nested pointer
+do
+  for DEPTH in $DEPTHS
+  do
+    DECL=`deep_decl $KIND $DEPTH`
+    START=`now_ms`
+    i=0
+    while [ $i -lt $RUNS ]
+    do
+      "$CDECL" -E explain "$DECL" >/dev/null 2>&1 ||
+        error 65 "$KIND $DEPTH: cdecl failed"
+      i=`expr $i + 1`
+    done
+    END=`now_ms`
+    printf "%-8s %6d %10d\n" $KIND $DEPTH `expr \( $END - $START \) / $RUNS`
+  done
+done
+
+# vim:set et sw=2 ts=2:
@@ -0,0 +1,131 @@
+#! /bin/sh
+##
+#       cdecl -- C gibberish translator
+#       test/bench_startup.sh
+#
+#       Copyright (C) 2021  Paul J. Lucas
+#
+#       This program is free software: you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation, either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# Times how long cdecl takes from exec(2) to exit(3) for a trivial one-shot
+# command, i.e., its startup cost, after subtracting the cost of exec'ing a
+# trivial program.  Predefined types are excluded (via --no-typedefs) since
+# their cost is that of parsing them; their time is printed for reference
+# only.  Exits non-zero if the startup time exceeds the target.
+
+# Uncomment the following line for shell tracing.
+#set -x
+
+########## Functions ##########################################################
+
+error() {
+  exit_status=$1; shift
+  echo $ME: $*
+  exit $exit_status
+}
+
+local_basename() {
+  ##
+  # Autoconf, 11.15:
+  #
+  # basename
+  #   Not all hosts have a working basename. You can use expr instead.
+  ##
+  expr "//$1" : '.*/\(.*\)'
+}
+
+##
+# Prints the current time in microseconds.
+##
+now_usec() {
+  expr `date +%s%N` / 1000
+}
+
+##
+# Prints the average time in microseconds to run the command $* $RUNS times.
+##
+time_usec() {
+  START=`now_usec`
+  i=0
+  while [ $i -lt $RUNS ]
+  do
+    "$@" >/dev/null 2>&1 || error 65 "$*: failed"
+    i=`expr $i + 1`
+  done
+  END=`now_usec`
+  expr \( $END - $START \) / $RUNS
+}
+
+usage() {
+  cat >&2 <<END
+usage: $ME [-n runs] [-t target-usec]
+END
+  exit 1
+}
+
+########## Begin ##############################################################
+
+ME=`local_basename "$0"`
+
+[ "$BUILD_SRC" ] || BUILD_SRC=../src
+CDECL="$BUILD_SRC/cdecl"
+[ -x "$CDECL" ] || error 66 $CDECL: not found or not executable
+
+TRUE=`command -v true`
+case "$TRUE" in
+/*) ;;
+*) TRUE=/bin/true ;;
+esac
+[ -x "$TRUE" ] || error 66 true: not found
+
+case `date +%N` in
+[0-9]*) ;;
+*) error 69 "date(1) does not support %N" ;;
+esac
+
+########## Process command-line ###############################################
+
+RUNS=200
+TARGET_USEC=${CDECL_STARTUP_TARGET_USEC:-1000}
+while getopts n:t: opt
+do
+  case $opt in
+  n) RUNS=$OPTARG ;;
+  t) TARGET_USEC=$OPTARG ;;
+  ?) usage ;;
+  esac
+done
+shift `expr $OPTIND - 1`
+[ $# -eq 0 ] || usage
+
+########## Run benchmarks #####################################################
+
+BASE_USEC=`time_usec "$TRUE"`
+STARTUP_USEC=`time_usec "$CDECL" --no-config --no-typedefs explain int x`
+TYPEDEFS_USEC=`time_usec "$CDECL" --no-config explain int x`
+
+STARTUP_USEC=`expr $STARTUP_USEC - $BASE_USEC`
+TYPEDEFS_USEC=`expr $TYPEDEFS_USEC - $BASE_USEC`
+[ $STARTUP_USEC -ge 0 ] || STARTUP_USEC=0
+
+printf "%-24s %10s\n" STARTUP USEC
+printf "%-24s %10d\n" exec $BASE_USEC
+printf "%-24s %10d\n" "cdecl (no typedefs)" $STARTUP_USEC
+printf "%-24s %10d\n" "cdecl (with typedefs)" $TYPEDEFS_USEC
+
+[ $STARTUP_USEC -le $TARGET_USEC ] ||
+  error 1 "startup time of $STARTUP_USEC usec exceeds target of $TARGET_USEC usec"
+
+# vim:set et sw=2 ts=2:
@@ -0,0 +1,271 @@
+#! /bin/sh
+##
+#       cdecl -- C gibberish translator
+#       test/check_perf.sh
+#
+#       Copyright (C) 2021  Paul J. Lucas
+#
+#       This program is free software: you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation, either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# For every workload in the budgets file, runs cdecl with phase profiling
+# enabled (see src/phase_prof.h) and fails if the number of instructions
+# retired in any phase (lexing, parsing, checking, or rendering) exceeds its
+# budget by more than the tolerance.  A phase that has no budget yet is
+# measured and reported, but not enforced.  Unlike times, instruction counts
+# barely vary from run to run, so this can gate changes even on a noisy
+# machine.
+#
+# If instructions can't be counted (e.g., not Linux, no hardware counters, or
+# not permitted), prints why and exits successfully.
+
+# Uncomment the following line for shell tracing.
+#set -x
+
+########## Functions ##########################################################
+
+error() {
+  exit_status=$1; shift
+  echo $ME: $*
+  exit $exit_status
+}
+
+local_basename() {
+  ##
+  # Autoconf, 11.15:
+  #
+  # basename
+  #   Not all hosts have a working basename. You can use expr instead.
+  ##
+  expr "//$1" : '.*/\(.*\)'
+}
+
+##
+# Prints a synthetic workload of kind $1 and size $2:
+#
+#   array     An array declaration having $2 dimensions.
+#   decl_list A typedef having $2 declarators.
+#   func      A declaration of functions returning pointers to functions
+#             nested $2 levels deep.
+#   pointer   A declaration of $2 levels of pointer.
+##
+synthetic() {
+  awk -v kind=$1 -v n=$2 'BEGIN {
+    if ( kind == "array" ) {
+      d = "explain int a"
+      for ( i = 0; i < n; ++i ) d = d "[2]"
+    }
+    else if ( kind == "decl_list" ) {
+      d = "typedef unsigned long long "
+      for ( i = 0; i < n; ++i ) {
+        d = d (i == 0 ? "" : ", ")
+        if ( i % 3 == 0 ) d = d "T" i
+        else if ( i % 3 == 1 ) d = d "*P" i
+        else d = d "(*F" i ")(int)"
+      }
+    }
+    else if ( kind == "func" ) {
+      d = "explain int "
+      for ( i = 0; i < n; ++i ) d = d "(*"
+      d = d "f"
+      for ( i = 0; i < n; ++i ) d = d ")()"
+    }
+    else if ( kind == "pointer" ) {
+      d = "explain int "
+      for ( i = 0; i < n; ++i ) d = d "*"
+      d = d "p"
+    }
+    else {
+      exit 1
+    }
+    print d
+  }'
+}
+
+##
+# Runs workload $1 with phase profiling enabled writing the profile to
+# $PROFILE.
+##
+run_workload() {
+  rm -f $PROFILE
+  case $1 in
+  synthetic/*)
+    KIND=`expr "$1" : 'synthetic/\(.*\)-[0-9]*$'`
+    SIZE=`expr "$1" : 'synthetic/.*-\([0-9]*\)$'`
+    [ "$KIND" -a "$SIZE" ] || error 65 "$1: invalid synthetic workload"
+    synthetic $KIND $SIZE > $INPUT_FILE ||
+      error 65 "$1: unknown synthetic workload"
+    CDECL_PHASE_PROFILE=$PROFILE cdecl --no-config $INPUT_FILE > /dev/null 2>&1
+    ;;
+  *)
+    TEST=tests/$1.test
+    [ -f "$TEST" ] || error 66 "$TEST: not found"
+    IFS_old=$IFS
+    IFS='@'; read COMMAND CONFIG OPTIONS INPUT EXPECTED_EXIT < $TEST
+    [ "$IFS_old" ] && IFS=$IFS_old
+    COMMAND=`echo $COMMAND`             # trims whitespace
+    CONFIG=`echo $CONFIG`               # trims whitespace
+    [ "$CONFIG" ] && CONFIG="-c data/$CONFIG"
+    echo "$INPUT" | sed 's/^ //' |
+      CDECL_PHASE_PROFILE=$PROFILE $COMMAND $CONFIG $OPTIONS > /dev/null 2>&1
+    ;;
+  esac
+  [ -f $PROFILE ] || error 70 "$1: no profile written"
+}
+
+##
+# Prints the count for phase $1 from $PROFILE.
+##
+phase_count() {
+  awk -v phase=$1 '$1 == phase { print $2 }' $PROFILE
+}
+
+usage() {
+  cat >&2 <<END
+usage: $ME [-t tolerance] [-u] [budgets-file]
+END
+  exit 1
+}
+
+########## Begin ##############################################################
+
+ME=`local_basename "$0"`
+
+[ "$BUILD_SRC" ] || BUILD_SRC=../src
+[ -x "$BUILD_SRC/cdecl" ] || error 66 $BUILD_SRC/cdecl: not found or not executable
+
+##
+# The automake framework sets $srcdir. If it's empty, it means this script was
+# called by hand, so set it ourselves.
+##
+[ "$srcdir" ] || srcdir="."
+
+##
+# Must put BUILD_SRC first in PATH so we get the correct version of cdecl.
+# It's made absolute since we cd to $srcdir so tests find their data files.
+##
+BUILD_SRC=`cd "$BUILD_SRC" && pwd`
+PATH=$BUILD_SRC:$PATH
+
+INPUT_FILE=/tmp/cdecl_perf_input_$$_
+NEW_BUDGETS=/tmp/cdecl_perf_budgets_$$_
+PROFILE=/tmp/cdecl_perf_profile_$$_
+
+trap "x=$?; rm -f /tmp/*_$$_* 2>/dev/null; exit $x" EXIT HUP INT TERM
+
+########## Process command-line ###############################################
+
+TOLERANCE=${CDECL_PERF_TOLERANCE:-5}    # percent
+UPDATE=
+while getopts t:u opt
+do
+  case $opt in
+  t) TOLERANCE=$OPTARG ;;
+  u) UPDATE=1 ;;
+  ?) usage ;;
+  esac
+done
+shift `expr $OPTIND - 1`
+
+[ $# -le 1 ] || usage
+BUDGETS=${1:-$srcdir/perf_budgets}
+[ -f "$BUDGETS" ] || error 66 "$BUDGETS: not found"
+BUDGETS=`cd \`dirname "$BUDGETS"\` && pwd`/`local_basename "$BUDGETS"`
+
+expr "$TOLERANCE" : '[0-9][0-9]*$' > /dev/null ||
+  error 64 "\"$TOLERANCE\": invalid tolerance; must be percent"
+
+cd "$srcdir" || exit 1
+
+########## Check budgets ######################################################
+
+PHASES="lex parse check render"
+FAILURES=0
+MISSING=0
+
+HEADING=1
+while read -r LINE
+do
+  case "$LINE" in
+  ''|\#*)
+    [ "$UPDATE" ] && echo "$LINE" >> $NEW_BUDGETS
+    continue
+    ;;
+  esac
+
+  set -- $LINE
+  WORKLOAD=$1; shift
+  [ $# -eq 4 ] || error 65 "$WORKLOAD: 4 budgets expected"
+
+  run_workload $WORKLOAD
+  if UNAVAILABLE=`sed -n 's/^unavailable: //p' $PROFILE` && [ "$UNAVAILABLE" ]
+  then
+    [ "$UPDATE" ] && error 69 "can not count instructions: $UNAVAILABLE"
+    echo "$ME: skipped: can not count instructions: $UNAVAILABLE"
+    exit 0
+  fi
+
+  if [ "$HEADING" ]
+  then
+    printf "%-32s %-6s %12s %12s %7s\n" WORKLOAD PHASE BUDGET ACTUAL DIFF%
+    HEADING=
+  fi
+
+  ACTUALS=
+  for PHASE in $PHASES
+  do
+    BUDGET=$1; shift
+    ACTUAL=`phase_count $PHASE`
+    [ "$ACTUAL" ] || error 70 "$WORKLOAD: no count for $PHASE"
+    ACTUALS="$ACTUALS $ACTUAL"
+
+    if [ "$BUDGET" = - ]
+    then
+      DIFF=-
+      STATUS="NO BUDGET"
+      MISSING=`expr $MISSING + 1`
+    else
+      DIFF=`awk -v b=$BUDGET -v a=$ACTUAL \
+        'BEGIN { printf( "%+.1f", b > 0 ? (a - b) * 100 / b : 0 ) }'`
+      if awk -v b=$BUDGET -v a=$ACTUAL -v t=$TOLERANCE \
+        'BEGIN { exit !(a > b + b * t / 100) }'
+      then
+        STATUS=FAIL
+        FAILURES=`expr $FAILURES + 1`
+      else
+        STATUS=
+      fi
+    fi
+    printf "%-32s %-6s %12s %12s %7s %s\n" \
+      $WORKLOAD $PHASE $BUDGET $ACTUAL $DIFF "$STATUS"
+  done
+
+  [ "$UPDATE" ] && printf "%-32s %10s %10s %10s %10s\n" \
+    $WORKLOAD $ACTUALS >> $NEW_BUDGETS
+done < "$BUDGETS"
+
+if [ "$UPDATE" ]
+then
+  cp $NEW_BUDGETS "$BUDGETS" || exit 73
+  echo "$ME: updated $BUDGETS"
+  exit 0
+fi
+
+[ $FAILURES -gt 0 ] &&
+  echo "$ME: $FAILURES phase(s) exceeded budget by more than $TOLERANCE%"
+[ $MISSING -gt 0 ] &&
+  echo "$ME: $MISSING phase(s) have no budget (not enforced); record them via: $ME -u"
+[ $FAILURES -eq 0 ] || exit 1
+
+# vim:set et sw=2 ts=2:
@@ -0,0 +1,41 @@
+#! /bin/sh
+##
+#       cdecl -- C gibberish translator
+#       test/data/reload_check_only.sh
+#
+#       Copyright (C) 2021  Paul J. Lucas
+#
+#       This program is free software: you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation, either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+
+# Reloads the configuration file part way through a --check-only input file.
+# Diagnostics for lines after the reload must still carry the input file's
+# path and line number, not the configuration file's.
+
+CDECL=`command -v cdecl` || exit 1
+case $CDECL in
+/*) ;;
+*)  CDECL=`pwd`/$CDECL ;;
+esac
+
+DIR=/tmp/cdecl_reload_$$
+trap 'rm -fr $DIR' EXIT
+mkdir $DIR || exit 1
+cd $DIR
+printf 'typedef int T;\ntypedef int U;\ntypedef int V;\ntypedef int W;\ntypedef int X;\n' > cdeclrc
+printf 'explain int x\nreload\nexplain T y\nexplain foo bar baz\n' > input.cdecl
+
+$CDECL -c cdeclrc -n input.cdecl
+echo "exit $?"
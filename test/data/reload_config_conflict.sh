@@ -0,0 +1,53 @@
+#! /bin/sh
+##
+#       cdecl -- C gibberish translator
+#       test/data/reload_config_conflict.sh
+#
+#       Copyright (C) 2021  Paul J. Lucas
+#
+#       This program is free software: you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation, either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# Defines T interactively, then reloads a configuration file that now defines
+# T differently.  The interactive T must be kept (and still be found by
+# typedef hints) and the conflict reported.
+
+CDECL=`command -v cdecl` || exit 1
+case $CDECL in
+/*) ;;
+*)  CDECL=`pwd`/$CDECL ;;
+esac
+
+# Run in a directory of our own so the path in the message is always the same.
+DIR=/tmp/cdecl_reload_$$
+trap 'rm -fr $DIR' EXIT
+mkdir $DIR || exit 1
+cd $DIR
+echo 'typedef int U;' > cdeclrc
+
+{
+  echo 'typedef int *T;'
+  #
+  # Cdecl reads its input only after reading the configuration file, so once
+  # more than a pipe buffer's worth of empty lines has been written, it's safe
+  # to change the file.
+  #
+  awk 'BEGIN { for ( i = 0; i < 70000; ++i ) print "" }'
+  echo 'typedef char *T; typedef int U; typedef long V;' > cdeclrc
+  echo 'reload'
+  echo 'set typedef-hints'
+  echo 'explain int **p'
+  echo 'explain char **q'
+  echo 'show user typedef'
+} | $CDECL -c cdeclrc
@@ -0,0 +1,106 @@
+#! /bin/sh
+##
+#       cdecl -- C gibberish translator
+#       test/lexer_diff.sh
+#
+#       Copyright (C) 2021  Paul J. Lucas
+#
+#       This program is free software: you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation, either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# Runs every test twice, once with the lexer's hand-written fast path and once
+# with only Flex, printing every token via CDECL_DEBUG_LEXER, and checks that
+# the token streams (and all other output) are identical.
+
+# Uncomment the following line for shell tracing.
+#set -x
+
+########## Functions ##########################################################
+
+error() {
+  exit_status=$1; shift
+  echo $ME: $*
+  exit $exit_status
+}
+
+local_basename() {
+  ##
+  # Autoconf, 11.15:
+  #
+  # basename
+  #   Not all hosts have a working basename. You can use expr instead.
+  ##
+  expr "//$1" : '.*/\(.*\)'
+}
+
+##
+# Runs test $1 with CDECL_DEBUG_LEXER set to $2 writing all output to $3.
+##
+run_test() {
+  IFS_old=$IFS
+  IFS='@'; read COMMAND CONFIG OPTIONS INPUT EXPECTED_EXIT < $1
+  [ "$IFS_old" ] && IFS=$IFS_old
+  COMMAND=`echo $COMMAND`               # trims whitespace
+  CONFIG=`echo $CONFIG`                 # trims whitespace
+  [ "$CONFIG" ] && CONFIG="-c $DATA_DIR/$CONFIG"
+
+  echo "$INPUT" | sed 's/^ //' |
+    CDECL_DEBUG_LEXER=$2 $COMMAND $CONFIG $OPTIONS > $3 2>&1
+  echo "exit status: $?" >> $3
+}
+
+########## Begin ##############################################################
+
+ME=`local_basename "$0"`
+
+[ "$BUILD_SRC" ] || BUILD_SRC=../src
+[ -x "$BUILD_SRC/cdecl" ] || error 66 $BUILD_SRC/cdecl: not found or not executable
+
+[ "$srcdir" ] || srcdir="."
+DATA_DIR=$srcdir/data
+FAST_OUT=/tmp/cdecl_lexer_fast_$$_
+FLEX_OUT=/tmp/cdecl_lexer_flex_$$_
+
+##
+# Must put BUILD_SRC first in PATH so we get the correct version of cdecl.
+##
+PATH=$BUILD_SRC:$PATH
+
+trap "x=$?; rm -f /tmp/*_$$_* 2>/dev/null; exit $x" EXIT HUP INT TERM
+
+echo "explain int x" | CDECL_DEBUG_LEXER=fast cdecl 2>&1 | grep -q '^lexer:' || {
+  echo "$ME: cdecl not built with debugging support: skipped"
+  exit 0
+}
+
+########## Run tests ##########################################################
+
+TOTAL=0
+FAILED=0
+for TEST in $srcdir/tests/*.test
+do
+  run_test $TEST fast $FAST_OUT
+  run_test $TEST flex $FLEX_OUT
+  TOTAL=`expr $TOTAL + 1`
+  cmp -s $FAST_OUT $FLEX_OUT || {
+    echo "FAIL: `local_basename $TEST`"
+    diff $FLEX_OUT $FAST_OUT | head -10
+    FAILED=`expr $FAILED + 1`
+  }
+done
+
+echo "$ME: $FAILED of $TOTAL token streams differ"
+[ $FAILED -eq 0 ]
+
+# vim:set et sw=2 ts=2:
@@ -60,6 +60,72 @@ fail() {
   } > $TRS_FILE
 }
 
+skip() {
+  print_result SKIP $TEST_NAME
+  {
+    echo ":test-result: SKIP"
+    echo ":copy-in-global-log: no"
+  } > $TRS_FILE
+}
+
+##
+# Adds the canonical name (as given to configure --enable-langs) of the
+# language $1 to TEST_LANGS, if $1 is a language.  The generic "C" and "C++"
+# are the newest of each since that's what the tests expect.
+##
+add_test_lang() {
+  TEST_LANG=`echo "$1" | tr 'A-Z' 'a-z'`
+  case $TEST_LANG in
+  lang=*)         TEST_LANG=`expr "x$TEST_LANG" : 'xlang=\(.*\)'` ;;
+  esac
+  case $TEST_LANG in
+  c)              TEST_LANG=c2x ;;
+  c++)            TEST_LANG=c++20 ;;
+  c78|ck\&r|cknr|ckr|k\&r|k\&rc|knr|knrc|kr|krc)
+                  TEST_LANG=knr ;;
+  c89|c90)        TEST_LANG=c89 ;;
+  c17|c18)        TEST_LANG=c17 ;;
+  c95|c99|c11|c2x|c++98|c++03|c++11|c++14|c++17|c++20)
+                  ;;
+  *)              return ;;
+  esac
+  TEST_LANGS="$TEST_LANGS $TEST_LANG"
+}
+
+##
+# Sets TEST_LANGS to the canonical names of the languages the test uses: those
+# given via -x or --language, or via the "set" command; or, if none, the
+# default language.
+##
+set_test_langs() {
+  TEST_LANGS=
+  for OPTION in $OPTIONS
+  do
+    case $OPTION in
+    --language=*) add_test_lang `expr "x$OPTION" : 'x--language=\(.*\)'` ;;
+    --*)          ;;
+    -*x*)         add_test_lang `expr "x$OPTION" : 'x-[^x]*x\(.*\)'` ;;
+    esac
+  done
+  for WORD in `echo "$INPUT" | tr ';' '\n' | sed -n 's/^ *set  *//p'`
+  do
+    add_test_lang "$WORD"
+  done
+  [ "$TEST_LANGS" ] || TEST_LANGS=c2x
+}
+
+##
+# Returns 0 only if language $1 is enabled, i.e., either all languages are
+# (CDECL_TEST_LANGS is empty) or it's among those in CDECL_TEST_LANGS.
+##
+is_lang_enabled() {
+  [ -z "$CDECL_TEST_LANGS" ] && return 0
+  case " $CDECL_TEST_LANGS " in
+  *" $1 "*) return 0 ;;
+  esac
+  return 1
+}
+
 print_result() {
   RESULT=$1; shift
   COLOR=`eval echo \\$COLOR_$RESULT`
@@ -190,6 +256,7 @@ esac
 DATA_DIR=$srcdir/data
 EXPECTED_DIR=$srcdir/expected
 DIFF_FILE=/tmp/cdecl_diff_$$_
+EXPECTED_FILE=/tmp/cdecl_expected_$$_
 
 ########## Run test ###########################################################
 
@@ -203,6 +270,19 @@ run_cdecl_test() {
   [ "$CONFIG" ] && CONFIG="-c $DATA_DIR/$CONFIG"
   EXPECTED_EXIT=`echo $EXPECTED_EXIT`   # trims whitespace
 
+  ##
+  # In a build for only some languages (configure --enable-langs), skip tests
+  # that use any other language.
+  ##
+  if [ "$CDECL_TEST_LANGS" ]
+  then
+    set_test_langs
+    for TEST_LANG in $TEST_LANGS
+    do
+      is_lang_enabled $TEST_LANG || { skip; return; }
+    done
+  fi
+
   #echo "$INPUT" \| $COMMAND $CONFIG "$OPTIONS" \> $LOG_FILE
   if echo "$INPUT" | sed 's/^ //' |
      $COMMAND $CONFIG $OPTIONS > $LOG_FILE 2>&1
@@ -211,6 +291,16 @@ run_cdecl_test() {
     then
       EXPECTED_OUTPUT="$EXPECTED_DIR/`echo $TEST_NAME | sed s/test$/out/`"
       assert_exists $EXPECTED_OUTPUT
+      if ! is_lang_enabled c99
+      then
+        ##
+        # The predefined Embedded C types are compiled out when C99 isn't
+        # enabled, so drop them from the "show" output.
+        ##
+        grep -v -E '(^|[^A-Za-z_0-9])u?int_u?[hl]?[kr]_t([^A-Za-z_0-9]|$)' \
+          $EXPECTED_OUTPUT > $EXPECTED_FILE
+        EXPECTED_OUTPUT=$EXPECTED_FILE
+      fi
       if diff $EXPECTED_OUTPUT $LOG_FILE > $DIFF_FILE
       then pass
       else fail; mv $DIFF_FILE $LOG_FILE